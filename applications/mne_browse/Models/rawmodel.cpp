@@ -383,6 +383,9 @@ bool RawModel::loadFiffData(QFile* qFile)
 
     m_pfiffIO = QSharedPointer<FiffIO>(new FiffIO(*qFile));
     if(!m_pfiffIO->m_qlistRaw.empty()) {
+        //Decode the data buffers directly out of a memory mapping of the file
+        m_pfiffIO->m_qlistRaw[0]->setMemoryMapped(true);
+
         m_iAbsFiffCursor = m_pfiffIO->m_qlistRaw[0]->first_samp; //Set cursor somewhere into fiff file [in samples]
         m_iCurAbsScrollPos = 0;
         m_bStartReached = true;
@@ -395,6 +398,9 @@ bool RawModel::loadFiffData(QFile* qFile)
 
         newDataPackage = QSharedPointer<DataPackage>(new DataPackage(t_data, (MatrixXdR)t_times));
 
+        //Reloads are served by a reader which reads the following windows ahead
+        m_pRawReader = FiffRawReader::SPtr(new FiffRawReader(*m_pfiffIO->m_qlistRaw[0], m_iWindowSize));
+
         m_bFileloaded = true;
     }
     else {
@@ -497,6 +503,7 @@ void RawModel::loadFiffInfos()
 void RawModel::clearModel()
 {
     //FiffIO object
+    m_pRawReader.clear();
     m_pfiffIO.clear();
     m_chInfolist.clear();
 
@@ -626,11 +633,16 @@ QPair<MatrixXd,MatrixXd> RawModel::readSegment(fiff_int_t from, fiff_int_t to)
 {
     QPair<MatrixXd,MatrixXd> datatime;
 
-    m_Mutex.lock();
-    if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(datatime.first, datatime.second, from, to)) {
-        printf("RawModel: Error when reading raw data!");
+    //Full windows come from the read-ahead reader, which keeps on reading in scroll direction
+    if(m_pRawReader && to - from + 1 == m_pRawReader->blockSize()) {
+        if(!m_pRawReader->read(from, datatime.first, datatime.second, !m_bReloadBefore))
+            printf("RawModel: Error when reading raw data!");
         return datatime;
     }
+
+    m_Mutex.lock();
+    if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(datatime.first, datatime.second, from, to))
+        printf("RawModel: Error when reading raw data!");
     m_Mutex.unlock();
 
     return datatime;
@@ -975,6 +987,10 @@ void RawModel::updateProjections()
             m_pfiffIO->m_qlistRaw[0]->proj.resize(0,0);
         }
 
+        //the blocks read ahead still carry the old projector
+        if(m_pRawReader)
+            m_pRawReader->setProjAndComp(m_pfiffIO->m_qlistRaw[0]->proj, m_pfiffIO->m_qlistRaw[0]->comp);
+
         if(m_iCurAbsScrollPos == 0)
             resetPosition(m_iCurAbsScrollPos + firstSample());
         else
@@ -1008,6 +1024,10 @@ void RawModel::updateCompensator(int to)
         //set compensator for upcoming read raw segement calls
         m_pfiffIO->m_qlistRaw[0]->comp = newComp;
 
+        //the blocks read ahead still carry the old compensator
+        if(m_pRawReader)
+            m_pRawReader->setProjAndComp(m_pfiffIO->m_qlistRaw[0]->proj, m_pfiffIO->m_qlistRaw[0]->comp);
+
         if(m_iCurAbsScrollPos == 0)
             resetPosition(m_iCurAbsScrollPos + firstSample());
         else
@@ -107,6 +107,7 @@
 
 #include <fiff/fiff.h>
 #include <fiff/fiff_io.h>
+#include <fiff/fiff_raw_reader.h>
 #include <mne/mne.h>
 #include <utils/filterTools/parksmcclellan.h>
 
@@ -184,6 +185,7 @@ public:
     QList<FiffChInfo>                           m_chInfolist;   /**< List of FiffChInfo objects that holds the corresponding channels information */
     FiffInfo::SPtr                              m_pFiffInfo;    /**< fiff info of whole fiff file */
     QSharedPointer<FIFFLIB::FiffIO>             m_pfiffIO;      /**< FiffIO objects, which holds all the information of the fiff data (excluding the samples!) */
+    FIFFLIB::FiffRawReader::SPtr                m_pRawReader;   /**< Reads the next windows in scroll direction ahead */
     QMap<QString,QSharedPointer<MNEOperator> >  m_Operators;    /**< generated MNEOperator types (FilterOperator,PCA etc.) */
 
 private:
@@ -529,7 +529,9 @@ void FiffSimulator::run()
 
     while(m_bIsRunning)
     {
-        QSharedPointer<Eigen::MatrixXf> t_pRawBuffer(new Eigen::MatrixXf(m_pRawMatrixBuffer->pop()));
+        QSharedPointer<Eigen::MatrixXf> t_pRawBuffer(new Eigen::MatrixXf);
+        if(!m_pRawMatrixBuffer->pop(*t_pRawBuffer))
+            continue;
 //        ++count;
 //        printf("%d raw buffer (%d x %d) generated\r\n", count, t_pRawBuffer->rows(), t_pRawBuffer->cols());
 
@@ -280,8 +280,10 @@ void Neuromag::run()
     {
         if(m_pRawMatrixBuffer)
         {
-            // Pop available Buffers
-            QSharedPointer<Eigen::MatrixXf> t_pRawBuffer(new Eigen::MatrixXf(m_pRawMatrixBuffer->pop()));
+            // Pop available Buffers, a released pop returns no data
+            QSharedPointer<Eigen::MatrixXf> t_pRawBuffer(new Eigen::MatrixXf);
+            if(!m_pRawMatrixBuffer->pop(*t_pRawBuffer))
+                continue;
 //            ++count;
 //            printf("%d raw buffer (%d x %d) generated\r\n", count, t_pRawBuffer->rows(), t_pRawBuffer->cols());
 
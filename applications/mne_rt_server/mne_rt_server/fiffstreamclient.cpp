@@ -0,0 +1,506 @@
+//=============================================================================================================
+/**
+* @file     fiffstreamclient.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     July, 2012
+*
+* @section  LICENSE
+*
+* Copyright (C) 2012, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffStreamClient Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiffstreamclient.h"
+#include "mne_rt_commands.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Fiff INCLUDES
+//=============================================================================================================
+
+#include <utils/ioutils.h>
+#include <fiff/fiff_constants.h>
+#include <fiff/fiff_stream.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtNetwork>
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace RTSERVER;
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define FIFF_STREAM_CLIENT_SOCKET_BUFFER    262144      /**< Bytes handed to the socket ahead of the network */
+#define FIFF_STREAM_CLIENT_MAX_COMMAND      1048576     /**< Largest command tag accepted from a client */
+#define FIFF_STREAM_CLIENT_MAX_QUEUE        33554432    /**< Default limit of the send queue in bytes */
+#define FIFF_STREAM_CLIENT_MAX_DECIMATION   64          /**< Largest decimation factor of the Decimate policy */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffStreamClient::FiffStreamClient(qint32 id)
+: QObject()
+, m_iDataClientId(id)
+, m_sDataClientAlias(QString(""))
+, m_pTcpSocket(Q_NULLPTR)
+, m_iHeadOffset(0)
+, m_iQueuedBytes(0)
+, m_sendPolicy(DropOldest)
+, m_iMaxQueuedBytes(FIFF_STREAM_CLIENT_MAX_QUEUE)
+, m_iDecimation(1)
+, m_iDecimationCounter(0)
+, m_iBytesSent(0)
+, m_iDroppedFrames(0)
+, m_iDecimatedFrames(0)
+, m_iStatsBytesSent(0)
+, m_iStatsMs(0)
+, m_bIsSendingRawBuffer(false)
+{
+    m_timer.start();
+}
+
+
+//*************************************************************************************************************
+
+FiffStreamClient::~FiffStreamClient()
+{
+    if(m_pTcpSocket) {
+        m_pTcpSocket->disconnect(this);
+        m_pTcpSocket->abort();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::init(qintptr socketDescriptor)
+{
+    m_pTcpSocket = new QTcpSocket(this);
+    if (!m_pTcpSocket->setSocketDescriptor(socketDescriptor)) {
+        emit error(m_pTcpSocket->error());
+        emit closed(m_iDataClientId);
+        return;
+    }
+
+    printf("FiffStreamClient (assigned ID %d) accepted from\n\tIP:\t%s\n\tPort:\t%d\n\n",
+           m_iDataClientId,
+           QHostAddress(m_pTcpSocket->peerAddress()).toString().toUtf8().constData(),
+           m_pTcpSocket->peerPort());
+
+    connect(m_pTcpSocket, &QTcpSocket::readyRead, this, &FiffStreamClient::readTags);
+    connect(m_pTcpSocket, &QTcpSocket::bytesWritten, this, &FiffStreamClient::onBytesWritten);
+    connect(m_pTcpSocket, &QTcpSocket::disconnected, this, &FiffStreamClient::onDisconnected);
+}
+
+
+//*************************************************************************************************************
+
+QString FiffStreamClient::getAlias()
+{
+    QMutexLocker t_locker(&m_qMutex);
+    return m_sDataClientAlias;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::setSendPolicy(SendPolicy p_policy, qint64 p_iMaxQueuedBytes)
+{
+    QMutexLocker t_locker(&m_qMutex);
+    m_sendPolicy = p_policy;
+    m_iMaxQueuedBytes = p_iMaxQueuedBytes;
+    m_iDecimation = 1;
+    m_iDecimationCounter = 0;
+}
+
+
+//*************************************************************************************************************
+
+FiffStreamClient::Statistics FiffStreamClient::getStatistics()
+{
+    QMutexLocker t_locker(&m_qMutex);
+
+    qint64 t_iNowMs = m_timer.elapsed();
+
+    Statistics t_stats;
+    t_stats.policy = m_sendPolicy;
+    t_stats.iMaxQueuedBytes = m_iMaxQueuedBytes;
+    t_stats.iQueuedBytes = m_iQueuedBytes;
+    t_stats.iQueuedFrames = m_qSendQueue.size();
+    t_stats.iLagMs = m_qSendQueue.isEmpty() ? 0 : t_iNowMs - m_qSendQueue.head().iEnqueuedMs;
+    t_stats.iBytesSent = m_iBytesSent;
+    t_stats.dThroughput = t_iNowMs > m_iStatsMs ? 1000.0*(m_iBytesSent - m_iStatsBytesSent)/(t_iNowMs - m_iStatsMs) : 0.0;
+    t_stats.iDroppedFrames = m_iDroppedFrames;
+    t_stats.iDecimatedFrames = m_iDecimatedFrames;
+
+    m_iStatsBytesSent = m_iBytesSent;
+    m_iStatsMs = t_iNowMs;
+
+    return t_stats;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffStreamClient::policyName(SendPolicy p_policy)
+{
+    switch(p_policy) {
+        case Decimate:
+            return QString("decimate");
+        case Disconnect:
+            return QString("disconnect");
+        default:
+            return QString("drop-oldest");
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStreamClient::parsePolicy(const QString& p_sName, SendPolicy& p_policy)
+{
+    if(p_sName.compare("drop-oldest", Qt::CaseInsensitive) == 0)
+        p_policy = DropOldest;
+    else if(p_sName.compare("decimate", Qt::CaseInsensitive) == 0)
+        p_policy = Decimate;
+    else if(p_sName.compare("disconnect", Qt::CaseInsensitive) == 0)
+        p_policy = Disconnect;
+    else
+        return false;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::startMeas(qint32 ID)
+{
+    if(ID == m_iDataClientId)
+    {
+        qDebug() << "Activate raw buffer sending.";
+
+        QByteArray t_blockStart;
+        FiffStream t_FiffStreamOut(&t_blockStart, QIODevice::WriteOnly);
+        t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+        enqueue(t_blockStart);
+        m_bIsSendingRawBuffer = true;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::stopMeas(qint32 ID)
+{
+    if((ID == m_iDataClientId || ID == -1) && m_bIsSendingRawBuffer)
+    {
+        qDebug() << "stop raw buffer sending.";
+
+        QByteArray t_blockEnd;
+        FiffStream t_FiffStreamOut(&t_blockEnd, QIODevice::WriteOnly);
+        t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
+        enqueue(t_blockEnd);
+        m_bIsSendingRawBuffer = false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::sendFrame(qint32 ID, const QByteArray& p_blockFrame)
+{
+    if(ID == m_iDataClientId)
+        enqueue(p_blockFrame);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::sendRawFrame(const QByteArray& p_blockFrame)
+{
+    if(m_bIsSendingRawBuffer)
+        enqueue(p_blockFrame, true);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::parseCommand(FiffTag::SPtr p_pTag)
+{
+    if(p_pTag->size() >= 4)
+    {
+        qint32* t_pInt = (qint32*)p_pTag->data();
+        IOUtils::swap_intp(t_pInt);
+        qint32 t_iCmd = t_pInt[0];
+
+        if(t_iCmd == MNE_RT_SET_CLIENT_ALIAS)
+        {
+            //
+            // Set Client Alias
+            //
+            m_qMutex.lock();
+            m_sDataClientAlias = QString(p_pTag->mid(4, p_pTag->size()-4));
+            m_qMutex.unlock();
+            printf("FiffStreamClient (ID %d): new alias = '%s'\r\n\n", m_iDataClientId, getAlias().toUtf8().constData());
+        }
+        else if(t_iCmd == MNE_RT_GET_CLIENT_ID)
+        {
+            //
+            // Send Client ID
+            //
+            printf("FiffStreamClient (ID %d): send client ID %d\r\n\n", m_iDataClientId, m_iDataClientId);
+            writeClientId();
+        }
+        else
+        {
+            printf("FiffStreamClient (ID %d): unknown command\r\n\n", m_iDataClientId);
+        }
+    }
+    else
+    {
+        printf("FiffStreamClient (ID %d): unknown command\r\n\n", m_iDataClientId);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::writeClientId()
+{
+    QByteArray t_blockClientId;
+    FiffStream t_FiffStreamOut(&t_blockClientId, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+    enqueue(t_blockClientId);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::enqueue(const QByteArray& p_blockFrame, bool p_bIsRawBuffer)
+{
+    if(p_blockFrame.isEmpty())
+        return;
+
+    m_qMutex.lock();
+
+    if(p_bIsRawBuffer && m_sendPolicy == Decimate)
+    {
+        //
+        //   Accept every n-th raw buffer, n doubles while the client stays behind and resets once it caught up
+        //
+        if(m_iQueuedBytes <= m_iMaxQueuedBytes/2)
+            m_iDecimation = 1;
+
+        if(++m_iDecimationCounter < m_iDecimation)
+        {
+            ++m_iDecimatedFrames;
+            m_qMutex.unlock();
+            return;
+        }
+        m_iDecimationCounter = 0;
+        if(m_iQueuedBytes > m_iMaxQueuedBytes/2)
+            m_iDecimation = qMin(2*m_iDecimation, FIFF_STREAM_CLIENT_MAX_DECIMATION);
+    }
+
+    //Implicit sharing: the queue holds a reference to the frame, the bytes are not copied
+    QueuedFrame t_frame;
+    t_frame.block = p_blockFrame;
+    t_frame.iEnqueuedMs = m_timer.elapsed();
+    t_frame.bIsRawBuffer = p_bIsRawBuffer;
+    m_qSendQueue.enqueue(t_frame);
+    m_iQueuedBytes += p_blockFrame.size();
+
+    if(m_iQueuedBytes > m_iMaxQueuedBytes)
+    {
+        if(m_sendPolicy == Disconnect)
+        {
+            printf("FiffStreamClient (ID %d): send queue exceeds %lld bytes, closing connection\r\n\n", m_iDataClientId, m_iMaxQueuedBytes);
+            m_qMutex.unlock();
+            if(m_pTcpSocket)
+                m_pTcpSocket->abort();
+            return;
+        }
+        dropOldest();
+    }
+
+    m_qMutex.unlock();
+
+    writeQueued();
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::dropOldest()
+{
+    //The first frame may be partially handed to the socket already, dropping it would corrupt the stream
+    QQueue<QueuedFrame>::iterator it = m_qSendQueue.begin();
+    if(it != m_qSendQueue.end() && m_iHeadOffset > 0)
+        ++it;
+
+    while(m_iQueuedBytes > m_iMaxQueuedBytes && it != m_qSendQueue.end())
+    {
+        if(it->bIsRawBuffer)
+        {
+            m_iQueuedBytes -= it->block.size();
+            ++m_iDroppedFrames;
+            it = m_qSendQueue.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::writeQueued()
+{
+    if(!m_pTcpSocket || m_pTcpSocket->state() != QAbstractSocket::ConnectedState)
+        return;
+
+    QMutexLocker t_locker(&m_qMutex);
+
+    //
+    //   Keep the socket buffer short, everything else stays in the shared frames until the network takes it
+    //
+    while(!m_qSendQueue.isEmpty() && m_pTcpSocket->bytesToWrite() < FIFF_STREAM_CLIENT_SOCKET_BUFFER)
+    {
+        const QByteArray& t_blockHead = m_qSendQueue.head().block;
+        qint64 t_iChunk = qMin(t_blockHead.size() - m_iHeadOffset,
+                               FIFF_STREAM_CLIENT_SOCKET_BUFFER - m_pTcpSocket->bytesToWrite());
+        qint64 t_iBytesWritten = m_pTcpSocket->write(t_blockHead.constData() + m_iHeadOffset, t_iChunk);
+        if(t_iBytesWritten <= 0)
+            break;
+
+        m_iHeadOffset += t_iBytesWritten;
+        m_iQueuedBytes -= t_iBytesWritten;
+        if(m_iHeadOffset == t_blockHead.size())
+        {
+            m_qSendQueue.dequeue();
+            m_iHeadOffset = 0;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::readTags()
+{
+    m_qReadBlock.append(m_pTcpSocket->readAll());
+
+    //
+    //   Parse all complete tags: 16 byte big endian header (kind, type, size, next) followed by the data
+    //
+    qint32 t_iPos = 0;
+    while(m_qReadBlock.size() - t_iPos >= (int)sizeof(qint32)*4)
+    {
+        const uchar* t_pHeader = reinterpret_cast<const uchar*>(m_qReadBlock.constData()) + t_iPos;
+        qint32 t_iSize = qFromBigEndian<qint32>(t_pHeader + 8);
+        if(t_iSize < 0 || t_iSize > FIFF_STREAM_CLIENT_MAX_COMMAND)
+        {
+            printf("FiffStreamClient (ID %d): invalid tag size %d, closing connection\r\n\n", m_iDataClientId, t_iSize);
+            m_qReadBlock.clear();
+            m_pTcpSocket->abort();
+            return;
+        }
+        if(m_qReadBlock.size() - t_iPos - (int)sizeof(qint32)*4 < t_iSize)
+            break;
+
+        FiffTag::SPtr t_pTag(new FiffTag());
+        t_pTag->kind = qFromBigEndian<qint32>(t_pHeader);
+        t_pTag->type = qFromBigEndian<qint32>(t_pHeader + 4);
+        t_pTag->next = qFromBigEndian<qint32>(t_pHeader + 12);
+        t_pTag->resize(t_iSize);
+        memcpy(t_pTag->data(), t_pHeader + sizeof(qint32)*4, t_iSize);
+        t_iPos += (qint32)sizeof(qint32)*4 + t_iSize;
+
+        //
+        // Parse the tag
+        //
+        if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
+        {
+            parseCommand(t_pTag);
+        }
+    }
+    m_qReadBlock.remove(0, t_iPos);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::onBytesWritten(qint64 p_iBytes)
+{
+    m_qMutex.lock();
+    m_iBytesSent += p_iBytes;
+    m_qMutex.unlock();
+
+    writeQueued();
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamClient::onDisconnected()
+{
+    m_qMutex.lock();
+    m_qSendQueue.clear();
+    m_iHeadOffset = 0;
+    m_iQueuedBytes = 0;
+    m_qMutex.unlock();
+
+    emit closed(m_iDataClientId);
+}
@@ -0,0 +1,290 @@
+//=============================================================================================================
+/**
+* @file     fiffstreamclient.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     July, 2012
+*
+* @section  LICENSE
+*
+* Copyright (C) 2012, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the FiffStreamClient Class.
+*
+*/
+
+#ifndef FIFFSTREAMCLIENT_H
+#define FIFFSTREAMCLIENT_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_tag.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QMutex>
+#include <QQueue>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTSERVER
+//=============================================================================================================
+
+namespace RTSERVER
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//=============================================================================================================
+/**
+* A connected fiff stream client. All clients live in the I/O thread of the FiffStreamServer and are driven by
+* its event loop: incoming commands are parsed as soon as they arrive and outgoing frames are handed to the
+* socket whenever it drained. The frames are encoded once by the server and shared between all clients.
+*
+* The send queue is bounded. If a slow client lets it grow beyond the limit, the send policy decides whether
+* the oldest raw buffers are dropped, the raw buffers are decimated or the client is disconnected. Control
+* frames (measurement info, block start/end, client ID) are never dropped.
+*
+* @brief A fiff stream client connection, served by the event loop of the server's I/O thread
+*/
+class FiffStreamClient : public QObject
+{
+    Q_OBJECT
+public:
+    //=========================================================================================================
+    /**
+    * What to do with raw buffers when the send queue exceeds its limit.
+    */
+    enum SendPolicy {
+        DropOldest,     /**< Drop the oldest queued raw buffers. */
+        Decimate,       /**< Send only every n-th raw buffer, n doubles while the queue stays above half the limit and falls back to 1 below it. The oldest buffers are dropped if this is not enough. */
+        Disconnect      /**< Close the connection. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Send queue counters of a client.
+    */
+    struct Statistics {
+        SendPolicy policy;          /**< The send policy. */
+        qint64 iMaxQueuedBytes;     /**< Limit of the send queue in bytes. */
+        qint64 iQueuedBytes;        /**< Bytes waiting in the send queue. */
+        qint32 iQueuedFrames;       /**< Frames waiting in the send queue. */
+        qint64 iLagMs;              /**< Age of the oldest queued frame in ms. */
+        qint64 iBytesSent;          /**< Bytes sent since the client connected. */
+        double dThroughput;         /**< Bytes per second sent since the previous statistics request. */
+        qint64 iDroppedFrames;      /**< Raw buffers dropped by DropOldest or the hard limit. */
+        qint64 iDecimatedFrames;    /**< Raw buffers skipped by Decimate. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a FiffStreamClient. The socket is set up by init() after the client was moved to the I/O
+    * thread.
+    *
+    * @param[in] id     The client ID
+    */
+    FiffStreamClient(qint32 id);
+
+    //=========================================================================================================
+    /**
+    * Destroys the FiffStreamClient.
+    */
+    ~FiffStreamClient();
+
+    //=========================================================================================================
+    /**
+    * Takes over the accepted connection. Has to be called in the I/O thread.
+    *
+    * @param[in] socketDescriptor   The socket descriptor of the accepted connection
+    */
+    void init(qintptr socketDescriptor);
+
+    inline qint32 getID();
+
+    QString getAlias();
+
+    //=========================================================================================================
+    /**
+    * Queues a frame which is sent to this client only, if ID matches the client ID.
+    *
+    * @param[in] ID             Target client ID
+    * @param[in] p_blockFrame   The encoded fiff tags
+    */
+    void sendFrame(qint32 ID, const QByteArray& p_blockFrame);
+
+    //=========================================================================================================
+    /**
+    * Queues a raw buffer frame, if raw buffer sending is activated for this client.
+    *
+    * @param[in] p_blockFrame   The encoded data buffer tag, shared with the other clients
+    */
+    void sendRawFrame(const QByteArray& p_blockFrame);
+
+    void startMeas(qint32 ID);
+
+    void stopMeas(qint32 ID);
+
+    //=========================================================================================================
+    /**
+    * Sets the send policy and the send queue limit. Thread safe.
+    *
+    * @param[in] p_policy           What to do when the limit is exceeded
+    * @param[in] p_iMaxQueuedBytes  Limit of the send queue in bytes
+    */
+    void setSendPolicy(SendPolicy p_policy, qint64 p_iMaxQueuedBytes);
+
+    //=========================================================================================================
+    /**
+    * Returns the send queue counters. Thread safe.
+    *
+    * @return the counters
+    */
+    Statistics getStatistics();
+
+    //=========================================================================================================
+    /**
+    * Converts between send policies and their command names ("drop-oldest", "decimate", "disconnect").
+    */
+    static QString policyName(SendPolicy p_policy);
+    static bool parsePolicy(const QString& p_sName, SendPolicy& p_policy);
+
+signals:
+    void error(QTcpSocket::SocketError socketError);
+
+    //=========================================================================================================
+    /**
+    * Emitted when the connection was closed. The server then removes and deletes the client.
+    *
+    * @param[in] id     The client ID
+    */
+    void closed(qint32 id);
+
+private:
+    void parseCommand(QSharedPointer<FiffTag> p_pTag);
+
+    void writeClientId();
+
+    //=========================================================================================================
+    /**
+    * Appends a frame to the send queue, applies the send policy and starts sending.
+    *
+    * @param[in] p_blockFrame   The frame to send
+    * @param[in] p_bIsRawBuffer Whether the frame is a raw buffer, only these are dropped or decimated
+    */
+    void enqueue(const QByteArray& p_blockFrame, bool p_bIsRawBuffer = false);
+
+    //=========================================================================================================
+    /**
+    * Drops the oldest raw buffers until the queue is within the limit. The frame being sent is kept.
+    * m_qMutex has to be locked.
+    */
+    void dropOldest();
+
+    //=========================================================================================================
+    /**
+    * Hands queued frames to the socket until its write buffer reaches the limit. Called again when the socket
+    * wrote data.
+    */
+    void writeQueued();
+
+    //=========================================================================================================
+    /**
+    * Parses all complete tags received so far.
+    */
+    void readTags();
+
+    void onBytesWritten(qint64 p_iBytes);
+
+    void onDisconnected();
+
+    //=========================================================================================================
+    /**
+    * A queued frame.
+    */
+    struct QueuedFrame {
+        QByteArray block;           /**< The frame, shared with the other clients for raw buffers. */
+        qint64 iEnqueuedMs;         /**< Time the frame was queued, see m_timer. */
+        bool bIsRawBuffer;          /**< Whether the frame may be dropped or decimated. */
+    };
+
+    qint32 m_iDataClientId;
+    QString m_sDataClientAlias;
+
+    QMutex m_qMutex;                    /**< Guards alias, send queue, policy and counters, which are accessed by the server thread. */
+
+    QTcpSocket* m_pTcpSocket;           /**< The client connection, owned by this client. */
+
+    QQueue<QueuedFrame> m_qSendQueue;   /**< Frames waiting to be sent. Raw buffer frames are shared. */
+    qint64 m_iHeadOffset;               /**< Bytes of the first queued frame already handed to the socket. */
+    qint64 m_iQueuedBytes;              /**< Bytes in the send queue not yet handed to the socket. */
+
+    SendPolicy m_sendPolicy;            /**< What to do when the queue exceeds m_iMaxQueuedBytes. */
+    qint64 m_iMaxQueuedBytes;           /**< Limit of the send queue in bytes. */
+    qint32 m_iDecimation;               /**< Current decimation factor of the raw buffers. */
+    qint32 m_iDecimationCounter;        /**< Raw buffers skipped since the last accepted one. */
+
+    QElapsedTimer m_timer;              /**< Clock for the lag and throughput counters. */
+    qint64 m_iBytesSent;
+    qint64 m_iDroppedFrames;
+    qint64 m_iDecimatedFrames;
+    qint64 m_iStatsBytesSent;           /**< m_iBytesSent at the previous statistics request. */
+    qint64 m_iStatsMs;                  /**< Time of the previous statistics request. */
+    QByteArray m_qReadBlock;            /**< Received bytes not yet parsed into tags. */
+
+    bool m_bIsSendingRawBuffer;
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 FiffStreamClient::getID()
+{
+    return m_iDataClientId;
+}
+
+} // NAMESPACE
+
+#endif //FIFFSTREAMCLIENT_H
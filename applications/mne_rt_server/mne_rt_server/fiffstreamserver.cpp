@@ -39,11 +39,20 @@
 //=============================================================================================================
 
 #include "fiffstreamserver.h"
-#include "fiffstreamthread.h"
+#include "fiffstreamclient.h"
 
 #include "mne_rt_server.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Fiff INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_constants.h>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // STL INCLUDES
@@ -52,6 +61,14 @@
 #include <stdlib.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QTimer>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -70,7 +87,7 @@ FiffStreamServer::FiffStreamServer(QObject *parent)
 : QTcpServer(parent)
 , m_iNextClientId(0)
 {
-
+    m_ioThread.start();
 }
 
 
@@ -79,6 +96,15 @@ FiffStreamServer::FiffStreamServer(QObject *parent)
 FiffStreamServer::~FiffStreamServer()
 {
     emit closeFiffStreamServer();
+
+    //Pending deferred deletes of the clients are processed when the thread finishes
+    QMap<qint32, FiffStreamClient*>::iterator i;
+    for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
+        i.value()->deleteLater();
+    m_qClientList.clear();
+
+    m_ioThread.quit();
+    m_ioThread.wait();
 }
 
 
@@ -89,7 +115,7 @@ void FiffStreamServer::comClist(Command p_command)
     //ToDo JSON
     QString t_sOutput("");
     t_sOutput.append("\tID\tAlias\r\n");
-    QMap<qint32, FiffStreamThread*>::iterator i;
+    QMap<qint32, FiffStreamClient*>::iterator i;
     for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
     {
         QString str = QString("\t%1\t%2\r\n").arg(i.key()).arg(i.value()->getAlias());
@@ -173,6 +199,92 @@ void FiffStreamServer::comStopAll(Command p_command)
 }
 
 
+//*************************************************************************************************************
+
+void FiffStreamServer::comCstats(Command p_command)
+{
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["cstats"].reply(getClientStatistics());
+
+    Q_UNUSED(p_command);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamServer::comCpolicy(Command p_command)
+{
+    //Parameters are ordered by name: id, limit, policy
+    QString t_sOutput = setClientPolicy(p_command.pValues()[0].toString(),
+                                        p_command.pValues()[1].toInt(),
+                                        p_command.pValues()[2].toString());
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["cpolicy"].reply(t_sOutput);
+}
+
+
+//*************************************************************************************************************
+
+QString FiffStreamServer::getClientStatistics()
+{
+    QString t_sOutput("");
+    t_sOutput.append("\tID\tAlias\tPolicy\tLimit[kB]\tQueued[kB]\tFrames\tLag[ms]\tSent[kB]\tRate[kB/s]\tDropped\tDecimated\r\n");
+    QMap<qint32, FiffStreamClient*>::iterator i;
+    for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
+    {
+        FiffStreamClient::Statistics t_stats = i.value()->getStatistics();
+        QString str = QString("\t%1\t%2\t%3\t%4\t%5\t%6\t%7\t%8\t%9\t%10\t%11\r\n")
+                .arg(i.key())
+                .arg(i.value()->getAlias())
+                .arg(FiffStreamClient::policyName(t_stats.policy))
+                .arg(t_stats.iMaxQueuedBytes/1024)
+                .arg(t_stats.iQueuedBytes/1024)
+                .arg(t_stats.iQueuedFrames)
+                .arg(t_stats.iLagMs)
+                .arg(t_stats.iBytesSent/1024)
+                .arg(t_stats.dThroughput/1024.0, 0, 'f', 1)
+                .arg(t_stats.iDroppedFrames)
+                .arg(t_stats.iDecimatedFrames);
+        t_sOutput.append(str);
+    }
+    t_sOutput.append("\n");
+
+    return t_sOutput;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffStreamServer::setClientPolicy(QString p_sClient, qint32 p_iLimit, const QString& p_sPolicy)
+{
+    qint32 t_id = -1;
+    QString t_sOutput("");
+    t_sOutput.append(parseToId(p_sClient,t_id));
+
+    if(t_id != -1)
+    {
+        FiffStreamClient::SendPolicy t_policy;
+
+        if(!FiffStreamClient::parsePolicy(p_sPolicy, t_policy))
+        {
+            t_sOutput.append("\twarning: unknown policy, use drop-oldest, decimate or disconnect\r\n\n");
+        }
+        else if(p_iLimit <= 0)
+        {
+            t_sOutput.append("\twarning: the queue limit has to be positive\r\n\n");
+        }
+        else
+        {
+            m_qClientList[t_id]->setSendPolicy(t_policy, (qint64)p_iLimit*1024);
+
+            QString str = QString("\tFiffStreamClient (ID: %1) sends with policy %2, queue limit %3 kB\r\n\n")
+                    .arg(t_id).arg(FiffStreamClient::policyName(t_policy)).arg(p_iLimit);
+            t_sOutput.append(str);
+        }
+    }
+
+    return t_sOutput;
+}
+
+
 //*************************************************************************************************************
 
 void FiffStreamServer::connectCommands()
@@ -185,6 +297,8 @@ void FiffStreamServer::connectCommands()
     QObject::connect(&t_pMNERTServer->getCommandManager()["start"], &Command::executed, this, &FiffStreamServer::comStart);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop"], &Command::executed, this, &FiffStreamServer::comStop);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop-all"], &Command::executed, this, &FiffStreamServer::comStopAll);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["cstats"], &Command::executed, this, &FiffStreamServer::comCstats);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["cpolicy"], &Command::executed, this, &FiffStreamServer::comCpolicy);
 
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("clist"), this, &FiffStreamServer::comClist);
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("measinfo"), this, &FiffStreamServer::comMeasinfo);
@@ -208,7 +322,7 @@ void FiffStreamServer::connectCommands()
 //        printf("clist\n");
 
 //        p_blockOutputInfo.append("\tID\tAlias\r\n");
-//        QMap<qint32, FiffStreamThread*>::iterator i;
+//        QMap<qint32, FiffStreamClient*>::iterator i;
 //        for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
 //        {
 //            QString str = QString("\t%1\t%2\r\n").arg(i.key()).arg(i.value()->getAlias());
@@ -322,7 +436,7 @@ QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
         }
         else
         {
-            QMap<qint32, FiffStreamThread*>::iterator i;
+            QMap<qint32, FiffStreamClient*>::iterator i;
             for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
             {
                 if(i.value()->getAlias().compare(p_sRawId) == 0)
@@ -354,7 +468,7 @@ QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
 
 //void FiffStreamServer::clearClients()
 //{
-//    QMap<qint32, FiffStreamThread*>::const_iterator i = m_qClientList.constBegin();
+//    QMap<qint32, FiffStreamClient*>::const_iterator i = m_qClientList.constBegin();
 //    while (i != m_qClientList.constEnd()) {
 //        if(i.value())
 //            delete i.value();
@@ -368,15 +482,36 @@ QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
 
 void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
 {
-    emit remitMeasInfo(ID, p_fiffInfo);
+    QByteArray t_blockMeasInfo;
+    FiffStream t_FiffStreamOut(&t_blockMeasInfo, QIODevice::WriteOnly);
+    p_fiffInfo.writeToStream(&t_FiffStreamOut);
+
+    emit remitMeasInfo(ID, t_blockMeasInfo);
 }
 
 
 //*************************************************************************************************************
-//ToDo increase preformance --> try inline
+
 void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    //
+    //   Encode once, all clients share the same immutable bytes
+    //
+    QByteArray t_blockFrame;
+    FiffStream t_FiffStreamOut(&t_blockFrame, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
+
+    emit remitRawFrame(t_blockFrame);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamServer::removeClient(qint32 id)
+{
+    FiffStreamClient* t_pClient = m_qClientList.take(id);
+    if(t_pClient)
+        t_pClient->deleteLater();
 }
 
 
@@ -384,14 +519,23 @@ void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRa
 
 void FiffStreamServer::incomingConnection(qintptr socketDescriptor)
 {
-    FiffStreamThread* t_pStreamThread = new FiffStreamThread(m_iNextClientId, socketDescriptor, this);
+    FiffStreamClient* t_pClient = new FiffStreamClient(m_iNextClientId);
+    t_pClient->moveToThread(&m_ioThread);
 
-    m_qClientList.insert(m_iNextClientId, t_pStreamThread);
+    m_qClientList.insert(m_iNextClientId, t_pClient);
     ++m_iNextClientId;
 
-    //when thread has finished it gets deleted
-    connect(t_pStreamThread, SIGNAL(finished()), t_pStreamThread, SLOT(deleteLater()));
-    connect(this, SIGNAL(closeFiffStreamServer()), t_pStreamThread, SLOT(deleteLater()));
+    //the client lives in the I/O thread, all connections below are queued
+    connect(this, &FiffStreamServer::remitMeasInfo, t_pClient, &FiffStreamClient::sendFrame);
+    connect(this, &FiffStreamServer::remitRawFrame, t_pClient, &FiffStreamClient::sendRawFrame);
+    connect(this, &FiffStreamServer::startMeasFiffStreamClient, t_pClient, &FiffStreamClient::startMeas);
+    connect(this, &FiffStreamServer::stopMeasFiffStreamClient, t_pClient, &FiffStreamClient::stopMeas);
+
+    //when the connection is closed the client gets deleted
+    connect(t_pClient, &FiffStreamClient::closed, this, &FiffStreamServer::removeClient);
 
-    t_pStreamThread->start();
+    //the socket has to be created in the I/O thread
+    QTimer::singleShot(0, t_pClient, [t_pClient, socketDescriptor]() {
+        t_pClient->init(socketDescriptor);
+    });
 }
@@ -52,6 +52,8 @@
 
 #include <QStringList>
 #include <QTcpServer>
+#include <QThread>
+#include <QByteArray>
 
 
 //*************************************************************************************************************
@@ -76,19 +78,21 @@ using namespace REALTIMELIB;
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
-class FiffStreamThread;
+class FiffStreamClient;
 
 //=============================================================================================================
 /**
 * DECLARE CLASS FiffStreamServer
 *
+* All client connections are served by the event loop of a single I/O thread. Raw buffers are encoded once into
+* an implicitly shared frame, which is handed to every client instead of serialising the buffer per client.
+*
 * @brief The FiffStreamServer class provides
 */
 class FiffStreamServer : public QTcpServer//, public ICommandParser //OLD remove this
 {
     Q_OBJECT
 
-    friend class FiffStreamThread;
 
 public:
 
@@ -102,9 +106,13 @@ public:
 
     //=========================================================================================================
     /**
-    * ToDo...
+    * Returns the client with the given ID.
+    *
+    * @param[in] id     The client ID
+    *
+    * @return the client, NULL if there is no client with this ID
     */
-    inline FiffStreamThread* getClient(qint32 id);
+    inline FiffStreamClient* getClient(qint32 id);
 
     //=========================================================================================================
     /**
@@ -123,16 +131,42 @@ public:
 
 //public slots: --> in Qt 5 not anymore declared as slot
     void forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo);
+    //=========================================================================================================
+    /**
+    * Encodes the raw buffer once into a FIFF_DATA_BUFFER tag and broadcasts the frame to all clients.
+    *
+    * @param[in] m_pMatRawData  The raw buffer
+    */
     void forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
 
+    //=========================================================================================================
+    /**
+    * Returns the table of the send queue counters of all fiff data clients, the reply of the cstats command.
+    *
+    * @return the statistics table
+    */
+    QString getClientStatistics();
+
+    //=========================================================================================================
+    /**
+    * Sets the send policy and the send queue limit of a fiff data client, see the cpolicy command.
+    *
+    * @param[in] p_sClient  The client ID or alias
+    * @param[in] p_iLimit   The queue limit in kB
+    * @param[in] p_sPolicy  The policy name: drop-oldest, decimate or disconnect
+    *
+    * @return the reply of the cpolicy command
+    */
+    QString setClientPolicy(QString p_sClient, qint32 p_iLimit, const QString& p_sPolicy);
+
 signals:
     void requestMeasInfo(qint32 ID);
 
     void startMeasFiffStreamClient(qint32 ID);
     void stopMeasFiffStreamClient(qint32 ID);
 
-    void remitMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    void remitMeasInfo(qint32 ID, const QByteArray& p_blockMeasInfo);
+    void remitRawFrame(const QByteArray& p_blockFrame);
 
     void closeFiffStreamServer();
 
@@ -181,11 +215,37 @@ private:
     */
     void comStopAll(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Prints and sends the send queue counters (lag, throughput, drops) of all fiff data clients
+    *
+    * @param[in] p_command  The client statistics command.
+    */
+    void comCstats(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Sets the send policy and the send queue limit of a fiff data client
+    *
+    * @param[in] p_command  The client policy command.
+    */
+    void comCpolicy(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Removes a client whose connection was closed and deletes it in the I/O thread.
+    *
+    * @param[in] id     The client ID
+    */
+    void removeClient(qint32 id);
+
     QByteArray parseToId(QString& p_sRawId, qint32& p_iParsedId);
 
-    QMap<qint32, FiffStreamThread*> m_qClientList;
+    QMap<qint32, FiffStreamClient*> m_qClientList;
     qint32                          m_iNextClientId;
 
+    QThread                         m_ioThread;         /**< Runs the event loop serving all client sockets. */
+
 };
 
 
@@ -194,9 +254,9 @@ private:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
-FiffStreamThread* FiffStreamServer::getClient(qint32 id)
+FiffStreamClient* FiffStreamServer::getClient(qint32 id)
 {
-    return m_qClientList[id];
+    return m_qClientList.value(id, Q_NULLPTR);
 }
 
 } // NAMESPACE
@@ -320,6 +320,27 @@ void MNERTServer::init()
             "           \"description\": \"Prints and sends all available FiffStreamClients.\","
             "           \"parameters\": {}"
             "        },"
+            "       \"cpolicy\": {"
+            "           \"description\": \"Sets what happens to raw buffers when the send queue of the specified FiffStreamClient exceeds its limit.\","
+            "           \"parameters\": {"
+            "               \"id\": {"
+            "                   \"description\": \"ID/Alias\","
+            "                   \"type\": \"QString\" "
+            "               },"
+            "               \"limit\": {"
+            "                   \"description\": \"Queue limit in kB\","
+            "                   \"type\": \"int\" "
+            "               },"
+            "               \"policy\": {"
+            "                   \"description\": \"drop-oldest, decimate or disconnect\","
+            "                   \"type\": \"QString\" "
+            "               }"
+            "           }"
+            "        },"
+            "       \"cstats\": {"
+            "           \"description\": \"Prints and sends lag, throughput and dropped buffers of all FiffStreamClients.\","
+            "           \"parameters\": {}"
+            "        },"
             "       \"close\": {"
             "           \"description\": \"Closes mne_rt_server.\","
             "           \"parameters\": {}"
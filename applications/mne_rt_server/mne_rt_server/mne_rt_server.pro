@@ -76,7 +76,7 @@ SOURCES += \
     connectormanager.cpp \
     mne_rt_server.cpp \
     fiffstreamserver.cpp \
-    fiffstreamthread.cpp \
+    fiffstreamclient.cpp \
     commandserver.cpp \
     commandthread.cpp
 
@@ -87,7 +87,7 @@ HEADERS += \
     connectormanager.h \
     mne_rt_server.h \
     fiffstreamserver.h \
-    fiffstreamthread.h \
+    fiffstreamclient.h \
     commandserver.h \
     commandthread.h \
     mne_rt_commands.h
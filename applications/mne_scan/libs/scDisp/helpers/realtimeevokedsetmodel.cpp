@@ -629,8 +629,8 @@ void RealTimeEvokedSetModel::filterChanged(QList<FilterData> filterData)
 
     m_iMaxFilterLength = 1;
     for(int i=0; i<filterData.size(); i++) {
-        if(m_iMaxFilterLength<filterData.at(i).m_iFilterOrder) {
-            m_iMaxFilterLength = filterData.at(i).m_iFilterOrder;
+        if(m_iMaxFilterLength<filterData.at(i).getFilterLength()) {
+            m_iMaxFilterLength = filterData.at(i).getFilterLength();
         }
     }
 
@@ -420,7 +420,7 @@ private:
     bool                                m_bProjActivated;               /**< Doo projections flag */
     bool                                m_bCompActivated;               /**< Compensator activated */
     float                               m_fSps;                         /**< Sampling rate */
-    qint32                              m_iMaxFilterLength;             /**< Max order of the current filters */
+    qint32                              m_iMaxFilterLength;             /**< Max length of the current filters, see FilterData::getFilterLength(). */
 
     QString                             m_sFilterChannelType;           /**< Kind of channel which is to be filtered */
     QList<FilterData>                   m_filterData;                   /**< List of currently active filters. */
@@ -224,8 +224,6 @@ bool Averaging::stop()
         m_pAveragingBuffer->releaseFromPop();
         m_pAveragingBuffer->releaseFromPush();
 
-        m_pAveragingBuffer->clear();
-
 //        m_pRTMSAOutput->data()->clear();
     }
     m_qMutex.unlock();
@@ -651,6 +649,8 @@ void Averaging::run()
 
     m_pRtAve->start();
 
+    MatrixXd rawSegment;
+
     while(true)
     {
         {
@@ -668,7 +668,8 @@ void Averaging::run()
         if(doProcessing)
         {
             /* Dispatch the inputs */
-            MatrixXd rawSegment = m_pAveragingBuffer->pop();
+            if(!m_pAveragingBuffer->pop(rawSegment))
+                continue;
 
             m_pRtAve->append(rawSegment);
 
@@ -693,4 +694,8 @@ void Averaging::run()
     m_pActionShowAdjustment->setVisible(false);
 
     m_pRtAve->stop();
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pAveragingBuffer)
+        m_pAveragingBuffer->clear();
 }
@@ -302,7 +302,6 @@ bool BabyMEG::stop()
     m_pRawMatrixBuffer->releaseFromPop();
 
     //Clear Buffers
-    m_pRawMatrixBuffer->clear();
 
     return true;
 }
@@ -348,8 +347,9 @@ void BabyMEG::run()
 
     while(m_bIsRunning) {
         if(m_pRawMatrixBuffer) {
-            //pop matrix
-            matValue = m_pRawMatrixBuffer->pop();
+            //pop matrix, a released pop returns no data
+            if(!m_pRawMatrixBuffer->pop(matValue))
+                continue;
 
             //Update HPI data (for single and continous HPI fitting)
             updateHPI(matValue);
@@ -371,8 +371,11 @@ void BabyMEG::run()
                     this->splitRecordingFile();
                 }
 
+                //The buffer is only queued, the disk never holds up the acquisition
                 m_mutex.lock();
-                m_pOutfid->write_raw_buffer(matValue.cast<double>());
+                if(m_pRawWriter) {
+                    m_pRawWriter->write(matValue);
+                }
                 m_mutex.unlock();
             } else {
                 size = 0;
@@ -388,6 +391,10 @@ void BabyMEG::run()
     if(m_bWriteToFile) {
         this->toggleRecordingFile();
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer)
+        m_pRawMatrixBuffer->clear();
 }
 
 
@@ -754,25 +761,39 @@ void BabyMEG::splitRecordingFile()
     QString nextFileName = m_sRecordFile.remove("_raw.fif");
     nextFileName += QString("-%1_raw.fif").arg(m_iSplitCount);
 
-    //Write the link to the next file
-    qint32 data;
-    m_pOutfid->start_block(FIFFB_REF);
-    data = FIFFV_ROLE_NEXT_FILE;
-    m_pOutfid->write_int(FIFF_REF_ROLE,&data);
-    m_pOutfid->write_string(FIFF_REF_FILE_NAME, nextFileName);
-    m_pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
-    data = m_iSplitCount - 1;
-    m_pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
-    m_pOutfid->end_block(FIFFB_REF);
-
-    //finish file
-    m_pOutfid->finish_writing_raw();
-
-    //start next file
-    m_qFileOut.setFileName(nextFileName);
-    m_pOutfid = FiffStream::start_writing_raw(m_qFileOut, *m_pFiffInfo, m_cals, defaultMatrixXi, false);
-    fiff_int_t first = 0;
-    m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+    qint32 iSplitCount = m_iSplitCount;
+    FiffInfo info = *m_pFiffInfo;
+    RowVectorXd cals = m_cals;
+
+    //The split is done by the I/O thread after all buffers queued so far
+    QMutexLocker locker(&m_mutex);
+    if(!m_pRawWriter) {
+        return;
+    }
+
+    QSharedPointer<QFile> pFileOut = m_pFileOut;
+
+    m_pRawWriter->post([=](FiffStream::SPtr& pOutfid) {
+        //Write the link to the next file
+        qint32 data;
+        pOutfid->start_block(FIFFB_REF);
+        data = FIFFV_ROLE_NEXT_FILE;
+        pOutfid->write_int(FIFF_REF_ROLE,&data);
+        pOutfid->write_string(FIFF_REF_FILE_NAME, nextFileName);
+        pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
+        data = iSplitCount - 1;
+        pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
+        pOutfid->end_block(FIFFB_REF);
+
+        //finish file
+        pOutfid->finish_writing_raw();
+
+        //start next file, the closed file is reused for it
+        pFileOut->setFileName(nextFileName);
+        pOutfid = FiffStream::start_writing_raw(*pFileOut, info, cals, defaultMatrixXi, false);
+        fiff_int_t first = 0;
+        pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+    });
 }
 
 
@@ -783,9 +804,24 @@ void BabyMEG::toggleRecordingFile()
     //Setup writing to file
     if(m_bWriteToFile) {
         m_mutex.lock();
-        m_pOutfid->finish_writing_raw();
+        FiffRawWriter::SPtr pRawWriter = m_pRawWriter;
+        m_pRawWriter.clear();
+        QSharedPointer<QFile> pFileOut = m_pFileOut;
+        m_pFileOut.clear();
         m_mutex.unlock();
 
+        //Destroying the writer waits until the queued buffers and the end of the file are written. The file is
+        //released after the writer, which destroys the stream
+        if(pRawWriter) {
+            pRawWriter->post([](FiffStream::SPtr& pOutfid) {
+                pOutfid->finish_writing_raw();
+            });
+            if(pRawWriter->droppedBuffers() > 0) {
+                qWarning() << "BabyMEG::toggleRecordingFile -" << pRawWriter->droppedBuffers() << "buffers were dropped during the recording.";
+            }
+            pRawWriter.clear();
+        }
+
         m_bWriteToFile = false;
         m_iSplitCount = 0;
 
@@ -807,8 +843,7 @@ void BabyMEG::toggleRecordingFile()
 
         //Initiate the stream for writing to the fif file
         m_sRecordFile = getFilePath(true);
-        m_qFileOut.setFileName(m_sRecordFile);
-        if(m_qFileOut.exists()) {
+        if(QFile::exists(m_sRecordFile)) {
             QMessageBox msgBox;
             msgBox.setText("The file you want to write already exists.");
             msgBox.setInformativeText("Do you want to overwrite this file?");
@@ -825,10 +860,15 @@ void BabyMEG::toggleRecordingFile()
         }
 
         //Start/Prepare writing process. Actual writing is done in run() method.
-        m_mutex.lock();
-        m_pOutfid = FiffStream::start_writing_raw(m_qFileOut, *m_pFiffInfo, m_cals, defaultMatrixXi, false);
+        //From now on the file and the stream are only used by the writer's I/O thread
+        QSharedPointer<QFile> pFileOut(new QFile(m_sRecordFile));
+        FiffStream::SPtr pOutfid = FiffStream::start_writing_raw(*pFileOut, *m_pFiffInfo, m_cals, defaultMatrixXi, false);
         fiff_int_t first = 0;
-        m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+        pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+
+        m_mutex.lock();
+        m_pFileOut = pFileOut;
+        m_pRawWriter = FiffRawWriter::SPtr(new FiffRawWriter(pOutfid));
         m_mutex.unlock();
 
         m_bWriteToFile = true;
@@ -618,7 +618,9 @@ void BCI::BCIOnSensorLevel()
         if(m_iTBWIndexSensor < m_matSlidingWindowSensor.cols())
         {
             //cout<<"About to pop matrix"<<endl;
-            MatrixXd t_mat = m_pBCIBuffer_Sensor->pop();
+            MatrixXd t_mat;
+            if(!m_pBCIBuffer_Sensor->pop(t_mat))
+                return;
             //cout<<"poped matrix"<<endl;
 
             // Get only the rows from the matrix which correspond with the selected features, namely electrodes on sensor level and destrieux clustered regions on source level
@@ -640,7 +642,9 @@ void BCI::BCIOnSensorLevel()
         if(m_iTBWIndexSensor < m_matTimeBetweenWindowsSensor.cols())
         {
             //cout<<"About to pop matrix"<<endl;
-            MatrixXd t_mat = m_pBCIBuffer_Sensor->pop();
+            MatrixXd t_mat;
+            if(!m_pBCIBuffer_Sensor->pop(t_mat))
+                return;
             //cout<<"poped matrix"<<endl;
 
             // Get only the rows from the matrix which correspond with the selected features, namely electrodes on sensor level and destrieux clustered regions on source level
@@ -357,8 +357,6 @@ bool BrainAMP::stop()
     //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
     m_pRawMatrixBuffer_In->releaseFromPop();
 
-    m_pRawMatrixBuffer_In->clear();
-
     m_pRMTSA_BrainAMP->data()->clear();
 
     m_qListReceivedSamples.clear();
@@ -461,6 +459,10 @@ void BrainAMP::run()
     }
 
     //std::cout<<"EXITING - BrainAMP::run()"<<std::endl;
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer_In)
+        m_pRawMatrixBuffer_In->clear();
 }
 
 
@@ -169,8 +169,6 @@ bool Covariance::stop()
     //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
     m_pCovarianceBuffer->releaseFromPop();
 
-    m_pCovarianceBuffer->clear();
-
     return true;
 }
 
@@ -294,12 +292,15 @@ void Covariance::run()
     //
     m_bProcessData = true;
 
+    MatrixXd t_mat;
+
     while (m_bIsRunning)
     {
         if(m_bProcessData)
         {
             /* Dispatch the inputs */
-            MatrixXd t_mat = m_pCovarianceBuffer->pop();
+            if(!m_pCovarianceBuffer->pop(t_mat))
+                continue;
 
             //Add to covariance estimation
             m_pRtCov->append(t_mat);
@@ -318,5 +319,9 @@ void Covariance::run()
 //    m_pActionShowAdjustment->setVisible(false);
 
     m_pRtCov->stop();
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pCovarianceBuffer)
+        m_pCovarianceBuffer->clear();
 }
 
@@ -145,8 +145,6 @@ bool DummyToolbox::stop()
     m_pDummyBuffer->releaseFromPop();
     m_pDummyBuffer->releaseFromPush();
 
-    m_pDummyBuffer->clear();
-
     return true;
 }
 
@@ -221,8 +219,10 @@ void DummyToolbox::run()
 
     while(m_bIsRunning)
     {
-        //Dispatch the inputs
-        MatrixXd t_mat = m_pDummyBuffer->pop();
+        //Dispatch the inputs, a released pop returns no data
+        MatrixXd t_mat;
+        if(!m_pDummyBuffer->pop(t_mat))
+            continue;
 
         //ToDo: Implement your algorithm here
 
@@ -230,6 +230,10 @@ void DummyToolbox::run()
         //Unocmment this if you also uncommented the m_pDummyOutput in the constructor above
         m_pDummyOutput->data()->setValue(t_mat);
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pDummyBuffer)
+        m_pDummyBuffer->clear();
 }
 
 
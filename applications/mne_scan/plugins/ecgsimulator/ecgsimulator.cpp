@@ -232,25 +232,16 @@ bool ECGSimulator::stop()
     //Wait until this thread (TMSI) is stopped
     m_bIsRunning = false;
 
-
     //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
     m_pInBuffer_I->releaseFromPop();
-    m_pInBuffer_I->clear();
     m_pInBuffer_II->releaseFromPop();
-    m_pInBuffer_II->clear();
     m_pInBuffer_III->releaseFromPop();
-    m_pInBuffer_III->clear();
-
 
     //Clear Buffers
     m_pECGChannel_ECG_I->clear();
     m_pECGChannel_ECG_II->clear();
     m_pECGChannel_ECG_III->clear();
 
-    m_pInBuffer_I->clear();
-    m_pInBuffer_II->clear();
-    m_pInBuffer_III->clear();
-
     return true;
 }
 
@@ -316,4 +307,9 @@ void ECGSimulator::run()
             }
         }
     }
+
+    //The consumer drops the values which are left, a clear from stop() would race with the pops
+    m_pInBuffer_I->clear();
+    m_pInBuffer_II->clear();
+    m_pInBuffer_III->clear();
 }
@@ -159,8 +159,6 @@ bool Epidetect::stop()
     m_pEpidetectBuffer->releaseFromPop();
     m_pEpidetectBuffer->releaseFromPush();
 
-    m_pEpidetectBuffer->clear();
-
     return true;
 }
 
@@ -299,7 +297,8 @@ void Epidetect::run()
         //Dispatch the inputs
         if (!overlap)
         {
-            t_mat = m_pEpidetectBuffer->pop();
+            if(!m_pEpidetectBuffer->pop(t_mat))
+                continue;
             data = prepareData(t_mat);
             trimmedData = data.first;
             stimChs = data.second;
@@ -413,6 +412,10 @@ void Epidetect::run()
             m_pEpidetectOutput->data()->setValue(t_mat);
         std::cout << timer.elapsed() << " ms \n";
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pEpidetectBuffer)
+        m_pEpidetectBuffer->clear();
 }
 
 
@@ -216,8 +216,6 @@ bool FiffSimulator::stop()
         //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
         m_pRawMatrixBuffer_In->releaseFromPop();
 
-        m_pRawMatrixBuffer_In->clear();
-
         m_pRTMSA_FiffSimulator->data()->clear();
     }
 
@@ -263,8 +261,9 @@ void FiffSimulator::run()
             if(!m_bIsRunning)
                 break;
         }
-        //pop matrix
-        matValue = m_pRawMatrixBuffer_In->pop();
+        //pop matrix, a released pop returns no data
+        if(!m_pRawMatrixBuffer_In->pop(matValue))
+            continue;
 
         //Update HPI data (for single and continous HPI fitting)
         updateHPI(matValue);
@@ -277,6 +276,10 @@ void FiffSimulator::run()
         //emit values
         m_pRTMSA_FiffSimulator->data()->setValue(matValue.cast<double>());
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer_In)
+        m_pRawMatrixBuffer_In->clear();
 }
 
 
@@ -291,8 +291,6 @@ bool GUSBAmp::stop()
     //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
     m_pRawMatrixBuffer_In->releaseFromPop();
 
-    m_pRawMatrixBuffer_In->clear();
-
     m_pRTMSA_GUSBAmp->data()->clear();
 
     return true;
@@ -341,7 +339,9 @@ void GUSBAmp::run()
         if(m_pGUSBAmpProducer->isRunning())
         {
             //qDebug()<<"GUSBAmp is running";
-            MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
+            MatrixXf matValue;
+            if(!m_pRawMatrixBuffer_In->pop(matValue))
+                continue;
             MatrixXf matValue_show = matValue/1000000; //matvalue for showing
 
             for(int i = 0; i < matValue.cols(); i++){
@@ -370,6 +370,10 @@ void GUSBAmp::run()
                 size = 0;
         }
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer_In)
+        m_pRawMatrixBuffer_In->clear();
 }
 
 
@@ -156,8 +156,6 @@ void MNE::unload()
 
 void MNE::calcFiffInfo()
 {
-    QMutexLocker locker(&m_qMutex);
-
     if(m_qListCovChNames.size() > 0 && m_pFiffInfoInput && m_pFiffInfoForward)
     {
         qDebug() << "Fiff Infos available";
@@ -272,6 +270,7 @@ void MNE::finishedClustering()
     m_qMutex.lock();
     m_bFinishedClustering = true;
     m_pFiffInfoForward = QSharedPointer<FiffInfoBase>(new FiffInfoBase(m_pClusteredFwd->info));
+    m_qWaitCondition.wakeAll();
     m_qMutex.unlock();
 
     emit clusteringFinished();
@@ -301,13 +300,17 @@ bool MNE::start()
 
 bool MNE::stop()
 {
+    m_qMutex.lock();
     m_bIsRunning = false;
+    m_qWaitCondition.wakeAll();
+    m_qMutex.unlock();
 
-    if(m_pRtInvOp->isRunning())
+    if(m_pRtInvOp && m_pRtInvOp->isRunning())
         m_pRtInvOp->stop();
 
     if(m_bProcessData) // Only clear if buffers have been initialised
     {
+        QMutexLocker locker(&m_qMutex);
         m_qVecFiffEvoked.clear();
         m_qVecFiffCov.clear();
     }
@@ -362,15 +365,21 @@ void MNE::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     QSharedPointer<NewRealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>();
 
     if(pRTMSA && m_bReceiveData) {
-        //Check if buffer initialized
-        if(!m_pMatrixDataBuffer)
-            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+        if(!m_pMatrixDataBuffer || !m_pFiffInfoInput) {
+            QMutexLocker locker(&m_qMutex);
 
-        //Fiff Information of the evoked
-        if(!m_pFiffInfoInput) {
-            //qDebug()<<"MNE::updateRTMSA - Creating m_pFiffInfoInput";
-            //m_pFiffInfoInput = QSharedPointer<FiffInfo>(new FiffInfo(pRTMSA->info().data()));
-            m_pFiffInfoInput = pRTMSA->info();
+            //Check if buffer initialized
+            if(!m_pMatrixDataBuffer)
+                m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+
+            //Fiff Information of the evoked
+            if(!m_pFiffInfoInput) {
+                //qDebug()<<"MNE::updateRTMSA - Creating m_pFiffInfoInput";
+                //m_pFiffInfoInput = QSharedPointer<FiffInfo>(new FiffInfo(pRTMSA->info().data()));
+                m_pFiffInfoInput = pRTMSA->info();
+            }
+
+            m_qWaitCondition.wakeAll();
         }
 
         if(m_bProcessData)
@@ -381,6 +390,10 @@ void MNE::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
                 m_pMatrixDataBuffer->push(&t_mat);
             }
+
+            //Raw data, covariances and evokeds share one wake up, so none of them waits for another
+            QMutexLocker locker(&m_qMutex);
+            m_qWaitCondition.wakeAll();
         }
     }
 }
@@ -395,16 +408,16 @@ void MNE::updateRTC(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     //MEG
     if(pRTC && m_bReceiveData)
     {
+        QMutexLocker locker(&m_qMutex);
+
         //Fiff Information of the covariance
         if(m_qListCovChNames.size() != pRTC->getValue()->names.size())
             m_qListCovChNames = pRTC->getValue()->names;
 
         if(m_bProcessData)
-        {
-            m_qMutex.lock();
             m_qVecFiffCov.push_back(pRTC->getValue()->pick_channels(m_qListPickChannels));
-            m_qMutex.unlock();
-        }
+
+        m_qWaitCondition.wakeAll();
     }
 }
 
@@ -439,6 +452,8 @@ void MNE::updateRTE(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
                 }
             }
         }
+
+        m_qWaitCondition.wakeAll();
     }
 }
 
@@ -448,21 +463,24 @@ void MNE::updateRTE(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 void MNE::updateInvOp(MNEInverseOperator::SPtr p_pInvOp)
 {
     qDebug() << "MNE::updateInvOp - START";
-    m_pInvOp = p_pInvOp;
 
     double snr = 3.0;
     double lambda2 = 1.0 / pow(snr, 2); //ToDO estimate lambda using covariance
 
     QString method("dSPM"); //"MNE" | "dSPM" | "sLORETA"
 
-    m_qMutex.lock();
-
-    m_pMinimumNorm = MinimumNorm::SPtr(new MinimumNorm(*m_pInvOp.data(), lambda2, method));
+    MinimumNorm::SPtr t_pMinimumNorm(new MinimumNorm(*p_pInvOp.data(), lambda2, method));
 
     //
-    //   Set up the inverse according to the parameters
+    //   Set up the inverse according to the parameters, the source estimation keeps using the previous kernel
+    //   meanwhile and only waits for the swap
     //
-    m_pMinimumNorm->doInverseSetup(m_iNumAverages,false);
+    t_pMinimumNorm->doInverseSetup(m_iNumAverages,false);
+
+    m_qMutex.lock();
+    m_pInvOp = p_pInvOp;
+    m_pMinimumNorm = t_pMinimumNorm;
+    m_qWaitCondition.wakeAll();
     m_qMutex.unlock();
 }
 
@@ -481,16 +499,20 @@ void MNE::run()
     //
     // Read Fiff Info
     //
-    while(true)
+    m_qMutex.lock();
+    while(m_bIsRunning && !m_pFiffInfo)
     {
-        {
-            QMutexLocker locker(&m_qMutex);
-            if(m_pFiffInfo)
-                break;
-        }
         calcFiffInfo();
-        msleep(10);// Wait for fiff Info
+
+        //Sleep until one of the inputs or the clustering delivered new information
+        if(!m_pFiffInfo)
+            m_qWaitCondition.wait(&m_qMutex);
     }
+    bool t_bIsRunning = m_bIsRunning;
+    m_qMutex.unlock();
+
+    if(!t_bIsRunning)
+        return;
 
     //qDebug() << "m_pClusteredFwd->info.ch_names" << m_pClusteredFwd->info.ch_names;
     //qDebug() << "m_pFiffInfo->ch_names" << m_pFiffInfo->ch_names;
@@ -542,30 +564,57 @@ void MNE::run()
 //    // TEMP INV LOADING END
 //    //
 
-    while(m_bIsRunning)
+    MatrixXd rawSegment;
+    FiffCov t_noiseCov;
+    FiffEvoked t_fiffEvoked;
+
+    while(true)
     {
+        bool t_bNoiseCov = false;
+        bool t_bEvoked = false;
+        bool t_bRawData = false;
+        MinimumNorm::SPtr t_pMinimumNorm;
+
         m_qMutex.lock();
-        qint32 t_covSize = m_qVecFiffCov.size();
-        m_qMutex.unlock();
-        if(t_covSize > 0)
-        {
-            m_qMutex.lock();
-            m_pRtInvOp->appendNoiseCov(m_qVecFiffCov[0]);
-            m_qVecFiffCov.pop_front();
+
+        //Sleep until any of the inputs delivered something, the raw data producer wakes up the same condition
+        while(m_bIsRunning && m_qVecFiffCov.isEmpty() && m_qVecFiffEvoked.isEmpty()
+              && (!m_pMatrixDataBuffer || m_pMatrixDataBuffer->used() == 0))
+            m_qWaitCondition.wait(&m_qMutex);
+
+        if(!m_bIsRunning) {
             m_qMutex.unlock();
+            break;
         }
 
-        m_qMutex.lock();
-        qint32 t_evokedSize = m_qVecFiffEvoked.size();
+        //Only the latest noise covariance and evoked are of interest, older pending ones are stale
+        if(!m_qVecFiffCov.isEmpty()) {
+            t_noiseCov = m_qVecFiffCov.last();
+            m_qVecFiffCov.clear();
+            t_bNoiseCov = true;
+        }
+
+        if(!m_qVecFiffEvoked.isEmpty()) {
+            t_fiffEvoked = m_qVecFiffEvoked.last();
+            m_qVecFiffEvoked.clear();
+            t_bEvoked = true;
+        }
+
+        t_bRawData = !m_pMatrixDataBuffer.isNull();
+        t_pMinimumNorm = m_pMinimumNorm;
+
         m_qMutex.unlock();
 
-        if(m_pMatrixDataBuffer)
+        if(t_bNoiseCov)
+            m_pRtInvOp->appendNoiseCov(t_noiseCov);
+
+        //Never blocks, so pending covariances and evokeds are not held back by the raw data.
+        //Blocks are consumed even without an inverse so the producer is never stalled.
+        if(t_bRawData && m_pMatrixDataBuffer->tryPop(rawSegment))
         {
             //qDebug()<<"MNE::run - Processing RTMSA data";
-            if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
+            if(t_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
             {
-                MatrixXd rawSegment = m_pMatrixDataBuffer->pop();
-
                 float tmin = 1 / m_pFiffInfo->sfreq;
                 float tstep = 1 / m_pFiffInfo->sfreq;
 
@@ -578,25 +627,15 @@ void MNE::run()
 
                 m_pRTSEOutput->data()->setValue(sourceEstimate);
             }
-            else
-            {
-                m_qMutex.lock();
-                m_qVecFiffEvoked.pop_front();
-                m_qMutex.unlock();
-            }
             ++skip_count;
         }
 
-        if(t_evokedSize > 0)
+        if(t_bEvoked)
         {
-            qDebug() << "MNE::run - Processing RTE data - t_evokedSize" << t_evokedSize;
-            if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
+            qDebug() << "MNE::run - Processing RTE data";
+            if(t_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
             {
-                m_qMutex.lock();
-                FiffEvoked t_fiffEvoked = m_qVecFiffEvoked[0];
                 qDebug()<<"MNE::run - t_fiffEvoked.data.rows()"<<t_fiffEvoked.data.rows();
-                m_qVecFiffEvoked.pop_front();
-                m_qMutex.unlock();
 
                 float tmin = ((float)t_fiffEvoked.first) / t_fiffEvoked.info.sfreq;
                 float tstep = 1/t_fiffEvoked.info.sfreq;
@@ -611,12 +650,6 @@ void MNE::run()
 
                 m_pRTSEOutput->data()->setValue(sourceEstimate);
             }
-            else
-            {
-                m_qMutex.lock();
-                m_qVecFiffEvoked.pop_front();
-                m_qMutex.unlock();
-            }
             ++skip_count;
         }
     }
@@ -69,6 +69,7 @@
 
 #include <QtWidgets>
 #include <QFile>
+#include <QWaitCondition>
 
 
 //*************************************************************************************************************
@@ -147,6 +148,11 @@ public:
     */
     virtual void unload();
 
+    //=========================================================================================================
+    /**
+    * Sets up the fiff information once the covariance, the input and the forward solution information are
+    * available. Must be called with m_qMutex locked.
+    */
     void calcFiffInfo();
 
     void doClustering();
@@ -217,6 +223,7 @@ private:
     CircularMatrixBuffer<double>::SPtr                      m_pMatrixDataBuffer;    /**< Holds incoming RealTimeMultiSampleArray data.*/
 
     QMutex m_qMutex;
+    QWaitCondition m_qWaitCondition;    /**< Wakes up the worker when new input arrived or the plugin is stopped. */
 
     QVector<FiffEvoked> m_qVecFiffEvoked;
     qint32 m_iNumAverages;
@@ -355,8 +355,6 @@ bool Neuromag::stop()
         //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
         m_pRawMatrixBuffer_In->releaseFromPop();
 
-        m_pRawMatrixBuffer_In->clear();
-
         m_pRTMSA_Neuromag->data()->clear();
     }
 
@@ -438,10 +436,15 @@ void Neuromag::run()
     MatrixXf matValue;
     while(m_bIsRunning)
     {
-        //pop matrix
-        matValue = m_pRawMatrixBuffer_In->pop();
+        //pop matrix, a released pop returns no data
+        if(!m_pRawMatrixBuffer_In->pop(matValue))
+            continue;
 
         //emit values
         m_pRTMSA_Neuromag->data()->setValue(matValue.cast<double>());
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer_In)
+        m_pRawMatrixBuffer_In->clear();
 }
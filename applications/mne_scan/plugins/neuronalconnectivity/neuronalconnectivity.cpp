@@ -167,8 +167,6 @@ bool NeuronalConnectivity::stop()
     m_pNeuronalConnectivityBuffer->releaseFromPop();
     m_pNeuronalConnectivityBuffer->releaseFromPush();
 
-    m_pNeuronalConnectivityBuffer->clear();
-
     return true;
 }
 
@@ -343,8 +341,10 @@ void NeuronalConnectivity::run()
 
     while(m_bIsRunning)
     {
-        //Dispatch the inputs
-        MatrixXd t_mat = m_pNeuronalConnectivityBuffer->pop();
+        //Dispatch the inputs, a released pop returns no data
+        MatrixXd t_mat;
+        if(!m_pNeuronalConnectivityBuffer->pop(t_mat))
+            continue;
 
         //Do processing after skip count has reached limit
         if((skip_count % m_iDownSample) == 0)
@@ -370,6 +370,10 @@ void NeuronalConnectivity::run()
 
         ++skip_count;
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pNeuronalConnectivityBuffer)
+        m_pNeuronalConnectivityBuffer->clear();
 }
 
 
@@ -338,7 +338,9 @@ void NoiseEstimate::run()
         if(m_bProcessData)
         {
             /* Dispatch the inputs */
-            MatrixXd t_mat = m_pBuffer->pop();
+            MatrixXd t_mat;
+            if(!m_pBuffer->pop(t_mat))
+                continue;
 
             //ToDo: Implement your algorithm here
             m_pRtNoise->append(t_mat);
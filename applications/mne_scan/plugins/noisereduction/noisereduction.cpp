@@ -206,9 +206,6 @@ bool NoiseReduction::stop()
     m_bIsRunning = false;
 
     m_pNoiseReductionBuffer->releaseFromPop();
-    m_pNoiseReductionBuffer->clear();
-
-    m_pNoiseReductionBuffer->clear();
 
     return true;
 }
@@ -485,8 +482,8 @@ void NoiseReduction::filterChanged(QList<FilterData> filterData)
 
     m_iMaxFilterLength = 1;
     for(int i = 0; i < filterData.size(); ++i) {
-        if(m_iMaxFilterLength<filterData.at(i).m_iFilterOrder) {
-            m_iMaxFilterLength = filterData.at(i).m_iFilterOrder;
+        if(m_iMaxFilterLength<filterData.at(i).getFilterLength()) {
+            m_iMaxFilterLength = filterData.at(i).getFilterLength();
         }
     }
 }
@@ -730,10 +727,13 @@ void NoiseReduction::run()
     initSphara();
     createSpharaOperator();
 
+    MatrixXd t_mat;
+
     while(m_bIsRunning)
     {
-        //Dispatch the inputs
-        MatrixXd t_mat = m_pNoiseReductionBuffer->pop();
+        //Dispatch the inputs, a released pop returns no data
+        if(!m_pNoiseReductionBuffer->pop(t_mat))
+            continue;
 
         m_mutex.lock();
 
@@ -757,7 +757,7 @@ void NoiseReduction::run()
 
         //Do temporal filtering here
         if(m_bFilterActivated) {
-            t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
+            m_pRtFilter->filterChannels(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
         }
 
 //        qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
@@ -801,4 +801,8 @@ void NoiseReduction::run()
         //Send the data to the connected plugins and the online display
         m_pNoiseReductionOutput->data()->setValue(t_mat);
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pNoiseReductionBuffer)
+        m_pNoiseReductionBuffer->clear();
 }
@@ -147,8 +147,6 @@ bool Reference::stop()
     m_pRefBuffer->releaseFromPop();
     m_pRefBuffer->releaseFromPush();
 
-    m_pRefBuffer->clear();
-
     return true;
 }
 
@@ -224,8 +222,10 @@ void Reference::run()
 
     while(m_bIsRunning)
     {
-        //Dispatch the inputs
-        MatrixXd t_mat = m_pRefBuffer->pop();
+        //Dispatch the inputs, a released pop returns no data
+        MatrixXd t_mat;
+        if(!m_pRefBuffer->pop(t_mat))
+            continue;
 
         // apply common average reference
         MatrixXd matCAR = EEGRef::applyCAR(t_mat, m_pFiffInfo);
@@ -233,6 +233,10 @@ void Reference::run()
         //Send the data to the connected plugins and the online display
         m_pRefOutput->data()->setValue(matCAR);
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRefBuffer)
+        m_pRefBuffer->clear();
 }
 
 
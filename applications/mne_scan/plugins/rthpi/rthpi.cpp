@@ -278,7 +278,9 @@ void RtHpi::run()
 
     while (m_bIsRunning) {
         if(m_bProcessData) {
-            MatrixXd t_mat = m_pRtHpiBuffer->pop();
+            MatrixXd t_mat;
+            if(!m_pRtHpiBuffer->pop(t_mat))
+                continue;
             m_pRtHPIS->append(t_mat);
         }
         //msleep(1);
@@ -177,7 +177,6 @@ bool RtSss::stop()
         m_pRtSssBuffer->releaseFromPop();
         m_pRtSssBuffer->releaseFromPush();
 
-        m_pRtSssBuffer->clear();
     }
 
     m_bReceiveData = false;
@@ -411,6 +410,8 @@ void RtSss::run()
 
     bool m_bIsHeadMov = true;
 
+    MatrixXd in_mat;
+
     while(m_bIsRunning)
     {
 //        if (m_bIsHeadMov)
@@ -429,7 +430,8 @@ void RtSss::run()
         if(nrows > 0) // check if init
         {
             // * Dispatch the inputs * //
-            MatrixXd in_mat = m_pRtSssBuffer->pop();
+            if(!m_pRtSssBuffer->pop(in_mat))
+                continue;
 //            qDebug() << "size of in_mat (run): " << in_mat.rows() << " x " << in_mat.cols();
 
             //Generate new matrix from picked channels
@@ -490,6 +492,10 @@ void RtSss::run()
     m_bProcessData = false;
     m_bReceiveData = false;
     //qDebug() << "rtSSS stopped.";
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRtSssBuffer)
+        m_pRtSssBuffer->clear();
 }
 
 
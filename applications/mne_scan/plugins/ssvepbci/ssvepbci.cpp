@@ -716,7 +716,9 @@ void SsvepBci::ssvepBciOnSensor()
 
     // Start filling buffers with data from the inputs
     m_bProcessData = true;
-    MatrixXd t_mat = m_pBCIBuffer_Sensor->pop();
+    MatrixXd t_mat;
+    if(!m_pBCIBuffer_Sensor->pop(t_mat))
+        return;
 
     // writing selected feature channels to the time window storage and increase the segment index
     int   writtenSamples = 0;
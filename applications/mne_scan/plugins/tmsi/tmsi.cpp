@@ -562,8 +562,6 @@ bool TMSI::stop()
     //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
     m_pRawMatrixBuffer_In->releaseFromPop();
 
-    m_pRawMatrixBuffer_In->clear();
-
     m_pRMTSA_TMSI->data()->clear();
 
     m_tmsiManualAnnotationWidget->hide();
@@ -657,7 +655,9 @@ void TMSI::run()
         // Check impedances - send new impedance values to graphic scene
         if(m_pTMSIProducer->isRunning() && m_bCheckImpedances)
         {
-            MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
+            MatrixXf matValue;
+            if(!m_pRawMatrixBuffer_In->pop(matValue))
+                continue;
 
             for(qint32 i = 0; i < matValue.cols(); ++i)
                 m_pTmsiImpedanceWidget->updateGraphicScene(matValue.col(i).cast<double>());
@@ -666,7 +666,9 @@ void TMSI::run()
         //pop matrix only if the producer thread is running
         if(m_pTMSIProducer->isRunning() && !m_bCheckImpedances)
         {
-            MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
+            MatrixXf matValue;
+            if(!m_pRawMatrixBuffer_In->pop(matValue))
+                continue;
 
             // Set Beep trigger (if activated)
             if(m_bBeepTrigger && m_qTimerTrigger.elapsed() >= m_iTriggerInterval)
@@ -786,6 +788,10 @@ void TMSI::run()
     }
 
     //std::cout<<"EXITING - TMSI::run()"<<std::endl;
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer_In)
+        m_pRawMatrixBuffer_In->clear();
 }
 
 
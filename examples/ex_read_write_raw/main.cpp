@@ -46,6 +46,7 @@
 
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_raw_reader.h>
 
 
 //*************************************************************************************************************
@@ -139,36 +140,30 @@ int main(int argc, char *argv[])
     //   Set up the reading parameters
     //
     fiff_int_t from = raw.first_samp;
-    fiff_int_t to = raw.last_samp;
     float quantum_sec = 10.0f;//read and write in 10 sec junks
     fiff_int_t quantum = ceil(quantum_sec*raw.info.sfreq);
     //
     //   To read the whole file at once set
     //
-    //quantum     = to - from + 1;
+    //quantum     = raw.last_samp - from + 1;
     //
     //
     //   Read and write all the data
     //
     bool first_buffer = true;
 
-    fiff_int_t first, last;
+    fiff_int_t first;
     MatrixXd data;
     MatrixXd times;
 
-    for(first = from; first < to; first+=quantum)
-    {
-        last = first+quantum-1;
-        if (last > to)
-        {
-            last = to;
-        }
+    //
+    //   The reader reads and decodes the next quanta in background threads while we are writing
+    //
+    FiffRawReader reader(raw, quantum);
+    reader.seek(from);
 
-        if (!raw.read_raw_segment(data,times,first,last/*,picks*/))
-        {
-                printf("error during read_raw_segment\n");
-                return -1;
-        }
+    while(reader.read(data, times, first))
+    {
         //
         //   You can add your own miracle here
         //
@@ -183,6 +178,12 @@ int main(int argc, char *argv[])
         printf("[done]\n");
     }
 
+    if(!reader.atEnd())
+    {
+        printf("error during read_raw_segment\n");
+        return -1;
+    }
+
     outfid->finish_writing_raw();
 
     printf("Finished\n");
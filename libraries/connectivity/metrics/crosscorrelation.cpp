@@ -44,6 +44,8 @@
 #include "network/networkedge.h"
 #include "network/network.h"
 
+#include <utils/fftservice.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -54,14 +56,6 @@
 #include <QtConcurrent>
 
 
-//*************************************************************************************************************
-//=============================================================================================================
-// Eigen INCLUDES
-//=============================================================================================================
-
-#include <unsupported/Eigen/FFT>
-
-
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -69,6 +63,7 @@
 
 using namespace CONNECTIVITYLIB;
 using namespace Eigen;
+using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
@@ -140,40 +135,35 @@ Network CrossCorrelation::crossCorrelation(const QList<MatrixXd> &matDataList, c
 
 QPair<int,double> CrossCorrelation::calcCrossCorrelation(const RowVectorXd &vecFirst, const RowVectorXd &vecSecond)
 {
-    Eigen::FFT<double> fft;
-
     int N = std::max(vecFirst.cols(), vecSecond.cols());
 
     //Compute the FFT size as the "next power of 2" of the input vector's length (max)
     int b = ceil(log2(2.0 * N - 1));
     int fftsize = pow(2,b);
-//    int end = fftsize - 1;
-//    int maxlag = N - 1;
 
-    //Zero Padd
-    RowVectorXd xCorrInputVecFirst = RowVectorXd::Zero(fftsize);
-    xCorrInputVecFirst.head(vecFirst.cols()) = vecFirst;
-
-    RowVectorXd xCorrInputVecSecond = RowVectorXd::Zero(fftsize);
-    xCorrInputVecSecond.head(vecSecond.cols()) = vecSecond;
-
-    //FFT for freq domain to both vectors
+    //FFT for freq domain to both vectors (zero padded to fftsize)
     RowVectorXcd freqvec;
     RowVectorXcd freqvec2;
 
-    fft.fwd(freqvec, xCorrInputVecFirst);
-    fft.fwd(freqvec2, xCorrInputVecSecond);
+    FFTService::fwd(freqvec, vecFirst, fftsize);
+    FFTService::fwd(freqvec2, vecSecond, fftsize);
 
-    //Create conjugate complex
-    freqvec2.conjugate();
+    return calcCrossCorrelation(freqvec, freqvec2, fftsize);
+}
+
+
+//*************************************************************************************************************
+
+QPair<int,double> CrossCorrelation::calcCrossCorrelation(const RowVectorXcd &vecFreqFirst, const RowVectorXcd &vecFreqSecond, int iFFTSize)
+{
+//    int end = iFFTSize - 1;
+//    int maxlag = N - 1;
 
     //Main step of cross corr
-    for (int i = 0; i < fftsize; i++) {
-        freqvec[i] = freqvec[i] * freqvec2[i];
-    }
+    RowVectorXcd freqvec = vecFreqFirst.array() * vecFreqSecond.array();
 
     RowVectorXd result;
-    fft.inv(result, freqvec);
+    FFTService::inv(result, freqvec, iFFTSize);
 
     //Will get rid of extra zero padding
     RowVectorXd result2 = result;//.segment(maxlag, N);
@@ -187,8 +177,7 @@ QPair<int,double> CrossCorrelation::calcCrossCorrelation(const RowVectorXd &vecF
 
 //    std::cout<<"result2(minMaxRange.first)"<<result2(minMaxRange.first)<<std::endl;
 //    std::cout<<"result2(minMaxRange.second)"<<result2(minMaxRange.second)<<std::endl;
-//    std::cout<<"b"<<b<<std::endl;
-//    std::cout<<"fftsize"<<fftsize<<std::endl;
+//    std::cout<<"fftsize"<<iFFTSize<<std::endl;
 //    std::cout<<"end"<<end<<std::endl;
 //    std::cout<<"maxlag"<<maxlag<<std::endl;
 
@@ -207,9 +196,19 @@ MatrixXd CrossCorrelation::calculate(const MatrixXd &data)
     MatrixXd matDist(data.rows(), data.rows());
     matDist.setZero();
 
+    //Compute the FFT size as the "next power of 2" of the row length
+    int b = ceil(log2(2.0 * data.cols() - 1));
+    int fftsize = pow(2,b);
+
+    //Transform all rows at once instead of twice per row pair
+    MatrixXcd matFreq;
+    FFTService::fwd(matFreq, data, fftsize);
+
     for(int i = 0; i < data.rows(); ++i) {
+        RowVectorXcd vecFreqFirst = matFreq.row(i);
+
         for(int j = i; j < data.rows(); ++j) {
-            matDist(i,j) += calcCrossCorrelation(data.row(i), data.row(j)).second;
+            matDist(i,j) += calcCrossCorrelation(vecFreqFirst, matFreq.row(j), fftsize).second;
         }
     }
 
@@ -127,6 +127,18 @@ protected:
     */
     static QPair<int,double> calcCrossCorrelation(const Eigen::RowVectorXd &vecFirst, const Eigen::RowVectorXd &vecSecond);
 
+    //=========================================================================================================
+    /**
+    * Calculates the actual correlation coefficient between two data vectors given their half spectra.
+    *
+    * @param[in] vecFreqFirst    The half spectrum of the first input data row.
+    * @param[in] vecFreqSecond   The half spectrum of the second input data row.
+    * @param[in] iFFTSize        The FFT size the spectra were computed with.
+    *
+    * @return                    The cross position where the maximum correlation was computed.
+    */
+    static QPair<int,double> calcCrossCorrelation(const Eigen::RowVectorXcd &vecFreqFirst, const Eigen::RowVectorXcd &vecFreqSecond, int iFFTSize);
+
     //=========================================================================================================
     /**
     * Calculates the connectivity matrix for a given input data matrix based on the cross correlation coefficient.
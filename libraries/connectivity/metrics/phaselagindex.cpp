@@ -44,6 +44,8 @@
 #include "network/networkedge.h"
 #include "network/network.h"
 
+#include <utils/fftservice.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -54,14 +56,6 @@
 #include <QtConcurrent>
 
 
-//*************************************************************************************************************
-//=============================================================================================================
-// Eigen INCLUDES
-//=============================================================================================================
-
-#include <unsupported/Eigen/FFT>
-
-
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -69,6 +63,7 @@
 
 using namespace CONNECTIVITYLIB;
 using namespace Eigen;
+using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
@@ -140,46 +135,40 @@ Network PhaseLagIndex::phaseLagIndex(const QList<MatrixXd> &matDataList, const M
 
 int PhaseLagIndex::calcPhaseLagIndex(const RowVectorXd& vecFirst, const RowVectorXd& vecSecond)
 {
-    Eigen::FFT<double> fft;
-
     int N = std::max(vecFirst.cols(), vecSecond.cols());
 
     //Compute the FFT size as the "next power of 2" of the input vector's length (max)
     int b = ceil(log2(2.0 * N - 1));
     int fftsize = pow(2,b);
 
-    //Zero Padd
-    RowVectorXd xCorrInputVecFirst = RowVectorXd::Zero(fftsize);
-    xCorrInputVecFirst.head(vecFirst.cols()) = vecFirst;
-
-    RowVectorXd xCorrInputVecSecond = RowVectorXd::Zero(fftsize);
-    xCorrInputVecSecond.head(vecSecond.cols()) = vecSecond;
-
-    //FFT for freq domain to both vectors
+    //FFT for freq domain to both vectors (zero padded to fftsize)
     RowVectorXcd freqvec;
     RowVectorXcd freqvec2;
 
-    fft.fwd(freqvec, xCorrInputVecFirst);
-    fft.fwd(freqvec2, xCorrInputVecSecond);
+    FFTService::fwd(freqvec, vecFirst, fftsize);
+    FFTService::fwd(freqvec2, vecSecond, fftsize);
+
+    return calcPhaseLagIndex(freqvec, freqvec2, fftsize);
+}
 
-    //Create conjugate complex
-    freqvec2.conjugate();
 
+//*************************************************************************************************************
+
+int PhaseLagIndex::calcPhaseLagIndex(const RowVectorXcd& vecFreqFirst, const RowVectorXcd& vecFreqSecond, int iFFTSize)
+{
     //Main step of cross corr
-    freqvec = freqvec.array() * freqvec2.array();
-
-    std::complex<double> cdCSD = freqvec.mean();
-
-    int iSignResult = 0.0;
-    for (int i = 0; i < freqvec.cols(); i++) {
-        //signum and addition of all values
-        if (cdCSD.imag() > 0.0) {
-            iSignResult = 1.0;
-        } else if (cdCSD.imag() == 0.0) {
-            iSignResult = 0.0;
-        } else {
-            iSignResult = -1.0;
-        }
+    RowVectorXcd freqvec = vecFreqFirst.array() * vecFreqSecond.array();
+
+    //Mean over the full spectrum - the bins above Nyquist are the conjugates of the mirrored half spectrum bins
+    int iMirrored = iFFTSize - freqvec.cols();
+    std::complex<double> cdCSD = (freqvec.sum() + std::conj(freqvec.segment(1, iMirrored).sum())) / double(iFFTSize);
+
+    //signum of the imaginary part
+    int iSignResult = 0;
+    if (cdCSD.imag() > 0.0) {
+        iSignResult = 1;
+    } else if (cdCSD.imag() < 0.0) {
+        iSignResult = -1;
     }
 
     return iSignResult;
@@ -266,9 +255,19 @@ MatrixXd PhaseLagIndex::calculate(const MatrixXd &data)
     MatrixXd matDist(data.rows(), data.rows());
     matDist.setZero();
 
+    //Compute the FFT size as the "next power of 2" of the row length
+    int b = ceil(log2(2.0 * data.cols() - 1));
+    int fftsize = pow(2,b);
+
+    //Transform all rows at once instead of twice per row pair
+    MatrixXcd matFreq;
+    FFTService::fwd(matFreq, data, fftsize);
+
     for(int i = 0; i < data.rows(); ++i) {
+        RowVectorXcd vecFreqFirst = matFreq.row(i);
+
         for(int j = i; j < data.rows(); ++j) {
-            matDist(i,j) += calcPhaseLagIndex(data.row(i), data.row(j));
+            matDist(i,j) += calcPhaseLagIndex(vecFreqFirst, matFreq.row(j), fftsize);
         }
     }
 
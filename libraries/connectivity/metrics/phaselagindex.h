@@ -125,6 +125,18 @@ protected:
     */
     static int calcPhaseLagIndex(const Eigen::RowVectorXd &vecFirst, const Eigen::RowVectorXd &vecSecond);
 
+    //=========================================================================================================
+    /**
+    * Calculates the actual phase lag index between two data vectors given their half spectra.
+    *
+    * @param[in] vecFreqFirst    The half spectrum of the first input data row.
+    * @param[in] vecFreqSecond   The half spectrum of the second input data row.
+    * @param[in] iFFTSize        The FFT size the spectra were computed with.
+    *
+    * @return                    The PLI value.
+    */
+    static int calcPhaseLagIndex(const Eigen::RowVectorXcd &vecFreqFirst, const Eigen::RowVectorXcd &vecFreqSecond, int iFFTSize);
+
     //=========================================================================================================
     /**
     * Calculates the connectivity matrix for a given input data matrix based on the correlation coefficient.
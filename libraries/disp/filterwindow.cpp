@@ -176,7 +176,6 @@ void FilterWindow::setFilterParameters(double hp, double lp, int order, int type
 {
     ui->m_doubleSpinBox_highpass->setValue(lp);
     ui->m_doubleSpinBox_lowpass->setValue(hp);
-    ui->m_spinBox_filterTaps->setValue(order);
 
     if(type == 0)
         ui->m_comboBox_filterType->setCurrentText("Lowpass");
@@ -191,6 +190,13 @@ void FilterWindow::setFilterParameters(double hp, double lp, int order, int type
         ui->m_comboBox_designMethod->setCurrentText("Tschebyscheff");
     if(designMethod == 1)
         ui->m_comboBox_designMethod->setCurrentText("Cosine");
+    if(designMethod == 3)
+        ui->m_comboBox_designMethod->setCurrentText("Butterworth (IIR)");
+    if(designMethod == 4)
+        ui->m_comboBox_designMethod->setCurrentText("Chebyshev I (IIR)");
+
+    //Set the order after the design method, since switching between FIR and IIR changes the range of the spin box
+    ui->m_spinBox_filterTaps->setValue(order);
 
     ui->m_doubleSpinBox_transitionband->setValue(transition);
 
@@ -555,6 +561,23 @@ void FilterWindow::changeStateSpinBoxes(int currentIndex)
             break;
     }
 
+    //IIR designs are parametrized by the order of the lowpass prototype instead of the number of taps
+    if(ui->m_comboBox_designMethod->currentIndex() >= 2) {
+        if(ui->m_label_filterTaps->text() != "Filter order:") {
+            ui->m_label_filterTaps->setText("Filter order:");
+            ui->m_spinBox_filterTaps->setRange(1, 16);
+            ui->m_spinBox_filterTaps->setSingleStep(1);
+            ui->m_spinBox_filterTaps->setValue(4);
+        }
+    } else {
+        if(ui->m_label_filterTaps->text() != "Filter taps:") {
+            ui->m_label_filterTaps->setText("Filter taps:");
+            ui->m_spinBox_filterTaps->setRange(2, 256);
+            ui->m_spinBox_filterTaps->setSingleStep(2);
+            ui->m_spinBox_filterTaps->setValue(128);
+        }
+    }
+
     //Change visibility of spin boxes depending on filter type
     switch(ui->m_comboBox_filterType->currentIndex()) {
         case 0: //Bandpass
@@ -610,12 +633,30 @@ void FilterWindow::filterParametersChanged()
     double samplingFrequency = m_dSFreq <= 0 ? 600 : m_dSFreq;
     double nyquistFrequency = samplingFrequency/2;
 
+    //set filter design method
+    FilterData::DesignMethod dMethod = FilterData::Tschebyscheff;
+    if(ui->m_comboBox_designMethod->currentText() == "Tschebyscheff")
+        dMethod = FilterData::Tschebyscheff;
+
+    if(ui->m_comboBox_designMethod->currentText() == "Cosine")
+        dMethod = FilterData::Cosine;
+
+    if(ui->m_comboBox_designMethod->currentText() == "Butterworth (IIR)")
+        dMethod = FilterData::Butterworth;
+
+    if(ui->m_comboBox_designMethod->currentText() == "Chebyshev I (IIR)")
+        dMethod = FilterData::Chebyshev;
+
+    bool bIIR = dMethod == FilterData::Butterworth || dMethod == FilterData::Chebyshev;
+
     //Calculate the needed fft length
     m_iFilterTaps = ui->m_spinBox_filterTaps->value();
-    if(ui->m_spinBox_filterTaps->value()%2 != 0)
+    if(!bIIR && ui->m_spinBox_filterTaps->value()%2 != 0)
         m_iFilterTaps--;
 
     int fftLength = m_iWindowSize + ui->m_spinBox_filterTaps->value() * 4; // *2 to take into account the overlap in front and back after the convolution. Another *2 to take into account the appended and prepended data.
+    if(bIIR)
+        fftLength = m_iWindowSize * 2; // The truncated IIR impulse response is at most a quarter of the fft length, which leaves room for the data plus overhead.
     int exp = ceil(MNEMath::log2(fftLength));
     fftLength = pow(2, exp) <512 ? 512 : pow(2, exp);
 
@@ -637,14 +678,6 @@ void FilterWindow::filterParametersChanged()
         ui->m_doubleSpinBox_lowpass->setMaximum(ui->m_doubleSpinBox_highpass->value());
     }
 
-    //set filter design method
-    FilterData::DesignMethod dMethod = FilterData::Tschebyscheff;
-    if(ui->m_comboBox_designMethod->currentText() == "Tschebyscheff")
-        dMethod = FilterData::Tschebyscheff;
-
-    if(ui->m_comboBox_designMethod->currentText() == "Cosine")
-        dMethod = FilterData::Cosine;
-
     //Generate filters
     QSharedPointer<FilterData> userDefinedFilterOperator;
 
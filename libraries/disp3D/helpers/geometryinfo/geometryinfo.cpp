@@ -42,6 +42,7 @@
 #include "geometryinfo.h"
 
 #include <fiff/fiff_info.h>
+#include <utils/kdtree.h>
 
 
 //*************************************************************************************************************
@@ -49,8 +50,11 @@
 // INCLUDES
 //=============================================================================================================
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <functional>
+#include <queue>
 #include <set>
 
 
@@ -60,6 +64,7 @@
 //=============================================================================================================
 
 #include <QtConcurrent/QtConcurrent>
+#include <QAtomicInt>
 
 
 //*************************************************************************************************************
@@ -76,6 +81,15 @@
 using namespace DISP3DLIB;
 using namespace Eigen;
 using namespace FIFFLIB;
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define SCDC_SOURCE_CHUNK 8     /**< Number of subset vertices a thread takes from the shared counter at once. */
 
 
 //*************************************************************************************************************
@@ -155,102 +169,127 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
 
 //*************************************************************************************************************
 
-QVector<qint32> GeometryInfo::projectSensors(const MatrixX3f &matVertices,
-                                             const QVector<Vector3f> &vecSensorPositions)
+QSharedPointer<SparseMatrix<float> > GeometryInfo::scdcSparse(const MatrixX3f &matVertices,
+                                                              const QVector<QVector<int> > &vecNeighborVertices,
+                                                              QVector<qint32> &vecVertSubset,
+                                                              double dCancelDist)
 {
-    QVector<qint32> vecOutputArray;
+    // check for empty subset:
+    if(vecVertSubset.empty()) {
+        // caller passed an empty subset, need to fill in all vertex IDs
+        qDebug() << "[WARNING] SCDC received empty subset, calculating full distance table";
+        vecVertSubset.reserve(matVertices.rows());
+        for(qint32 id = 0; id < matVertices.rows(); ++id) {
+            vecVertSubset.push_back(id);
+        }
+    }
 
-    qint32 iCores = QThread::idealThreadCount();
-    if (iCores <= 0)
-    {
+    // flatten the adjacency and calculate the edge lengths once for all Dijkstra runs
+    const qint32 n = vecNeighborVertices.size();
+    QVector<qint32> vecAdjStart(n + 1);
+    vecAdjStart[0] = 0;
+    for (qint32 u = 0; u < n; ++u) {
+        vecAdjStart[u + 1] = vecAdjStart[u] + vecNeighborVertices[u].size();
+    }
+
+    QVector<qint32> vecAdjIndex(vecAdjStart[n]);
+    QVector<float> vecAdjWeight(vecAdjStart[n]);
+    for (qint32 u = 0; u < n; ++u) {
+        const QVector<int>& vecNeighbours = vecNeighborVertices[u];
+        for (qint32 ne = 0; ne < vecNeighbours.size(); ++ne) {
+            const qint32 v = vecNeighbours[ne];
+            vecAdjIndex[vecAdjStart[u] + ne] = v;
+            vecAdjWeight[vecAdjStart[u] + ne] = (matVertices.row(u) - matVertices.row(v)).norm();
+        }
+    }
+
+    // distribute calculation on cores, each thread takes the next chunk of the subset when it is done
+    int iCores = QThread::idealThreadCount();
+    if (iCores <= 0) {
         // assume that we have at least two available cores
         iCores = 2;
     }
 
-    const qint32 iSubArraySize = ceil(vecSensorPositions.size() / iCores);
+    std::vector<std::vector<std::pair<qint32, float> > > vecColumns(vecVertSubset.size());
+    QAtomicInt iNextSource(0);
 
-    //small input size no threads needed
-    if(iSubArraySize <= 1)
-    {
-        vecOutputArray.append(nearestNeighbor(matVertices,
-                                              vecSensorPositions.constBegin(),
-                                              vecSensorPositions.constEnd()));
-        return vecOutputArray;
-    }
-    // split input array + thread start
-    QVector<QFuture<QVector<qint32>>> vecThreads(iCores - 1);
-    qint32 iBeginOffset = iSubArraySize;
-    qint32 iEndOffset = iBeginOffset + iSubArraySize;
-    for(qint32 i = 0; i < vecThreads.size(); ++i)
-    {
-        //last round
-        if(i == vecThreads.size() -1)
-        {
-            vecThreads[i] = QtConcurrent::run(nearestNeighbor,
-                                              matVertices,
-                                              vecSensorPositions.constBegin() + iBeginOffset,
-                                              vecSensorPositions.constEnd());
-            break;
-        }
-        else
-        {
-            vecThreads[i] = QtConcurrent::run(nearestNeighbor,
-                                              matVertices,
-                                              vecSensorPositions.constBegin() + iBeginOffset,
-                                              vecSensorPositions.constBegin() + iEndOffset);
-            iBeginOffset = iEndOffset;
-            iEndOffset += iSubArraySize;
-        }
+    QVector<QFuture<void> > vecThreads(iCores - 1);
+    for (int i = 0; i < vecThreads.size(); ++i) {
+        vecThreads[i] = QtConcurrent::run(std::bind(sparseDijkstra,
+                                                    std::ref(vecColumns),
+                                                    std::cref(vecAdjStart),
+                                                    std::cref(vecAdjIndex),
+                                                    std::cref(vecAdjWeight),
+                                                    std::cref(vecVertSubset),
+                                                    &iNextSource,
+                                                    dCancelDist));
     }
-    //calc while waiting for other threads
-    vecOutputArray.append(nearestNeighbor(matVertices,
-                                          vecSensorPositions.constBegin(),
-                                          vecSensorPositions.constBegin() + iSubArraySize));
 
-    //wait for threads to finish
-    for (QFuture<QVector<qint32>>& f : vecThreads) {
+    // use main thread as well
+    sparseDijkstra(vecColumns,
+                   vecAdjStart,
+                   vecAdjIndex,
+                   vecAdjWeight,
+                   vecVertSubset,
+                   &iNextSource,
+                   dCancelDist);
+
+    // wait for all other threads to finish
+    for (QFuture<void>& f : vecThreads) {
         f.waitForFinished();
     }
 
-    //move sub arrays back into output
-    for(qint32 i = 0; i < vecThreads.size(); ++i)
-    {
-        vecOutputArray.append(std::move(vecThreads[i].result()));
+    // convention: first dimension in distance table is "from", second dimension "to"
+    QSharedPointer<SparseMatrix<float> > returnMat = QSharedPointer<SparseMatrix<float> >::create(matVertices.rows(), vecVertSubset.size());
+
+    VectorXi vecColSizes(vecVertSubset.size());
+    for (qint32 c = 0; c < vecVertSubset.size(); ++c) {
+        vecColSizes[c] = vecColumns[c].size();
     }
+    returnMat->reserve(vecColSizes);
 
-    return vecOutputArray;
+    for (qint32 c = 0; c < vecVertSubset.size(); ++c) {
+        std::vector<std::pair<qint32, float> >& vecColumn = vecColumns[c];
+        std::sort(vecColumn.begin(), vecColumn.end());
+        for (const std::pair<qint32, float>& entry : vecColumn) {
+            returnMat->insert(entry.first, c) = entry.second;
+        }
+        std::vector<std::pair<qint32, float> >().swap(vecColumn);
+    }
+    returnMat->makeCompressed();
+
+    return returnMat;
 }
 
 
 //*************************************************************************************************************
 
-QVector<qint32> GeometryInfo::nearestNeighbor(const MatrixX3f &matVertices,
-                                              QVector<Vector3f>::const_iterator itSensorBegin,
-                                              QVector<Vector3f>::const_iterator itSensorEnd)
+QVector<qint32> GeometryInfo::projectSensors(const MatrixX3f &matVertices,
+                                             const QVector<Vector3f> &vecSensorPositions)
 {
-    ///lin search sensor positions
-    QVector<qint32> vecMappedSensors;
-    vecMappedSensors.reserve(std::distance(itSensorBegin, itSensorEnd));
-
-    for(auto sensor = itSensorBegin; sensor != itSensorEnd; ++sensor)
-    {
-        qint32 iChampionId;
-        double iChampDist = std::numeric_limits<double>::max();
-        for(qint32 i = 0; i < matVertices.rows(); ++i)
-        {
-            //calculate 3d euclidian distance
-            double dDist = sqrt(squared(matVertices(i, 0) - (*sensor)[0])  // x-cord
-                    + squared(matVertices(i, 1) - (*sensor)[1])    // y-cord
-                    + squared(matVertices(i, 2) - (*sensor)[2]));  // z-cord
-            if(dDist < iChampDist)
-            {
-                iChampionId = i;
-                iChampDist = dDist;
-            }
-        }
-        vecMappedSensors.push_back(iChampionId);
+    QVector<qint32> vecOutputArray;
+
+    if(vecSensorPositions.isEmpty() || matVertices.rows() == 0) {
+        return vecOutputArray;
+    }
+
+    MatrixX3f matSensorPositions(vecSensorPositions.size(), 3);
+    for(qint32 i = 0; i < vecSensorPositions.size(); ++i) {
+        matSensorPositions.row(i) = vecSensorPositions[i].transpose();
+    }
+
+    // the k-d tree answers each sensor in O(log n), the queries are distributed on all cores
+    KdTree vertexTree(matVertices);
+    MatrixXi matNearest;
+    MatrixXf matDist;
+    vertexTree.knn(matSensorPositions, 1, matNearest, matDist);
+
+    vecOutputArray.reserve(vecSensorPositions.size());
+    for(qint32 i = 0; i < matNearest.rows(); ++i) {
+        vecOutputArray.push_back(matNearest(i, 0));
     }
-    return vecMappedSensors;
+
+    return vecOutputArray;
 }
 
 
@@ -319,6 +358,75 @@ void GeometryInfo::iterativeDijkstra(QSharedPointer<MatrixXd> matOutputDistMatri
 }
 
 
+//*************************************************************************************************************
+
+void GeometryInfo::sparseDijkstra(std::vector<std::vector<std::pair<qint32, float> > > &vecColumns,
+                                  const QVector<qint32> &vecAdjStart,
+                                  const QVector<qint32> &vecAdjIndex,
+                                  const QVector<float> &vecAdjWeight,
+                                  const QVector<qint32> &vecVertSubset,
+                                  QAtomicInt *pNextSource,
+                                  double dCancelDistance)
+{
+    // initialization, the distances are only reset for the vertices touched by the previous root
+    const qint32 n = vecAdjStart.size() - 1;
+    const double INF = FLOAT_INFINITY;
+    std::vector<double> vecMinDists(n, INF);
+    std::vector<qint32> vecTouched;
+
+    // binary heap with lazy deletion: outdated entries are skipped when they are popped
+    typedef std::pair<double, qint32> HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > vertexQ;
+
+    const qint32 iNumSources = vecVertSubset.size();
+
+    for (qint32 iChunk = pNextSource->fetchAndAddRelaxed(SCDC_SOURCE_CHUNK); iChunk < iNumSources; iChunk = pNextSource->fetchAndAddRelaxed(SCDC_SOURCE_CHUNK)) {
+        const qint32 iChunkEnd = std::min(iChunk + SCDC_SOURCE_CHUNK, iNumSources);
+
+        for (qint32 i = iChunk; i < iChunkEnd; ++i) {
+            // init phase of dijkstra: set source node for current iteration and reset data fields
+            const qint32 iRoot = vecVertSubset.at(i);
+            for (qint32 t : vecTouched) {
+                vecMinDists[t] = INF;
+            }
+            vecTouched.clear();
+
+            vecMinDists[iRoot] = 0.0;
+            vecTouched.push_back(iRoot);
+            vertexQ.push(HeapEntry(0.0, iRoot));
+
+            std::vector<std::pair<qint32, float> >& vecColumn = vecColumns[i];
+
+            // dijkstra main loop, vertices beyond the cancel distance are never queued
+            while (vertexQ.empty() == false) {
+                const double dDist = vertexQ.top().first;
+                const qint32 u = vertexQ.top().second;
+                vertexQ.pop();
+
+                if (dDist > vecMinDists[u]) {
+                    continue;
+                }
+                vecColumn.push_back(std::make_pair(u, static_cast<float>(dDist)));
+
+                // visit each neighbour of u
+                for (qint32 e = vecAdjStart[u]; e < vecAdjStart[u + 1]; ++e) {
+                    const qint32 v = vecAdjIndex[e];
+                    const double dDistWithU = dDist + vecAdjWeight[e];
+
+                    if (dDistWithU < vecMinDists[v] && dDistWithU <= dCancelDistance) {
+                        if (vecMinDists[v] == INF) {
+                            vecTouched.push_back(v);
+                        }
+                        vecMinDists[v] = dDistWithU;
+                        vertexQ.push(HeapEntry(dDistWithU, v));
+                    }
+                }
+            }
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 QVector<qint32> GeometryInfo::filterBadChannels(QSharedPointer<Eigen::MatrixXd> matDistanceTable,
@@ -349,3 +457,40 @@ QVector<qint32> GeometryInfo::filterBadChannels(QSharedPointer<Eigen::MatrixXd>
     }
     return vecBadColumns;
 }
+
+
+//*************************************************************************************************************
+
+QVector<qint32> GeometryInfo::filterBadChannels(QSharedPointer<SparseMatrix<float> > matDistanceTable,
+                                                const FIFFLIB::FiffInfo& fiffInfo,
+                                                qint32 iSensorType) {
+    QVector<qint32> vecBadColumns;
+    QVector<const FiffChInfo*> vecSensors;
+    for(const FiffChInfo& s : fiffInfo.chs){
+        //Only take EEG with V as unit or MEG magnetometers with T as unit
+        if(s.kind == iSensorType && (s.unit == FIFF_UNIT_T || s.unit == FIFF_UNIT_V)){
+           vecSensors.push_back(&s);
+        }
+    }
+
+    for(int col = 0; col < vecSensors.size(); ++col){
+        if(fiffInfo.bads.contains(vecSensors[col]->ch_name)){
+            vecBadColumns.push_back(col);
+        }
+    }
+
+    // distances which are not stored are infinity, so simply drop the bad columns' entries
+    if(!vecBadColumns.isEmpty()) {
+        QVector<bool> vecIsBad(matDistanceTable->cols(), false);
+        for(qint32 col : vecBadColumns){
+            if(col < vecIsBad.size()) {
+                vecIsBad[col] = true;
+            }
+        }
+        matDistanceTable->prune([&vecIsBad](const Index&, const Index& col, const float&) {
+            return !vecIsBad[col];
+        });
+    }
+
+    return vecBadColumns;
+}
@@ -51,6 +51,8 @@
 //=============================================================================================================
 
 #include <limits>
+#include <utility>
+#include <vector>
 
 
 //*************************************************************************************************************
@@ -68,6 +70,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 
 //*************************************************************************************************************
@@ -79,6 +82,8 @@ namespace MNELIB {
     class MNEmatVertices;
 }
 
+class QAtomicInt;
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -136,6 +141,26 @@ public:
                                                 QVector<qint32> &pVecVertSubset,
                                                 double dCancelDist = FLOAT_INFINITY);
 
+    //=========================================================================================================
+    /**
+    * @brief scdcSparse                     Calculates surface constrained distances on a mesh and only stores the distances up to the cancel distance.
+    *
+    * The Dijkstra runs of the subset vertices are radius limited and distributed over all cores. In contrast to scdc,
+    * vertices which are not stored in a column are farther away than dCancelDist, i.e. their distance is infinity.
+    * The subset vertex itself is always stored with the distance 0.
+    *
+    * @param[in] matVertices                The surface on which distances should be calculated.
+    * @param[in] vecNeighborVertices        The neighbor vertex information.
+    * @param[in/out] pVecVertSubset         The subset of IDs for which the distances should be calculated.
+    * @param[in] dCancelDist                Distances higher than this are not stored.
+    *
+    * @return                               A sparse float matrix. One column holds the distances for one vertex inside of the passed subset
+    */
+    static QSharedPointer<Eigen::SparseMatrix<float> > scdcSparse(const Eigen::MatrixX3f &matVertices,
+                                                                  const QVector<QVector<int> > &vecNeighborVertices,
+                                                                  QVector<qint32> &pVecVertSubset,
+                                                                  double dCancelDist = FLOAT_INFINITY);
+
     //=========================================================================================================
     /**
     * @brief                            Calculates the nearest neighbor (euclidian distance) vertex to each sensor
@@ -162,30 +187,30 @@ public:
                                              const FIFFLIB::FiffInfo& fiffInfo,
                                              qint32 iSensorType);
 
-protected:
     //=========================================================================================================
     /**
-    * @brief squared        Implemented for better readability only
+    * @brief filterBadChannels          Filters bad channels from a sparse distance table, i.e. removes all distances of their columns
     *
-    * @param[in] dBase      Base double value
+    * @param[out] matDistanceTable      Result of scdcSparse.
+    * @param[in] fiffInfo               Container for sensors.
+    * @param[in] iSensorType            Sensor type to be filtered out, use fiff constants.
     *
-    * @return               Base squared
+    * @return Vector of bad channel indices.
     */
-    static inline  double squared(double dBase);
+    static QVector<qint32> filterBadChannels(QSharedPointer<Eigen::SparseMatrix<float> > matDistanceTable,
+                                             const FIFFLIB::FiffInfo& fiffInfo,
+                                             qint32 iSensorType);
 
+protected:
     //=========================================================================================================
     /**
-    * @brief nearestNeighbor        Calculates the nearest vertex of an MNEmatVertices for each position between the two iterators
+    * @brief squared        Implemented for better readability only
     *
-    * @param[in] matVertices        The MNEmatVertices that holds the vertex information
-    * @param[in] itSensorBegin      The iterator that indicates the start of the wanted section of positions
-    * @param[in] itSensorEnd        The iterator that indicates the end of the wanted section of positions
+    * @param[in] dBase      Base double value
     *
-    * @return                       A vector of nearest vertex IDs that corresponds to the subvector between the two iterators
+    * @return               Base squared
     */
-    static QVector<qint32> nearestNeighbor(const Eigen::MatrixX3f &matVertices,
-                                           QVector<Eigen::Vector3f>::const_iterator itSensorBegin,
-                                           QVector<Eigen::Vector3f>::const_iterator itSensorEnd);
+    static inline  double squared(double dBase);
 
     //=========================================================================================================
     /**
@@ -206,6 +231,28 @@ protected:
                                   qint32 iBegin,
                                   qint32 iEnd,
                                   double dCancelDistance);
+
+    //=========================================================================================================
+    /**
+    * @brief sparseDijkstra             Calculates radius limited shortest distances on a mesh given as flat adjacency arrays.
+    *                                   The subset vertices are taken in chunks from a shared counter until all are done, so that
+    *                                   several threads running this function balance their work.
+    *
+    * @param[out] vecColumns            The (vertex, distance) lists, one for each subset vertex
+    * @param[in] vecAdjStart            Start of the neighbors of each vertex in vecAdjIndex (number of vertices + 1)
+    * @param[in] vecAdjIndex            The neighbor IDs of all vertices
+    * @param[in] vecAdjWeight           The lengths of the edges in vecAdjIndex
+    * @param[in] vecVertSubset          The subset of vertices
+    * @param[in] pNextSource            Shared counter of the next subset index to be processed
+    * @param[in] dCancelDistance        Distance threshold: vertices with a higher distance to the respective root vertex are not stored
+    */
+    static void sparseDijkstra(std::vector<std::vector<std::pair<qint32, float> > > &vecColumns,
+                               const QVector<qint32> &vecAdjStart,
+                               const QVector<qint32> &vecAdjIndex,
+                               const QVector<float> &vecAdjWeight,
+                               const QVector<qint32> &vecVertSubset,
+                               QAtomicInt *pNextSource,
+                               double dCancelDistance);
 };
 
 
@@ -150,6 +150,73 @@ QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const
 }
 
 
+//*************************************************************************************************************
+
+QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const QVector<qint32> &vecProjectedSensors,
+                                                                           const QSharedPointer<SparseMatrix<float> > matDistanceTable,
+                                                                           double (*interpolationFunction) (double),
+                                                                           const double dCancelDist,
+                                                                           const QVector<qint32> &vecExcludeIndex)
+{
+    if(matDistanceTable->rows() == 0 && matDistanceTable->cols() == 0) {
+        qDebug() << "[WARNING] Interpolation::createInterpolationMat - received an empty distance table.";
+        return QSharedPointer<SparseMatrix<float> >::create();
+    }
+
+    // initialization
+    QSharedPointer<Eigen::SparseMatrix<float> > matInterpolationMatrix = QSharedPointer<SparseMatrix<float> >::create(matDistanceTable->rows(), vecProjectedSensors.size());
+
+    // temporary helper structure for filling sparse matrix
+    QVector<Triplet<float> > vecNonZeroEntries;
+    vecNonZeroEntries.reserve(matDistanceTable->nonZeros());
+    const qint32 iRows = matInterpolationMatrix->rows();
+    const qint32 iCols = std::min<qint32>(matInterpolationMatrix->cols(), matDistanceTable->cols());
+
+    // insert all sensor nodes into set for faster lookup during later computation. Also consider bad channels here.
+    QSet<qint32> sensorLookup;
+    int idx = 0;
+
+    for(const qint32& s : vecProjectedSensors){
+        if(!vecExcludeIndex.contains(idx)){
+            sensorLookup.insert(s);
+        }
+        idx++;
+    }
+
+    // main loop: go through the stored distances of each column and accumulate the weights of the "normal" nodes
+    VectorXf vecWeightsSum = VectorXf::Zero(iRows);
+
+    for (qint32 c = 0; c < iCols; ++c) {
+        for (SparseMatrix<float>::InnerIterator it(*matDistanceTable, c); it; ++it) {
+            const qint32 r = it.row();
+            const float dDist = it.value();
+
+            if (dDist < dCancelDist && sensorLookup.contains(r) == false) {
+                const float dValueWeight = std::fabs(1.0 / interpolationFunction(dDist));
+                vecWeightsSum[r] += dValueWeight;
+                vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, c, dValueWeight));
+            }
+        }
+    }
+
+    for (Triplet<float>& t : vecNonZeroEntries) {
+        t = Triplet<float> (t.row(), t.col(), t.value() / vecWeightsSum[t.row()]);
+    }
+
+    // a sensor has been assigned to these nodes, we do not need to interpolate anything
+    //(final vertex signal is equal to sensor input signal, thus factor 1)
+    for (const qint32 r : sensorLookup) {
+        if (r >= 0 && r < iRows) {
+            vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, vecProjectedSensors.indexOf(r), 1));
+        }
+    }
+
+    matInterpolationMatrix->setFromTriplets(vecNonZeroEntries.begin(), vecNonZeroEntries.end());
+
+    return matInterpolationMatrix;
+}
+
+
 //*************************************************************************************************************
 
 VectorXf Interpolation::interpolateSignal(const QSharedPointer<SparseMatrix<float> > matInterpolationMatrix,
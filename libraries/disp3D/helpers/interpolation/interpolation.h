@@ -134,6 +134,25 @@ public:
                                                                               const double dCancelDist = FLOAT_INFINITY,
                                                                               const QVector<qint32> &vecExcludeIndex = QVector<qint32>());
 
+    //=========================================================================================================
+    /**
+    * Calculates the weight matrix like the dense version, but from the sparse distance table of GeometryInfo::scdcSparse.
+    * Distances which are not stored in the table are treated as infinity. The work is proportional to the number of stored distances.
+    *
+    * @param[in] vecProjectedSensors           Vector of IDs of sensor vertices
+    * @param[in] matDistanceTable              Sparse matrix that contains all needed distances
+    * @param[in] interpolationFunction         Function that computes interpolation coefficients using the distance values
+    * @param[in] dCancelDist                   Distances higher than this are ignored, i.e. the respective coefficients are set to zero
+    * @param[in] vecExcludeIndex               The indices to be excluded from vecProjectedSensors, e.g., bad channels (empty by default)
+    *
+    * @return                                  The distance matrix created
+    */
+    static QSharedPointer<Eigen::SparseMatrix<float> > createInterpolationMat(const QVector<qint32> &vecProjectedSensors,
+                                                                              const QSharedPointer<Eigen::SparseMatrix<float> > matDistanceTable,
+                                                                              double (*interpolationFunction) (double),
+                                                                              const double dCancelDist = FLOAT_INFINITY,
+                                                                              const QVector<qint32> &vecExcludeIndex = QVector<qint32>());
+
     //=========================================================================================================
     /**
     * The interpolation essentially corresponds to a matrix * vector multiplication. A vector of sensor data (i.e. a vector of double-values)
@@ -38,7 +38,7 @@ include(../../mne-cpp.pri)
 
 TEMPLATE = lib
 
-QT += network
+QT += network concurrent
 QT -= gui
 
 DEFINES += FIFF_LIBRARY
@@ -81,11 +81,15 @@ else {
 
 SOURCES += fiff.cpp \
     fiff_tag.cpp \
+    fiff_tag_view.cpp \
     fiff_coord_trans.cpp \
     fiff_ch_info.cpp \
     fiff_proj.cpp \
     fiff_named_matrix.cpp \
     fiff_raw_data.cpp \
+    fiff_raw_reader.cpp \
+    fiff_raw_writer.cpp \
+    fiff_raw_codec.cpp \
     fiff_ctf_comp.cpp \
     fiff_id.cpp \
     fiff_info.cpp \
@@ -114,6 +118,7 @@ HEADERS += fiff.h \
     fiff_id.h \
     fiff_constants.h \
     fiff_tag.h \
+    fiff_tag_view.h \
     fiff_coord_trans.h \
     fiff_ch_info.h \
     fiff_proj.h \
@@ -121,6 +126,9 @@ HEADERS += fiff.h \
     fiff_ctf_comp.h \
     fiff_info.h \
     fiff_raw_data.h \
+    fiff_raw_reader.h \
+    fiff_raw_writer.h \
+    fiff_raw_codec.h \
     fiff_dir_entry.h \
     fiff_raw_dir.h \
     fiff_dig_point.h \
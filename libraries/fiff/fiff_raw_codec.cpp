@@ -0,0 +1,606 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_codec.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawCodec class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_codec.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+#include <QVector>
+#include <QAtomicInt>
+#include <QtAlgorithms>
+#include <QtConcurrent/QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define RAW_CODEC_VERSION       2           /**< 2: float words with the sign in bit 0 and the verbatim mode */
+#define RAW_CODEC_HEADER_SIZE   16          /**< version, nchan, nsamp, reserved */
+#define RAW_CODEC_CHAN_HEADER   4           /**< mode, prediction order, Rice parameter, pad */
+#define RAW_CODEC_MODE_INT      0           /**< The channel holds integer valued floats */
+#define RAW_CODEC_MODE_FLOAT    1           /**< The channel is coded by the bit patterns of the floats */
+#define RAW_CODEC_MODE_VERBATIM 2           /**< The channel is stored as big endian floats, coding would not shrink it */
+#define RAW_CODEC_MAX_ORDER     2
+#define RAW_CODEC_MAX_RICE      31
+#define RAW_CODEC_ESCAPE        24          /**< Quotients of this size are replaced by the raw 32 bit residual */
+#define RAW_CODEC_CHAN_BLOCK    16          /**< Channels handled by one concurrent task */
+#define RAW_CODEC_PARALLEL_MIN  65536       /**< Minimal number of samples to distribute a buffer over the cores */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Appends bits MSB first to a byte vector.
+*/
+class RiceWriter
+{
+public:
+    RiceWriter(std::vector<uchar>& p_vecOut)
+    : m_vecOut(p_vecOut)
+    , m_iAcc(0)
+    , m_iBits(0)
+    {
+    }
+
+    inline void put(quint32 p_iValue, int p_iNBits)
+    {
+        if(p_iNBits == 0)
+            return;
+        quint64 t_iMask = (Q_UINT64_C(1) << p_iNBits) - 1;
+        m_iAcc = (m_iAcc << p_iNBits) | (p_iValue & t_iMask);
+        m_iBits += p_iNBits;
+        while(m_iBits >= 8) {
+            m_iBits -= 8;
+            m_vecOut.push_back((uchar)(m_iAcc >> m_iBits));
+        }
+    }
+
+    inline void putRice(quint32 p_iValue, int p_iK)
+    {
+        quint32 t_iQ = p_iValue >> p_iK;
+        if(t_iQ < RAW_CODEC_ESCAPE) {
+            //Unary quotient terminated by a zero, followed by the k low bits
+            put((1u << (t_iQ + 1)) - 2, t_iQ + 1);
+            put(p_iValue, p_iK);
+        } else {
+            put((1u << RAW_CODEC_ESCAPE) - 1, RAW_CODEC_ESCAPE);
+            put(p_iValue, 32);
+        }
+    }
+
+    inline void flush()
+    {
+        if(m_iBits > 0) {
+            m_vecOut.push_back((uchar)(m_iAcc << (8 - m_iBits)));
+            m_iBits = 0;
+        }
+    }
+
+private:
+    std::vector<uchar>& m_vecOut;
+    quint64 m_iAcc;
+    int m_iBits;
+};
+
+
+//=============================================================================================================
+/**
+* Reads bits MSB first. Reading past the end yields zeros, damaged streams therefore never read out of bounds.
+*/
+class RiceReader
+{
+public:
+    RiceReader(const uchar* p_pData, const uchar* p_pEnd)
+    : m_pData(p_pData)
+    , m_pEnd(p_pEnd)
+    , m_iBuf(0)
+    , m_iBits(0)
+    {
+    }
+
+    inline void refill()
+    {
+        while(m_iBits <= 56) {
+            quint64 t_iByte = m_pData < m_pEnd ? *m_pData++ : 0;
+            m_iBuf |= t_iByte << (56 - m_iBits);
+            m_iBits += 8;
+        }
+    }
+
+    inline quint32 get(int p_iNBits)
+    {
+        if(p_iNBits == 0)
+            return 0;
+        refill();
+        quint32 t_iValue = (quint32)(m_iBuf >> (64 - p_iNBits));
+        m_iBuf <<= p_iNBits;
+        m_iBits -= p_iNBits;
+        return t_iValue;
+    }
+
+    inline quint32 getRice(int p_iK)
+    {
+        refill();
+        quint64 t_iOnes = ~m_iBuf;
+        int t_iQ = t_iOnes == 0 ? 64 : (int)qCountLeadingZeroBits(t_iOnes);
+        if(t_iQ >= RAW_CODEC_ESCAPE) {
+            m_iBuf <<= RAW_CODEC_ESCAPE;
+            m_iBits -= RAW_CODEC_ESCAPE;
+            return get(32);
+        }
+        m_iBuf <<= t_iQ + 1;
+        m_iBits -= t_iQ + 1;
+        return ((quint32)t_iQ << p_iK) | get(p_iK);
+    }
+
+private:
+    const uchar* m_pData;
+    const uchar* m_pEnd;
+    quint64 m_iBuf;
+    int m_iBits;
+};
+
+
+//*************************************************************************************************************
+
+inline quint32 zigzag(quint32 p_iResidual)
+{
+    return (p_iResidual << 1) ^ (quint32)((qint32)p_iResidual >> 31);
+}
+
+
+//*************************************************************************************************************
+
+inline quint32 unzigzag(quint32 p_iValue)
+{
+    return (p_iValue >> 1) ^ (0u - (p_iValue & 1u));
+}
+
+
+//*************************************************************************************************************
+
+inline quint32 float_to_word(float p_fValue)
+{
+    //The sign goes to bit 0, so samples of opposite sign but similar magnitude have close words. With the sign
+    //on top, each zero crossing of a zero-mean channel costs a residual of 2^31, i.e. a Rice escape.
+    quint32 t_iBits;
+    std::memcpy(&t_iBits, &p_fValue, sizeof(quint32));
+    return (t_iBits << 1) | (t_iBits >> 31);
+}
+
+
+//*************************************************************************************************************
+
+inline float word_to_float(quint32 p_iWord)
+{
+    quint32 t_iBits = (p_iWord >> 1) | (p_iWord << 31);
+    float t_fValue;
+    std::memcpy(&t_fValue, &t_iBits, sizeof(float));
+    return t_fValue;
+}
+
+
+//*************************************************************************************************************
+
+inline quint32 predict(int p_iOrder, quint32 p_iW1, quint32 p_iW2)
+{
+    //Wrapping unsigned arithmetic, the decoder reproduces the prediction bit exactly
+    switch(p_iOrder) {
+        case 1:
+            return p_iW1;
+        case 2:
+            return 2*p_iW1 - p_iW2;
+        default:
+            return 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+inline quint64 rice_bits(const std::vector<quint32>& p_vecRes, int p_iK)
+{
+    quint64 t_iBits = 0;
+    for(size_t i = 0; i < p_vecRes.size(); ++i) {
+        quint32 t_iQ = p_vecRes[i] >> p_iK;
+        t_iBits += t_iQ < RAW_CODEC_ESCAPE ? t_iQ + 1 + p_iK : RAW_CODEC_ESCAPE + 32;
+    }
+    return t_iBits;
+}
+
+
+//*************************************************************************************************************
+
+void encode_channel(const float* p_pData,
+                    qint32 p_iNChan,
+                    qint32 p_iNSamp,
+                    qint32 p_iChan,
+                    std::vector<quint32>& p_vecWords,
+                    std::vector<quint32>& p_vecRes,
+                    std::vector<uchar>& p_vecOut)
+{
+    //
+    //   Converter counts stored as floats are coded as integers, everything else by the float bits
+    //
+    bool t_bInt = true;
+    for(qint32 s = 0; s < p_iNSamp && t_bInt; ++s) {
+        float t_fValue = p_pData[(qint64)s*p_iNChan + p_iChan];
+        t_bInt = t_fValue == std::floor(t_fValue)
+                && std::fabs(t_fValue) < 2147483648.0f
+                && !(t_fValue == 0.0f && std::signbit(t_fValue));
+    }
+
+    p_vecWords.resize(p_iNSamp);
+    for(qint32 s = 0; s < p_iNSamp; ++s) {
+        float t_fValue = p_pData[(qint64)s*p_iNChan + p_iChan];
+        if(t_bInt)
+            p_vecWords[s] = (quint32)(qint32)t_fValue;
+        else
+            p_vecWords[s] = float_to_word(t_fValue);
+    }
+
+    //
+    //   Choose the prediction order with the smallest residuals
+    //
+    quint64 t_iCost[RAW_CODEC_MAX_ORDER + 1] = {0, 0, 0};
+    for(qint32 s = RAW_CODEC_MAX_ORDER; s < p_iNSamp; ++s) {
+        quint32 w = p_vecWords[s], w1 = p_vecWords[s-1], w2 = p_vecWords[s-2];
+        t_iCost[0] += zigzag(w);
+        t_iCost[1] += zigzag(w - w1);
+        t_iCost[2] += zigzag(w - 2*w1 + w2);
+    }
+    int t_iOrder = 0;
+    for(int o = 1; o <= RAW_CODEC_MAX_ORDER; ++o)
+        if(t_iCost[o] < t_iCost[t_iOrder])
+            t_iOrder = o;
+    t_iOrder = std::min(t_iOrder, (int)p_iNSamp);
+
+    p_vecRes.resize(p_iNSamp - t_iOrder);
+    quint64 t_iSum = 0;
+    for(qint32 s = t_iOrder; s < p_iNSamp; ++s) {
+        quint32 t_iPred = predict(t_iOrder, s > 0 ? p_vecWords[s-1] : 0, s > 1 ? p_vecWords[s-2] : 0);
+        p_vecRes[s - t_iOrder] = zigzag(p_vecWords[s] - t_iPred);
+        t_iSum += p_vecRes[s - t_iOrder];
+    }
+
+    //
+    //   Rice parameter from the mean residual, refined by the exact code length of its neighbours
+    //
+    quint64 t_iCount = p_vecRes.size();
+    int t_iK = 0;
+    while(t_iK < RAW_CODEC_MAX_RICE && (t_iCount << (t_iK + 1)) <= t_iSum)
+        ++t_iK;
+    int t_iBestK = t_iK;
+    quint64 t_iBestBits = rice_bits(p_vecRes, t_iK);
+    for(int k = std::max(t_iK - 1, 0); k <= std::min(t_iK + 1, RAW_CODEC_MAX_RICE); ++k) {
+        if(k == t_iK)
+            continue;
+        quint64 t_iBits = rice_bits(p_vecRes, k);
+        if(t_iBits < t_iBestBits) {
+            t_iBestBits = t_iBits;
+            t_iBestK = k;
+        }
+    }
+
+    p_vecOut.clear();
+
+    //
+    //   Noise-like float channels may not shrink, they are stored as they are
+    //
+    if(!t_bInt && 4*t_iOrder + (t_iBestBits + 7)/8 >= 4*(quint64)p_iNSamp) {
+        p_vecOut.resize(RAW_CODEC_CHAN_HEADER + 4*(size_t)p_iNSamp);
+        p_vecOut[0] = RAW_CODEC_MODE_VERBATIM;
+        p_vecOut[1] = p_vecOut[2] = p_vecOut[3] = 0;
+        for(qint32 s = 0; s < p_iNSamp; ++s) {
+            quint32 t_iBits;
+            std::memcpy(&t_iBits, &p_pData[(qint64)s*p_iNChan + p_iChan], sizeof(quint32));
+            qToBigEndian<quint32>(t_iBits, &p_vecOut[RAW_CODEC_CHAN_HEADER + 4*(size_t)s]);
+        }
+        return;
+    }
+
+    p_vecOut.reserve(RAW_CODEC_CHAN_HEADER + 4*t_iOrder + (size_t)(t_iBestBits/8) + 1);
+    p_vecOut.push_back(t_bInt ? RAW_CODEC_MODE_INT : RAW_CODEC_MODE_FLOAT);
+    p_vecOut.push_back((uchar)t_iOrder);
+    p_vecOut.push_back((uchar)t_iBestK);
+    p_vecOut.push_back(0);
+
+    for(int s = 0; s < t_iOrder; ++s) {
+        uchar t_cWord[4];
+        qToBigEndian<quint32>(p_vecWords[s], t_cWord);
+        p_vecOut.insert(p_vecOut.end(), t_cWord, t_cWord + 4);
+    }
+
+    RiceWriter t_writer(p_vecOut);
+    for(size_t i = 0; i < p_vecRes.size(); ++i)
+        t_writer.putRice(p_vecRes[i], t_iBestK);
+    t_writer.flush();
+}
+
+
+//*************************************************************************************************************
+
+bool decode_channel(const uchar* p_pData,
+                    const uchar* p_pEnd,
+                    qint32 p_iFirstSamp,
+                    qint32 p_iNSamp,
+                    qint32 p_iChanNSamp,
+                    double p_dGain,
+                    double* p_pDest,
+                    qint64 p_iDestStride)
+{
+    if(p_pEnd - p_pData < RAW_CODEC_CHAN_HEADER)
+        return false;
+
+    int t_iMode = p_pData[0];
+    int t_iOrder = p_pData[1];
+    int t_iK = p_pData[2];
+
+    if(t_iMode == RAW_CODEC_MODE_VERBATIM) {
+        if(p_pEnd - p_pData < RAW_CODEC_CHAN_HEADER + 4*(qint64)p_iChanNSamp)
+            return false;
+        const uchar* t_pSamples = p_pData + RAW_CODEC_CHAN_HEADER;
+        for(qint32 s = 0; s < p_iNSamp; ++s) {
+            quint32 t_iBits = qFromBigEndian<quint32>(t_pSamples + 4*(p_iFirstSamp + s));
+            float t_fValue;
+            std::memcpy(&t_fValue, &t_iBits, sizeof(float));
+            p_pDest[s*p_iDestStride] = p_dGain * (double)t_fValue;
+        }
+        return true;
+    }
+
+    if(t_iMode > RAW_CODEC_MODE_FLOAT || t_iOrder > RAW_CODEC_MAX_ORDER || t_iK > RAW_CODEC_MAX_RICE
+            || t_iOrder > p_iChanNSamp || p_pEnd - p_pData < RAW_CODEC_CHAN_HEADER + 4*t_iOrder)
+        return false;
+
+    const uchar* t_pWarmup = p_pData + RAW_CODEC_CHAN_HEADER;
+    RiceReader t_reader(t_pWarmup + 4*t_iOrder, p_pEnd);
+
+    //
+    //   The prediction runs from the start of the buffer, decoding stops after the last requested sample
+    //
+    quint32 w1 = 0, w2 = 0;
+    qint32 t_iLast = p_iFirstSamp + p_iNSamp;
+    for(qint32 s = 0; s < t_iLast; ++s) {
+        quint32 w;
+        if(s < t_iOrder)
+            w = qFromBigEndian<quint32>(t_pWarmup + 4*s);
+        else
+            w = predict(t_iOrder, w1, w2) + unzigzag(t_reader.getRice(t_iK));
+        w2 = w1;
+        w1 = w;
+
+        if(s >= p_iFirstSamp) {
+            double t_dValue;
+            if(t_iMode == RAW_CODEC_MODE_INT)
+                t_dValue = (double)(qint32)w;
+            else
+                t_dValue = (double)word_to_float(w);
+            p_pDest[(s - p_iFirstSamp)*p_iDestStride] = p_dGain * t_dValue;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+bool FiffRawCodec::encode(const float* p_pData,
+                          fiff_int_t p_iNChan,
+                          fiff_int_t p_iNSamp,
+                          QByteArray& p_baOut)
+{
+    if(p_iNChan <= 0 || p_iNSamp < 0 || (p_iNSamp > 0 && !p_pData))
+        return false;
+
+    std::vector<std::vector<uchar> > t_vecStreams(p_iNChan);
+
+    std::function<void(const int&)> encodeBlock = [&](const int& p_iStart) {
+        std::vector<quint32> t_vecWords, t_vecRes;
+        for(qint32 c = p_iStart; c < std::min(p_iStart + RAW_CODEC_CHAN_BLOCK, p_iNChan); ++c)
+            encode_channel(p_pData, p_iNChan, p_iNSamp, c, t_vecWords, t_vecRes, t_vecStreams[c]);
+    };
+
+    QVector<int> t_vecBlocks;
+    for(qint32 c = 0; c < p_iNChan; c += RAW_CODEC_CHAN_BLOCK)
+        t_vecBlocks.append(c);
+
+    if((qint64)p_iNChan*p_iNSamp >= RAW_CODEC_PARALLEL_MIN && t_vecBlocks.size() > 1)
+        QtConcurrent::blockingMap(t_vecBlocks, encodeBlock);
+    else
+        for(int i = 0; i < t_vecBlocks.size(); ++i)
+            encodeBlock(t_vecBlocks[i]);
+
+    //
+    //   Header, channel offsets relative to the first stream, streams
+    //
+    qint64 t_iTableSize = RAW_CODEC_HEADER_SIZE + 4*((qint64)p_iNChan + 1);
+    qint64 t_iStreamSize = 0;
+    for(qint32 c = 0; c < p_iNChan; ++c)
+        t_iStreamSize += t_vecStreams[c].size();
+    if(t_iTableSize + t_iStreamSize > INT_MAX)
+        return false;
+
+    p_baOut.resize((int)(t_iTableSize + t_iStreamSize));
+    uchar* t_pOut = reinterpret_cast<uchar*>(p_baOut.data());
+
+    qToBigEndian<qint32>(RAW_CODEC_VERSION, t_pOut);
+    qToBigEndian<qint32>(p_iNChan, t_pOut + 4);
+    qToBigEndian<qint32>(p_iNSamp, t_pOut + 8);
+    qToBigEndian<qint32>(0, t_pOut + 12);
+
+    uchar* t_pTable = t_pOut + RAW_CODEC_HEADER_SIZE;
+    uchar* t_pStream = t_pOut + t_iTableSize;
+    quint32 t_iOffset = 0;
+    for(qint32 c = 0; c < p_iNChan; ++c) {
+        qToBigEndian<quint32>(t_iOffset, t_pTable + 4*c);
+        if(!t_vecStreams[c].empty())
+            std::memcpy(t_pStream + t_iOffset, t_vecStreams[c].data(), t_vecStreams[c].size());
+        t_iOffset += (quint32)t_vecStreams[c].size();
+    }
+    qToBigEndian<quint32>(t_iOffset, t_pTable + 4*p_iNChan);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawCodec::peek(const fiff_data_t* p_pData,
+                        qint64 p_iSize,
+                        fiff_int_t& p_iNChan,
+                        fiff_int_t& p_iNSamp)
+{
+    if(!p_pData || p_iSize < RAW_CODEC_HEADER_SIZE)
+        return false;
+
+    const uchar* t_pData = reinterpret_cast<const uchar*>(p_pData);
+    if(qFromBigEndian<qint32>(t_pData) != RAW_CODEC_VERSION)
+        return false;
+
+    p_iNChan = qFromBigEndian<qint32>(t_pData + 4);
+    p_iNSamp = qFromBigEndian<qint32>(t_pData + 8);
+
+    return p_iNChan > 0 && p_iNSamp >= 0;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawCodec::decode(const fiff_data_t* p_pData,
+                          qint64 p_iSize,
+                          fiff_int_t p_iFirstSamp,
+                          fiff_int_t p_iNSamp,
+                          const qint32* p_pSel,
+                          const double* p_pGains,
+                          qint32 p_iNRows,
+                          double* p_pDest,
+                          qint64 p_iDestStride)
+{
+    fiff_int_t t_iNChan, t_iNSamp;
+    if(!peek(p_pData, p_iSize, t_iNChan, t_iNSamp))
+        return false;
+    if(p_iFirstSamp < 0 || p_iNSamp < 0 || (qint64)p_iFirstSamp + p_iNSamp > t_iNSamp)
+        return false;
+
+    qint64 t_iTableSize = RAW_CODEC_HEADER_SIZE + 4*((qint64)t_iNChan + 1);
+    if(p_iSize < t_iTableSize)
+        return false;
+
+    const uchar* t_pData = reinterpret_cast<const uchar*>(p_pData);
+    const uchar* t_pTable = t_pData + RAW_CODEC_HEADER_SIZE;
+    const uchar* t_pStreams = t_pData + t_iTableSize;
+    qint64 t_iStreamSize = p_iSize - t_iTableSize;
+
+    QAtomicInt t_iFailed(0);
+
+    std::function<void(const int&)> decodeRows = [&](const int& p_iStart) {
+        qint32 t_iEnd = std::min(p_iStart + RAW_CODEC_CHAN_BLOCK, p_iNRows);
+        for(qint32 r = p_iStart; r < t_iEnd; ++r) {
+            qint32 t_iChan = p_pSel ? p_pSel[r] : r;
+            if(t_iChan < 0 || t_iChan >= t_iNChan) {
+                t_iFailed.storeRelease(1);
+                return;
+            }
+            quint32 t_iBegin = qFromBigEndian<quint32>(t_pTable + 4*t_iChan);
+            quint32 t_iStop = qFromBigEndian<quint32>(t_pTable + 4*(t_iChan + 1));
+            if(t_iBegin > t_iStop || t_iStop > t_iStreamSize
+                    || !decode_channel(t_pStreams + t_iBegin, t_pStreams + t_iStop,
+                                       p_iFirstSamp, p_iNSamp, t_iNSamp,
+                                       p_pGains ? p_pGains[r] : 1.0,
+                                       p_pDest + r, p_iDestStride)) {
+                t_iFailed.storeRelease(1);
+                return;
+            }
+        }
+    };
+
+    QVector<int> t_vecBlocks;
+    for(qint32 r = 0; r < p_iNRows; r += RAW_CODEC_CHAN_BLOCK)
+        t_vecBlocks.append(r);
+
+    if((qint64)p_iNRows*(p_iFirstSamp + p_iNSamp) >= RAW_CODEC_PARALLEL_MIN && t_vecBlocks.size() > 1)
+        QtConcurrent::blockingMap(t_vecBlocks, decodeRows);
+    else
+        for(int i = 0; i < t_vecBlocks.size(); ++i)
+            decodeRows(t_vecBlocks[i]);
+
+    return t_iFailed.loadAcquire() == 0;
+}
@@ -0,0 +1,146 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_codec.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawCodec class declaration.
+*
+*/
+
+
+#ifndef FIFF_RAW_CODEC_H
+#define FIFF_RAW_CODEC_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+* Lossless codec for raw data buffers stored with the tag type FIFFT_RAW_COMPRESSED. Each channel of a buffer
+* is coded independently: integer valued channels (e.g. int16/int24 converter counts) are coded as integers,
+* all others by the bit patterns of their float values with the sign moved to the lowest bit. The samples are
+* predicted from the previous ones (order 0, 1 or 2, chosen per channel) and the residuals are Rice coded with
+* a per channel parameter. Float channels which would not shrink are stored verbatim, a compressed buffer is
+* therefore never larger than the float32 buffer plus the offset table and the channel headers.
+*
+* The compressed data start with a big endian header (version, number of channels, number of samples,
+* reserved word) followed by the byte offsets of the channel streams. Since the channels are independent,
+* a selection of channels is decoded without touching the others and the decoding is distributed over the
+* cores.
+*
+* @brief Lossless predictive Rice codec for raw data buffers
+*/
+class FIFFSHARED_EXPORT FiffRawCodec
+{
+public:
+    //=========================================================================================================
+    /**
+    * Compresses a raw data buffer.
+    *
+    * @param[in] p_pData        The buffer (channels x samples, column major as in MatrixXf)
+    * @param[in] p_iNChan       Number of channels
+    * @param[in] p_iNSamp       Number of samples
+    * @param[out] p_baOut       The compressed data. The array is reused, it only grows.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    static bool encode(const float* p_pData,
+                       fiff_int_t p_iNChan,
+                       fiff_int_t p_iNSamp,
+                       QByteArray& p_baOut);
+
+    //=========================================================================================================
+    /**
+    * Reads the dimensions of a compressed buffer without decoding it.
+    *
+    * @param[in] p_pData        The compressed data
+    * @param[in] p_iSize        Size of the compressed data in bytes
+    * @param[out] p_iNChan      Number of channels
+    * @param[out] p_iNSamp      Number of samples
+    *
+    * @return true if the header is valid, false otherwise
+    */
+    static bool peek(const fiff_data_t* p_pData,
+                     qint64 p_iSize,
+                     fiff_int_t& p_iNChan,
+                     fiff_int_t& p_iNSamp);
+
+    //=========================================================================================================
+    /**
+    * Decodes the samples p_iFirstSamp ... p_iFirstSamp+p_iNSamp-1 of the selected channels, applies the per
+    * channel gains and writes the result into the destination (selected channels x samples), like the raw
+    * buffer kernels of FiffTagView.
+    *
+    * @param[in] p_pData        The compressed data
+    * @param[in] p_iSize        Size of the compressed data in bytes
+    * @param[in] p_iFirstSamp   First sample to decode
+    * @param[in] p_iNSamp       Number of samples to decode
+    * @param[in] p_pSel         Channel of each destination row, NULL for all channels
+    * @param[in] p_pGains       Gain of each destination row, NULL for 1
+    * @param[in] p_iNRows       Number of destination rows
+    * @param[out] p_pDest       The destination
+    * @param[in] p_iDestStride  Distance between the columns of the destination
+    *
+    * @return true if succeeded, false if the data are damaged or the request exceeds the buffer
+    */
+    static bool decode(const fiff_data_t* p_pData,
+                       qint64 p_iSize,
+                       fiff_int_t p_iFirstSamp,
+                       fiff_int_t p_iNSamp,
+                       const qint32* p_pSel,
+                       const double* p_pGains,
+                       qint32 p_iNRows,
+                       double* p_pDest,
+                       qint64 p_iDestStride);
+};
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_CODEC_H
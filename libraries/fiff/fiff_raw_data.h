@@ -141,6 +141,29 @@ public:
         return first_samp == -1 && info.isEmpty();
     }
 
+    //=========================================================================================================
+    /**
+    * Enables or disables the memory mapped read mode. When enabled, the fif file is mapped into memory and
+    * read_raw_segment decodes the data buffers directly out of the mapping instead of reading each buffer into
+    * a freshly allocated tag. If the file can not be mapped, reading falls back to the regular mode.
+    *
+    * @param[in] p_bMemoryMapped    Whether to use the memory mapped read mode
+    *
+    * @return true if the requested mode is active, false if the file could not be mapped
+    */
+    bool setMemoryMapped(bool p_bMemoryMapped);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the memory mapped read mode is requested.
+    *
+    * @return true if the memory mapped read mode is requested
+    */
+    inline bool isMemoryMapped() const
+    {
+        return m_bMemoryMapped;
+    }
+
     //=========================================================================================================
     /**
     * ### MNE toolbox root function ###: Implementation of the fiff_read_raw_segment function
@@ -199,6 +222,28 @@ public:
     QList<FiffRawDir> rawdir;   /**< Special fiff diretory entry for raw data. */
     MatrixXd proj;              /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
+
+private:
+    //=========================================================================================================
+    /**
+    * Sets up the combined calibration, compensation and projection operator for a channel selection. The
+    * operator is cached and only rebuilt if the selection, the calibrations, the compensator or the projector
+    * changed since the last call.
+    *
+    * @param[in] sel        channel selection vector (empty for all channels)
+    */
+    void update_mult(const RowVectorXi& sel);
+
+    bool m_bMemoryMapped;               /**< Whether the data buffers are read from a memory mapping of the file. */
+
+    bool m_bMultValid;                  /**< Whether the cached operator was set up. */
+    bool m_bMultIsDiagonal;             /**< True if the cached operator consists of the calibrations only. */
+    SparseMatrix<double> m_matMult;     /**< Cached operator (compensator, projection, calibration) of the selected channels. */
+    RowVectorXd m_vecMultGains;         /**< Calibration of each selected channel. */
+    RowVectorXi m_vecMultSel;           /**< Channel selection the cached operator was set up for. */
+    RowVectorXd m_vecMultCals;          /**< Calibrations the cached operator was set up for. */
+    MatrixXd m_matMultProj;             /**< Projector the cached operator was set up for. */
+    FiffCtfComp m_multComp;             /**< Compensator the cached operator was set up for, shares the data with comp. */
 };
 
 } // NAMESPACE
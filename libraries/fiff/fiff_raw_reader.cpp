@@ -0,0 +1,323 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_reader.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawReader Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_reader.h"
+#include "fiff_stream.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+* Worker thread of FiffRawReader. Reads and decodes the blocks through its own file handle.
+*/
+class FiffRawReaderWorker : public QThread
+{
+public:
+    FiffRawReaderWorker(FiffRawReader* p_pReader)
+    : m_pReader(p_pReader)
+    {
+    }
+
+protected:
+    void run();
+
+private:
+    FiffRawReader* m_pReader;   /**< The reader this worker belongs to */
+};
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+void FiffRawReaderWorker::run()
+{
+    FiffRawReader* r = m_pReader;
+
+    //
+    //   Each worker has its own file handle, so reads do not have to be serialized
+    //
+    QMutexLocker locker(&r->m_mutex);
+    FiffRawData t_raw(r->m_raw);
+    qint64 t_iProjCompVersion = r->m_iProjCompVersion;
+    locker.unlock();
+
+    QFile t_file(t_raw.info.filename);
+    t_raw.file = FiffStream::SPtr(new FiffStream(&t_file));
+    t_raw.setMemoryMapped(true);
+
+    locker.relock();
+
+    forever {
+        while(!r->m_bStop && !(r->m_bStarted
+                               && r->blockInRange(r->m_iNextSeq)
+                               && r->m_iNextSeq - r->m_iConsumeSeq < r->m_iQueueSize))
+            r->m_condWork.wait(&r->m_mutex);
+
+        if(r->m_bStop)
+            break;
+
+        //
+        //   Pick up a projector or compensator set in the meantime
+        //
+        if(t_iProjCompVersion != r->m_iProjCompVersion) {
+            t_raw.proj = r->m_raw.proj;
+            t_raw.comp = r->m_raw.comp;
+            t_iProjCompVersion = r->m_iProjCompVersion;
+        }
+
+        qint64 t_iSeq = r->m_iNextSeq++;
+        qint64 t_iGeneration = r->m_iGeneration;
+        fiff_int_t t_iFrom = r->blockStart(t_iSeq);
+
+        locker.unlock();
+
+        FiffRawReader::Block t_block;
+        t_block.from = std::max(t_iFrom, r->m_raw.first_samp);
+        t_block.ok = t_raw.read_raw_segment(t_block.data, t_block.times, t_iFrom, t_iFrom + r->m_iBlockSize - 1, r->m_vecSel);
+
+        locker.relock();
+
+        //
+        //   Drop the block if a seek happened in the meantime
+        //
+        if(t_iGeneration == r->m_iGeneration) {
+            r->m_mapReady.insert(t_iSeq, t_block);
+            r->m_condReady.wakeAll();
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+FiffRawReader::FiffRawReader(const FiffRawData& p_raw,
+                             fiff_int_t p_iBlockSize,
+                             const RowVectorXi& p_vecSel,
+                             int p_iQueueSize,
+                             int p_iNumThreads)
+: m_raw(p_raw)
+, m_vecSel(p_vecSel)
+, m_iBlockSize(std::max(p_iBlockSize, 1))
+, m_iQueueSize(std::max(p_iQueueSize, 1))
+, m_bStarted(false)
+, m_bStop(false)
+, m_bForward(true)
+, m_bAtEnd(false)
+, m_iStart(p_raw.first_samp)
+, m_iGeneration(0)
+, m_iProjCompVersion(0)
+, m_iNextSeq(0)
+, m_iConsumeSeq(0)
+{
+    if(p_iNumThreads <= 0)
+        p_iNumThreads = QThread::idealThreadCount();
+
+    //More workers than queued blocks would idle
+    p_iNumThreads = std::max(1, std::min(p_iNumThreads, m_iQueueSize));
+
+    for(int i = 0; i < p_iNumThreads; ++i) {
+        FiffRawReaderWorker* t_pWorker = new FiffRawReaderWorker(this);
+        m_lWorkers.append(t_pWorker);
+        t_pWorker->start();
+    }
+}
+
+
+//*************************************************************************************************************
+
+FiffRawReader::~FiffRawReader()
+{
+    m_mutex.lock();
+    m_bStop = true;
+    m_condWork.wakeAll();
+    m_mutex.unlock();
+
+    for(int i = 0; i < m_lWorkers.size(); ++i) {
+        m_lWorkers[i]->wait();
+        delete m_lWorkers[i];
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawReader::seek(fiff_int_t p_iFrom, bool p_bForward)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_bStarted = true;
+    m_bForward = p_bForward;
+    m_iStart = p_iFrom;
+    m_bAtEnd = false;
+    ++m_iGeneration;
+    m_iNextSeq = 0;
+    m_iConsumeSeq = 0;
+    m_mapReady.clear();
+
+    m_condWork.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawReader::read(MatrixXd& p_matData, MatrixXd& p_matTimes, fiff_int_t& p_iFrom)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(!m_bStarted) {
+        locker.unlock();
+        seek(m_raw.first_samp, true);
+        locker.relock();
+    }
+
+    while(!m_mapReady.contains(m_iConsumeSeq)) {
+        if(!blockInRange(m_iConsumeSeq)) {
+            m_bAtEnd = true;
+            return false;
+        }
+        m_condReady.wait(&m_mutex);
+    }
+
+    m_bAtEnd = false;
+
+    Block t_block = m_mapReady.take(m_iConsumeSeq);
+    ++m_iConsumeSeq;
+
+    //
+    //   A slot in the queue is free again
+    //
+    m_condWork.wakeAll();
+
+    locker.unlock();
+
+    p_matData.swap(t_block.data);
+    p_matTimes.swap(t_block.times);
+    p_iFrom = t_block.from;
+
+    return t_block.ok;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawReader::atEnd() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_bAtEnd;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawReader::read(fiff_int_t p_iFrom, MatrixXd& p_matData, MatrixXd& p_matTimes, bool p_bForward)
+{
+    m_mutex.lock();
+    bool t_bExpected = m_bStarted && m_bForward == p_bForward && blockStart(m_iConsumeSeq) == p_iFrom;
+    m_mutex.unlock();
+
+    if(!t_bExpected)
+        seek(p_iFrom, p_bForward);
+
+    fiff_int_t t_iFrom;
+    return read(p_matData, p_matTimes, t_iFrom);
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawReader::setProjAndComp(const MatrixXd& p_matProj, const FiffCtfComp& p_comp)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_raw.proj = p_matProj;
+    m_raw.comp = p_comp;
+    ++m_iProjCompVersion;
+
+    if(!m_bStarted)
+        return;
+
+    //
+    //   Read the blocks from the next one to be returned on again, with the new operators
+    //
+    m_iStart = blockStart(m_iConsumeSeq);
+    m_bAtEnd = false;
+    ++m_iGeneration;
+    m_iNextSeq = 0;
+    m_iConsumeSeq = 0;
+    m_mapReady.clear();
+
+    m_condWork.wakeAll();
+}
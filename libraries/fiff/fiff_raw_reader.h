@@ -0,0 +1,270 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_reader.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawReader class declaration.
+*
+*/
+
+#ifndef FIFF_RAW_READER_H
+#define FIFF_RAW_READER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_raw_data.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffRawReaderWorker;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Reads raw data in consecutive blocks of fixed size with read-ahead. A pool of worker threads reads and
+* decodes the blocks following the last requested one in the current read direction, each worker with its
+* own file handle. Finished blocks are kept in a bounded queue, so the consumer usually gets the next block
+* without waiting for the disk.
+*
+* @brief Parallel raw data block reader with read-ahead
+*/
+class FIFFSHARED_EXPORT FiffRawReader
+{
+    friend class FiffRawReaderWorker;
+
+public:
+    typedef QSharedPointer<FiffRawReader> SPtr;             /**< Shared pointer type for FiffRawReader. */
+    typedef QSharedPointer<const FiffRawReader> ConstSPtr;  /**< Const shared pointer type for FiffRawReader. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the reader. No data are read before the first call of read or seek.
+    *
+    * @param[in] p_raw          The raw data set up by FiffStream::setup_read_raw (incl. projector/compensator)
+    * @param[in] p_iBlockSize   Number of samples per block
+    * @param[in] p_vecSel       Channel selection (optional, default all channels)
+    * @param[in] p_iQueueSize   Maximum number of blocks which are read ahead (optional)
+    * @param[in] p_iNumThreads  Number of worker threads (optional, default ideal thread count, at most p_iQueueSize)
+    */
+    FiffRawReader(const FiffRawData& p_raw,
+                  fiff_int_t p_iBlockSize,
+                  const RowVectorXi& p_vecSel = defaultRowVectorXi,
+                  int p_iQueueSize = 4,
+                  int p_iNumThreads = -1);
+
+    //=========================================================================================================
+    /**
+    * Stops the workers and destroys the reader.
+    */
+    ~FiffRawReader();
+
+    //=========================================================================================================
+    /**
+    * Restarts the read-ahead at the given sample. Blocks already read ahead are discarded.
+    *
+    * @param[in] p_iFrom        First sample of the next block
+    * @param[in] p_bForward     Read direction: true for increasing, false for decreasing sample numbers
+    */
+    void seek(fiff_int_t p_iFrom, bool p_bForward = true);
+
+    //=========================================================================================================
+    /**
+    * Returns the next block in the read direction. Blocks until the block is available.
+    *
+    * @param[out] p_matData     The calibrated data of the block (channels x samples)
+    * @param[out] p_matTimes    The time values corresponding to the samples
+    * @param[out] p_iFrom       The first sample of the block
+    *
+    * @return true if succeeded, false if the end of the data is reached or the block could not be read (see atEnd)
+    */
+    bool read(MatrixXd& p_matData, MatrixXd& p_matTimes, fiff_int_t& p_iFrom);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the last call of read returned false because the end of the data was reached. Tells the
+    * end of the data from a block which could not be read.
+    *
+    * @return true if the end of the data was reached, false otherwise
+    */
+    bool atEnd() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the block starting at p_iFrom. If this block was read ahead it is returned right away, otherwise
+    * the read-ahead is restarted there. The following blocks in the given direction are read ahead.
+    *
+    * @param[in] p_iFrom        First sample of the block
+    * @param[out] p_matData     The calibrated data of the block (channels x samples)
+    * @param[out] p_matTimes    The time values corresponding to the samples
+    * @param[in] p_bForward     Read direction of the read-ahead
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read(fiff_int_t p_iFrom, MatrixXd& p_matData, MatrixXd& p_matTimes, bool p_bForward = true);
+
+    //=========================================================================================================
+    /**
+    * Sets the SSP projector and the compensator applied to the blocks read from now on. Blocks already read
+    * ahead are discarded and read again with the new operators, starting at the next block to be returned.
+    *
+    * @param[in] p_matProj      The SSP projector (empty for none)
+    * @param[in] p_comp         The compensator (kind -1 for none)
+    */
+    void setProjAndComp(const MatrixXd& p_matProj, const FiffCtfComp& p_comp);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples per block.
+    *
+    * @return the block size
+    */
+    inline fiff_int_t blockSize() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * A block which was read ahead.
+    */
+    struct Block {
+        fiff_int_t  from;       /**< First sample of the block */
+        bool        ok;         /**< Whether reading succeeded */
+        MatrixXd    data;       /**< The data */
+        MatrixXd    times;      /**< The time values */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the first sample of the block with sequence number p_iSeq of the current generation.
+    */
+    inline fiff_int_t blockStart(qint64 p_iSeq) const;
+
+    //=========================================================================================================
+    /**
+    * Whether the block with sequence number p_iSeq of the current generation lies within the data.
+    */
+    inline bool blockInRange(qint64 p_iSeq) const;
+
+    FiffRawData                     m_raw;              /**< The raw data description the workers clone */
+    RowVectorXi                     m_vecSel;           /**< The channel selection */
+    fiff_int_t                      m_iBlockSize;       /**< Number of samples per block */
+    int                             m_iQueueSize;       /**< Maximum number of blocks read ahead */
+
+    QList<FiffRawReaderWorker*>     m_lWorkers;         /**< The worker threads */
+
+    mutable QMutex                  m_mutex;            /**< Guards all members below */
+    QWaitCondition                  m_condWork;         /**< Signals the workers that blocks can be read */
+    QWaitCondition                  m_condReady;        /**< Signals the consumer that a block is ready */
+    bool                            m_bStarted;         /**< Whether a read position was set */
+    bool                            m_bStop;            /**< Whether the workers should terminate */
+    bool                            m_bForward;         /**< The read direction */
+    bool                            m_bAtEnd;           /**< Whether the last read reached the end of the data */
+    fiff_int_t                      m_iStart;           /**< First sample of block 0 of the current generation */
+    qint64                          m_iGeneration;      /**< Incremented by each seek, invalidates running reads */
+    qint64                          m_iProjCompVersion; /**< Incremented by each setProjAndComp, tells the workers to update their operators */
+    qint64                          m_iNextSeq;         /**< Next block to hand to a worker */
+    qint64                          m_iConsumeSeq;      /**< Next block to hand to the consumer */
+    QMap<qint64, Block>             m_mapReady;         /**< Blocks which are ready, by sequence number */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline fiff_int_t FiffRawReader::blockSize() const
+{
+    return m_iBlockSize;
+}
+
+
+//*************************************************************************************************************
+
+inline fiff_int_t FiffRawReader::blockStart(qint64 p_iSeq) const
+{
+    return m_bForward ? m_iStart + p_iSeq*m_iBlockSize : m_iStart - p_iSeq*m_iBlockSize;
+}
+
+
+//*************************************************************************************************************
+
+inline bool FiffRawReader::blockInRange(qint64 p_iSeq) const
+{
+    fiff_int_t t_iFrom = blockStart(p_iSeq);
+    return t_iFrom <= m_raw.last_samp && t_iFrom + m_iBlockSize - 1 >= m_raw.first_samp;
+}
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_READER_H
@@ -0,0 +1,313 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_writer.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawWriter class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_writer.h"
+#include "fiff_file.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+* I/O thread of FiffRawWriter. Calibrates, converts and writes the queued buffers.
+*/
+class FiffRawWriterWorker : public QThread
+{
+public:
+    FiffRawWriterWorker(FiffRawWriter* p_pWriter)
+    : m_pWriter(p_pWriter)
+    {
+    }
+
+protected:
+    void run();
+
+private:
+    FiffRawWriter* m_pWriter;   /**< The writer this thread belongs to */
+};
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+void FiffRawWriterWorker::run()
+{
+    FiffRawWriter* w = m_pWriter;
+
+    QMutexLocker locker(&w->m_mutex);
+
+    forever {
+        while(!w->m_bStop && w->m_queue.isEmpty()) {
+            w->m_bBusy = false;
+            w->m_condIdle.wakeAll();
+            w->m_condWork.wait(&w->m_mutex);
+        }
+
+        //
+        //   Everything is written before the thread terminates
+        //
+        if(w->m_queue.isEmpty())
+            break;
+
+        FiffRawWriter::Entry t_entry = w->m_queue.dequeue();
+        w->m_bBusy = true;
+
+        locker.unlock();
+
+        if(t_entry.slot < 0) {
+            t_entry.job(w->m_pStream);
+        } else {
+            if(t_entry.skip > 0) {
+                printf("FiffRawWriter - %d buffers were dropped because the disk could not keep up.\n", t_entry.skip);
+                w->m_pStream->write_int(FIFF_DATA_SKIP, &t_entry.skip);
+            }
+
+            MatrixXf& t_matData = w->m_vecSlots[t_entry.slot];
+            if(w->m_vecCals.size() == 0 || w->m_vecCals.size() == t_matData.rows()) {
+                //
+                //   Remove the calibration in place, the buffer is then written with one bulk conversion
+                //
+                if(w->m_vecCals.size() > 0)
+                    for(qint32 c = 0; c < t_matData.cols(); ++c)
+                        for(qint32 r = 0; r < t_matData.rows(); ++r)
+                            t_matData(r,c) = (float)((1.0/w->m_vecCals[r])*t_matData(r,c));
+
+                w->m_pStream->write_data_buffer(t_matData.data(), t_matData.rows(), t_matData.cols());
+            } else {
+                printf("FiffRawWriter - buffer and calibration sizes do not match\n");
+            }
+        }
+
+        locker.relock();
+
+        if(t_entry.slot >= 0)
+            w->m_vecFreeSlots.append(t_entry.slot);
+    }
+
+    w->m_bBusy = false;
+    w->m_condIdle.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+FiffRawWriter::FiffRawWriter(const FiffStream::SPtr& p_pStream,
+                             const RowVectorXd& p_vecCals,
+                             int p_iQueueSize)
+: m_pStream(p_pStream)
+, m_vecCals(p_vecCals)
+, m_pWorker(Q_NULLPTR)
+, m_vecSlots(std::max(p_iQueueSize, 1))
+, m_bBusy(false)
+, m_bStop(false)
+, m_iPendingSkip(0)
+, m_iDropped(0)
+{
+    m_vecFreeSlots.reserve(m_vecSlots.size());
+    for(int i = m_vecSlots.size() - 1; i >= 0; --i)
+        m_vecFreeSlots.append(i);
+
+    m_pWorker = new FiffRawWriterWorker(this);
+    m_pWorker->start();
+}
+
+
+//*************************************************************************************************************
+
+FiffRawWriter::~FiffRawWriter()
+{
+    m_mutex.lock();
+    m_bStop = true;
+    m_condWork.wakeAll();
+    m_mutex.unlock();
+
+    m_pWorker->wait();
+    delete m_pWorker;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::write(const MatrixXf& p_matData)
+{
+    int t_iSlot = acquireSlot(p_matData.rows(), p_matData.cols());
+    if(t_iSlot < 0)
+        return false;
+
+    m_vecSlots[t_iSlot] = p_matData;
+
+    enqueueSlot(t_iSlot);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::write(const MatrixXd& p_matData)
+{
+    int t_iSlot = acquireSlot(p_matData.rows(), p_matData.cols());
+    if(t_iSlot < 0)
+        return false;
+
+    m_vecSlots[t_iSlot] = p_matData.cast<float>();
+
+    enqueueSlot(t_iSlot);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::post(const StreamJob& p_job)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Entry t_entry;
+    t_entry.slot = -1;
+    t_entry.skip = 0;
+    t_entry.job = p_job;
+    m_queue.enqueue(t_entry);
+
+    //
+    //   Buffers dropped before a job (e.g. a file split) do not shift the buffers written after it
+    //
+    m_iPendingSkip = 0;
+
+    m_condWork.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::flush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while(!m_queue.isEmpty() || m_bBusy)
+        m_condIdle.wait(&m_mutex);
+}
+
+
+//*************************************************************************************************************
+
+qint64 FiffRawWriter::droppedBuffers() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_iDropped;
+}
+
+
+//*************************************************************************************************************
+
+int FiffRawWriter::acquireSlot(int p_iRows, int p_iCols)
+{
+    m_mutex.lock();
+
+    if(m_vecFreeSlots.isEmpty()) {
+        ++m_iPendingSkip;
+        ++m_iDropped;
+        m_mutex.unlock();
+        return -1;
+    }
+
+    int t_iSlot = m_vecFreeSlots.takeLast();
+
+    m_mutex.unlock();
+
+    //
+    //   The slot belongs to the producer until it is queued, it only reallocates if the buffer size changes
+    //
+    if(m_vecSlots[t_iSlot].rows() != p_iRows || m_vecSlots[t_iSlot].cols() != p_iCols)
+        m_vecSlots[t_iSlot].resize(p_iRows, p_iCols);
+
+    return t_iSlot;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::enqueueSlot(int p_iSlot)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Entry t_entry;
+    t_entry.slot = p_iSlot;
+    t_entry.skip = m_iPendingSkip;
+    m_queue.enqueue(t_entry);
+
+    m_iPendingSkip = 0;
+
+    m_condWork.wakeAll();
+}
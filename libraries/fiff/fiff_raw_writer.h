@@ -0,0 +1,228 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_writer.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawWriter class declaration.
+*
+*/
+
+
+#ifndef FIFF_RAW_WRITER_H
+#define FIFF_RAW_WRITER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_stream.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffRawWriterWorker;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Writes raw data buffers to a fif stream from a dedicated I/O thread. The buffers are copied into a bounded
+* pool of preallocated slots and queued, so write never waits for the disk. If all slots are in use, the
+* buffer is dropped and a FIFF_DATA_SKIP tag is written in its place, which keeps the timing of the
+* following buffers in the file correct. Buffers are expected to be written from a single producer thread.
+*
+* @brief Asynchronous raw data recording sink with bounded queue
+*/
+class FIFFSHARED_EXPORT FiffRawWriter
+{
+    friend class FiffRawWriterWorker;
+
+public:
+    typedef QSharedPointer<FiffRawWriter> SPtr;             /**< Shared pointer type for FiffRawWriter. */
+    typedef QSharedPointer<const FiffRawWriter> ConstSPtr;  /**< Const shared pointer type for FiffRawWriter. */
+
+    typedef std::function<void(FiffStream::SPtr& p_pStream)> StreamJob; /**< Job executed in the I/O thread, may replace the stream. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the writer and starts its I/O thread. From now on the stream must only be accessed through
+    * post.
+    *
+    * @param[in] p_pStream      The stream set up by FiffStream::start_writing_raw
+    * @param[in] p_vecCals      Calibrations which are removed before writing, as in FiffStream::write_raw_buffer (optional)
+    * @param[in] p_iQueueSize   Maximum number of buffers waiting to be written (optional)
+    */
+    FiffRawWriter(const FiffStream::SPtr& p_pStream,
+                  const RowVectorXd& p_vecCals = RowVectorXd(),
+                  int p_iQueueSize = 32);
+
+    //=========================================================================================================
+    /**
+    * Writes all queued buffers and jobs, then stops the I/O thread. The file is not finished, post a job
+    * calling FiffStream::finish_writing_raw for this.
+    */
+    ~FiffRawWriter();
+
+    //=========================================================================================================
+    /**
+    * Queues a raw data buffer (channels x samples). Does not wait for the disk.
+    *
+    * @param[in] p_matData      The buffer to write
+    *
+    * @return true if the buffer was queued, false if it was dropped because the queue is full
+    */
+    bool write(const MatrixXf& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Queues a raw data buffer (channels x samples). Does not wait for the disk.
+    *
+    * @param[in] p_matData      The buffer to write
+    *
+    * @return true if the buffer was queued, false if it was dropped because the queue is full
+    */
+    bool write(const MatrixXd& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Queues a job which is run in the I/O thread after all buffers queued so far were written, e.g. to split
+    * or to finish the file. Jobs are never dropped.
+    *
+    * @param[in] p_job          The job, gets the stream the writer writes to
+    */
+    void post(const StreamJob& p_job);
+
+    //=========================================================================================================
+    /**
+    * Blocks until all queued buffers and jobs were written.
+    */
+    void flush();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of buffers which were dropped because the queue was full.
+    *
+    * @return the number of dropped buffers
+    */
+    qint64 droppedBuffers() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Takes a free slot from the pool, resized to the given dimensions.
+    *
+    * @return the slot index, -1 if all slots are in use
+    */
+    int acquireSlot(int p_iRows, int p_iCols);
+
+    //=========================================================================================================
+    /**
+    * Queues a filled slot.
+    */
+    void enqueueSlot(int p_iSlot);
+
+    //=========================================================================================================
+    /**
+    * A queued buffer or job.
+    */
+    struct Entry {
+        int         slot;       /**< Slot holding the buffer, -1 for jobs */
+        qint32      skip;       /**< Number of buffers dropped directly before this one */
+        StreamJob   job;        /**< The job */
+    };
+
+    FiffStream::SPtr                m_pStream;          /**< The stream, only accessed by the I/O thread */
+    RowVectorXd                     m_vecCals;          /**< Calibrations removed before writing */
+
+    FiffRawWriterWorker*            m_pWorker;          /**< The I/O thread */
+
+    mutable QMutex                  m_mutex;            /**< Guards all members below */
+    QWaitCondition                  m_condWork;         /**< Signals the I/O thread that entries are queued */
+    QWaitCondition                  m_condIdle;         /**< Signals that the queue was written */
+    QVector<MatrixXf>               m_vecSlots;         /**< The preallocated buffers */
+    QVector<int>                    m_vecFreeSlots;     /**< Slots which are not in use */
+    QQueue<Entry>                   m_queue;            /**< Entries waiting to be written */
+    bool                            m_bBusy;            /**< Whether the I/O thread is writing an entry */
+    bool                            m_bStop;            /**< Whether the I/O thread should terminate */
+    qint32                          m_iPendingSkip;     /**< Buffers dropped since the last queued one */
+    qint64                          m_iDropped;         /**< Total number of dropped buffers */
+};
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_WRITER_H
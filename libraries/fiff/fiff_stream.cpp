@@ -40,11 +40,13 @@
 
 #include "fiff_stream.h"
 #include "fiff_tag.h"
+#include "fiff_tag_view.h"
 #include "fiff_dir_node.h"
 #include "fiff_ctf_comp.h"
 #include "fiff_info.h"
 #include "fiff_info_base.h"
 #include "fiff_raw_data.h"
+#include "fiff_raw_codec.h"
 #include "fiff_cov.h"
 #include "fiff_coord_trans.h"
 #include "fiff_ch_info.h"
@@ -73,6 +75,7 @@
 // STL INCLUDES
 //=============================================================================================================
 
+#include <cstring>
 #include <iostream>
 #include <time.h>
 
@@ -92,7 +95,10 @@
 //=============================================================================================================
 
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QTcpSocket>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -104,6 +110,69 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+#define DIR_CACHE_MAGIC     0x4D444952  /**< "MDIR" */
+#define DIR_CACHE_VERSION   1
+
+bool FiffStream::m_bDirCacheEnabled = false;
+
+
+//*************************************************************************************************************
+
+static inline void store_big_endian(float p_fValue, uchar* p_pDest)
+{
+    //Swap the raw bits of the value, loops over this are vectorized by the compiler
+    quint32 t_bits;
+    std::memcpy(&t_bits, &p_fValue, sizeof(float));
+    qToBigEndian<quint32>(t_bits, p_pDest);
+}
+
+
+//*************************************************************************************************************
+
+static inline void store_big_endian(double p_dValue, uchar* p_pDest)
+{
+    quint64 t_bits;
+    std::memcpy(&t_bits, &p_dValue, sizeof(double));
+    qToBigEndian<quint64>(t_bits, p_pDest);
+}
+
+
+//*************************************************************************************************************
+
+static inline void store_big_endian(qint32 p_iValue, uchar* p_pDest)
+{
+    qToBigEndian<qint32>(p_iValue, p_pDest);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+static void store_big_endian(const T* p_pSrc, qint64 p_iNel, uchar* p_pDest)
+{
+    for(qint64 i = 0; i < p_iNel; ++i)
+        store_big_endian(p_pSrc[i], p_pDest + i*sizeof(T));
+}
+
+
+//*************************************************************************************************************
+
+static bool wait_for_bytes(QIODevice* p_pDevice, qint64 p_iBytes)
+{
+    //Sleep until data arrive instead of polling, give up when the connection is lost
+    QAbstractSocket* t_pSocket = qobject_cast<QAbstractSocket*>(p_pDevice);
+    while(p_pDevice->bytesAvailable() < p_iBytes)
+        if(!p_pDevice->waitForReadyRead(100) && (!t_pSocket || t_pSocket->state() != QAbstractSocket::ConnectedState))
+            return false;
+    return true;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -111,6 +180,10 @@ using namespace UTILSLIB;
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_pMappedData(Q_NULLPTR)
+, m_iMappedSize(0)
+, m_iTagSize(0)
+, m_bRawCompression(false)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -122,6 +195,10 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 
 FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_pMappedData(Q_NULLPTR)
+, m_iMappedSize(0)
+, m_iTagSize(0)
+, m_bRawCompression(false)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -129,6 +206,14 @@ FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 }
 
 
+//*************************************************************************************************************
+
+FiffStream::~FiffStream()
+{
+    this->unmap();
+}
+
+
 //*************************************************************************************************************
 
 QString FiffStream::streamName()
@@ -320,12 +405,15 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
     /*
     * Do we have a directory or not?
     */
-    if (dirpos <= 0) {  /* Must do it in the hard way... */
-        bool ok = false;
-        m_dir = this->make_dir(&ok);
-        if (!ok) {
-          qCritical ("Could not create tag directory!");
-          return false;
+    if (dirpos <= 0) {  /* Must do it in the hard way... unless we did it before */
+        if(!this->read_dir_cache(m_dir)) {
+            bool ok = false;
+            m_dir = this->make_dir(&ok);
+            if (!ok) {
+              qCritical ("Could not create tag directory!");
+              return false;
+            }
+            this->write_dir_cache(m_dir);
         }
     }
     else {              /* Just read the directory */
@@ -376,6 +464,86 @@ bool FiffStream::close()
 }
 
 
+//*************************************************************************************************************
+
+bool FiffStream::map()
+{
+    if(this->isMapped())
+        return true;
+
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile)
+        return false;
+
+    if(!t_pFile->isOpen() && !t_pFile->open(QIODevice::ReadOnly)) {
+        qWarning("FiffStream::map - Cannot open %s", t_pFile->fileName().toUtf8().constData());
+        return false;
+    }
+
+    fiff_long_t t_iSize = t_pFile->size();
+    uchar* t_pData = t_pFile->map(0, t_iSize);
+    if(!t_pData) {
+        qWarning("FiffStream::map - Cannot map %s: %s", t_pFile->fileName().toUtf8().constData(), t_pFile->errorString().toUtf8().constData());
+        return false;
+    }
+
+    m_pMappedData = t_pData;
+    m_iMappedSize = t_iSize;
+
+    //
+    //   QFile drops all mappings on close - forget about ours as well
+    //
+    m_mapConnection = QObject::connect(t_pFile, &QIODevice::aboutToClose, [this]() {
+        QObject::disconnect(m_mapConnection);
+        m_pMappedData = Q_NULLPTR;
+        m_iMappedSize = 0;
+    });
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::unmap()
+{
+    QObject::disconnect(m_mapConnection);
+
+    if(m_pMappedData) {
+        QFile* t_pFile = qobject_cast<QFile*>(this->device());
+        if(t_pFile)
+            t_pFile->unmap(m_pMappedData);
+    }
+
+    m_pMappedData = Q_NULLPTR;
+    m_iMappedSize = 0;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::isMapped() const
+{
+    return m_pMappedData != Q_NULLPTR;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::setDirCacheEnabled(bool p_bEnabled)
+{
+    m_bDirCacheEnabled = p_bEnabled;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::setRawCompression(bool p_bEnabled)
+{
+    m_bRawCompression = p_bEnabled;
+}
+
+
 //*************************************************************************************************************
 
 FiffDirNode::SPtr FiffStream::make_subtree(QList<FiffDirEntry::SPtr> &dentry)
@@ -1624,15 +1792,17 @@ fiff_long_t FiffStream::read_tag_info(FiffTag::SPtr &p_pTag, bool p_bDoSkip)
 
 bool FiffStream::read_rt_tag(FiffTag::SPtr &p_pTag)
 {
-    while(this->device()->bytesAvailable() < 16)
-        this->device()->waitForReadyRead(10);
+    if(!wait_for_bytes(this->device(), 16)) {
+        p_pTag = FiffTag::SPtr(new FiffTag());
+        return false;
+    }
 
 //    if(!this->read_tag_info(p_pTag, false))
 //        return false;
     this->read_tag_info(p_pTag, false);
 
-    while(this->device()->bytesAvailable() < p_pTag->size())
-        this->device()->waitForReadyRead(10);
+    if(!wait_for_bytes(this->device(), p_pTag->size()))
+        return false;
 
     if(!this->read_tag_data(p_pTag))
         return false;
@@ -1679,6 +1849,72 @@ bool FiffStream::read_tag(FiffTag::SPtr &p_pTag, fiff_long_t pos)
 }
 
 
+//*************************************************************************************************************
+
+bool FiffStream::read_tag_view(FiffTagView& p_tagView, fiff_long_t pos) const
+{
+    const fiff_long_t t_iHeaderSize = FIFFC_DATA_OFFSET;
+
+    p_tagView = FiffTagView();
+
+    if(!m_pMappedData || pos < 0 || pos + t_iHeaderSize > m_iMappedSize)
+        return false;
+
+    const uchar* t_pHeader = m_pMappedData + pos;
+    p_tagView.kind = qFromBigEndian<qint32>(t_pHeader);
+    p_tagView.type = qFromBigEndian<qint32>(t_pHeader + 4);
+    p_tagView.size = qFromBigEndian<qint32>(t_pHeader + 8);
+    p_tagView.next = qFromBigEndian<qint32>(t_pHeader + 12);
+
+    if(p_tagView.size < 0 || pos + t_iHeaderSize + p_tagView.size > m_iMappedSize) {
+        qWarning("FiffStream::read_tag_view - Tag at %lld exceeds the mapped file (file probably damaged)!", pos);
+        p_tagView = FiffTagView();
+        return false;
+    }
+
+    p_tagView.data = reinterpret_cast<const fiff_data_t*>(t_pHeader + t_iHeaderSize);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::read_tag_view(FiffTagView& p_tagView, fiff_long_t pos, QByteArray& p_baBuffer)
+{
+    if(this->isMapped())
+        return this->read_tag_view(p_tagView, pos);
+
+    p_tagView = FiffTagView();
+
+    if(pos < 0 || !this->device()->seek(pos))
+        return false;
+
+    qint32 size;
+    *this >> p_tagView.kind;
+    *this >> p_tagView.type;
+    *this >> size;
+    *this >> p_tagView.next;
+
+    if(size < 0)
+        return false;
+
+    //
+    //   Keep the data in file byte order - the view is decoded later on
+    //
+    if(p_baBuffer.size() != size)
+        p_baBuffer.resize(size);
+
+    if(size > 0 && this->readRawData(p_baBuffer.data(), size) != size)
+        return false;
+
+    p_tagView.size = size;
+    p_tagView.data = p_baBuffer.constData();
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield)
@@ -1809,6 +2045,22 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
                 case FIFFT_INT:
                     nsamp = ent->size/(4*nchan);
                     break;
+                case FIFFT_RAW_COMPRESSED:
+                {
+                    //
+                    //   The dimensions are stored in the header of the compressed data
+                    //
+                    char t_cHeader[16];
+                    fiff_int_t t_iNChan = 0;
+                    if(!t_pStream->device()->seek(ent->pos + FIFFC_DATA_OFFSET)
+                            || t_pStream->readRawData(t_cHeader, 16) != 16
+                            || !FiffRawCodec::peek(t_cHeader, 16, t_iNChan, nsamp)
+                            || t_iNChan != nchan) {
+                        printf("Invalid compressed data buffer at %d\n",ent->pos);
+                        return false;
+                    }
+                    break;
+                }
                 default:
                     printf("Cannot handle data buffers of type %d\n",ent->type);
                     return false;
@@ -2606,21 +2858,11 @@ fiff_long_t FiffStream::write_dir_entries(const QList<FiffDirEntry::SPtr> &dir,
 
 fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_int_t nel)
 {
-    fiff_long_t pos = this->device()->pos();
+    uchar* t_pData = this->begin_tag_data(kind, FIFFT_DOUBLE, nel * 8);
 
-    qint32 datasize = nel * 8;
-
-    *this << (qint32)kind;
-    *this << (qint32)FIFFT_DOUBLE;
-    *this << (qint32)datasize;
-    *this << (qint32)FIFFV_NEXT_SEQ;
+    store_big_endian(data, nel, t_pData);
 
-//    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
-
-    return pos;
+    return this->write_tag_data();
 }
 
 
@@ -2628,21 +2870,11 @@ fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_i
 
 fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int_t nel)
 {
-    fiff_long_t pos = this->device()->pos();
-
-    qint32 datasize = nel * 4;
-
-    *this << (qint32)kind;
-    *this << (qint32)FIFFT_FLOAT;
-    *this << (qint32)datasize;
-    *this << (qint32)FIFFV_NEXT_SEQ;
+    uchar* t_pData = this->begin_tag_data(kind, FIFFT_FLOAT, nel * 4);
 
-//    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    store_big_endian(data, nel, t_pData);
 
-    return pos;
+    return this->write_tag_data();
 }
 
 
@@ -2650,32 +2882,26 @@ fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int
 
 fiff_long_t FiffStream::write_float_matrix(fiff_int_t kind, const MatrixXf& mat)
 {
-    fiff_long_t pos = this->device()->pos();
-
     qint32 numel = mat.rows() * mat.cols();
 
     fiff_int_t datasize = 4*numel + 4*3;
 
-    *this << (qint32)kind;
-    *this << (qint32)FIFFT_MATRIX_FLOAT;
-    *this << (qint32)datasize;
-    *this << (qint32)FIFFV_NEXT_SEQ;
+    uchar* t_pData = this->begin_tag_data(kind, FIFFT_MATRIX_FLOAT, datasize);
 
     qint32 i, j;
-    // Storage order: row-major
-    for(i = 0; i < mat.rows(); ++i)
-        for(j = 0; j < mat.cols(); ++j)
-            *this << mat(i,j);
+    // Storage order: row-major, the source is read contiguously column by column
+    for(j = 0; j < mat.cols(); ++j)
+        for(i = 0; i < mat.rows(); ++i)
+            store_big_endian(mat(i,j), t_pData + 4*((qint64)i*mat.cols() + j));
 
     qint32 dims[3];
     dims[0] = mat.cols();
     dims[1] = mat.rows();
     dims[2] = 2;
 
-    for(i = 0; i < 3; ++i)
-        *this << dims[i];
+    store_big_endian(dims, 3, t_pData + 4*(qint64)numel);
 
-    return pos;
+    return this->write_tag_data();
 }
 
 
@@ -2986,19 +3212,11 @@ fiff_long_t FiffStream::write_info_base(const FiffInfoBase & p_FiffInfoBase)
 
 fiff_long_t FiffStream::write_int(fiff_int_t kind, const fiff_int_t* data, fiff_int_t nel, fiff_int_t next)
 {
-    fiff_long_t pos = this->device()->pos();
-
-    fiff_int_t datasize = nel * 4;
-
-    *this << (qint32)kind;
-    *this << (qint32)FIFFT_INT;
-    *this << (qint32)datasize;
-    *this << (qint32)next;
+    uchar* t_pData = this->begin_tag_data(kind, FIFFT_INT, nel * 4, next);
 
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    store_big_endian(data, nel, t_pData);
 
-    return pos;
+    return this->write_tag_data();
 }
 
 
@@ -3113,17 +3331,22 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
         return false;
     }
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(cals.cols());
-    for(qint32 i = 0; i < cals.cols(); ++i)
-        tripletList.push_back(T(i, i, 1.0/cals[i]));
+    if(m_bRawCompression) {
+        m_matRawBuffer = (cals.cwiseInverse().transpose().asDiagonal()*buf).cast<float>();
+        return this->write_data_buffer(m_matRawBuffer.data(), m_matRawBuffer.rows(), m_matRawBuffer.cols()) >= 0;
+    }
+
+    uchar* t_pData = this->begin_tag_data(FIFF_DATA_BUFFER, FIFFT_FLOAT, buf.rows()*buf.cols()*4);
 
-    SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
-    inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
+    //Remove the calibration, convert to float and swap in one pass without temporaries
+    const double* t_pBuf = buf.data();
+    const double* t_pCals = cals.data();
+    const qint64 t_iRows = buf.rows();
+    for(qint64 c = 0; c < buf.cols(); ++c)
+        for(qint64 r = 0; r < t_iRows; ++r)
+            store_big_endian((float)((1.0/t_pCals[r])*t_pBuf[c*t_iRows + r]), t_pData + 4*(c*t_iRows + r));
 
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_tag_data();
     return true;
 }
 
@@ -3143,7 +3366,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
         inv_mult.coeffRef(it.row(),it.col()) = 1/it.value();
 
     MatrixXf tmp = (inv_mult*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_data_buffer(tmp.data(),tmp.rows(),tmp.cols());
     return true;
 }
 
@@ -3152,12 +3375,40 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 {
-    MatrixXf tmp = buf.cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    if(m_bRawCompression) {
+        m_matRawBuffer = buf.cast<float>();
+        return this->write_data_buffer(m_matRawBuffer.data(), m_matRawBuffer.rows(), m_matRawBuffer.cols()) >= 0;
+    }
+
+    uchar* t_pData = this->begin_tag_data(FIFF_DATA_BUFFER, FIFFT_FLOAT, buf.rows()*buf.cols()*4);
+
+    const double* t_pBuf = buf.data();
+    for(qint64 i = 0; i < buf.size(); ++i)
+        store_big_endian((float)t_pBuf[i], t_pData + 4*i);
+
+    this->write_tag_data();
     return true;
 }
 
 
+//*************************************************************************************************************
+
+fiff_long_t FiffStream::write_data_buffer(const float* data, fiff_int_t nchan, fiff_int_t nsamp)
+{
+    if(!m_bRawCompression)
+        return this->write_float(FIFF_DATA_BUFFER, data, nchan*nsamp);
+
+    if(!FiffRawCodec::encode(data, nchan, nsamp, m_baCodecBuffer)) {
+        printf("Could not compress the data buffer (%d x %d)\n", nchan, nsamp);
+        return -1;
+    }
+
+    uchar* t_pData = this->begin_tag_data(FIFF_DATA_BUFFER, FIFFT_RAW_COMPRESSED, m_baCodecBuffer.size());
+    std::memcpy(t_pData, m_baCodecBuffer.constData(), m_baCodecBuffer.size());
+    return this->write_tag_data();
+}
+
+
 //*************************************************************************************************************
 
 fiff_long_t FiffStream::write_string(fiff_int_t kind, const QString& data)
@@ -3195,34 +3446,52 @@ void FiffStream::write_rt_command(fiff_int_t command, const QString& data)
 
 QList<FiffDirEntry::SPtr> FiffStream::make_dir(bool *ok)
 {
-    FiffTag::SPtr t_pTag;
     QList<FiffDirEntry::SPtr> dir;
     FiffDirEntry::SPtr t_pFiffDirEntry;
     fiff_long_t pos;
+    fiff_int_t kind, type, size, next;
     if(ok) *ok = false;
     /*
     * Start from the very beginning...
     */
     if(!this->device()->seek(SEEK_SET))
         return dir;
-    while ((pos = this->read_tag_info(t_pTag)) != -1) {
+    /*
+    * Only the tag headers are needed - do not read (and allocate) the tag data
+    */
+    while (!this->atEnd()) {
+        pos = this->device()->pos();
+        *this >> kind;
+        *this >> type;
+        *this >> size;
+        *this >> next;
+        if (this->status() != QDataStream::Ok)
+            break;
         /*
         * Check that we haven't run into the directory
         */
-        if (t_pTag->kind == FIFF_DIR)
+        if (kind == FIFF_DIR)
             break;
         /*
         * Put in the new entry
         */
         t_pFiffDirEntry = FiffDirEntry::SPtr(new FiffDirEntry);
-        t_pFiffDirEntry->kind = t_pTag->kind;
-        t_pFiffDirEntry->type = t_pTag->type;
-        t_pFiffDirEntry->size = t_pTag->size();
+        t_pFiffDirEntry->kind = kind;
+        t_pFiffDirEntry->type = type;
+        t_pFiffDirEntry->size = size;
         t_pFiffDirEntry->pos = (fiff_long_t)pos;
         dir.append(t_pFiffDirEntry);
-        if (t_pTag->next < 0)
+        if (next < 0)
+            break;
+        /*
+        * Skip the data
+        */
+        if (!this->device()->seek(next > 0 ? (fiff_long_t)next : this->device()->pos() + size)) {
+            qCritical("fseek");
             break;
+        }
     }
+    this->resetStatus();
     /*
     * Put in the new the terminating entry
     */
@@ -3238,6 +3507,113 @@ QList<FiffDirEntry::SPtr> FiffStream::make_dir(bool *ok)
 }
 
 
+//*************************************************************************************************************
+
+bool FiffStream::read_dir_cache(QList<FiffDirEntry::SPtr>& p_dir)
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!m_bDirCacheEnabled || !t_pFile)
+        return false;
+
+    QFileInfo t_fileInfo(*t_pFile);
+    QFile t_cacheFile(t_pFile->fileName() + ".dir");
+    if(!t_cacheFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream t_stream(&t_cacheFile);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+
+    qint32 t_iMagic, t_iVersion, t_iNent;
+    qint64 t_iSize, t_iModified;
+    FiffId t_id;
+    t_stream >> t_iMagic >> t_iVersion;
+    t_stream >> t_id.version >> t_id.machid[0] >> t_id.machid[1] >> t_id.time.secs >> t_id.time.usecs;
+    t_stream >> t_iSize >> t_iModified >> t_iNent;
+
+    //
+    //   Only use the cache if it was created for exactly this file
+    //
+    if(t_stream.status() != QDataStream::Ok || t_iMagic != DIR_CACHE_MAGIC || t_iVersion != DIR_CACHE_VERSION
+            || t_id.version != m_id.version || t_id.machid[0] != m_id.machid[0] || t_id.machid[1] != m_id.machid[1]
+            || t_id.time.secs != m_id.time.secs || t_id.time.usecs != m_id.time.usecs
+            || t_iSize != t_fileInfo.size() || t_iModified != t_fileInfo.lastModified().toMSecsSinceEpoch()
+            || t_iNent <= 0)
+        return false;
+
+    QList<FiffDirEntry::SPtr> t_dir;
+    t_dir.reserve(t_iNent);
+    for(qint32 k = 0; k < t_iNent; ++k) {
+        FiffDirEntry::SPtr t_pFiffDirEntry(new FiffDirEntry);
+        t_stream >> t_pFiffDirEntry->kind >> t_pFiffDirEntry->type >> t_pFiffDirEntry->size >> t_pFiffDirEntry->pos;
+        t_dir.append(t_pFiffDirEntry);
+    }
+
+    if(t_stream.status() != QDataStream::Ok)
+        return false;
+
+    p_dir = t_dir;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::write_dir_cache(const QList<FiffDirEntry::SPtr>& p_dir)
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!m_bDirCacheEnabled || !t_pFile || p_dir.isEmpty())
+        return false;
+
+    QFileInfo t_fileInfo(*t_pFile);
+    QFile t_cacheFile(t_pFile->fileName() + ".dir");
+    if(!t_cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false; // e.g. read only location - the cache is optional
+
+    QDataStream t_stream(&t_cacheFile);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+
+    t_stream << (qint32)DIR_CACHE_MAGIC << (qint32)DIR_CACHE_VERSION;
+    t_stream << m_id.version << m_id.machid[0] << m_id.machid[1] << m_id.time.secs << m_id.time.usecs;
+    t_stream << (qint64)t_fileInfo.size() << (qint64)t_fileInfo.lastModified().toMSecsSinceEpoch() << (qint32)p_dir.size();
+
+    for(qint32 k = 0; k < p_dir.size(); ++k)
+        t_stream << p_dir[k]->kind << p_dir[k]->type << p_dir[k]->size << p_dir[k]->pos;
+
+    return t_stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+uchar* FiffStream::begin_tag_data(fiff_int_t kind, fiff_int_t type, fiff_int_t datasize, fiff_int_t next)
+{
+    m_iTagSize = 16 + datasize;
+    if(m_baTagBuffer.size() < m_iTagSize)
+        m_baTagBuffer.resize(m_iTagSize);
+
+    uchar* t_pBuffer = reinterpret_cast<uchar*>(m_baTagBuffer.data());
+    qToBigEndian<qint32>(kind, t_pBuffer);
+    qToBigEndian<qint32>(type, t_pBuffer + 4);
+    qToBigEndian<qint32>(datasize, t_pBuffer + 8);
+    qToBigEndian<qint32>(next, t_pBuffer + 12);
+
+    return t_pBuffer + 16;
+}
+
+
+//*************************************************************************************************************
+
+fiff_long_t FiffStream::write_tag_data()
+{
+    fiff_long_t pos = this->device()->pos();
+
+    this->writeRawData(m_baTagBuffer.constData(), m_iTagSize);
+
+    return pos;
+}
+
+
 //*************************************************************************************************************
 
 bool FiffStream::check_beginning(FiffTag::SPtr &p_pTag)
@@ -68,6 +68,7 @@
 #include <QDataStream>
 #include <QIODevice>
 #include <QList>
+#include <QMetaObject>
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
@@ -88,6 +89,7 @@ namespace FIFFLIB
 
 class FiffStream;
 class FiffTag;
+class FiffTagView;
 class FiffCtfComp;
 class FiffRawData;
 class FiffInfo;
@@ -143,6 +145,12 @@ public:
     */
     explicit FiffStream(QByteArray * a, QIODevice::OpenMode mode);
 
+    //=========================================================================================================
+    /**
+    * Destroys the fiff stream. An existing memory mapping is released.
+    */
+    ~FiffStream();
+
     //=========================================================================================================
     /**
     * Get the stream name
@@ -265,6 +273,63 @@ public:
     */
     bool close();
 
+    //=========================================================================================================
+    /**
+    * Memory maps the whole underlying file. Tags can then be accessed with read_tag_view without allocating
+    * or copying any data. The device is opened read only if it is not open yet. The mapping is released
+    * automatically when the device gets closed. Only available for QFile devices.
+    *
+    * @return true if the file is mapped, false otherwise
+    */
+    bool map();
+
+    //=========================================================================================================
+    /**
+    * Releases the memory mapping established by map().
+    */
+    void unmap();
+
+    //=========================================================================================================
+    /**
+    * True if the underlying file is currently memory mapped.
+    *
+    * @return true if the file is mapped
+    */
+    bool isMapped() const;
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the tag directory cache. Files without a tag directory have to be scanned tag by tag
+    * when they are opened. If the cache is enabled, the scanned directory is stored in a sidecar file next to
+    * the fif file (file name + ".dir") and reused the next time, as long as file id, size and modification
+    * time still match. The cache is disabled by default.
+    *
+    * @param[in] p_bEnabled     Whether to use the tag directory cache
+    */
+    static void setDirCacheEnabled(bool p_bEnabled);
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the lossless compression of raw data buffers. If enabled, write_raw_buffer and
+    * write_data_buffer store the buffers with the tag type FIFFT_RAW_COMPRESSED (see FiffRawCodec), which is
+    * decoded transparently by read_raw_segment. Files written this way can not be read by MNE-C or
+    * MNE-Python. Compression is disabled by default.
+    *
+    * @param[in] p_bEnabled     Whether to compress the raw data buffers
+    */
+    void setRawCompression(bool p_bEnabled);
+
+    //=========================================================================================================
+    /**
+    * True if raw data buffers are written compressed, see setRawCompression.
+    *
+    * @return true if raw data buffers are compressed
+    */
+    inline bool rawCompression() const
+    {
+        return m_bRawCompression;
+    }
+
     //=========================================================================================================
     /**
     * Create the directory tree structure
@@ -425,6 +490,7 @@ public:
     /**
     * Read one tag from a fif real-time stream.
     * difference to the other read tag functions is: that this function has blocking behaviour (waitForReadyRead)
+    * It sleeps until the data arrived and returns false if the connection is lost in between.
     *
     * @param[out] p_pTag the read tag
     *
@@ -445,6 +511,33 @@ public:
     */
     bool read_tag(QSharedPointer<FiffTag>& p_pTag, fiff_long_t pos = -1);
 
+    //=========================================================================================================
+    /**
+    * Provides a view of one tag of a memory mapped fif file. The tag header is decoded, the tag data are not
+    * touched: the returned view points directly into the mapping and keeps the big endian file byte order.
+    * The view is only valid as long as the mapping exists. Requires a preceding call to map().
+    *
+    * @param[out] p_tagView     the tag view
+    * @param[in] pos            position of the tag inside the fif file
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_tag_view(FiffTagView& p_tagView, fiff_long_t pos) const;
+
+    //=========================================================================================================
+    /**
+    * Provides a view of one tag of a fif file. If the file is memory mapped, the view points into the mapping.
+    * Otherwise the tag data are read into p_baBuffer without byte swapping, and the view points into the buffer.
+    * Passing the same buffer for consecutive tags avoids any allocation once it is large enough.
+    *
+    * @param[out] p_tagView     the tag view
+    * @param[in] pos            position of the tag inside the fif file
+    * @param[in, out] p_baBuffer    buffer which holds the tag data if the file is not memory mapped
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_tag_view(FiffTagView& p_tagView, fiff_long_t pos, QByteArray& p_baBuffer);
+
     //=========================================================================================================
     /**
     * fiff_setup_read_raw
@@ -845,6 +938,18 @@ public:
     */
     bool write_raw_buffer(const MatrixXd& buf);
 
+    //=========================================================================================================
+    /**
+    * Writes a raw data buffer which is already in float format, compressed if enabled by setRawCompression.
+    *
+    * @param[in] data       The buffer (channels x samples, column major)
+    * @param[in] nchan      Number of channels
+    * @param[in] nsamp      Number of samples
+    *
+    * @return the position where the buffer was written to, -1 on failure
+    */
+    fiff_long_t write_data_buffer(const float* data, fiff_int_t nchan, fiff_int_t nsamp);
+
     //=========================================================================================================
     /**
     * Writes a string tag
@@ -889,6 +994,48 @@ private:
     */
     QList<FiffDirEntry::SPtr> make_dir(bool *ok=Q_NULLPTR);
 
+    //=========================================================================================================
+    /**
+    * Reads the tag directory from the sidecar cache file, see setDirCacheEnabled.
+    *
+    * @param[out] p_dir     The cached directory
+    *
+    * @return true if a valid cache was found, false otherwise
+    */
+    bool read_dir_cache(QList<FiffDirEntry::SPtr>& p_dir);
+
+    //=========================================================================================================
+    /**
+    * Writes the tag directory to the sidecar cache file, see setDirCacheEnabled.
+    *
+    * @param[in] p_dir      The directory to cache
+    *
+    * @return true if the cache was written, false otherwise
+    */
+    bool write_dir_cache(const QList<FiffDirEntry::SPtr>& p_dir);
+
+    //=========================================================================================================
+    /**
+    * Prepares the reusable tag buffer for a tag with datasize bytes of data and writes the big endian tag
+    * header into it. The buffer only grows, so writing tags of equal size does not allocate.
+    *
+    * @param[in] kind       Tag kind
+    * @param[in] type       Data type
+    * @param[in] datasize   Size of the tag data in bytes
+    * @param[in] next       Position of the next tag
+    *
+    * @return pointer to the data section of the buffer, to be filled in big endian byte order
+    */
+    uchar* begin_tag_data(fiff_int_t kind, fiff_int_t type, fiff_int_t datasize, fiff_int_t next = FIFFV_NEXT_SEQ);
+
+    //=========================================================================================================
+    /**
+    * Writes the tag prepared by begin_tag_data with a single write to the device.
+    *
+    * @return the position where the tag was written to
+    */
+    fiff_long_t write_tag_data();
+
 private:
 
 //    char         *file_name;    /**< Name of the file */ -> Use streamName() instead
@@ -897,6 +1044,19 @@ private:
     QList<FiffDirEntry::SPtr>   m_dir;  /**< This is the directory. If no directory exists, open automatically scans the file to create one. */
 //    int         nent;           /**< How many entries? */ -> Use nent() instead
     FiffDirNode::SPtr           m_dirtree; /**< Directory compiled into a tree */
+
+    uchar*                      m_pMappedData;  /**< Start of the memory mapped file, NULL if not mapped */
+    fiff_long_t                 m_iMappedSize;  /**< Size of the memory mapped region in bytes */
+    QMetaObject::Connection     m_mapConnection;/**< Connection which releases the mapping when the device closes */
+
+    QByteArray                  m_baTagBuffer;  /**< Reusable buffer holding the big endian tag being written */
+    qint32                      m_iTagSize;     /**< Number of valid bytes in m_baTagBuffer */
+
+    bool                        m_bRawCompression;  /**< Whether raw data buffers are written compressed */
+    MatrixXf                    m_matRawBuffer;     /**< Reusable float buffer for the compressed write_raw_buffer */
+    QByteArray                  m_baCodecBuffer;    /**< Reusable buffer holding the compressed raw data */
+
+    static bool                 m_bDirCacheEnabled; /**< Whether scanned tag directories are cached in a sidecar file */
 //    char        *ext_file_name; /**< Name of the file holding the external data */
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open  */
 
@@ -255,6 +255,9 @@ QString FiffTag::getInfo() const
         case FIFFT_COMPLEX_DOUBLE:
             t_qStringInfo = "Simple type FIFFT_COMPLEX_DOUBLE";
             break;
+        case FIFFT_RAW_COMPRESSED:
+            t_qStringInfo = "Simple type FIFFT_RAW_COMPRESSED";
+            break;
         //
         //   Structures
         //
@@ -0,0 +1,259 @@
+//=============================================================================================================
+/**
+* @file     fiff_tag_view.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffTagView Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_tag_view.h"
+#include "fiff_file.h"
+#include "fiff_raw_codec.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+template<typename V, typename U>
+static inline double load_big_endian(const uchar* p_pSrc)
+{
+    //Swap the raw bits of the word and reinterpret them as the stored value type
+    U t_bits = qFromBigEndian<U>(p_pSrc);
+    V t_value;
+    std::memcpy(&t_value, &t_bits, sizeof(V));
+    return (double)t_value;
+}
+
+
+//*************************************************************************************************************
+
+template<typename V, typename U>
+static void decode_raw_samples(const fiff_data_t* p_pSrc,
+                               qint32 p_iNChan,
+                               qint32 p_iFirstSamp,
+                               qint32 p_iNSamp,
+                               const qint32* p_pSel,
+                               const double* p_pGains,
+                               qint32 p_iNRows,
+                               double* p_pDest,
+                               qint64 p_iDestStride)
+{
+    //
+    //   One sample holds all channels contiguously. The inner loops are free of branches and dependencies,
+    //   which lets the compiler vectorize the byte swap, the conversion and the calibration.
+    //
+    const uchar* t_pSrc = reinterpret_cast<const uchar*>(p_pSrc);
+    for(qint32 c = 0; c < p_iNSamp; ++c) {
+        const uchar* t_pSamp = t_pSrc + (qint64)(p_iFirstSamp + c)*p_iNChan*sizeof(V);
+        double* t_pDest = p_pDest + c*p_iDestStride;
+
+        if(p_pSel && p_pGains) {
+            for(qint32 r = 0; r < p_iNRows; ++r)
+                t_pDest[r] = p_pGains[r] * load_big_endian<V,U>(t_pSamp + p_pSel[r]*sizeof(V));
+        } else if(p_pSel) {
+            for(qint32 r = 0; r < p_iNRows; ++r)
+                t_pDest[r] = load_big_endian<V,U>(t_pSamp + p_pSel[r]*sizeof(V));
+        } else if(p_pGains) {
+            for(qint32 r = 0; r < p_iNRows; ++r)
+                t_pDest[r] = p_pGains[r] * load_big_endian<V,U>(t_pSamp + r*sizeof(V));
+        } else {
+            for(qint32 r = 0; r < p_iNRows; ++r)
+                t_pDest[r] = load_big_endian<V,U>(t_pSamp + r*sizeof(V));
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffTagView::FiffTagView()
+: kind(-1)
+, type(-1)
+, size(0)
+, next(-1)
+, data(Q_NULLPTR)
+{
+
+}
+
+
+//*************************************************************************************************************
+
+FiffTagView::~FiffTagView()
+{
+
+}
+
+
+//*************************************************************************************************************
+
+bool FiffTagView::toRawBuffer(MatrixXd& p_matData, fiff_int_t p_iNChan, fiff_int_t p_iNSamp) const
+{
+    if(p_matData.rows() != p_iNChan || p_matData.cols() != p_iNSamp)
+        p_matData.resize(p_iNChan, p_iNSamp);
+
+    return toRawBuffer(p_matData, p_iNChan, 0, p_iNSamp);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffTagView::toRawBuffer(Ref<MatrixXd> p_matDest,
+                              fiff_int_t p_iNChan,
+                              fiff_int_t p_iFirstSamp,
+                              fiff_int_t p_iNSamp,
+                              const RowVectorXi& p_vecSel,
+                              const RowVectorXd& p_vecGains) const
+{
+    if(this->isEmpty())
+        return false;
+
+    if(type == FIFFT_RAW_COMPRESSED)
+        return toCompressedRawBuffer(p_matDest, p_iNChan, p_iFirstSamp, p_iNSamp, p_vecSel, p_vecGains);
+
+    qint32 t_iWordSize;
+    switch(type) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            t_iWordSize = 2;
+            break;
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            t_iWordSize = 4;
+            break;
+        default:
+            printf("FiffTagView::toRawBuffer - Data Storage Format not known yet!! Type: %d\n", type);
+            return false;
+    }
+
+    qint32 t_iNRows = p_vecSel.size() > 0 ? p_vecSel.size() : p_iNChan;
+
+    if(p_iFirstSamp < 0 || (qint64)(p_iFirstSamp + p_iNSamp)*p_iNChan*t_iWordSize > size) {
+        printf("FiffTagView::toRawBuffer - Tag too small for samples %d ... %d.\n", p_iFirstSamp, p_iFirstSamp + p_iNSamp - 1);
+        return false;
+    }
+
+    if(p_matDest.rows() != t_iNRows || p_matDest.cols() != p_iNSamp
+            || (p_vecGains.size() > 0 && p_vecGains.size() != t_iNRows)) {
+        printf("FiffTagView::toRawBuffer - Destination dimensions do not match.\n");
+        return false;
+    }
+
+    const qint32* t_pSel = p_vecSel.size() > 0 ? p_vecSel.data() : Q_NULLPTR;
+    const double* t_pGains = p_vecGains.size() > 0 ? p_vecGains.data() : Q_NULLPTR;
+
+    switch(type) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            decode_raw_samples<qint16,quint16>(data, p_iNChan, p_iFirstSamp, p_iNSamp, t_pSel, t_pGains, t_iNRows, p_matDest.data(), p_matDest.outerStride());
+            break;
+        case FIFFT_INT:
+            decode_raw_samples<qint32,quint32>(data, p_iNChan, p_iFirstSamp, p_iNSamp, t_pSel, t_pGains, t_iNRows, p_matDest.data(), p_matDest.outerStride());
+            break;
+        case FIFFT_FLOAT:
+            decode_raw_samples<float,quint32>(data, p_iNChan, p_iFirstSamp, p_iNSamp, t_pSel, t_pGains, t_iNRows, p_matDest.data(), p_matDest.outerStride());
+            break;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffTagView::toCompressedRawBuffer(Ref<MatrixXd> p_matDest,
+                                        fiff_int_t p_iNChan,
+                                        fiff_int_t p_iFirstSamp,
+                                        fiff_int_t p_iNSamp,
+                                        const RowVectorXi& p_vecSel,
+                                        const RowVectorXd& p_vecGains) const
+{
+    fiff_int_t t_iNChan, t_iNSamp;
+    if(!FiffRawCodec::peek(data, size, t_iNChan, t_iNSamp) || t_iNChan != p_iNChan) {
+        printf("FiffTagView::toRawBuffer - Invalid compressed data buffer.\n");
+        return false;
+    }
+
+    qint32 t_iNRows = p_vecSel.size() > 0 ? p_vecSel.size() : p_iNChan;
+
+    if(p_iFirstSamp < 0 || p_iFirstSamp + p_iNSamp > t_iNSamp) {
+        printf("FiffTagView::toRawBuffer - Tag too small for samples %d ... %d.\n", p_iFirstSamp, p_iFirstSamp + p_iNSamp - 1);
+        return false;
+    }
+
+    if(p_matDest.rows() != t_iNRows || p_matDest.cols() != p_iNSamp
+            || (p_vecGains.size() > 0 && p_vecGains.size() != t_iNRows)) {
+        printf("FiffTagView::toRawBuffer - Destination dimensions do not match.\n");
+        return false;
+    }
+
+    if(!FiffRawCodec::decode(data, size, p_iFirstSamp, p_iNSamp,
+                             p_vecSel.size() > 0 ? p_vecSel.data() : Q_NULLPTR,
+                             p_vecGains.size() > 0 ? p_vecGains.data() : Q_NULLPTR,
+                             t_iNRows, p_matDest.data(), p_matDest.outerStride())) {
+        printf("FiffTagView::toRawBuffer - Damaged compressed data buffer.\n");
+        return false;
+    }
+
+    return true;
+}
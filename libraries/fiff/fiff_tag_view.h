@@ -0,0 +1,182 @@
+//=============================================================================================================
+/**
+* @file     fiff_tag_view.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffTagView class declaration.
+*
+*/
+
+#ifndef FIFF_TAG_VIEW_H
+#define FIFF_TAG_VIEW_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* A FiffTagView describes a tag which resides inside a memory mapped fiff file. In contrast to FiffTag, no
+* memory is allocated and no data are copied: the tag data pointer points directly into the mapping and the
+* data are kept in the big endian file byte order. They are decoded on demand straight into the destination.
+*
+* @brief Non-owning view of a FIFF tag inside a memory mapped file
+*/
+class FIFFSHARED_EXPORT FiffTagView {
+public:
+    typedef QSharedPointer<FiffTagView> SPtr;            /**< Shared pointer type for FiffTagView. */
+    typedef QSharedPointer<const FiffTagView> ConstSPtr; /**< Const shared pointer type for FiffTagView. */
+
+    //=========================================================================================================
+    /**
+    * Default constructor
+    */
+    FiffTagView();
+
+    //=========================================================================================================
+    /**
+    * Destroys the FiffTagView. The viewed data are not touched.
+    */
+    ~FiffTagView();
+
+    //=========================================================================================================
+    /**
+    * True if the view does not point to any tag data.
+    *
+    * @return true if the view is empty
+    */
+    inline bool isEmpty() const;
+
+    //=========================================================================================================
+    /**
+    * Decodes a raw data buffer (FIFFT_DAU_PACK16, FIFFT_SHORT, FIFFT_INT or FIFFT_FLOAT) from the big endian
+    * file representation directly into a double matrix (channels x samples). The destination is only
+    * reallocated if its dimensions do not match, so repeated calls with equally sized buffers do not allocate.
+    *
+    * @param[out] p_matData     The decoded data matrix
+    * @param[in] p_iNChan       Number of channels stored in the buffer
+    * @param[in] p_iNSamp       Number of samples stored in the buffer
+    *
+    * @return true if succeeded, false if the data type is not supported or the tag is too small
+    */
+    bool toRawBuffer(MatrixXd& p_matData, fiff_int_t p_iNChan, fiff_int_t p_iNSamp) const;
+
+    //=========================================================================================================
+    /**
+    * Fused decoding kernel for raw data buffers: decodes the samples p_iFirstSamp ... p_iFirstSamp+p_iNSamp-1
+    * of the big endian buffer, picks the selected channels, applies the per channel gains and writes the result
+    * straight into the destination (selected channels x samples). No temporaries are created. Compressed
+    * buffers (FIFFT_RAW_COMPRESSED) are decoded by FiffRawCodec, distributed over the cores.
+    *
+    * @param[out] p_matDest     The destination, e.g. a block of the segment matrix. Must be sized beforehand.
+    * @param[in] p_iNChan       Number of channels stored in the buffer
+    * @param[in] p_iFirstSamp   First sample of the buffer to decode
+    * @param[in] p_iNSamp       Number of samples to decode
+    * @param[in] p_vecSel       Channel selection (optional, default all channels)
+    * @param[in] p_vecGains     Gain for each destination row, e.g. the calibration (optional, default 1)
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool toRawBuffer(Ref<MatrixXd> p_matDest,
+                     fiff_int_t p_iNChan,
+                     fiff_int_t p_iFirstSamp,
+                     fiff_int_t p_iNSamp,
+                     const RowVectorXi& p_vecSel = defaultRowVectorXi,
+                     const RowVectorXd& p_vecGains = RowVectorXd()) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Decoding of FIFFT_RAW_COMPRESSED buffers for toRawBuffer, same arguments.
+    */
+    bool toCompressedRawBuffer(Ref<MatrixXd> p_matDest,
+                               fiff_int_t p_iNChan,
+                               fiff_int_t p_iFirstSamp,
+                               fiff_int_t p_iNSamp,
+                               const RowVectorXi& p_vecSel,
+                               const RowVectorXd& p_vecGains) const;
+
+public:
+    fiff_int_t          kind;   /**< Tag number. This defines the meaning of the item */
+    fiff_int_t          type;   /**< Data type. This defines the reperentation of the data. */
+    fiff_int_t          size;   /**< Size of the data in bytes. */
+    fiff_int_t          next;   /**< Pointer to the next object. Zero if the object follows sequentially in file. */
+    const fiff_data_t*  data;   /**< Pointer to the big endian tag data inside the mapping. Not owned. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffTagView::isEmpty() const
+{
+    return data == Q_NULLPTR;
+}
+
+} // NAMESPACE
+
+#endif // FIFF_TAG_VIEW_H
@@ -2167,6 +2167,8 @@ void ComputeFwd::calculateFwd() const
             qCritical("Cannot use a homogeneous model in EEG calculations.");
             goto out;
         }
+        bem_model->solve_precision = settings->bem_precision;
+        bem_model->sol_cache_dir   = settings->bem_cache_dir;
         printf("\nLoading the solution matrix...\n");
         if (FwdBemModel::fwd_bem_load_recompute_solution(settings->bemname.toUtf8().data(),FWD_BEM_UNKNOWN,FALSE,bem_model) == FAIL)
             goto out;
@@ -1,6 +1,7 @@
 
 
 #include "compute_fwd_settings.h"
+#include "../fwd_bem_model.h"
 
 #include <stdio.h>
 
@@ -114,6 +115,7 @@ void ComputeFwdSettings::initMembers()
     scale_eeg_pos = false;    
     use_equiv_eeg = true;     
     use_threads = true;       
+    bem_precision = FWD_BEM_SOLVE_FLOAT;
 
 }
 
@@ -136,6 +138,8 @@ void ComputeFwdSettings::usage(char *name)
     fprintf(stderr,"\t--notrans         head and MRI coordinate systems are identical.\n");
     fprintf(stderr,"\t--meas name       take MEG sensor and EEG electrode locations from here\n");
     fprintf(stderr,"\t--bem  name       BEM model name\n");
+    fprintf(stderr,"\t--bemprecision p  precision of the BEM solution: float (default), double, or mixed (float with double refinement)\n");
+    fprintf(stderr,"\t--bemcache dir    cache computed BEM solutions in this directory\n");
     fprintf(stderr,"\t--origin x:y:z/mm use a sphere model with this origin (head coordinates/mm)\n");
     fprintf(stderr,"\t--eegscalp        scale the electrode locations to the surface of the scalp when using a sphere model\n");
     fprintf(stderr,"\t--eegmodels name  read EEG sphere model specifications from here.\n");
@@ -280,6 +284,31 @@ bool ComputeFwdSettings::check_args (int *argc,char **argv)
             }
             bemname = QString(argv[k+1]);
         }
+        else if (strcmp(argv[k],"--bemprecision") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--bemprecision: argument required.");
+                return false;
+            }
+            if (strcmp(argv[k+1],"float") == 0)
+                bem_precision = FWD_BEM_SOLVE_FLOAT;
+            else if (strcmp(argv[k+1],"double") == 0)
+                bem_precision = FWD_BEM_SOLVE_DOUBLE;
+            else if (strcmp(argv[k+1],"mixed") == 0)
+                bem_precision = FWD_BEM_SOLVE_MIXED;
+            else {
+                qCritical("Unknown BEM precision : %s",argv[k+1]);
+                return false;
+            }
+        }
+        else if (strcmp(argv[k],"--bemcache") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--bemcache: argument required.");
+                return false;
+            }
+            bem_cache_dir = QString(argv[k+1]);
+        }
         else if (strcmp(argv[k],"--origin") == 0) {
             found = 2;
             if (k == *argc - 1) {
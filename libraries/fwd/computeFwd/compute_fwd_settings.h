@@ -124,6 +124,8 @@ public:
     QString transname;          /**< head2mri transformation file */
     bool mri_head_ident;        /**< Are the head and MRI coordinates the same? */
     QString bemname;            /**< BEM model file */
+    int bem_precision;          /**< Precision of the BEM coefficient matrix inversion (FWD_BEM_SOLVE_*) */
+    QString bem_cache_dir;      /**< Directory where computed BEM solutions are cached */
     QString solname;            /**< Solution file */
     QString mindistoutname;     /**< Output file for omitted source space points */
     bool filter_spaces;  	/**< Filter the source space points */
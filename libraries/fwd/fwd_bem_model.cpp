@@ -51,8 +51,13 @@
 #include "fwd_thread_arg.h"
 
 #include <fiff/fiff_stream.h>
+#include <utils/trianglebvh.h>
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QList>
 #include <QThread>
 #include <QtConcurrent>
@@ -129,6 +134,9 @@ static float Qz[] = {0.0,0.0,1.0};
 
 #define FREE_CMATRIX_40(m) mne_free_cmatrix_40((m))
 
+#define FWD_MAX_CHUNK 64                /* Maximal number of source points computed by one work item */
+#define FWD_CHUNKS_PER_WORKER 8         /* Work items per worker, leaves room to balance the load */
+
 
 
 
@@ -212,15 +220,39 @@ void fromFloatEigenMatrix_40(const Eigen::MatrixXf& from_mat, float **& to_mat)
 
 
 
-float **mne_lu_invert_40(float **mat,int dim)
+float **mne_lu_invert_40(float **mat,int dim,int precision = FWD_BEM_SOLVE_FLOAT)
 /*
-      * Invert a matrix using the LU decomposition from
-      * LAPACK
+      * Invert a matrix in place using a blocked LU decomposition with
+      * partial pivoting. In the mixed precision mode the single precision
+      * factorization is reused to refine the inverse against residuals
+      * computed in double precision.
       */
 {
-    Eigen::MatrixXf eigen_mat = toFloatEigenMatrix_40(mat, dim, dim);
-    Eigen::MatrixXf eigen_mat_inv = eigen_mat.inverse();
-    fromFloatEigenMatrix_40(eigen_mat_inv, mat);
+    typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowMatrixXf;
+    Eigen::Map<RowMatrixXf> eigen_mat(mat[0],dim,dim);
+
+    if (precision == FWD_BEM_SOLVE_DOUBLE) {
+        Eigen::PartialPivLU<Eigen::MatrixXd> lu(eigen_mat.cast<double>());
+        eigen_mat = lu.inverse().cast<float>();
+        return mat;
+    }
+    Eigen::MatrixXd orig;
+    if (precision == FWD_BEM_SOLVE_MIXED)
+        orig = eigen_mat.cast<double>();
+
+    Eigen::PartialPivLU<Eigen::MatrixXf> lu(eigen_mat);
+    eigen_mat = lu.inverse();
+
+    if (precision == FWD_BEM_SOLVE_MIXED) {
+        const int block = 256;
+        for (int step = 0; step < FWD_BEM_REFINE_STEPS; step++)
+            for (int c = 0; c < dim; c += block) {
+                int nc = std::min(block,dim-c);
+                Eigen::MatrixXd res = -(orig*eigen_mat.middleCols(c,nc).cast<double>());
+                res.middleRows(c,nc).diagonal().array() += 1.0;
+                eigen_mat.middleCols(c,nc) += lu.solve(res.cast<float>());
+            }
+    }
     return mat;
 }
 
@@ -445,6 +477,7 @@ FwdBemModel::FwdBemModel()
 ,v0         (NULL)
 ,use_ip_approach(false)
 ,ip_approach_limit(FWD_BEM_IP_APPROACH_LIMIT)
+,solve_precision(FWD_BEM_SOLVE_FLOAT)
 {
 
 }
@@ -779,6 +812,84 @@ not_found : {
 }
 
 
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_save_solution(const QString &name, FwdBemModel *m)
+/*
+    * Write the potential solution matrix in the layout fwd_bem_load_solution expects
+    */
+{
+    typedef Matrix<float,Dynamic,Dynamic,RowMajor> RowMatrixXf;
+    fiff_int_t method;
+
+    if (!m || !m->solution) {
+        printf("No solution to save in fwd_bem_save_solution");
+        return FAIL;
+    }
+    if (m->bem_method == FWD_BEM_CONSTANT_COLL)
+        method = FIFFV_BEM_APPROX_CONST;
+    else if (m->bem_method == FWD_BEM_LINEAR_COLL)
+        method = FIFFV_BEM_APPROX_LINEAR;
+    else {
+        printf("Unknown BEM method in fwd_bem_save_solution : %d",m->bem_method);
+        return FAIL;
+    }
+    QDir().mkpath(QFileInfo(name).absolutePath());
+    /*
+    * Write to a temporary file first so that a concurrent reader never sees a partial solution
+    */
+    QString tmp_name = name + QString(".%1.tmp").arg(QCoreApplication::applicationPid());
+    QFile file(tmp_name);
+    FiffStream::SPtr stream = FiffStream::start_file(file);
+    if (!stream)
+        return FAIL;
+    stream->start_block(FIFFB_BEM);
+    stream->write_int(FIFF_BEM_APPROX,&method);
+    stream->write_float_matrix(FIFF_BEM_POT_SOLUTION,Map<const RowMatrixXf>(m->solution[0],m->nsol,m->nsol));
+    stream->end_block(FIFFB_BEM);
+    stream->end_file();
+    file.close();
+
+    QFile::remove(name);
+    if (!QFile::rename(tmp_name,name)) {
+        QFile::remove(tmp_name);
+        return FAIL;
+    }
+    return OK;
+}
+
+
+//*************************************************************************************************************
+
+QString FwdBemModel::fwd_bem_solution_cache_name(FwdBemModel *m, int bem_method)
+/*
+    * The cache key covers the geometry, the conductivities and all settings which change the solution
+    */
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    int k,j;
+
+    hash.addData((const char *)&bem_method,sizeof(bem_method));
+    hash.addData((const char *)&m->solve_precision,sizeof(m->solve_precision));
+    hash.addData((const char *)&m->ip_approach_limit,sizeof(m->ip_approach_limit));
+    hash.addData((const char *)&m->nsurf,sizeof(m->nsurf));
+    for (k = 0; k < m->nsurf; k++) {
+        MneSurfaceOld* surf = m->surfs[k];
+        hash.addData((const char *)&surf->id,sizeof(surf->id));
+        hash.addData((const char *)&surf->np,sizeof(surf->np));
+        hash.addData((const char *)&surf->ntri,sizeof(surf->ntri));
+        for (j = 0; j < surf->np; j++)
+            hash.addData((const char *)surf->rr[j],3*sizeof(float));
+        for (j = 0; j < surf->ntri; j++)
+            hash.addData((const char *)surf->itris[j],3*sizeof(int));
+    }
+    if (m->sigma)
+        hash.addData((const char *)m->sigma,m->nsurf*sizeof(float));
+
+    return QDir(m->sol_cache_dir).filePath(QString("bem-sol-%1.fif").arg(QString(hash.result().toHex())));
+}
+
+
 //*************************************************************************************************************
 
 int FwdBemModel::fwd_bem_set_head_mri_t(FwdBemModel *m, FiffCoordTransOld *t)
@@ -1087,10 +1198,8 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
     float **sub_mat = NULL;
     int   np1,np2,ntri,np_tot,np_max;
     float **nodes;
-    MneTriangle*   tri;
-    double omega[3];
-    double *row = NULL;
-    int    j,k,p,q,c;
+    QVector<int> rows;
+    int    j,k,p,q;
     int    joff,koff;
     MneSurfaceOld* surf1;
     MneSurfaceOld* surf2;
@@ -1105,7 +1214,8 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
     for (j = 0; j < np_tot; j++)
         for (k = 0; k < np_tot; k++)
             mat[j][k] = 0.0;
-    row        = MALLOC_40(np_max,double);
+    for (j = 0; j < np_max; j++)
+        rows.append(j);
     sub_mat = MALLOC_40(np_max,float *);
     for (p = 0, joff = 0; p < surfs.size(); p++, joff = joff + np1) {
         surf1 = surfs[p];
@@ -1120,9 +1230,15 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
                     fwd_bem_explain_surface(surf1->id).toUtf8().constData(),np1,
                     fwd_bem_explain_surface(surf2->id).toUtf8().constData(),np2);
 
-            for (j = 0; j < np1; j++) {
-                for (k = 0; k < np2; k++)
-                    row[k] = 0.0;
+            /*
+             * The rows are independent of each other
+             */
+            QtConcurrent::blockingMap(rows.begin(),rows.begin()+np1,[&](int j) {
+                MneTriangle* tri;
+                VectorXd    row = VectorXd::Zero(np2);
+                double      omega[3];
+                int         k,c;
+
                 for (k = 0, tri = surf2->tris; k < ntri; k++,tri++) {
                     /*
                * No contribution from a triangle that
@@ -1139,7 +1255,7 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
                 }
                 for (k = 0; k < np2; k++)
                     mat[j+joff][k+koff] = row[k];
-            }
+            });
             if (p == q) {
                 for (j = 0; j < np1; j++)
                     sub_mat[j] = mat[j+joff]+koff;
@@ -1148,7 +1264,6 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
             fprintf(stderr,"[done]\n");
         }
     }
-    FREE_40(row);
     FREE_40(sub_mat);
     return(mat);
 }
@@ -1177,7 +1292,7 @@ int FwdBemModel::fwd_bem_linear_collocation_solution(FwdBemModel *m)
         m->nsol += m->surfs[k]->np;
 
     fprintf (stderr,"\tInverting the coefficient matrix...\n");
-    if ((m->solution = fwd_bem_multi_solution (coeff,m->gamma,m->nsurf,m->np)) == NULL)
+    if ((m->solution = fwd_bem_multi_solution (coeff,m->gamma,m->nsurf,m->np,m->solve_precision)) == NULL)
         goto bad;
 
     /*
@@ -1196,7 +1311,7 @@ int FwdBemModel::fwd_bem_linear_collocation_solution(FwdBemModel *m)
             goto bad;
 
         fprintf (stderr,"\tInverting the coefficient matrix (homog)...\n");
-        if ((ip_solution = fwd_bem_homog_solution (coeff,m->surfs[m->nsurf-1]->np)) == NULL)
+        if ((ip_solution = fwd_bem_homog_solution (coeff,m->surfs[m->nsurf-1]->np,m->solve_precision)) == NULL)
             goto bad;
 
         fprintf (stderr,"\tModify the original solution to incorporate IP approach...\n");
@@ -1220,7 +1335,7 @@ bad : {
 
 //*************************************************************************************************************
 
-float **FwdBemModel::fwd_bem_multi_solution(float **solids, float **gamma, int nsurf, int *ntri)       /* Number of triangles or nodes on each surface */
+float **FwdBemModel::fwd_bem_multi_solution(float **solids, float **gamma, int nsurf, int *ntri, int precision)
 /*
           * Invert I - solids/(2*M_PI)
           * Take deflation into account
@@ -1255,13 +1370,13 @@ float **FwdBemModel::fwd_bem_multi_solution(float **solids, float **gamma, int n
     for (k = 0; k < ntot; k++)
         solids[k][k] = solids[k][k] + 1.0;
 
-    return (mne_lu_invert_40(solids,ntot));
+    return (mne_lu_invert_40(solids,ntot,precision));
 }
 
 
 //*************************************************************************************************************
 
-float **FwdBemModel::fwd_bem_homog_solution(float **solids, int ntri)
+float **FwdBemModel::fwd_bem_homog_solution(float **solids, int ntri, int precision)
 /*
           * Invert I - solids/(2*M_PI)
           * Take deflation into account
@@ -1269,7 +1384,7 @@ float **FwdBemModel::fwd_bem_homog_solution(float **solids, int ntri)
           * This is the homogeneous model case
           */
 {
-    return fwd_bem_multi_solution (solids,NULL,1,&ntri);
+    return fwd_bem_multi_solution (solids,NULL,1,&ntri,precision);
 }
 
 
@@ -1280,72 +1395,39 @@ void FwdBemModel::fwd_bem_ip_modify_solution(float **solution, float **ip_soluti
           * Modify the solution according to the IP approach
           */
 {
+    typedef Matrix<float,Dynamic,Dynamic,RowMajor> RowMatrixXf;
     int s;
-    int j,k,joff,koff,ntot,nlast;
+    int koff,ntot,nlast;
     float mult;
-    float *row = NULL;
-    float **sub = NULL;
 
     for (s = 0, koff = 0; s < nsurf-1; s++)
         koff = koff + ntri[s];
     nlast = ntri[nsurf-1];
     ntot  = koff + nlast;
 
-    row = MALLOC_40(nlast,float);
-    sub = MALLOC_40(ntot,float *);
     mult = (1.0 + ip_mult)/ip_mult;
 
+    Map<RowMatrixXf> sol(solution[0],ntot,ntot);
+    Map<const RowMatrixXf> ip_sol(ip_solution[0],nlast,nlast);
+    /*
+    * The columns belonging to the innermost surface are multiplied
+    * with the isolated problem solution in one go
+    */
     fprintf(stderr,"\t\tCombining...");
-#ifndef OLD
-    fprintf(stderr,"t ");
-    mne_transpose_square_40(ip_solution,nlast);
-#endif
-    for (s = 0, joff = 0; s < nsurf; s++) {
-        fprintf(stderr,"%d3 ",s+1);
-        /*
-        * Pick the correct submatrix
-        */
-        for (j = 0; j < ntri[s]; j++)
-            sub[j] = solution[j+joff]+koff;
-        /*
-        * Multiply
-        */
-#ifdef OLD
-        for (j = 0; j < ntri[s]; j++) {
-            for (k = 0; k < nlast; k++) {
-                res = mne_dot_vectors_skip_skip(sub[j],1,ip_solution[0]+k,nlast,nlast);
-                row[k] = sub[j][k] - 2.0*res;
-            }
-            for (k = 0; k < nlast; k++)
-                sub[j][k] = row[k];
-        }
-#else
-        for (j = 0; j < ntri[s]; j++) {
-            for (k = 0; k < nlast; k++)
-                row[k] = mne_dot_vectors_40(sub[j],ip_solution[k],nlast);
-            mne_add_scaled_vector_to_40(row,-2.0,sub[j],nlast);
-        }
-#endif
-        joff = joff+ntri[s];
+    {
+        RowMatrixXf prod = sol.rightCols(nlast)*ip_sol;
+        sol.rightCols(nlast) -= 2.0f*prod;
     }
-#ifndef OLD
-    fprintf(stderr,"t ");
-    mne_transpose_square_40(ip_solution,nlast);
-#endif
-    fprintf(stderr,"33 ");
     /*
     * The lower right corner is a special case
     */
-    for (j = 0; j < nlast; j++)
-        for (k = 0; k < nlast; k++)
-            sub[j][k] = sub[j][k] + mult*ip_solution[j][k];
+    sol.bottomRightCorner(nlast,nlast) += mult*ip_sol;
     /*
     * Final scaling
     */
     fprintf(stderr,"done.\n\t\tScaling...");
-    mne_scale_vector_40(ip_mult,solution[0],ntot*ntot);
+    sol *= ip_mult;
     fprintf(stderr,"done.\n");
-    FREE_40(row); FREE_40(sub);
     return;
 }
 
@@ -1468,7 +1550,7 @@ int FwdBemModel::fwd_bem_constant_collocation_solution(FwdBemModel *m)
         m->nsol += m->surfs[k]->ntri;
 
     fprintf (stderr,"\tInverting the coefficient matrix...\n");
-    if ((m->solution = fwd_bem_multi_solution (solids,m->gamma,m->nsurf,m->ntri)) == NULL)
+    if ((m->solution = fwd_bem_multi_solution (solids,m->gamma,m->nsurf,m->ntri,m->solve_precision)) == NULL)
         goto bad;
     /*
        * IP approach?
@@ -1486,7 +1568,7 @@ int FwdBemModel::fwd_bem_constant_collocation_solution(FwdBemModel *m)
             goto bad;
 
         fprintf (stderr,"\tInverting the coefficient matrix (homog)...\n");
-        if ((ip_solution = fwd_bem_homog_solution (solids,m->surfs[m->nsurf-1]->ntri)) == NULL)
+        if ((ip_solution = fwd_bem_homog_solution (solids,m->surfs[m->nsurf-1]->ntri,m->solve_precision)) == NULL)
             goto bad;
 
         fprintf (stderr,"\tModify the original solution to incorporate IP approach...\n");
@@ -1537,6 +1619,7 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
 */
 {
     int solres;
+    QString cache_name;
 
     if (!m) {
         printf ("No model specified for fwd_bem_load_recompute_solution");
@@ -1560,7 +1643,28 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
     }
     if (bem_method == FWD_BEM_UNKNOWN)
         bem_method = FWD_BEM_LINEAR_COLL;
-    return fwd_bem_compute_solution(m,bem_method);
+    /*
+    * Try the solution cache before computing
+    */
+    if (!m->sol_cache_dir.isEmpty()) {
+        cache_name = fwd_bem_solution_cache_name(m,bem_method);
+        if (!force_recompute && QFile::exists(cache_name)) {
+            if (fwd_bem_load_solution(cache_name,bem_method,m) == TRUE) {
+                fprintf(stderr,"\nLoaded cached %s BEM solution from %s\n",fwd_bem_explain_method(m->bem_method).toUtf8().constData(),cache_name.toUtf8().constData());
+                return OK;
+            }
+            m->fwd_bem_free_solution();
+        }
+    }
+    if (fwd_bem_compute_solution(m,bem_method) == FAIL)
+        return FAIL;
+    if (!cache_name.isEmpty()) {
+        if (fwd_bem_save_solution(cache_name,m) == OK)
+            fprintf(stderr,"Cached the BEM solution in %s\n",cache_name.toUtf8().constData());
+        else
+            qWarning("Could not cache the BEM solution in %s",cache_name.toUtf8().constData());
+    }
+    return OK;
 }
 
 
@@ -1613,6 +1717,7 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
     MneTriangle* tri;
     float       x,y,z;
     FwdBemSolution* sol;
+    UTILSLIB::TriangleBvh* bvh = NULL;
 
     if (!m) {
         printf("Model missing in fwd_bem_specify_els");
@@ -1634,6 +1739,11 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
     sol->ncoil = els->ncoil;
     sol->np    = m->nsol;
     sol->solution  = ALLOC_CMATRIX_40(sol->ncoil,sol->np);
+    /*
+       * The triangle hierarchy of the scalp is shared by all electrodes
+       */
+    scalp = m->surfs[0];
+    bvh = MneSurfaceOrVolume::mne_make_surface_bvh(scalp);
     /*
        * Go through all coils
        */
@@ -1642,7 +1752,6 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
         one_sol = sol->solution[k];
         for (q = 0; q < m->nsol; q++)
             one_sol[q] = 0.0;
-        scalp = m->surfs[0];
         /*
          * Go through all 'integration points'
          */
@@ -1650,7 +1759,7 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
             VEC_COPY_40(r,el->rmag[p]);
             if (m->head_mri_t != NULL)
                 FiffCoordTransOld::fiff_coord_trans(r,m->head_mri_t,FIFFV_MOVE);
-            best = MneSurfaceOrVolume::mne_project_to_surface(scalp,NULL,r,FALSE,&dist);
+            best = MneSurfaceOrVolume::mne_project_to_surface_bvh(scalp,bvh,r,FALSE,&dist);
             if (best < 0) {
                 printf("One of the electrodes could not be projected onto the scalp surface. How come?");
                 goto bad;
@@ -1685,9 +1794,11 @@ int FwdBemModel::fwd_bem_specify_els(FwdBemModel* m, FwdCoilSet *els)
             }
         }
     }
+    delete bvh;
     return OK;
 
 bad : {
+        delete bvh;
         els->fwd_free_coil_set_user_data();
         return FAIL;
     }
@@ -2152,6 +2263,120 @@ void FwdBemModel::field_integrals(float *from, MneTriangle* to, double *I1p, dou
 }
 
 
+//*************************************************************************************************************
+
+namespace
+{
+
+/*
+ * Structure-of-arrays copy of the triangles of one surface. The coefficient
+ * kernels below stream through these contiguous arrays instead of chasing
+ * the MneTriangle pointers so that the compiler can vectorize them.
+ */
+struct FwdBemTriangles {
+    int                 ntri;
+    Eigen::VectorXf     r1[3],r2[3],r3[3];  /* Corner coordinates, one array per component */
+    Eigen::VectorXf     nn[3];              /* Normal vectors */
+    Eigen::VectorXf     area;               /* Areas */
+    Eigen::VectorXi     vert[3];            /* Vertex numbers of the corners */
+
+    explicit FwdBemTriangles(MneSurfaceOld* surf)
+    : ntri(surf->ntri)
+    , area(surf->ntri)
+    {
+        int c,k;
+        for (c = 0; c < 3; c++) {
+            r1[c].resize(ntri); r2[c].resize(ntri); r3[c].resize(ntri);
+            nn[c].resize(ntri);
+            vert[c].resize(ntri);
+        }
+        for (k = 0; k < ntri; k++) {
+            MneTriangle* tri = surf->tris+k;
+            for (c = 0; c < 3; c++) {
+                r1[c][k]   = tri->r1[c];
+                r2[c][k]   = tri->r2[c];
+                r3[c][k]   = tri->r3[c];
+                nn[c][k]   = tri->nn[c];
+                vert[c][k] = tri->vert[c];
+            }
+            area[k] = tri->area;
+        }
+    }
+};
+
+
+/*
+ * Batched version of FwdBemModel::one_field_coeff:
+ * acc[k] += w * (field coefficient of triangle k at dest along normal)
+ */
+void fwd_bem_field_coeff_batch(const FwdBemTriangles& t, const float *dest, const float *normal, double w, double *acc)
+{
+    const float *x1 = t.r1[X_40].data(), *y1 = t.r1[Y_40].data(), *z1 = t.r1[Z_40].data();
+    const float *x2 = t.r2[X_40].data(), *y2 = t.r2[Y_40].data(), *z2 = t.r2[Z_40].data();
+    const float *x3 = t.r3[X_40].data(), *y3 = t.r3[Y_40].data(), *z3 = t.r3[Z_40].data();
+    const float dx = dest[X_40], dy = dest[Y_40], dz = dest[Z_40];
+    const double nx = normal[X_40], ny = normal[Y_40], nz = normal[Z_40];
+
+    for (int k = 0; k < t.ntri; k++) {
+        double ax = x1[k]-dx, ay = y1[k]-dy, az = z1[k]-dz;
+        double bx = x2[k]-dx, by = y2[k]-dy, bz = z2[k]-dz;
+        double cx = x3[k]-dx, cy = y3[k]-dy, cz = z3[k]-dz;
+        double la = sqrt(ax*ax + ay*ay + az*az);
+        double lb = sqrt(bx*bx + by*by + bz*bz);
+        double lc = sqrt(cx*cx + cy*cy + cz*cz);
+        double ex,ey,ez,size,beta0,beta1,beta2;
+        /*
+         * calc_beta for the three sides, sharing the corner distances
+         */
+        ex = bx-ax; ey = by-ay; ez = bz-az;
+        size  = sqrt(ex*ex + ey*ey + ez*ez);
+        beta0 = log((la*size + ax*ex + ay*ey + az*ez)/(lb*size + bx*ex + by*ey + bz*ez))/size;
+        ex = cx-bx; ey = cy-by; ez = cz-bz;
+        size  = sqrt(ex*ex + ey*ey + ez*ez);
+        beta1 = log((lb*size + bx*ex + by*ey + bz*ez)/(lc*size + cx*ex + cy*ey + cz*ez))/size;
+        ex = ax-cx; ey = ay-cy; ez = az-cz;
+        size  = sqrt(ex*ex + ey*ey + ez*ez);
+        beta2 = log((lc*size + cx*ex + cy*ey + cz*ez)/(la*size + ax*ex + ay*ey + az*ez))/size;
+
+        double bb0 = beta2-beta0, bb1 = beta0-beta1, bb2 = beta1-beta2;
+        double coeff_x = ax*bb0 + bx*bb1 + cx*bb2;
+        double coeff_y = ay*bb0 + by*bb1 + cy*bb2;
+        double coeff_z = az*bb0 + bz*bb1 + cz*bb2;
+        acc[k] += w*(coeff_x*nx + coeff_y*ny + coeff_z*nz);
+    }
+}
+
+
+/*
+ * Batched version of FwdBemModel::fwd_bem_one_lin_field_coeff_simple:
+ * acc<c>[k] += w * (coefficient of corner c of triangle k at dest along normal)
+ */
+void fwd_bem_lin_field_coeff_simple_batch(const FwdBemTriangles& t, const float *dest, const float *normal, double w, double *acc0, double *acc1, double *acc2)
+{
+    const float *nnx = t.nn[X_40].data(), *nny = t.nn[Y_40].data(), *nnz = t.nn[Z_40].data();
+    const float *area = t.area.data();
+    const float dx = dest[X_40], dy = dest[Y_40], dz = dest[Z_40];
+    const float nx = normal[X_40], ny = normal[Y_40], nz = normal[Z_40];
+    double *acc[3] = { acc0, acc1, acc2 };
+    const Eigen::VectorXf *corners[3] = { t.r1, t.r2, t.r3 };
+
+    for (int c = 0; c < 3; c++) {
+        const float *rx = corners[c][X_40].data(), *ry = corners[c][Y_40].data(), *rz = corners[c][Z_40].data();
+        double *res = acc[c];
+        for (int k = 0; k < t.ntri; k++) {
+            float ux = dx-rx[k], uy = dy-ry[k], uz = dz-rz[k];
+            float dl = ux*ux + uy*uy + uz*uz;
+            float vx =   uy*nnz[k] - nny[k]*uz;
+            float vy = -(ux*nnz[k] - nnx[k]*uz);
+            float vz =   ux*nny[k] - nnx[k]*uy;
+            res[k] += w*(area[k]*(vx*nx + vy*ny + vz*nz)/(3.0*dl*sqrt(dl)));
+        }
+    }
+}
+
+} // anonymous namespace
+
+
 //*************************************************************************************************************
 
 double FwdBemModel::one_field_coeff(float *dest, float *normal, MneTriangle* tri)
@@ -2196,15 +2421,11 @@ float **FwdBemModel::fwd_bem_field_coeff(FwdBemModel *m, FwdCoilSet *coils)	/* G
      * Compute the weighting factors to obtain the magnetic field
      */
 {
-    MneSurfaceOld*     surf;
-    MneTriangle*    tri;
-    FwdCoil*        coil;
     FwdCoilSet*     tcoils = NULL;
-    int            ntri;
     float          **coeff = NULL;
-    int            j,k,p,s,off;
-    double         res;
-    double         mult;
+    int            j,s;
+    QList<QSharedPointer<FwdBemTriangles> > tris;
+    QVector<int>   rows;
 
     if (m->solution == NULL) {
         printf("Solution matrix missing in fwd_bem_field_coeff");
@@ -2238,26 +2459,32 @@ float **FwdBemModel::fwd_bem_field_coeff(FwdBemModel *m, FwdCoilSet *coils)	/* G
             return NULL;
         }
     }
-    ntri  = m->nsol;
-    coeff = ALLOC_CMATRIX_40(coils->ncoil,ntri);
-
-    for (s = 0, off = 0; s < m->nsurf; s++) {
-        surf = m->surfs[s];
-        ntri = surf->ntri;
-        tri  = surf->tris;
-        mult = m->field_mult[s];
+    coeff = ALLOC_CMATRIX_40(coils->ncoil,m->nsol);
 
-        for (k = 0; k < ntri; k++,tri++) {
-            for (j = 0; j < coils->ncoil; j++) {
-                coil = coils->coils[j];
-                res = 0.0;
-                for (p = 0; p < coil->np; p++)
-                    res = res + coil->w[p]*one_field_coeff(coil->rmag[p],coil->cosmag[p],tri);
-                coeff[j][k+off] = mult*res;
-            }
+    for (s = 0; s < m->nsurf; s++)
+        tris.append(QSharedPointer<FwdBemTriangles>(new FwdBemTriangles(m->surfs[s])));
+    /*
+     * Each coil fills its own row of the coefficient matrix
+     */
+    for (j = 0; j < coils->ncoil; j++)
+        rows.append(j);
+    QtConcurrent::blockingMap(rows, [m,coils,coeff,&tris](int j) {
+        FwdCoil*    coil = coils->coils[j];
+        VectorXd    res;
+        int         s,k,p,off;
+        double      mult;
+
+        for (s = 0, off = 0; s < m->nsurf; s++) {
+            const FwdBemTriangles& t = *tris[s];
+            mult = m->field_mult[s];
+            res.setZero(t.ntri);
+            for (p = 0; p < coil->np; p++)
+                fwd_bem_field_coeff_batch(t,coil->rmag[p],coil->cosmag[p],coil->w[p],res.data());
+            for (k = 0; k < t.ntri; k++)
+                coeff[j][k+off] = mult*res[k];
+            off = off + t.ntri;
         }
-        off = off + ntri;
-    }
+    });
     delete tcoils;
     return coeff;
 }
@@ -2419,16 +2646,12 @@ float **FwdBemModel::fwd_bem_lin_field_coeff(FwdBemModel *m, FwdCoilSet *coils,
           * in the linear potential approximation
           */
 {
-    MneSurfaceOld*  surf;
-    MneTriangle* tri;
-    FwdCoil*     coil;
     FwdCoilSet*  tcoils = NULL;
-    int         ntri;
     float       **coeff  = NULL;
-    int         j,k,p,pp,off,s;
-    double      res[3],one[3];
-    float       mult;
+    int         j,k,s;
     linFieldIntFunc func;
+    QList<QSharedPointer<FwdBemTriangles> > tris;
+    QVector<int> rows;
 
     if (m->solution == NULL) {
         printf("Solution matrix missing in fwd_bem_lin_field_coeff");
@@ -2473,38 +2696,55 @@ float **FwdBemModel::fwd_bem_lin_field_coeff(FwdBemModel *m, FwdCoilSet *coils,
     for (k = 0; k < m->nsol; k++)
         for (j = 0; j < coils->ncoil; j++)
             coeff[j][k] = 0.0;
+    for (s = 0; s < m->nsurf; s++)
+        tris.append(QSharedPointer<FwdBemTriangles>(new FwdBemTriangles(m->surfs[s])));
     /*
-       * Process each of the surfaces
-       */
-    for (s = 0, off = 0; s < m->nsurf; s++) {
-        surf = m->surfs[s];
-        ntri = surf->ntri;
-        tri  = surf->tris;
-        mult = m->field_mult[s];
-
-        for (k = 0; k < ntri; k++,tri++) {
-            for (j = 0; j < coils->ncoil; j++) {
-                coil = coils->coils[j];
-                for (pp = 0; pp < 3; pp++)
-                    res[pp] = 0;
-                /*
+     * Each coil fills its own row of the coefficient matrix
+     */
+    for (j = 0; j < coils->ncoil; j++)
+        rows.append(j);
+    QtConcurrent::blockingMap(rows, [m,coils,coeff,func,method,&tris](int j) {
+        FwdCoil*    coil = coils->coils[j];
+        MneSurfaceOld* surf;
+        MneTriangle* tri;
+        MatrixXd    res;
+        double      one[3];
+        int         s,k,p,pp,off;
+        float       mult;
+        /*
+         * Process each of the surfaces
+         */
+        for (s = 0, off = 0; s < m->nsurf; s++) {
+            const FwdBemTriangles& t = *tris[s];
+            surf = m->surfs[s];
+            mult = m->field_mult[s];
+            /*
              * Accumulate the coefficients for each triangle node...
              */
-                for (p = 0; p < coil->np; p++) {
-                    func(coil->rmag[p],coil->cosmag[p],tri,one);
-                    for (pp = 0; pp < 3; pp++)
-                        res[pp] = res[pp] + coil->w[p]*one[pp];
-                }
-                /*
+            res.setZero(t.ntri,3);
+            if (method != FWD_BEM_LIN_FIELD_FERGUSON && method != FWD_BEM_LIN_FIELD_URANKAR) {
+                for (p = 0; p < coil->np; p++)
+                    fwd_bem_lin_field_coeff_simple_batch(t,coil->rmag[p],coil->cosmag[p],coil->w[p],
+                                                         res.col(0).data(),res.col(1).data(),res.col(2).data());
+            }
+            else {
+                for (k = 0, tri = surf->tris; k < t.ntri; k++,tri++)
+                    for (p = 0; p < coil->np; p++) {
+                        func(coil->rmag[p],coil->cosmag[p],tri,one);
+                        for (pp = 0; pp < 3; pp++)
+                            res(k,pp) = res(k,pp) + coil->w[p]*one[pp];
+                    }
+            }
+            /*
              * Add these to the corresponding coefficient matrix
              * elements...
              */
+            for (k = 0; k < t.ntri; k++)
                 for (pp = 0; pp < 3; pp++)
-                    coeff[j][tri->vert[pp]+off] = coeff[j][tri->vert[pp]+off] + mult*res[pp];
-            }
+                    coeff[j][t.vert[pp][k]+off] = coeff[j][t.vert[pp][k]+off] + mult*res(k,pp);
+            off = off + surf->np;
         }
-        off = off + surf->np;
-    }
+    });
     /*
        * Discard the duplicate
        */
@@ -2548,7 +2788,12 @@ int FwdBemModel::fwd_bem_specify_coils(FwdBemModel *m, FwdCoilSet *coils)
 
     csol->ncoil     = coils->ncoil;
     csol->np        = m->nsol;
-    csol->solution  = mne_mat_mat_mult_40(sol,m->solution,coils->ncoil,m->nsol,m->nsol);//TODO: Suspicion, that this is slow - use Eigen
+    csol->solution  = ALLOC_CMATRIX_40(coils->ncoil,m->nsol);
+    {
+        typedef Matrix<float,Dynamic,Dynamic,RowMajor> RowMatrixXf;
+        Map<RowMatrixXf>(csol->solution[0],coils->ncoil,m->nsol).noalias() =
+                Map<const RowMatrixXf>(sol[0],coils->ncoil,m->nsol)*Map<const RowMatrixXf>(m->solution[0],m->nsol,m->nsol);
+    }
 
     FREE_CMATRIX_40(sol);
     return OK;
@@ -2969,13 +3214,14 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
     FwdThreadArg* a = (FwdThreadArg*)arg;
     MneSourceSpaceOld* s = a->s;
     int            j,p,q;
+    int            last = a->last < 0 ? s->np : a->last;
     float          *xyz[3];
 
     p = a->off;
     q = 3*a->off;
     if (a->fixed_ori) {					  /* The normal source component only */
         if (a->field_pot_grad && a->res_grad) {                   /* Gradient requested? */
-            for (j = 0; j < s->np; j++)
+            for (j = a->first; j < last; j++)
                 if (s->inuse[j]) {
                     if (a->field_pot_grad(s->rr[j],s->nn[j],a->coils_els,a->res[p],
                                           a->res_grad[q],a->res_grad[q+1],a->res_grad[q+2],
@@ -2986,7 +3232,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
                 }
         }
         else {
-            for (j = 0; j < s->np; j++)
+            for (j = a->first; j < last; j++)
                 if (s->inuse[j])
                     if (a->field_pot(s->rr[j],s->nn[j],a->coils_els,a->res[p++],a->client) != OK)
                         goto bad;
@@ -2994,7 +3240,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
     }
     else {						  /* All source components */
         if (a->field_pot_grad && a->res_grad) {               /* Gradient requested? */
-            for (j = 0; j < s->np; j++) {
+            for (j = a->first; j < last; j++) {
                 if (s->inuse[j]) {
                     if (a->comp < 0) {				  /* Compute all components */
                         if (a->field_pot_grad(s->rr[j],Qx,a->coils_els,a->res[p],
@@ -3044,7 +3290,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
             }
         }
         else {
-            for (j = 0; j < s->np; j++) {
+            for (j = a->first; j < last; j++) {
                 if (s->inuse[j]) {
                     if (a->vec_field_pot) {
                         xyz[0] = a->res[p++];
@@ -3093,6 +3339,74 @@ bad : {
 }
 
 
+//*************************************************************************************************************
+
+int FwdBemModel::meg_eeg_fwd_chunked(MneSourceSpaceOld **spaces, int nspace, QList<FwdThreadArg*>& workers)
+{
+    struct FwdChunk {
+        MneSourceSpaceOld*  s;      /* The source space */
+        int                 off;    /* Offset within the result to the first vertex solution of the chunk */
+        int                 first;  /* First vertex of the chunk */
+        int                 last;   /* One past the last vertex of the chunk */
+    };
+    QVector<FwdChunk>   chunks;
+    FwdChunk            chunk;
+    int                 k,j,nuse,nsource,chunk_size;
+    int                 ncomp = workers[0]->fixed_ori ? 1 : 3;
+
+    for (k = 0, nsource = 0; k < nspace; k++)
+        nsource += spaces[k]->nuse;
+    /*
+     * Small enough chunks to keep all workers busy until the end, large enough to keep the scheduling cheap
+     */
+    chunk_size = nsource / (FWD_CHUNKS_PER_WORKER*workers.size());
+    if (chunk_size > FWD_MAX_CHUNK)
+        chunk_size = FWD_MAX_CHUNK;
+    if (chunk_size < 1)
+        chunk_size = 1;
+
+    for (k = 0, chunk.off = 0; k < nspace; k++) {
+        chunk.s     = spaces[k];
+        chunk.first = 0;
+        for (j = 0, nuse = 0; j < spaces[k]->np; j++) {
+            if (spaces[k]->inuse[j] && ++nuse == chunk_size) {
+                chunk.last = j+1;
+                chunks.append(chunk);
+                chunk.off   = chunk.off + ncomp*nuse;
+                chunk.first = j+1;
+                nuse = 0;
+            }
+        }
+        if (nuse > 0) {
+            chunk.last = spaces[k]->np;
+            chunks.append(chunk);
+            chunk.off = chunk.off + ncomp*nuse;
+        }
+    }
+    fprintf(stderr,"%d chunks of up to %d source locations for %d threads...",chunks.size(),chunk_size,workers.size());
+    /*
+     * Each worker takes the next chunk which was not taken yet until all are done or one failed
+     */
+    QAtomicInt next_chunk(0);
+    QAtomicInt stat(OK);
+
+    QtConcurrent::blockingMap(workers, [&chunks,&next_chunk,&stat](FwdThreadArg* worker) {
+        int c;
+        while (stat.load() == OK && (c = next_chunk.fetchAndAddRelaxed(1)) < chunks.size()) {
+            worker->s       = chunks[c].s;
+            worker->off     = chunks[c].off;
+            worker->first   = chunks[c].first;
+            worker->last    = chunks[c].last;
+            worker->comp    = -1;
+            meg_eeg_fwd_one_source_space(worker);
+            if (worker->stat != OK)
+                stat.store(FAIL);
+        }
+    });
+    return stat.load();
+}
+
+
 //*************************************************************************************************************
 
 int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *coils, FwdCoilSet *comp_coils, MneCTFCompDataSet *comp_data, bool fixed_ori, FwdBemModel *bem_model, Vector3f *r0, bool use_threads, MneNamedMatrix **resp, MneNamedMatrix **resp_grad)
@@ -3110,7 +3424,7 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, Fwd
                                              * for one dipole orientation */
     int                 nmeg = coils->ncoil;/* Number of channels */
     int                 nsource;            /* Total number of sources */
-    int                 k,p,q,off;
+    int                 k,off;
     QStringList         names;              /* Channel names */
     void                *client;
     FwdThreadArg*       one_arg = NULL;
@@ -3135,7 +3449,6 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, Fwd
         /*
         * Field computation matrices...
         */
-        qDebug() << "!!!TODO Speed the following with Eigen up!";
         printf("Composing the field computation matrix...");
         if (fwd_bem_specify_coils(bem_model,coils) == FAIL)
             goto bad;
@@ -3215,52 +3528,21 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, Fwd
         use_threads = false;
 
     if (use_threads) {
-        int            nthread  = (fixed_ori || vec_field || nproc < 6) ? nspace : 3*nspace;
-        QList <FwdThreadArg*> args; //fwdThreadArg   *args    = MALLOC_40(nthread,fwdThreadArg);
+        QList <FwdThreadArg*> args;
         int            stat;
         /*
         * We need copies to allocate separate workspace for each thread
         */
-        if (fixed_ori || vec_field || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                FwdThreadArg* t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                t_arg->s   = spaces[k];
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.append(t_arg);
-            }
-            fprintf(stderr,"%d processors. I will use one thread for each of the %d source spaces.\n",
-                    nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    FwdThreadArg* t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                    t_arg->s    = spaces[k];
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.append(t_arg);
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            fprintf(stderr,"%d processors. I will use %d threads : %d source spaces x 3 source components.\n",
-                    nproc,nthread,nspace);
-        }
+        for (k = 0; k < nproc; k++)
+            args.append(FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL));
+        fprintf(stderr,"%d processors. I will use %d threads on chunks of the %d source spaces.\n",nproc,nproc,nspace);
         fprintf(stderr,"Computing MEG at %d source locations (%s orientations)...",
                 nsource,fixed_ori ? "fixed" : "free");
         /*
         * Ready to start the threads & Wait for them to complete
         */
-        QtConcurrent::blockingMap(args, meg_eeg_fwd_one_source_space);
-        /*
-        * Check the results
-        */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
-        for (k = 0; k < args.size(); k++)//nthread == args.size()
+        stat = meg_eeg_fwd_chunked(spaces,nspace,args);
+        for (k = 0; k < args.size(); k++)
             FwdThreadArg::free_meg_multi_thread_duplicate(args[k],bem_model != NULL);
         if (stat != OK)
             goto bad;
@@ -3323,7 +3605,7 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
                                              * for one dipole orientation */
     int             nsource;                /* Total number of sources */
     int             neeg = els->ncoil;      /* Number of channels */
-    int             k,p,q,off;
+    int             k,off;
     QStringList     names;                  /* Channel names */
     void            *client;
     FwdThreadArg*   one_arg = NULL;
@@ -3399,50 +3681,21 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
         use_threads = false;
 
     if (use_threads) {
-        int            nthread  = (fixed_ori || vec_pot || nproc < 6) ? nspace : 3*nspace;
-        QList <FwdThreadArg*> args; //FwdThreadArg*   *args    = MALLOC_40(nthread,FwdThreadArg*);
+        QList <FwdThreadArg*> args;
         int            stat;
         /*
         * We need copies to allocate separate workspace for each thread
         */
-        if (fixed_ori || vec_pot || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                FwdThreadArg* t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                t_arg->s   = spaces[k];
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.append(t_arg);
-            }
-            printf("%d processors. I will use one thread for each of the %d source spaces.\n",nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    FwdThreadArg* t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                    t_arg->s    = spaces[k];
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.append(t_arg);
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            printf("%d processors. I will use %d threads : %d source spaces x 3 source components.\n",nproc,nthread,nspace);
-        }
+        for (k = 0; k < nproc; k++)
+            args.append(FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL));
+        printf("%d processors. I will use %d threads on chunks of the %d source spaces.\n",nproc,nproc,nspace);
         printf("Computing EEG at %d source locations (%s orientations)...",
                 nsource,fixed_ori ? "fixed" : "free");
         /*
         * Ready to start the threads & Wait for them to complete
         */
-        QtConcurrent::blockingMap(args, meg_eeg_fwd_one_source_space);
-        /*
-        * Check the results
-        */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
-        for (k = 0; k < args.size(); k++)//nthread == args.size()
+        stat = meg_eeg_fwd_chunked(spaces,nspace,args);
+        for (k = 0; k < args.size(); k++)
             FwdThreadArg::free_eeg_multi_thread_duplicate(args[k],bem_model != NULL);
         if (stat != OK)
             goto bad;
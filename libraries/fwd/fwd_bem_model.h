@@ -64,6 +64,7 @@
 
 #include <QSharedPointer>
 #include <QString>
+#include <QList>
 
 
 
@@ -73,6 +74,12 @@
 
 #define FWD_BEM_IP_APPROACH_LIMIT 0.1
 
+#define FWD_BEM_SOLVE_FLOAT       0     /* Factor and invert the coefficient matrix in single precision */
+#define FWD_BEM_SOLVE_DOUBLE      1     /* Factor and invert the coefficient matrix in double precision */
+#define FWD_BEM_SOLVE_MIXED       2     /* Single precision factorization refined with double precision residuals */
+
+#define FWD_BEM_REFINE_STEPS      1     /* Iterative refinement steps in the mixed precision mode */
+
 #define FWD_BEM_LIN_FIELD_SIMPLE    1
 #define FWD_BEM_LIN_FIELD_FERGUSON  2
 #define FWD_BEM_LIN_FIELD_URANKAR   3
@@ -106,6 +113,7 @@ namespace FWDLIB
 //=============================================================================================================
 
 class FwdEegSphereModel;
+class FwdThreadArg;
 
 
 //=============================================================================================================
@@ -193,6 +201,16 @@ public:
 
     static int fwd_bem_load_solution(const QString& name, int bem_method, FwdBemModel* m);
 
+    /*
+    * Write the potential solution matrix of a model so that fwd_bem_load_solution can read it back
+    */
+    static int fwd_bem_save_solution(const QString& name, FwdBemModel* m);
+
+    /*
+    * Name of the cached solution file for a model, derived from a hash over everything the solution depends on
+    */
+    static QString fwd_bem_solution_cache_name(FwdBemModel* m, int bem_method);
+
     static int fwd_bem_set_head_mri_t(FwdBemModel* m, FIFFLIB::FiffCoordTransOld* t);
 
     //============================= dipole_fit_guesses.c =============================
@@ -232,9 +250,10 @@ public:
     static float **fwd_bem_multi_solution (float **solids,    /* The solid-angle matrix */
                                     float **gamma,     /* The conductivity multipliers */
                                     int   nsurf,       /* Number of surfaces */
-                                    int   *ntri);
+                                    int   *ntri,       /* Number of triangles or nodes on each surface */
+                                    int   precision = FWD_BEM_SOLVE_FLOAT);
 
-    static float **fwd_bem_homog_solution (float **solids,int ntri);
+    static float **fwd_bem_homog_solution (float **solids,int ntri,int precision = FWD_BEM_SOLVE_FLOAT);
 
 
     static void fwd_bem_ip_modify_solution(float **solution,    /* The original solution */
@@ -455,6 +474,20 @@ public:
 
     static void *meg_eeg_fwd_one_source_space(void *arg);
 
+    //=========================================================================================================
+    /**
+    * Computes the forward solution of all source spaces in parallel. The source spaces are split into chunks
+    * of source points. Each worker owns its workspace and takes the next chunk as soon as it finished the
+    * previous one, so the run time scales with the number of workers instead of the number of source spaces.
+    *
+    * @param[in] spaces     The source spaces.
+    * @param[in] nspace     Number of source spaces.
+    * @param[in] workers    One thread argument with a separate workspace per worker.
+    *
+    * @return OK if all chunks were computed, FAIL otherwise.
+    */
+    static int meg_eeg_fwd_chunked(MNELIB::MneSourceSpaceOld* *spaces, int nspace, QList<FwdThreadArg*>& workers);
+
     // TODO check if this is the correct class or move
     static int compute_forward_meg( MNELIB::MneSourceSpaceOld*    *spaces,     /* Source spaces */
                                     int                 nspace,      /* How many? */
@@ -539,6 +572,9 @@ public:
     float      ip_approach_limit;   /* Controls whether we need to use the isolated problem approach */
     bool       use_ip_approach;     /* Do we need it */
 
+    int        solve_precision;     /* How the coefficient matrix is inverted (FWD_BEM_SOLVE_*) */
+    QString     sol_cache_dir;      /* Computed solutions are cached here (empty = no caching) */
+
 // ### OLD STRUCT ###
 //typedef struct {
 //    char       *surf_name;              /* Name of the file where surfaces were loaded from */
@@ -106,6 +106,8 @@ FwdThreadArg::FwdThreadArg()
 ,fixed_ori     (FALSE)
 ,stat          (FAIL)
 ,comp          (-1)
+,first         (0)
+,last          (-1)
 {
 
 }
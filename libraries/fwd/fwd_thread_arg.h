@@ -139,6 +139,8 @@ public:
     int                 fixed_ori;         /* Compute fixed orientation solution? */
     int                 comp;              /* Which component to compute for free orientations */
     int                 stat;
+    int                 first;             /* First source space vertex to process */
+    int                 last;              /* One past the last source space vertex to process, -1 for all */
 
 // ### OLD STRUCT ###
 //typedef struct {
@@ -6,6 +6,10 @@
 
 #include <string.h>
 
+#include <QAtomicInt>
+#include <QThread>
+#include <QtConcurrent>
+
 
 
 using namespace INVERSELIB;
@@ -54,6 +58,9 @@ using namespace FWDLIB;
 
 #define SEG_LEN 10.0
 
+#define FIT_MAX_BLOCK           32  /* Maximum number of consecutive time points fitted by one worker in a row */
+#define FIT_BLOCKS_PER_WORKER   4   /* Aim at least at this many blocks per worker to balance the load */
+
 
 #define EPS_VALUES 0.05
 
@@ -638,6 +645,7 @@ ECDSet DipoleFit::calculateFit() const
         goto out;
 
     fit_data->fit_mag_dipoles = settings->fit_mag_dipoles;
+    fit_data->fit_gradient    = settings->fit_gradient;
     if (settings->is_raw) {
         int c;
         float t1,t2;
@@ -710,11 +718,11 @@ ECDSet DipoleFit::calculateFit() const
 
 
     if (raw) {
-        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose) == FAIL)
+        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,settings->warm_start) == FAIL)
             goto out;
     }
     else {
-        if (fit_dipoles(settings->measname,data,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
+        if (fit_dipoles(settings->measname,data,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set,settings->warm_start) == FAIL)
             goto out;
     }
     printf("%d dipoles fitted\n",set.size());
@@ -728,43 +736,36 @@ out : {
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool warm_start)
 {
-    float *one = MALLOC(data->nchan,float);
+    float **vals = NULL;
     float time;
+    QVector<float> times;
     ECDSet set;
-    ECD   dip;
-    int   s;
-    int   report_interval = 10;
+    int   s,ntime;
 
     set.dataname = dataname;
 
-    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
+    for (s = 0, ntime = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep)
+        ntime++;
+    if (ntime > 0)
+        vals = ALLOC_CMATRIX(ntime,data->nchan);
     for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
         /*
      * Pick the data point
      */
         if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
-                                     1.0/data->current->tstep,FALSE,one) == FAIL) {
+                                     1.0/data->current->tstep,FALSE,vals[times.size()]) == FAIL) {
             fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
             continue;
         }
-
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
-        }
+        times.append(time);
     }
+    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
+    fit_dipoles_parallel(fit,guess,times,vals,verbose,warm_start,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
-    FREE(one);
+    FREE_CMATRIX(vals);
     p_set = set;
     return OK;
 }
@@ -772,9 +773,8 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool warm_start)
 {
-    float *one    = MALLOC(sel->nchan,float);
     float sfreq   = raw->info->sfreq;
     float myinteg = integ > 0.0 ? 2*integ : 0.1;
     int   overlap = ceil(myinteg*sfreq);
@@ -782,22 +782,28 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     int   step    = length - overlap;
     int   stepo   = step + overlap/2;
     int   start   = raw->first_samp;
-    int   s,picks;
+    int   s,picks,ntime;
     float time,stime;
     float **data  = ALLOC_CMATRIX(sel->nchan,length);
-    ECD    dip;
+    float **vals  = NULL;
+    QVector<float> times;
     ECDSet set;
-    int    report_interval = 10;
 
     set.dataname = dataname;
 
+    for (s = 0, ntime = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep)
+        ntime++;
+    if (ntime > 0)
+        vals = ALLOC_CMATRIX(ntime,sel->nchan);
     /*
    * Load the initial data segment
    */
     stime = start/sfreq;
     if (MneRawData::mne_raw_pick_data_filt(raw,sel,start,length,data) == FAIL)
         goto bad;
-    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
+    /*
+   * Pick all values first, the fits can then proceed in parallel
+   */
     for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
         picks = time*sfreq - start;
         if (picks > stepo) {		/* Need a new data segment? */
@@ -810,35 +816,27 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
         /*
      * Get the values
      */
-        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
+        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,vals[times.size()]) == FAIL) {
             fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
             continue;
         }
-        /*
+        times.append(time);
+    }
+    /*
      * Fit
      */
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            qWarning() << "Error";
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
-        }
-    }
+    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
+    fit_dipoles_parallel(fit,guess,times,vals,verbose,warm_start,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
     FREE_CMATRIX(data);
-    FREE(one);
+    FREE_CMATRIX(vals);
     p_set = set;
     return OK;
 
 bad : {
         FREE_CMATRIX(data);
-        FREE(one);
+        FREE_CMATRIX(vals);
         return FAIL;
     }
 }
@@ -846,8 +844,90 @@ bad : {
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, bool warm_start)
 {
     ECDSet set;
-    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set);
+    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set, warm_start);
+}
+
+
+//*************************************************************************************************************
+
+int DipoleFit::fit_dipoles_parallel(DipoleFitData* fit, GuessData* guess, const QVector<float>& times, float **B, int verbose, bool warm_start, ECDSet& set)
+{
+    QVector<ECD>            dips(times.size());
+    QList<DipoleFitData*>   workers;
+    int                     ntime = times.size();
+    int                     nproc = QThread::idealThreadCount();
+    int                     nblock,block_size,fit_verbose,k;
+    int                     report_interval = 10;
+    QAtomicInt              next_block(0);
+    QAtomicInt              nfitted(0);
+
+    if (ntime == 0)
+        return OK;
+    /*
+     * Consecutive time points are fitted as a block by one worker so that warm starts can follow the
+     * time course, the blocks are distributed over the workers
+     */
+    block_size = ntime / (FIT_BLOCKS_PER_WORKER*nproc);
+    if (block_size > FIT_MAX_BLOCK)
+        block_size = FIT_MAX_BLOCK;
+    if (block_size < 1)
+        block_size = 1;
+    nblock = (ntime + block_size - 1)/block_size;
+    if (nproc > nblock)
+        nproc = nblock;
+    /*
+     * Every worker needs its own forward computation workspace
+     */
+    if (nproc <= 1)
+        workers.append(fit);
+    else
+        for (k = 0; k < nproc; k++)
+            workers.append(DipoleFitData::create_dipole_fit_thread_duplicate(fit));
+    fit_verbose = workers.size() == 1 ? verbose : FALSE;
+
+    QtConcurrent::blockingMap(workers, [&](DipoleFitData* worker) {
+        const ECD*  warm;
+        int         b,t,first,last,n;
+        int         best[FIT_MAX_BLOCK];
+        float       good[FIT_MAX_BLOCK];
+
+        while ((b = next_block.fetchAndAddRelaxed(1)) < nblock) {
+            warm  = NULL;
+            first = b*block_size;
+            last  = qMin(ntime,first+block_size);
+            /*
+             * The initial guesses of the whole block come from one matrix product. A failure leaves the
+             * affected entries at -1, they are skipped below
+             */
+            DipoleFitData::find_best_guesses(worker,guess,B+first,last-first,best,good);
+            for (t = first; t < last; t++) {
+                if (best[t-first] < 0)
+                    continue;
+                if (!DipoleFitData::fit_one(worker,guess,times[t],B[t],fit_verbose,dips[t],warm_start ? warm : NULL,best[t-first],good[t-first]))
+                    continue;
+                warm = &dips[t];
+                if (!verbose && (n = nfitted.fetchAndAddRelaxed(1)+1) % report_interval == 0)
+                    fprintf(stderr,"%d..",n);
+            }
+        }
+    });
+    if (workers.size() > 1)
+        for (k = 0; k < workers.size(); k++)
+            DipoleFitData::free_dipole_fit_thread_duplicate(workers[k]);
+    /*
+     * Collect the results in temporal order
+     */
+    for (k = 0; k < ntime; k++) {
+        if (!dips[k].valid)
+            printf("t = %7.1f ms : %s\n",1000*times[k],"error (tbd: catch)");
+        else {
+            set.addEcd(dips[k]);
+            if (verbose)
+                dips[k].print(stdout);
+        }
+    }
+    return OK;
 }
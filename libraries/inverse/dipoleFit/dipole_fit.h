@@ -56,6 +56,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QVector>
 
 
 
@@ -119,10 +120,11 @@ public:
     * @param[in] integ      Integration time
     * @param[in] verbose    Verbose output?
     * @param[out] p_set     the fitted ECD Set
+    * @param[in] warm_start Start each fit from the previous fit of the same block of time points (optional)
     *
     * @return true when successful
     */
-    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool warm_start = false);
 
     //=========================================================================================================
     /**
@@ -141,10 +143,11 @@ public:
     * @param[in] integ      Integration time
     * @param[in] verbose    Verbose output?
     * @param[out] p_set     Return all results here. Warning: for large data files this may take a lot of memory
+    * @param[in] warm_start Start each fit from the previous fit of the same block of time points (optional)
     *
     * @return true when successful
     */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool warm_start = false);
 
     //=========================================================================================================
     /**
@@ -162,10 +165,30 @@ public:
     * @param[in] tstep      Time step to use
     * @param[in] integ      Integration time
     * @param[in] verbose    Verbose output?
+    * @param[in] warm_start Start each fit from the previous fit of the same block of time points (optional)
     *
     * @return true when successful
     */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, bool warm_start = false);
+
+    //=========================================================================================================
+    /**
+    * Fits a single dipole to each of the given data vectors. Consecutive time points are grouped into blocks
+    * which are fitted sequentially by one worker, the blocks are distributed over all available cores. Each
+    * worker uses a thread-private copy of the forward computation workspace. The initial guesses of each block
+    * are searched with a single matrix product, see DipoleFitData::find_best_guesses.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] guess      The initial guesses
+    * @param[in] times      Time points of the data vectors
+    * @param[in] B          The data vectors (times.size() x nchan)
+    * @param[in] verbose    Verbose output?
+    * @param[in] warm_start Start each fit from the previous fit of the same block
+    * @param[out] set       The valid dipoles are appended here in temporal order
+    *
+    * @return OK when successful
+    */
+    static int fit_dipoles_parallel(DipoleFitData* fit, GuessData* guess, const QVector<float>& times, float **B, int verbose, bool warm_start, ECDSet& set);
 
 private:
     DipoleFitSettings* settings;
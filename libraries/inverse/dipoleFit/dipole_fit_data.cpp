@@ -1597,6 +1597,8 @@ static dipoleFitFuncs new_dipole_fit_funcs()
     f->eeg_pot       = NULL;
     f->meg_vec_field = NULL;
     f->eeg_vec_pot   = NULL;
+    f->meg_field_grad  = NULL;
+    f->eeg_pot_grad    = NULL;
     f->meg_client      = NULL;
     f->meg_client_free = NULL;
     f->eeg_client      = NULL;
@@ -3784,12 +3786,14 @@ DipoleFitData::DipoleFitData()
 , user (NULL)
 , user_free (NULL)
 , proj (NULL)
+, proj_work (NULL)
 , sphere_funcs (NULL)
 , bem_funcs (NULL)
 , mag_dipole_funcs (NULL)
 , funcs (NULL)
 , column_norm (COLUMN_NORM_NONE)
 , fit_mag_dipoles (FALSE)
+, fit_gradient (FALSE)
 {
     r0[0] = 0.0f;
     r0[1] = 0.0f;
@@ -3831,6 +3835,7 @@ DipoleFitData::~DipoleFitData()
 
     if(proj)
         delete proj;
+    FREE_3(proj_work);
 
     free_dipole_fit_funcs(sphere_funcs);
     free_dipole_fit_funcs(bem_funcs);
@@ -3904,7 +3909,7 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
            * It works the same way independent of whether or not the compensation is in effect
            */
             comp = FwdCompData::fwd_make_comp_data(comp_data,d->meg_coils,comp_coils,
-                                      FwdBemModel::fwd_bem_field,NULL,NULL,d->bem_model,NULL);
+                                      FwdBemModel::fwd_bem_field,NULL,FwdBemModel::fwd_bem_field_grad,d->bem_model,NULL);
             if (!comp)
                 goto out;
             printf("Compensation setup done.\n");
@@ -3918,6 +3923,7 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
 
             f->meg_field       = FwdCompData::fwd_comp_field;
             f->meg_vec_field   = NULL;
+            f->meg_field_grad  = FwdCompData::fwd_comp_field_grad;
             f->meg_client      = comp;
             f->meg_client_free = FwdCompData::fwd_free_comp_data;
         }
@@ -3926,9 +3932,10 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
             if (FwdBemModel::fwd_bem_specify_els(d->bem_model,d->eeg_els) == FAIL)
                 goto out;
             printf("[done]\n");
-            f->eeg_pot     = FwdBemModel::fwd_bem_pot_els;
-            f->eeg_vec_pot = NULL;
-            f->eeg_client  = d->bem_model;
+            f->eeg_pot      = FwdBemModel::fwd_bem_pot_els;
+            f->eeg_vec_pot  = NULL;
+            f->eeg_pot_grad = FwdBemModel::fwd_bem_pot_grad_els;
+            f->eeg_client   = d->bem_model;
         }
     }
     if (d->neeg > 0 && !d->eeg_model) {
@@ -3938,9 +3945,10 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
     d->sphere_funcs = f = new_dipole_fit_funcs();
     if (d->neeg > 0) {
         VEC_COPY_3(d->eeg_model->r0,d->r0);
-        f->eeg_pot     = FwdEegSphereModel::fwd_eeg_spherepot_coil;
-        f->eeg_vec_pot = FwdEegSphereModel::fwd_eeg_spherepot_coil_vec;
-        f->eeg_client  = d->eeg_model;
+        f->eeg_pot      = FwdEegSphereModel::fwd_eeg_spherepot_coil;
+        f->eeg_vec_pot  = FwdEegSphereModel::fwd_eeg_spherepot_coil_vec;
+        f->eeg_pot_grad = FwdEegSphereModel::fwd_eeg_spherepot_grad_coil;
+        f->eeg_client   = d->eeg_model;
     }
     if (d->nmeg > 0) {
         /*
@@ -3950,12 +3958,13 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
         comp = FwdCompData::fwd_make_comp_data(comp_data,d->meg_coils,comp_coils,
                                   FwdBemModel::fwd_sphere_field,
                                   FwdBemModel::fwd_sphere_field_vec,
-                                  NULL,
+                                  FwdBemModel::fwd_sphere_field_grad,
                                   d->r0,NULL);
         if (!comp)
             goto out;
         f->meg_field       = FwdCompData::fwd_comp_field;
         f->meg_vec_field   = FwdCompData::fwd_comp_field_vec;
+        f->meg_field_grad  = FwdCompData::fwd_comp_field_grad;
         f->meg_client      = comp;
         f->meg_client_free = FwdCompData::fwd_free_comp_data;
     }
@@ -3997,6 +4006,154 @@ out :
 }
 
 
+//*************************************************************************************************************
+
+static int proj_fit_vector(DipoleFitData* d, float *vec, int nvec)
+/*
+ * Apply the projection with the workspace of the fitting data, which belongs to one thread
+ */
+{
+    if (!d->proj || d->proj->nitems <= 0 || d->proj->nvec <= 0)
+        return OK;
+
+    if (!d->proj_work)
+        d->proj_work = MALLOC_3(d->proj->nch,float);
+    return MneProjOp::mne_proj_op_proj_vector(d->proj,vec,nvec,TRUE,d->proj_work);
+}
+
+
+//*************************************************************************************************************
+
+static dipoleFitFuncs dup_dipole_fit_funcs(dipoleFitFuncs f, FwdBemModel* orig_bem, FwdBemModel* new_bem)
+/*
+ * Duplicate the forward functions with private compensation data and BEM scratch
+ */
+{
+    dipoleFitFuncs res;
+
+    if (!f)
+        return NULL;
+
+    res  = new_dipole_fit_funcs();
+    *res = *f;
+    res->meg_client_free = NULL;
+    res->eeg_client_free = NULL;
+
+    if (f->meg_client) {
+        FwdCompData* orig = (FwdCompData*)f->meg_client;
+        FwdCompData* comp = new FwdCompData;
+
+        *comp = *orig;
+        comp->work        = NULL;
+        comp->vec_work    = NULL;
+        comp->set         = orig->set ? new MneCTFCompDataSet(*(orig->set)) : NULL;
+        comp->client_free = NULL;
+        if (orig_bem && comp->client == orig_bem)
+            comp->client = new_bem;
+        res->meg_client = comp;
+    }
+    if (orig_bem && f->eeg_client == orig_bem)
+        res->eeg_client = new_bem;
+    return res;
+}
+
+
+//*************************************************************************************************************
+
+static void free_dup_dipole_fit_funcs(dipoleFitFuncs f)
+
+{
+    if (!f)
+        return;
+
+    if (f->meg_client) {
+        FwdCompData* comp = (FwdCompData*)f->meg_client;
+        comp->comp_coils = NULL;        /* Shared with the original */
+        comp->client     = NULL;
+        delete comp;
+    }
+    FREE_3(f);
+    return;
+}
+
+
+//*************************************************************************************************************
+
+DipoleFitData* DipoleFitData::create_dipole_fit_thread_duplicate(DipoleFitData *d)
+{
+    DipoleFitData* res = new DipoleFitData;
+
+    *res = *d;
+    res->user      = NULL;
+    res->user_free = NULL;
+    res->proj_work = NULL;
+
+    if (d->bem_model) {
+        res->bem_model  = new FwdBemModel;
+        *res->bem_model = *d->bem_model;
+        res->bem_model->v0 = NULL;
+    }
+    res->sphere_funcs     = dup_dipole_fit_funcs(d->sphere_funcs,d->bem_model,res->bem_model);
+    res->bem_funcs        = dup_dipole_fit_funcs(d->bem_funcs,d->bem_model,res->bem_model);
+    res->mag_dipole_funcs = dup_dipole_fit_funcs(d->mag_dipole_funcs,d->bem_model,res->bem_model);
+    if (d->funcs == d->bem_funcs)
+        res->funcs = res->bem_funcs;
+    else if (d->funcs == d->mag_dipole_funcs)
+        res->funcs = res->mag_dipole_funcs;
+    else
+        res->funcs = res->sphere_funcs;
+    return res;
+}
+
+
+//*************************************************************************************************************
+
+void DipoleFitData::free_dipole_fit_thread_duplicate(DipoleFitData *d)
+{
+    if (!d)
+        return;
+
+    free_dup_dipole_fit_funcs(d->sphere_funcs);
+    free_dup_dipole_fit_funcs(d->bem_funcs);
+    free_dup_dipole_fit_funcs(d->mag_dipole_funcs);
+    d->sphere_funcs = d->bem_funcs = d->mag_dipole_funcs = d->funcs = NULL;
+
+    if (d->bem_model) {
+        /*
+         * Only the potential scratch belongs to the duplicate
+         */
+        FwdBemModel* bem = d->bem_model;
+        bem->surfs.clear();
+        bem->nsurf       = 0;
+        bem->ntri        = NULL;
+        bem->np          = NULL;
+        bem->sigma       = NULL;
+        bem->gamma       = NULL;
+        bem->source_mult = NULL;
+        bem->field_mult  = NULL;
+        bem->head_mri_t  = NULL;
+        bem->solution    = NULL;
+        delete bem;
+        d->bem_model = NULL;
+    }
+    if (d->user_free)
+        d->user_free(d->user);
+    d->user       = NULL;
+    d->user_free  = NULL;
+    d->mri_head_t = NULL;
+    d->meg_head_t = NULL;
+    d->chs        = NULL;
+    d->meg_coils  = NULL;
+    d->eeg_els    = NULL;
+    d->noise      = NULL;
+    d->noise_orig = NULL;
+    d->pick       = NULL;
+    d->eeg_model  = NULL;
+    d->proj       = NULL;
+    delete d;
+}
+
+
 //*************************************************************************************************************
 
 MneCovMatrix* DipoleFitData::ad_hoc_noise(FwdCoilSet *meg, FwdCoilSet *eeg, float grad_std, float mag_std, float eeg_std)
@@ -4773,49 +4930,119 @@ static float fit_eval(float *rd,int npar,void *user)
 
 
 
-static int find_best_guess(float     *B,         /* The whitened data */
-                           int       nch,
-                           GuessData* guess,	 /* Guesses */
-                           float     limit,	 /* Pseudoradial component omission limit */
-                           int       *bestp,	 /* Which is the best */
-                           float     *goodp)	 /* Best goodness of fit */
+#define PSEUDO_RADIAL_LIMIT 0.2    /* (pseudo) radial component omission limit */
+
+static int find_best_guess_batch(float     **B,       /* The whitened data vectors */
+                                 int       nB,        /* How many */
+                                 int       nch,
+                                 GuessData* guess,	  /* Guesses */
+                                 float     limit,	  /* Pseudoradial component omission limit */
+                                 int       *bestp,	  /* Which is the best for each data vector */
+                                 float     *goodp)	  /* Best goodness of fit for each data vector */
 /*
- * Thanks to the precomputed SVD everything is really simple
+ * Thanks to the precomputed SVD everything is really simple. With packed guess fields the projections of all
+ * data vectors on all guess bases are obtained from one matrix product.
  */
 {
-    int    k,c;
+    int    j,k,c;
     double B2,Bm2,this_good,one;
-    int    best = -1;
-    float  good = 0.0;
+    int    best,nfail = 0;
+    float  good;
     DipoleForward* fwd;
     int    ncomp;
 
-    B2 = mne_dot_vectors_3(B,B,nch);
-    for (k = 0; k < guess->nguess; k++) {
-        fwd = guess->guess_fwd[k];
-        if (fwd->nch == nch) {
-            ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
-            for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
-                one = mne_dot_vectors_3(fwd->uu[c],B,nch);
-                Bm2 = Bm2 + one*one;
+    if (guess->guess_basis.rows() == nch && guess->guess_basis.cols() == 3*guess->nguess) {
+        MatrixXf data(nch,nB);
+        MatrixXf proj;
+        MatrixXf Bm2s(guess->nguess,nB);
+        VectorXf B2s;
+        Index    maxg;
+
+        for (j = 0; j < nB; j++)
+            data.col(j) = Map<VectorXf>(B[j],nch);
+        B2s  = data.colwise().squaredNorm().transpose();
+        proj = guess->guess_basis.transpose()*data;
+        for (j = 0; j < nB; j++)
+            for (k = 0; k < guess->nguess; k++) {
+                Bm2s(k,j) = proj(3*k,j)*proj(3*k,j) + proj(3*k+1,j)*proj(3*k+1,j);
+                if (guess->guess_sing_ratio[k] > limit)
+                    Bm2s(k,j) += proj(3*k+2,j)*proj(3*k+2,j);
             }
-            this_good = 1.0 - (B2 - Bm2)/B2;
-            if (this_good > good) {
-                best = k;
-                good = this_good;
+        for (j = 0; j < nB; j++) {
+            good = Bm2s.col(j).maxCoeff(&maxg)/B2s[j];
+            bestp[j] = good > 0.0 ? (int)maxg : -1;
+            goodp[j] = good > 0.0 ? good : 0.0;
+        }
+    }
+    else {
+        for (j = 0; j < nB; j++) {
+            best = -1;
+            good = 0.0;
+            B2 = mne_dot_vectors_3(B[j],B[j],nch);
+            for (k = 0; k < guess->nguess; k++) {
+                fwd = guess->guess_fwd[k];
+                if (fwd->nch == nch) {
+                    ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
+                    for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
+                        one = mne_dot_vectors_3(fwd->uu[c],B[j],nch);
+                        Bm2 = Bm2 + one*one;
+                    }
+                    this_good = 1.0 - (B2 - Bm2)/B2;
+                    if (this_good > good) {
+                        best = k;
+                        good = this_good;
+                    }
+                }
             }
+            bestp[j] = best;
+            goodp[j] = good;
         }
     }
-    if (best < 0) {
+    for (j = 0; j < nB; j++)
+        if (bestp[j] < 0)
+            nfail++;
+    if (nfail > 0) {
         printf("No reasonable initial guess found.");
         return FAIL;
     }
-    *bestp = best;
-    *goodp = good;
     return OK;
 }
 
 
+static int find_best_guess(float     *B,         /* The whitened data */
+                           int       nch,
+                           GuessData* guess,	 /* Guesses */
+                           float     limit,	 /* Pseudoradial component omission limit */
+                           int       *bestp,	 /* Which is the best */
+                           float     *goodp)	 /* Best goodness of fit */
+{
+    return find_best_guess_batch(&B,1,nch,guess,limit,bestp,goodp);
+}
+
+
+//*************************************************************************************************************
+
+int DipoleFitData::find_best_guesses(DipoleFitData* fit, GuessData* guess, float **B, int nB, int *best, float *good)
+{
+    int nchan = fit->nmeg+fit->neeg;
+    int j;
+
+    /*
+     * Nothing is used as a starting point if the projection or whitening fails below
+     */
+    for (j = 0; j < nB; j++) {
+        best[j] = -1;
+        good[j] = 0.0;
+    }
+    for (j = 0; j < nB; j++)
+        if (proj_fit_vector(fit,B[j],nchan) == FAIL)
+            return FAIL;
+    if (mne_whiten_data(B,B,nB,nchan,fit->noise) == FAIL)
+        return FAIL;
+    return find_best_guess_batch(B,nB,nchan,guess,PSEUDO_RADIAL_LIMIT,best,good);
+}
+
+
 
 
 
@@ -4944,6 +5171,142 @@ static float rtol(float *vals,int nval)
 }
 
 
+static dipoleFitFuncs fit_pass_funcs(DipoleFitData* fit, int pass)
+/*
+ * The forward model of a fitting pass: the sphere model first, then the BEM if there is one
+ */
+{
+    if (pass == 0)
+        return fit->sphere_funcs;
+    return !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
+}
+
+
+static int fit_funcs_have_grad(DipoleFitData* fit, dipoleFitFuncs f)
+/*
+ * Does the forward model provide the position derivatives needed by gradient_minimize?
+ */
+{
+    return !((fit->nmeg > 0 && !f->meg_field_grad) || (fit->neeg > 0 && !f->eeg_pot_grad));
+}
+
+
+#define GRAD_FIT_MAX_ITER   50      /* Maximum number of Levenberg-Marquardt iterations */
+#define GRAD_FIT_MAX_TRIAL  10      /* Maximum number of damping increases within one iteration */
+#define GRAD_FIT_XTOL       1e-6    /* Converged if the dipole moves less than this (m)... */
+#define GRAD_FIT_FTOL       1e-6    /* ...or if the residual decreases relatively less than this */
+
+static int gradient_minimize(DipoleFitData* fit,     /* The fit data, fit->user is a fitDipUser */
+                             float         *rd,      /* Initial dipole position, replaced by the optimum */
+                             float         *valp,    /* Residual sum of squares at the optimum */
+                             int           *nevalp,  /* Number of forward computations */
+                             int           report)   /* Report every iteration? */
+/*
+ * Levenberg-Marquardt minimization of the residual with respect to the dipole position.
+ * The dipole moment is eliminated at each position (variable projection) and the Jacobian
+ * is approximated by the position derivatives of the field of the current moment with
+ * their component in the dipole subspace removed.
+ * fit->funcs is the forward model of the pass, it has to pass fit_funcs_have_grad.
+ */
+{
+    fitDipUser     fuser = (fitDipUser)fit->user;
+    int            nchan = fit->nmeg+fit->neeg;
+    float          **grad = NULL;
+    float          *resid = NULL;
+    float          Q[3],rd_try[3],val,val_try,one;
+    double         lambda = 1e-3;
+    DipoleForward* fwd;
+    Matrix3d       JtJ,A;
+    Vector3d       Jte,delta;
+    int            iter,trial,ncomp,c,p,q;
+    int            neval = 0;
+    int            converged;
+
+    grad  = ALLOC_CMATRIX_3(3,nchan);
+    resid = MALLOC_3(nchan,float);
+
+    val = fit_eval(rd,3,fit);
+    neval++;
+    for (iter = 0; iter < GRAD_FIT_MAX_ITER; iter++) {
+        if (report)
+            (void)report_func(iter,rd,3,val);
+        /*
+       * The dipole moment and the residual at the current position (fuser->fwd was computed here)
+       */
+        fwd   = fuser->fwd;
+        ncomp = fwd->sing[2]/fwd->sing[0] > fuser->limit ? 3 : 2;
+        Q[0] = Q[1] = Q[2] = 0.0;
+        for (c = 0; c < nchan; c++)
+            resid[c] = fuser->B[c];
+        for (c = 0; c < ncomp; c++) {
+            one = mne_dot_vectors_3(fwd->uu[c],fuser->B,nchan);
+            mne_add_scaled_vector_to_3(fwd->vv[c],one/fwd->sing[c],Q,3);
+            mne_add_scaled_vector_to_3(fwd->uu[c],-one,resid,nchan);
+        }
+        for (c = 0; c < 3; c++)
+            Q[c] = fwd->scales[c]*Q[c];
+        /*
+       * Derivatives of the field with respect to the position, projected off the dipole subspace
+       */
+        if (DipoleFitData::compute_dipole_field_grad(fit,rd,Q,grad) == FAIL)
+            goto bad;
+        neval++;
+        for (p = 0; p < 3; p++)
+            for (c = 0; c < ncomp; c++)
+                mne_add_scaled_vector_to_3(fwd->uu[c],-mne_dot_vectors_3(fwd->uu[c],grad[p],nchan),grad[p],nchan);
+        for (p = 0; p < 3; p++) {
+            Jte[p] = mne_dot_vectors_3(grad[p],resid,nchan);
+            for (q = 0; q <= p; q++)
+                JtJ(p,q) = JtJ(q,p) = mne_dot_vectors_3(grad[p],grad[q],nchan);
+        }
+        /*
+       * Damped Gauss-Newton step, increase the damping until the residual decreases
+       */
+        for (trial = 0; trial < GRAD_FIT_MAX_TRIAL; trial++) {
+            A = JtJ;
+            for (p = 0; p < 3; p++)
+                A(p,p) = (1.0+lambda)*JtJ(p,p);
+            delta = A.ldlt().solve(Jte);
+            for (p = 0; p < 3; p++)
+                rd_try[p] = rd[p] + delta[p];
+            val_try = fit_eval(rd_try,3,fit);
+            neval++;
+            if (val_try < val)
+                break;
+            lambda = 10.0*lambda;
+        }
+        if (trial == GRAD_FIT_MAX_TRIAL)
+            break;                      /* No decrease along any damped step: we are at the minimum */
+        converged = delta.norm() < GRAD_FIT_XTOL || val - val_try < GRAD_FIT_FTOL*val;
+        VEC_COPY_3(rd,rd_try);
+        val    = val_try;
+        lambda = lambda > 1e-7 ? lambda/10.0 : lambda;
+        if (converged)
+            break;
+    }
+    if (report)
+        (void)report_func(iter,rd,3,val);
+    /*
+   * Leave the forward solution of the optimum for the caller
+   */
+    if (trial == GRAD_FIT_MAX_TRIAL) {
+        val = fit_eval(rd,3,fit);
+        neval++;
+    }
+    *valp   = val;
+    *nevalp = neval;
+    FREE_CMATRIX_3(grad);
+    FREE_3(resid);
+    return OK;
+
+bad : {
+        FREE_CMATRIX_3(grad);
+        FREE_3(resid);
+        return FAIL;
+    }
+}
+
+
 
 
 
@@ -5117,12 +5480,15 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
                     float         time,              /* Which time is it? */
                     float         *B,	            /* The field to fit */
                     int           verbose,
-                    ECD&          res               /* The fitted dipole */
+                    ECD&          res,              /* The fitted dipole */
+                    const ECD*    warm,             /* Fit at a neighbouring time point (optional) */
+                    int           guess_best,       /* Initial guess found already, B is whitened (optional) */
+                    float         guess_good        /* Goodness of fit of this guess */
                     )
 {
     float  **simplex       = NULL;	       /* The simplex */
     float  vals[4];			       /* Values at the vertices */
-    float  limit           = 0.2;	               /* (pseudo) radial component omission limit */
+    float  limit           = PSEUDO_RADIAL_LIMIT;	/* (pseudo) radial component omission limit */
     float  size            = 1e-2;	       /* Size of the initial simplex */
     float  ftol[]          = { 1e-2, 1e-2 };     /* Tolerances on the the two passes */
     float  atol[]          = { 0.2e-3, 0.2e-3 }; /* If dipole movement between two iterations is less than this,
@@ -5140,16 +5506,22 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     nchan = fit->nmeg+fit->neeg;
     user.fwd = NULL;
 
-    if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
-        goto bad;
+    if (guess_best >= 0) {
+        best = guess_best;
+        good = guess_good;
+    }
+    else {
+        if (proj_fit_vector(fit,B,nchan) == FAIL)
+            goto bad;
 
-    if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
-        goto bad;
-    /*
-   * Get the initial guess
-   */
-    if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
-        goto bad;
+        if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
+            goto bad;
+        /*
+     * Get the initial guess
+     */
+        if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
+            goto bad;
+    }
 
 
     user.limit = limit;
@@ -5161,6 +5533,28 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
 
     VEC_COPY_3(rd_guess,guess->rr[best]);
     VEC_COPY_3(rd_final,guess->rr[best]);
+    /*
+   * Start from the neighbouring fit instead if it explains the data better. It is compared in the
+   * forward model of the first pass, fit->funcs may still be the BEM of the previous fit.
+   */
+    fit->funcs = fit_pass_funcs(fit,0);
+    if (warm && warm->valid) {
+        float rd_warm[3] = { warm->rd[0], warm->rd[1], warm->rd[2] };
+        double Bm2,one;
+        int    c,ncomp_warm;
+
+        if ((user.fwd = dipole_forward_one(fit,rd_warm,NULL)) != NULL) {
+            ncomp_warm = user.fwd->sing[2]/user.fwd->sing[0] > limit ? 3 : 2;
+            for (c = 0, Bm2 = 0.0; c < ncomp_warm; c++) {
+                one = mne_dot_vectors_3(user.fwd->uu[c],B,nchan);
+                Bm2 = Bm2 + one*one;
+            }
+            if (1.0 - (user.B2 - Bm2)/user.B2 > good) {
+                VEC_COPY_3(rd_guess,rd_warm);
+                VEC_COPY_3(rd_final,rd_warm);
+            }
+        }
+    }
 
     neval_tot = 0;
     fit_fail = FALSE;
@@ -5168,11 +5562,17 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
         /*
      * Do first pass with the sphere model
      */
-        if (k == 0)
-            fit->funcs = fit->sphere_funcs;
-        else
-            fit->funcs = !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
+        fit->funcs = fit_pass_funcs(fit,k);
 
+        /*
+     * The gradient-based optimizer is used if the forward model of this pass provides position derivatives
+     */
+        if (fit->fit_gradient && fit_funcs_have_grad(fit,fit->funcs)
+                && gradient_minimize(fit,rd_guess,&final_val,&neval,verbose) == OK) {
+            VEC_COPY_3(rd_final,rd_guess);
+            neval_tot += neval;
+            continue;
+        }
         simplex = make_initial_dipole_simplex(rd_guess,size);
         for (p = 0; p < 4; p++)
             vals[p] = fit_eval(simplex[p],3,fit);
@@ -5309,7 +5709,7 @@ int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten,
 #endif
 
     for (k = 0; k < 3; k++)
-        if (MneProjOp::mne_proj_op_proj_vector(d->proj,fwd[k],d->nmeg+d->neeg,TRUE) == FAIL)
+        if (proj_fit_vector(d,fwd[k],d->nmeg+d->neeg) == FAIL)
             goto bad;
 
 #ifdef DEBUG
@@ -5339,3 +5739,53 @@ int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten,
 bad :
     return FAIL;
 }
+
+
+//*************************************************************************************************************
+
+int DipoleFitData::compute_dipole_field_grad(DipoleFitData* d, float *rd, float *Q, float **grad)
+/*
+ * Compute the derivatives of the field with respect to the dipole position and take
+ * whitening and projection into account
+ */
+{
+    float *val = NULL;
+    int   nchan = d->nmeg+d->neeg;
+    int   k;
+
+    if ((d->nmeg > 0 && !d->funcs->meg_field_grad) || (d->neeg > 0 && !d->funcs->eeg_pot_grad))
+        return FAIL;
+    val = MALLOC_3(nchan,float);
+    /*
+   * Compute the derivatives
+   */
+    if (d->nmeg > 0) {
+        if (d->funcs->meg_field_grad(rd,Q,d->meg_coils,val,grad[0],grad[1],grad[2],d->funcs->meg_client) != OK)
+            goto bad;
+    }
+    if (d->neeg > 0) {
+        if (d->funcs->eeg_pot_grad(rd,Q,d->eeg_els,val+d->nmeg,
+                                   grad[0]+d->nmeg,grad[1]+d->nmeg,grad[2]+d->nmeg,d->funcs->eeg_client) != OK)
+            goto bad;
+    }
+    /*
+   * Apply projection
+   */
+    for (k = 0; k < 3; k++)
+        if (proj_fit_vector(d,grad[k],nchan) == FAIL)
+            goto bad;
+    /*
+   * Whiten
+   */
+    if (d->noise) {
+        if (mne_whiten_data(grad,grad,3,nchan,d->noise) == FAIL)
+            goto bad;
+    }
+    FREE_3(val);
+    return OK;
+
+bad : {
+        FREE_3(val);
+        return FAIL;
+    }
+}
@@ -82,11 +82,13 @@ typedef void (*fitUserFreeFunc)(void *);
 typedef struct {
   fwdFieldFunc    meg_field;	    /* MEG forward calculation functions */
   fwdVecFieldFunc meg_vec_field;
+  fwdFieldGradFunc meg_field_grad;  /* MEG field and its gradient with respect to the dipole position (optional) */
   void            *meg_client;	    /* Client data for MEG field computations */
   mneUserFreeFunc meg_client_free;
 
   fwdFieldFunc    eeg_pot;	    /* EEG forward calculation functions */
   fwdVecFieldFunc eeg_vec_pot;
+  fwdFieldGradFunc eeg_pot_grad;    /* EEG potential and its gradient with respect to the dipole position (optional) */
   void            *eeg_client;	    /* Client data for EEG field computations */
   mneUserFreeFunc eeg_client_free;
 } *dipoleFitFuncs,dipoleFitFuncsRec;
@@ -145,6 +147,26 @@ public:
 
     static int setup_forward_model(DipoleFitData* d, MNELIB::MneCTFCompDataSet* comp_data, FWDLIB::FwdCoilSet* comp_coils);
 
+    //=========================================================================================================
+    /**
+    * Create a duplicate of the fitting data which can be used in a thread of its own. The read-only parts
+    * (channels, coils, noise covariance, projection, BEM solution) are shared with the original, the
+    * forward computation workspaces (compensation data, BEM potential scratch) are private to the duplicate.
+    *
+    * @param[in] d      The fitting data set up by setup_dipole_fit_data
+    *
+    * @return the duplicate, to be released with free_dipole_fit_thread_duplicate
+    */
+    static DipoleFitData* create_dipole_fit_thread_duplicate(DipoleFitData* d);
+
+    //=========================================================================================================
+    /**
+    * Release a duplicate created with create_dipole_fit_thread_duplicate without touching the shared parts.
+    *
+    * @param[in] d      The duplicate
+    */
+    static void free_dipole_fit_thread_duplicate(DipoleFitData* d);
+
 
 
 
@@ -211,8 +233,28 @@ public:
     * @param[in] B          The field to fit
     * @param[in] verbose
     * @param[in] res        The fitted dipole
+    * @param[in] warm       A fit at a neighbouring time point to start from if it explains the data better than the best guess (optional)
+    * @param[in] guess_best Index of the initial guess found with find_best_guesses. If given, B must already be projected and whitened (optional)
+    * @param[in] guess_good Goodness of fit of the initial guess (optional)
     */
-    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res);
+    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res, const ECD* warm = NULL, int guess_best = -1, float guess_good = 0.0);
+
+    //=========================================================================================================
+    /**
+    * Projects and whitens a batch of data vectors in place and finds the best initial guess for each of them.
+    * When the guess fields are packed (GuessData::guess_basis) the goodness of fit of all guesses for all data
+    * vectors is computed with a single matrix product.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] guess      The initial guesses
+    * @param[in, out] B     The data vectors, projected and whitened on return
+    * @param[in] nB         Number of data vectors
+    * @param[out] best      Index of the best guess for each data vector, -1 if none was found or the projection failed
+    * @param[out] good      Goodness of fit of the best guess for each data vector
+    *
+    * @return OK if a guess was found for every data vector, FAIL otherwise
+    */
+    static int find_best_guesses(DipoleFitData* fit, GuessData* guess, float **B, int nB, int *best, float *good);
 
 
 
@@ -220,6 +262,20 @@ public:
 
     static int compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd);
 
+    //=========================================================================================================
+    /**
+    * Compute the derivatives of the field of a dipole with respect to its position, with projection and
+    * whitening applied in the same way as in compute_dipole_field.
+    *
+    * @param[in] d      The fit data
+    * @param[in] rd     Dipole position
+    * @param[in] Q      Dipole moment
+    * @param[out] grad  The derivatives with respect to x, y, and z (3 x nchan)
+    *
+    * @return OK if the current forward functions provide gradients, FAIL otherwise
+    */
+    static int compute_dipole_field_grad(DipoleFitData* d, float *rd, float *Q, float **grad);
+
     //============================= dipole_forward.c
 
     static DipoleForward* dipole_forward_one(DipoleFitData* d,
@@ -259,8 +315,10 @@ public:
       MNELIB::MneCovMatrix*      noise;              /**< Noise covariance matrix (weighted to take the selection into account) */
       int               nave;               /**< How many averages does this correspond to? */
       MNELIB::MneProjOp*        proj;               /**< The projection operator to use */
+      float             *proj_work;         /**< Result workspace of the projection, private to every thread duplicate */
       int               column_norm;        /**< What kind of column normalization to apply to the forward solution */
       int               fit_mag_dipoles;    /**< Fit magnetic dipoles? */
+      int               fit_gradient;       /**< Optimize the dipole position with analytic field gradients? */
       void              *user;              /**< User data for anything we need */
       fitUserFreeFunc   user_free;          /**< Function to free the above */
 
@@ -115,12 +115,14 @@ void DipoleFitSettings::initMembers()
     do_baseline  = false;         
     setno        = 1;             
     verbose      = false;
+    warm_start   = false;
     omit_data_proj = false;
          
     eeg_sphere_rad = 0.09f;      
     scale_eeg_pos  = false;     
     mag_reg      = 0.1f;         
     fit_mag_dipoles = false;
+    fit_gradient = false;
 
     grad_reg     = 0.1f;         
     eeg_reg      = 0.1f;                  
@@ -230,6 +232,7 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--tmax  time/ms   specify the ending analysis time\n");
     printf("\t--tstep time/ms   specify the time step between frames (default 1/(sampling frequency))\n");
     printf("\t--integ time/ms   specify the time integration for each frame (default 0)\n");
+    printf("\t--warm            start each fit from the previous time point if it fits better than the best guess\n");
 
     printf("\nPreprocessing:\n\n");
     printf("\t--bmin  time/ms   specify the baseline starting time (evoked data only)\n");
@@ -277,6 +280,7 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--gradfit         Optimize the dipole position with analytic field gradients (Levenberg-Marquardt) instead of the simplex.\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
@@ -823,6 +827,10 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             fit_mag_dipoles = true;
         }
+        else if (strcmp(argv[k],"--gradfit") == 0) {
+            found = 1;
+            fit_gradient = true;
+        }
         else if (strcmp(argv[k],"--dip") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -843,6 +851,10 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             verbose = true;
         }
+        else if (strcmp(argv[k],"--warm") == 0) {
+            found = 1;
+            warm_start = true;
+        }
         if (found) {
             for (int p = k; p < *argc-found; p++)
                 argv[p] = argv[p+found];
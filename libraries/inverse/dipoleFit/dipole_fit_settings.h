@@ -169,6 +169,7 @@ float guess_rad;       			/**< Radius of spherical guess surface */
     bool  do_baseline;         		/**< Are both baseline limits set? */
     int   setno;             		/**< Which data set */
     bool  verbose;
+    bool  warm_start;                   /**< Start each fit from the previous time point if it explains the data better */
     mneFilterDefRec filter;
     QStringList projnames;              /**< Projection file names */
     bool omit_data_proj;
@@ -179,6 +180,7 @@ float  eeg_sphere_rad;      		/**< Scalp radius to use in EEG sphere model */
     bool    scale_eeg_pos;     		/**< Scale the electrode locations to scalp in the sphere model */
     float  mag_reg;         		/**< Noise-covariance matrix regularization for MEG (magnetometers and axial gradiometers)  */
     bool   fit_mag_dipoles;
+    bool   fit_gradient;                /**< Optimize the dipole position with analytic field gradients instead of the simplex */
 
 float  grad_reg;         		/**< Noise-covariance matrix regularization for EEG (planar gradiometers) */
     float  eeg_reg;         		/**< Noise-covariance matrix regularization for EEG  */
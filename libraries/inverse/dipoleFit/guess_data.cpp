@@ -294,6 +294,7 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
 #endif
     }
     f->funcs = orig;
+    pack_guess_fields();
 
     fprintf(stderr,"[done %d sources]\n",p);
 
@@ -460,7 +461,36 @@ bool GuessData::compute_guess_fields(DipoleFitData* f)
 #endif
     }
     f->funcs = orig;
+    pack_guess_fields();
     printf("[done %d sources]\n",this->nguess);
 
     return true;
 }
+
+
+//*************************************************************************************************************
+
+void GuessData::pack_guess_fields()
+{
+    int nch,k,c;
+
+    guess_basis.resize(0,0);
+    guess_sing_ratio.resize(0);
+    if (nguess <= 0 || !guess_fwd || !guess_fwd[0])
+        return;
+    /*
+     * All guesses must have been computed for the same channels, otherwise stay with the unpacked fields
+     */
+    nch = guess_fwd[0]->nch;
+    for (k = 0; k < nguess; k++)
+        if (!guess_fwd[k] || guess_fwd[k]->nch != nch)
+            return;
+
+    guess_basis.resize(nch,3*nguess);
+    guess_sing_ratio.resize(nguess);
+    for (k = 0; k < nguess; k++) {
+        for (c = 0; c < 3; c++)
+            guess_basis.col(3*k+c) = Map<VectorXf>(guess_fwd[k]->uu[c],nch);
+        guess_sing_ratio[k] = guess_fwd[k]->sing[2]/guess_fwd[k]->sing[0];
+    }
+}
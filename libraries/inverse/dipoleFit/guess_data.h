@@ -144,11 +144,22 @@ public:
     */
     bool compute_guess_fields(DipoleFitData* f);
 
+    //=========================================================================================================
+    /**
+    * Packs the left singular vectors of all guess forward solutions into guess_basis so that the initial guess
+    * search can be done with a single matrix product. The basis is left empty if the guesses differ in the
+    * number of channels.
+    */
+    void pack_guess_fields();
+
 public:
     float          **rr;            /**< These are the guess dipole locations */
     DipoleForward** guess_fwd;      /**< Forward solutions for the guesses */
     int            nguess;          /**< How many sources */
 
+    Eigen::MatrixXf guess_basis;        /**< Left singular vectors of all guesses (nch x 3*nguess), column 3*k+c is guess_fwd[k]->uu[c] */
+    Eigen::VectorXf guess_sing_ratio;   /**< Ratio of the smallest to the largest singular value of each guess */
+
 // ### OLD STRUCT ###
 //    typedef struct {
 //        float          **rr;                    /**< These are the guess dipole locations */
@@ -44,6 +44,14 @@
 #endif
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -127,8 +135,8 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
 
     //Inits
     //Stop the time for benchmark purpose
-    clock_t start, end;
-    start = clock();
+    QElapsedTimer t_timerTotal;
+    t_timerTotal.start();
 
 //    //Map HPCMatrix to Eigen Matrix
 //    Eigen::Map<MatrixXT>
@@ -178,16 +186,13 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
     std::cout << "##### Calculation of PWL RAP MUSIC started ######\n\n";
 
     MatrixXT t_matProj_Phi_s(t_matOrthProj.rows(), t_pMatPhi_s->cols());
-    //new Version: Calculate projection before
-    MatrixXT t_matProj_LeadField(m_ForwardSolution.sol->data.rows(), m_ForwardSolution.sol->data.cols());
+    //Projected lead field and its Gram blocks
+    MatrixXT t_matProjLeadField, t_matZ, t_matDiagGram, t_matDiagCorGram;
 
     for(int r = 0; r < t_iMaxSearch ; ++r)
     {
         t_matProj_Phi_s = t_matOrthProj*(*t_pMatPhi_s);
 
-        //new Version: Calculating Projection before
-        t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
-
         //###First Option###
         //Step 1: lt. Mosher 1998 -> Maybe tmp_Proj_Phi_S is already orthogonal -> so no SVD needed -> U_B = tmp_Proj_Phi_S;
         Eigen::JacobiSVD< MatrixXT > t_svdProj_Phi_S(t_matProj_Phi_s, Eigen::ComputeThinU);
@@ -198,10 +203,11 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
         VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
         t_vecRoh.setZero();
 
-        //subcorr benchmark
-        //Stop the time
-        clock_t start_subcorr, end_subcorr;
-        start_subcorr = clock();
+        QElapsedTimer t_timerSubcorr;
+        t_timerSubcorr.start();
+
+        //Subtract the found sources from the lead field
+        calcProjLeadField(t_matOrthProj, r == 0, t_matU_B, t_matProjLeadField, t_matZ, t_matDiagGram, t_matDiagCorGram);
 
         double t_val_roh_k;
 
@@ -235,16 +241,11 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
                 for(int i = 0; i < t_iNumVecElements; i++)
                 {
                     int k = t_pVecIdxElements(i);
-                    //new Version: calculate matrix multiplication before
-                    //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                    MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
 
                     int idx1 = m_ppPairIdxCombinations[k]->x1;
                     int idx2 = m_ppPairIdxCombinations[k]->x2;
 
-                    RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
-
-                    t_vecRoh(k) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
+                    t_vecRoh(k) = RapMusic::pairCorrelation(t_matProjLeadField, t_matZ, t_matDiagGram, t_matDiagCorGram, idx1, idx2);//t_vecRoh holds the correlations roh_k
                 }
             }
 
@@ -293,11 +294,7 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
             PowellIdxVec(t_iCurrentRow, m_iNumGridPoints, t_pVecIdxElements);
         }
 
-        //subcorr benchmark
-        end_subcorr = clock();
-
-        float t_fSubcorrElapsedTime = ( (float)(end_subcorr-start_subcorr) / (float)CLOCKS_PER_SEC ) * 1000.0f;
-        std::cout << "Time Elapsed: " << t_fSubcorrElapsedTime << " ms" << std::endl;
+        reportTiming("correlation", r, t_timerSubcorr.nsecsElapsed());
 
 
         // (Idx+1) because of MATLAB positions -> starting with 1 not with 0
@@ -341,10 +338,7 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
 
     std::cout << "##### Calculation of PWL RAP MUSIC completed ######"<< std::endl << std::endl << std::endl;
 
-    end = clock();
-
-    float t_fElapsedTime = ( (float)(end-start) / (float)CLOCKS_PER_SEC ) * 1000.0f;
-    std::cout << "Total Time Elapsed: " << t_fElapsedTime << " ms" << std::endl << std::endl;
+    reportTiming("total", -1, t_timerTotal.nsecsElapsed());
 
     //garbage collecting
     delete t_pMatPhi_s;
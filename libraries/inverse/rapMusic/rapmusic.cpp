@@ -46,6 +46,23 @@
 #endif
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -401,9 +418,8 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
     }
 
     //Inits
-    //Stop the time for benchmark purpose
-    clock_t start, end;
-    start = clock();
+    QElapsedTimer t_timerTotal;
+    t_timerTotal.start();
 
 //    //Map HPCMatrix to Eigen Matrix
 //    Eigen::Map<MatrixXT>
@@ -453,16 +469,13 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
     std::cout << "##### Calculation of RAP MUSIC started ######\n\n";
 
     MatrixXT t_matProj_Phi_s(t_matOrthProj.rows(), t_pMatPhi_s->cols());
-    //new Version: Calculate projection before
-    MatrixXT t_matProj_LeadField(m_ForwardSolution.sol->data.rows(), m_ForwardSolution.sol->data.cols());
+    //Projected lead field and its Gram blocks
+    MatrixXT t_matProjLeadField, t_matZ, t_matDiagGram, t_matDiagCorGram;
 
     for(int r = 0; r < t_iMaxSearch ; ++r)
     {
         t_matProj_Phi_s = t_matOrthProj*(*t_pMatPhi_s);
 
-        //new Version: Calculating Projection before
-        t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
-
         //###First Option###
         //Step 1: lt. Mosher 1998 -> Maybe tmp_Proj_Phi_S is already orthogonal -> so no SVD needed -> U_B = tmp_Proj_Phi_S;
         Eigen::JacobiSVD< MatrixXT > t_svdProj_Phi_S(t_matProj_Phi_s, Eigen::ComputeThinU);
@@ -471,35 +484,13 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
 
         //Inits
         VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
-        t_vecRoh.setZero();
-
-        //subcorr benchmark
-        //Stop the time
-        clock_t start_subcorr, end_subcorr;
-        start_subcorr = clock();
-
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
-        {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
 
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
+        QElapsedTimer t_timerSubcorr;
+        t_timerSubcorr.start();
 
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
-        }
+        //Subtract the found sources from the lead field and correlate all pairs from their Gram blocks
+        calcProjLeadField(t_matOrthProj, r == 0, t_matU_B, t_matProjLeadField, t_matZ, t_matDiagGram, t_matDiagCorGram);
+        calcPairCorrelations(t_matProjLeadField, t_matZ, t_matDiagGram, t_matDiagCorGram, t_vecRoh);
 
 
 //         if(r==0)
@@ -518,11 +509,7 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
 //             //exit(0);
 //         }
 
-        //subcorr benchmark
-        end_subcorr = clock();
-
-        float t_fSubcorrElapsedTime = ( (float)(end_subcorr-start_subcorr) / (float)CLOCKS_PER_SEC ) * 1000.0f;
-        std::cout << "Time Elapsed: " << t_fSubcorrElapsedTime << " ms" << std::endl;
+        reportTiming("correlation", r, t_timerSubcorr.nsecsElapsed());
 
         //Find the maximum of correlation - can't put this in the for loop because it's running in different threads.
         double t_val_roh_k;
@@ -576,10 +563,7 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
 
     std::cout << "##### Calculation of RAP MUSIC completed ######"<< std::endl << std::endl << std::endl;
 
-    end = clock();
-
-    float t_fElapsedTime = ( (float)(end-start) / (float)CLOCKS_PER_SEC ) * 1000.0f;
-    std::cout << "Total Time Elapsed: " << t_fElapsedTime << " ms" << std::endl << std::endl;
+    reportTiming("total", -1, t_timerTotal.nsecsElapsed());
 
     //garbage collecting
     delete t_pMatPhi_s;
@@ -751,6 +735,151 @@ double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vecto
 }
 
 
+//*************************************************************************************************************
+
+double RapMusic::subcorrGram(const Matrix6T& p_matGram, const Matrix6T& p_matCorGram)
+{
+    //Step 1: U_A = G*W with G^T*G = V*D*V^T and W = V*D^-1/2
+    //lt. Mosher 1998: Only Retain those Components of U_A that correspond to nonzero singular values
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigGram(p_matGram);
+
+    //The eigenvalues are the squared singular values of the projected lead field pair, so the cut is the one
+    //of getRank: sigma > 10^-5 and at least the largest component is kept
+    Matrix6T t_matW = Matrix6T::Zero();
+    for(int k = 0; k < 6; ++k)
+    {
+        double t_dSigma = std::sqrt(std::max(t_eigGram.eigenvalues()(k), 0.0));
+        if(t_dSigma > 0.00001 || (k == 5 && t_dSigma > 0.0))
+            t_matW.col(k) = t_eigGram.eigenvectors().col(k) / t_dSigma;
+    }
+
+    //Step 2 and 3: the largest singular value of C = U_A^T*U_B is the root of the largest eigenvalue of
+    //C*C^T = W^T*(G^T*U_B*U_B^T*G)*W
+    Matrix6T t_matCC = t_matW.transpose() * p_matCorGram * t_matW;
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigCC(t_matCC, Eigen::EigenvaluesOnly);
+
+    return std::sqrt(std::max(t_eigCC.eigenvalues()(5), 0.0));
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::calcProjLeadField(const MatrixXT& p_matOrthProj,
+                                 bool p_bIsIdentity,
+                                 const MatrixXT& p_matU_B,
+                                 MatrixXT& p_matProjLeadField,
+                                 MatrixXT& p_matZ,
+                                 MatrixXT& p_matDiagGram,
+                                 MatrixXT& p_matDiagCorGram) const
+{
+    if(p_bIsIdentity)
+        p_matProjLeadField = m_ForwardSolution.sol->data;
+    else
+        p_matProjLeadField.noalias() = p_matOrthProj * m_ForwardSolution.sol->data;
+
+    p_matZ.noalias() = p_matProjLeadField.transpose() * p_matU_B;
+
+    p_matDiagGram.resize(3, 3*m_iNumGridPoints);
+    p_matDiagCorGram.resize(3, 3*m_iNumGridPoints);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < m_iNumGridPoints; ++i)
+    {
+        p_matDiagGram.middleCols(3*i, 3).noalias() = p_matProjLeadField.middleCols(3*i, 3).transpose() * p_matProjLeadField.middleCols(3*i, 3);
+        p_matDiagCorGram.middleCols(3*i, 3).noalias() = p_matZ.middleRows(3*i, 3) * p_matZ.middleRows(3*i, 3).transpose();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::calcPairCorrelations(const MatrixXT& p_matProjLeadField,
+                                    const MatrixXT& p_matZ,
+                                    const MatrixXT& p_matDiagGram,
+                                    const MatrixXT& p_matDiagCorGram,
+                                    VectorXT& p_vecRoh) const
+{
+    const int N = m_iNumGridPoints;
+
+    p_vecRoh.resize(m_iNumLeadFieldCombinations);
+
+    for(int i0 = 0; i0 < N; i0 += PAIR_BLOCK_SIZE)
+    {
+        //Gram blocks of this block of grid points with itself and all following grid points
+        int t_iBlock = std::min(PAIR_BLOCK_SIZE, N - i0);
+        int t_iCols = 3*(N - i0);
+
+        MatrixXT t_matGramBlock(3*t_iBlock, t_iCols);
+        t_matGramBlock.noalias() = p_matProjLeadField.middleCols(3*i0, 3*t_iBlock).transpose() * p_matProjLeadField.rightCols(t_iCols);
+        MatrixXT t_matCorGramBlock(3*t_iBlock, t_iCols);
+        t_matCorGramBlock.noalias() = p_matZ.middleRows(3*i0, 3*t_iBlock) * p_matZ.bottomRows(t_iCols).transpose();
+
+        //Multithreading correlation calculation
+        #ifdef _OPENMP
+        #pragma omp parallel for num_threads(m_iMaxNumThreads) schedule(dynamic)
+        #endif
+        for(int ii = 0; ii < t_iBlock; ++ii)
+        {
+            int i = i0 + ii;
+            //Index of the pair (i,i) in the combinations
+            int t_iOffset = i*N - ((i-1)*i)/2;
+
+            Matrix6T t_matGram, t_matCorGram;
+            t_matGram.block<3,3>(0,0) = t_matGramBlock.block<3,3>(3*ii, 3*ii);
+            t_matCorGram.block<3,3>(0,0) = t_matCorGramBlock.block<3,3>(3*ii, 3*ii);
+
+            for(int j = i; j < N; ++j)
+            {
+                t_matGram.block<3,3>(0,3) = t_matGramBlock.block<3,3>(3*ii, 3*(j-i0));
+                t_matGram.block<3,3>(3,0) = t_matGram.block<3,3>(0,3).transpose();
+                t_matGram.block<3,3>(3,3) = p_matDiagGram.block<3,3>(0, 3*j);
+
+                t_matCorGram.block<3,3>(0,3) = t_matCorGramBlock.block<3,3>(3*ii, 3*(j-i0));
+                t_matCorGram.block<3,3>(3,0) = t_matCorGram.block<3,3>(0,3).transpose();
+                t_matCorGram.block<3,3>(3,3) = p_matDiagCorGram.block<3,3>(0, 3*j);
+
+                p_vecRoh(t_iOffset + j - i) = RapMusic::subcorrGram(t_matGram, t_matCorGram);//t_vecRoh holds the correlations roh_k
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+double RapMusic::pairCorrelation(const MatrixXT& p_matProjLeadField,
+                                 const MatrixXT& p_matZ,
+                                 const MatrixXT& p_matDiagGram,
+                                 const MatrixXT& p_matDiagCorGram,
+                                 int p_iIdx1, int p_iIdx2)
+{
+    Matrix6T t_matGram, t_matCorGram;
+
+    t_matGram.block<3,3>(0,0) = p_matDiagGram.block<3,3>(0, 3*p_iIdx1);
+    t_matGram.block<3,3>(0,3) = p_matProjLeadField.middleCols(3*p_iIdx1, 3).transpose() * p_matProjLeadField.middleCols(3*p_iIdx2, 3);
+    t_matGram.block<3,3>(3,0) = t_matGram.block<3,3>(0,3).transpose();
+    t_matGram.block<3,3>(3,3) = p_matDiagGram.block<3,3>(0, 3*p_iIdx2);
+
+    t_matCorGram.block<3,3>(0,0) = p_matDiagCorGram.block<3,3>(0, 3*p_iIdx1);
+    t_matCorGram.block<3,3>(0,3) = p_matZ.middleRows(3*p_iIdx1, 3) * p_matZ.middleRows(3*p_iIdx2, 3).transpose();
+    t_matCorGram.block<3,3>(3,0) = t_matCorGram.block<3,3>(0,3).transpose();
+    t_matCorGram.block<3,3>(3,3) = p_matDiagCorGram.block<3,3>(0, 3*p_iIdx2);
+
+    return RapMusic::subcorrGram(t_matGram, t_matCorGram);
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::reportTiming(const QString& p_sStage, int p_iIteration, qint64 p_iNsecs) const
+{
+    if(m_timingHook)
+        m_timingHook(p_sStage, p_iIteration, p_iNsecs);
+}
+
+
 //*************************************************************************************************************
 
 void RapMusic::calcA_k_1(   const MatrixX6T& p_matG_k_1,
@@ -907,3 +1036,11 @@ void RapMusic::setStcAttr(int p_iSampStcWin, float p_fStcOverlap)
     m_iSamplesStcWindow = p_iSampStcWin;
     m_fStcOverlap = p_fStcOverlap;
 }
+
+
+//*************************************************************************************************************
+
+void RapMusic::setTimingHook(const TimingHook& p_timingHook)
+{
+    m_timingHook = p_timingHook;
+}
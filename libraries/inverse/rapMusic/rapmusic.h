@@ -48,7 +48,9 @@
 #include <mne/mne_forwardsolution.h>
 #include <mne/mne_sourceestimate.h>
 #include <time.h>
+#include <functional>
 
+#include <QString>
 #include <QVector>
 
 
@@ -61,6 +63,7 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 #include <Eigen/LU>
+#include <Eigen/Eigenvalues>
 
 
 //*************************************************************************************************************
@@ -86,6 +89,7 @@ using namespace MNELIB;
 
 #define NOT_TRANSPOSED   0  /**< Defines NOT_TRANSPOSED */
 #define IS_TRANSPOSED   1   /**< Defines IS_TRANSPOSED */
+#define PAIR_BLOCK_SIZE 32  /**< Number of lead field points whose pair correlations are computed as one block */
 
 
 //=============================================================================================================
@@ -129,6 +133,11 @@ public:
                                                                              1> as VectorXT type. */
     typedef Eigen::Matrix<double, 6, 1> Vector6T;                            /**< Defines Eigen::Matrix<T, 6, 1>
                                                                              as Vector6T type. */
+    typedef Eigen::Matrix<double, 3, 3> Matrix3T;                            /**< Defines Eigen::Matrix<T, 3, 3>
+                                                                             as Matrix3T type. */
+
+    typedef std::function<void(const QString& p_sStage, int p_iIteration, qint64 p_iNsecsElapsed)> TimingHook; /**< Receives the
+                                                                             elapsed time of a calculation stage. */
 
 
     //=========================================================================================================
@@ -183,6 +192,16 @@ public:
     */
     void setStcAttr(int p_iSampStcWin, float p_fStcOverlap);
 
+    //=========================================================================================================
+    /**
+    * Sets a hook which receives the elapsed times of the calculation. It is called with the stage
+    * "correlation" and the iteration for every scan over the lead field pairs and with the stage "total"
+    * (iteration -1) once per calculateInverse call. Pass an empty hook to disable the timing.
+    *
+    * @param[in] p_timingHook   The timing hook.
+    */
+    void setTimingHook(const TimingHook& p_timingHook);
+
 protected:
     //=========================================================================================================
     /**
@@ -228,6 +247,83 @@ protected:
     */
     static double subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1);
 
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a lead field pair from its Gram matrices. This gives the same
+    * correlation as subcorr without touching the channel dimension. The eigenvalues of p_matGram are the squared
+    * singular values of the projected pair, so the rank is cut as in getRank.
+    *
+    * @param[in] p_matGram      Gram matrix G^T G of the projected lead field pair (6 x 6).
+    * @param[in] p_matCorGram   Gram matrix G^T U_B U_B^T G of the pair's projections onto U_B (6 x 6).
+    * @return   The maximal correlation c_1 of the subspace correlation.
+    */
+    static double subcorrGram(const Matrix6T& p_matGram, const Matrix6T& p_matCorGram);
+
+    //=========================================================================================================
+    /**
+    * Projects the lead field and prepares the per source Gram blocks for the pair correlation.
+    *
+    * @param[in] p_matOrthProj        The current orthogonal projector.
+    * @param[in] p_bIsIdentity        Whether the projector is still the identity.
+    * @param[in] p_matU_B             The signal subspace of the projected measurement.
+    * @param[out] p_matProjLeadField  The projected lead field (channels x 3*grid points).
+    * @param[out] p_matZ              The projections of the lead field columns onto U_B (3*grid points x rank).
+    * @param[out] p_matDiagGram       The 3 x 3 Gram blocks of the projected lead field of every grid point (3 x 3*grid points).
+    * @param[out] p_matDiagCorGram    The 3 x 3 blocks of p_matZ*p_matZ^T of every grid point (3 x 3*grid points).
+    */
+    void calcProjLeadField(const MatrixXT& p_matOrthProj,
+                           bool p_bIsIdentity,
+                           const MatrixXT& p_matU_B,
+                           MatrixXT& p_matProjLeadField,
+                           MatrixXT& p_matZ,
+                           MatrixXT& p_matDiagGram,
+                           MatrixXT& p_matDiagCorGram) const;
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlations of all lead field pairs. The Gram blocks are computed for blocks of
+    * PAIR_BLOCK_SIZE grid points against all following grid points with one matrix product each.
+    *
+    * @param[in] p_matProjLeadField  The projected lead field.
+    * @param[in] p_matZ              The projections of the lead field columns onto U_B.
+    * @param[in] p_matDiagGram       The Gram blocks of every grid point.
+    * @param[in] p_matDiagCorGram    The correlation Gram blocks of every grid point.
+    * @param[out] p_vecRoh           The correlations in the order of m_ppPairIdxCombinations.
+    */
+    void calcPairCorrelations(const MatrixXT& p_matProjLeadField,
+                              const MatrixXT& p_matZ,
+                              const MatrixXT& p_matDiagGram,
+                              const MatrixXT& p_matDiagCorGram,
+                              VectorXT& p_vecRoh) const;
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a single lead field pair.
+    *
+    * @param[in] p_matProjLeadField  The projected lead field.
+    * @param[in] p_matZ              The projections of the lead field columns onto U_B.
+    * @param[in] p_matDiagGram       The Gram blocks of every grid point.
+    * @param[in] p_matDiagCorGram    The correlation Gram blocks of every grid point.
+    * @param[in] p_iIdx1             first Lead Field index point
+    * @param[in] p_iIdx2             second Lead Field index point
+    * @return   The maximal correlation c_1 of the pair.
+    */
+    static double pairCorrelation(const MatrixXT& p_matProjLeadField,
+                                  const MatrixXT& p_matZ,
+                                  const MatrixXT& p_matDiagGram,
+                                  const MatrixXT& p_matDiagCorGram,
+                                  int p_iIdx1, int p_iIdx2);
+
+    //=========================================================================================================
+    /**
+    * Reports the elapsed time of a calculation stage to the timing hook, if one is set.
+    *
+    * @param[in] p_sStage       The name of the stage.
+    * @param[in] p_iIteration   The iteration, -1 if not applicable.
+    * @param[in] p_iNsecs       The elapsed time in nanoseconds.
+    */
+    void reportTiming(const QString& p_sStage, int p_iIteration, qint64 p_iNsecs) const;
+
     //=========================================================================================================
     /**
     * Calculates the accumulated manifold vectors A_{k1}
@@ -326,6 +422,8 @@ protected:
 
     Pair** m_ppPairIdxCombinations; /**< Index combination vector with grid pair indices. */
 
+    TimingHook m_timingHook;        /**< Receives the elapsed times of the calculation. */
+
     int m_iMaxNumThreads;   /**< Number of available CPU threads. */
 
     bool m_bIsInit; /**< Whether the algorithm is initialized. */
@@ -70,6 +70,9 @@ FilterThreadArg::FilterThreadArg()
 ,limit      (-1)
 ,filtered   (NULL)
 ,stat       (FAIL)
+,bvh        (NULL)
+,tree       (NULL)
+,use_threads(true)
 {
 
 }
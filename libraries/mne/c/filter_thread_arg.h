@@ -48,6 +48,11 @@
 #include "mne_source_space_old.h"
 #include "mne_surface_old.h"
 
+namespace UTILSLIB {
+    class KdTree;
+    class TriangleBvh;
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -107,6 +112,9 @@ public:
     float          limit;           /* Distance limit */
     FILE           *filtered;       /* Log omitted point locations here */
     int            stat;            /* How was it? */
+    const UTILSLIB::TriangleBvh* bvh;   /* Triangle hierarchy of the inner skull (built on demand if NULL) */
+    const UTILSLIB::KdTree*      tree;  /* Vertex tree of the inner skull (built on demand if NULL) */
+    bool           use_threads;     /* Process the points in parallel? */
 
 // ### OLD STRUCT ###
 //typedef struct {
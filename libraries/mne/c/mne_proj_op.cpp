@@ -480,8 +480,29 @@ int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int
     * Assume that all dimension checking etc. has been done before
     */
 {
-    static float *res = NULL;
-    int    res_size   = 0;
+    float *res = NULL;
+    int   result;
+
+    if (!op || op->nitems <= 0 || op->nvec <= 0)
+        return OK;
+    /*
+     * A private result vector keeps this callable from several threads at once
+     */
+    res = MALLOC_23(op->nch,float);
+    result = mne_proj_op_proj_vector(op,vec,nvec,do_complement,res);
+    FREE_23(res);
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int do_complement, float *res)
+/*
+    * Apply projection operator to a vector (floats) using the result workspace res (op->nch floats)
+    * Assume that all dimension checking etc. has been done before
+    */
+{
     float *pvec;
     float  w;
     int k,p;
@@ -494,11 +515,6 @@ int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int
         return FAIL;
     }
 
-    if (op->nch > res_size) {
-        res = REALLOC_23(res,op->nch,float);
-        res_size = op->nch;
-    }
-
     for (k = 0; k < op->nch; k++)
         res[k] = 0.0;
 
@@ -141,6 +141,9 @@ public:
 
     static int mne_proj_op_proj_vector(MneProjOp* op, float *vec, int nvec, int do_complement);
 
+    // Same as above with a caller supplied result workspace of op->nch floats, e.g. private to a thread
+    static int mne_proj_op_proj_vector(MneProjOp* op, float *vec, int nvec, int do_complement, float *res);
+
 
 
     //============================= mne_lin_proj_io.c =============================
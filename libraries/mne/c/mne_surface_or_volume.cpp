@@ -59,6 +59,8 @@
 
 #include <utils/sphere.h>
 #include <utils/ioutils.h>
+#include <utils/kdtree.h>
+#include <utils/trianglebvh.h>
 
 #include <QFile>
 #include <QCoreApplication>
@@ -67,6 +69,9 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
@@ -200,6 +205,12 @@ void mne_free_icmatrix_17 (int **m)
 
 #define NNEIGHBORS 26
 
+#define FILTER_KEEP       0     /* Source point passes the filter */
+#define FILTER_OUTSIDE    1     /* Source point is outside the bounding surface */
+#define FILTER_TOO_CLOSE  2     /* Source point is too close to the bounding surface */
+
+#define FILTER_POINT_CHUNK 256  /* Number of source points classified by one task */
+
 #define CURVATURE_FILE_MAGIC_NUMBER  (16777215)
 
 #define TAG_MGH_XFORM               31
@@ -348,6 +359,7 @@ void mne_sort_nearest_by_nearest(MneNearest* points, int npoint)
 //=============================================================================================================
 
 MneSurfaceOrVolume::MneSurfaceOrVolume()
+: bvh(NULL)
 {
 
 }
@@ -373,6 +385,7 @@ MneSurfaceOrVolume::~MneSurfaceOrVolume()
         FREE_17(this->neighbor_tri);
     }
     FREE_17(this->nneighbor_tri);
+    delete this->bvh;
     FREE_17(this->curv);
 
     if (this->neighbor_vert) {
@@ -454,6 +467,107 @@ double MneSurfaceOrVolume::sum_solids(float *from, MneSurfaceOld* surf)
 }
 
 
+//*************************************************************************************************************
+
+double MneSurfaceOrVolume::sum_solids_bvh(float *from, MneSurfaceOld* surf, const UTILSLIB::TriangleBvh* bvh)
+/*
+     * For a closed surface the total solid angle is 4 pi times the winding number,
+     * which the triangle hierarchy gives by counting ray crossings.
+     * The exact sum is needed only if the point is (almost) on the surface.
+     */
+{
+    int winding;
+
+    if (bvh && bvh->windingNumber(Vector3f(from[X_17],from[Y_17],from[Z_17]),winding))
+        return 4*M_PI*winding;
+    return sum_solids(from,surf);
+}
+
+
+//*************************************************************************************************************
+
+int MneSurfaceOrVolume::mne_surface_is_closed(MneSurfaceOld* s)
+/*
+     * Each directed edge must occur once and its reverse must occur as well
+     */
+{
+    std::vector<qint64> edges;
+    qint64 np = s->np;
+    qint64 a,b;
+    int    k,j;
+
+    if (s->ntri == 0)
+        return FALSE;
+    edges.reserve(3*s->ntri);
+    for (k = 0; k < s->ntri; k++)
+        for (j = 0; j < 3; j++)
+            edges.push_back(s->itris[k][j]*np+s->itris[k][(j+1)%3]);
+    std::sort(edges.begin(),edges.end());
+    if (std::adjacent_find(edges.begin(),edges.end()) != edges.end())
+        return FALSE;
+    for (k = 0; k < (int)edges.size(); k++) {
+        a = edges[k]/np;
+        b = edges[k]%np;
+        if (!std::binary_search(edges.begin(),edges.end(),b*np+a))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+
+//*************************************************************************************************************
+
+void MneSurfaceOrVolume::mne_classify_source_points(MneSourceSpaceOld* s, FiffCoordTransOld* mri_head_t, MneSurfaceOld* surf, const UTILSLIB::TriangleBvh* bvh, const UTILSLIB::KdTree* tree, float limit, int *status, bool use_threads)
+/*
+     * Decide for each point in use whether it is inside the surface and far enough from it.
+     * The points are handled in chunks which are distributed over the cores.
+     */
+{
+    QVector<int> chunks;
+    int k;
+
+    for (k = 0; k < s->np; k += FILTER_POINT_CHUNK)
+        chunks.append(k);
+
+    auto classify_chunk = [&](const int& start) {
+        float r1[3];
+        float mindist;
+        int   end = std::min(start+FILTER_POINT_CHUNK,s->np);
+        int   p1;
+
+        for (p1 = start; p1 < end; p1++) {
+            status[p1] = FILTER_KEEP;
+            if (!s->inuse[p1])
+                continue;
+            VEC_COPY_17(r1,s->rr[p1]);	/* Transform the point to MRI coordinates */
+            if (s->coord_frame == FIFFV_COORD_HEAD)
+                FiffCoordTransOld::fiff_coord_trans_inv(r1,mri_head_t,FIFFV_MOVE);
+            /*
+             * Check that the source is inside the surface
+             */
+            if (std::fabs(sum_solids_bvh(r1,surf,bvh)/(4*M_PI)-1.0) > 1e-5)
+                status[p1] = FILTER_OUTSIDE;
+            else if (limit > 0.0) {
+                /*
+                 * Check the distance limit
+                 */
+                mindist = 1.0;
+                tree->nearest(Vector3f(r1[X_17],r1[Y_17],r1[Z_17]),&mindist);
+                if (mindist < limit)
+                    status[p1] = FILTER_TOO_CLOSE;
+            }
+        }
+    };
+
+    if (use_threads)
+        QtConcurrent::blockingMap(chunks,classify_chunk);
+    else
+        for (k = 0; k < chunks.size(); k++)
+            classify_chunk(chunks[k]);
+    return;
+}
+
+
 //*************************************************************************************************************
 
 int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limit, FiffCoordTransOld* mri_head_t, MneSourceSpaceOld* *spaces, int nspace, FILE *filtered)   /* Provide a list of filtered points here */
@@ -462,12 +576,12 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     */
 {
     MneSourceSpaceOld* s;
-    int k,p1,p2;
+    int k,p1;
     float r1[3];
-    float mindist,dist,diff[3];
-    int   minnode;
     int   omit,omit_outside;
-    double tot_angle;
+    int   *status;
+    UTILSLIB::TriangleBvh* bvh = NULL;
+    UTILSLIB::KdTree* tree = NULL;
 
     if (surf == NULL)
         return OK;
@@ -491,49 +605,34 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     printf(" (will take a few...)\n");
     omit         = 0;
     omit_outside = 0;
+    /*
+     * The ray crossing test needs a closed surface, otherwise the solid angles are summed up
+     */
+    if (mne_surface_is_closed(surf))
+        bvh = mne_make_surface_bvh(surf);
+    if (limit > 0.0)
+        tree = mne_make_surface_vertex_tree(surf);
     for (k = 0; k < nspace; k++) {
         s = spaces[k];
+        status = MALLOC_17(s->np,int);
+        mne_classify_source_points(s,mri_head_t,surf,bvh,tree,limit,status,true);
         for (p1 = 0; p1 < s->np; p1++)
-            if (s->inuse[p1]) {
-                VEC_COPY_17(r1,s->rr[p1]);	/* Transform the point to MRI coordinates */
-                if (s->coord_frame == FIFFV_COORD_HEAD)
-                    FiffCoordTransOld::fiff_coord_trans_inv(r1,mri_head_t,FIFFV_MOVE);
-                /*
-                * Check that the source is inside the inner skull surface
-                */
-                tot_angle = sum_solids(r1,surf)/(4*M_PI);
-                if (std::fabs(tot_angle-1.0) > 1e-5) {
+            if (status[p1] != FILTER_KEEP) {
+                if (status[p1] == FILTER_OUTSIDE)
                     omit_outside++;
-                    s->inuse[p1] = FALSE;
-                    s->nuse--;
-                    if (filtered)
-                        fprintf(filtered,"%10.3f %10.3f %10.3f\n",
-                                1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                }
-                else if (limit > 0.0) {
-                    /*
-                        * Check the distance limit
-                        */
-                    mindist = 1.0;
-                    minnode = 0;
-                    for (p2 = 0; p2 < surf->np; p2++) {
-                        VEC_DIFF_17(r1,surf->rr[p2],diff);
-                        dist = VEC_LEN_17(diff);
-                        if (dist < mindist) {
-                            mindist = dist;
-                            minnode = p2;
-                        }
-                    }
-                    if (mindist < limit) {
-                        omit++;
-                        s->inuse[p1] = FALSE;
-                        s->nuse--;
-                        if (filtered)
-                            fprintf(filtered,"%10.3f %10.3f %10.3f\n",
-                                    1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                    }
+                else
+                    omit++;
+                s->inuse[p1] = FALSE;
+                s->nuse--;
+                if (filtered) {
+                    VEC_COPY_17(r1,s->rr[p1]);
+                    if (s->coord_frame == FIFFV_COORD_HEAD)
+                        FiffCoordTransOld::fiff_coord_trans_inv(r1,mri_head_t,FIFFV_MOVE);
+                    fprintf(filtered,"%10.3f %10.3f %10.3f\n",
+                            1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
                 }
             }
+        FREE_17(status);
     }
     if (omit_outside > 0)
         printf("%d source space points omitted because they are outside the inner skull surface.\n",
@@ -541,6 +640,8 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     if (omit > 0)
         printf("%d source space points omitted because of the %6.1f-mm distance limit.\n",
                omit,1000*limit);
+    delete bvh;
+    delete tree;
     printf("Thank you for waiting.\n");
     return OK;
 }
@@ -670,55 +771,43 @@ void MneSurfaceOrVolume::rearrange_source_space(MneSourceSpaceOld* s)
 void *MneSurfaceOrVolume::filter_source_space(void *arg)
 {
     FilterThreadArg* a = (FilterThreadArg*)arg;
-    int    p1,p2;
-    double tot_angle;
+    int    p1;
     int    omit,omit_outside;
+    int    *status;
     float  r1[3];
-    float  mindist,dist,diff[3];
-    int    minnode;
+    UTILSLIB::TriangleBvh* bvh = NULL;
+    UTILSLIB::KdTree* tree = NULL;
 
     omit         = 0;
     omit_outside = 0;
+    /*
+     * Set up the search structures unless they are shared between the source spaces
+     */
+    if (!a->bvh && mne_surface_is_closed(a->surf))
+        bvh = mne_make_surface_bvh(a->surf);
+    if (!a->tree && a->limit > 0.0)
+        tree = mne_make_surface_vertex_tree(a->surf);
+
+    status = MALLOC_17(a->s->np,int);
+    mne_classify_source_points(a->s,a->mri_head_t,a->surf,
+                               a->bvh ? a->bvh : bvh,
+                               a->tree ? a->tree : tree,
+                               a->limit,status,a->use_threads);
 
     for (p1 = 0; p1 < a->s->np; p1++) {
-        if (a->s->inuse[p1]) {
-            VEC_COPY_17(r1,a->s->rr[p1]);	/* Transform the point to MRI coordinates */
-            if (a->s->coord_frame == FIFFV_COORD_HEAD)
-                FiffCoordTransOld::fiff_coord_trans_inv(r1,a->mri_head_t,FIFFV_MOVE);
-            /*
-           * Check that the source is inside the inner skull surface
-           */
-            tot_angle = sum_solids(r1,a->surf)/(4*M_PI);
-            if (std::fabs(tot_angle-1.0) > 1e-5) {
+        if (status[p1] != FILTER_KEEP) {
+            if (status[p1] == FILTER_OUTSIDE)
                 omit_outside++;
-                a->s->inuse[p1] = FALSE;
-                a->s->nuse--;
-                if (a->filtered)
-                    fprintf(a->filtered,"%10.3f %10.3f %10.3f\n",
-                            1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-            }
-            else if (a->limit > 0.0) {
-                /*
-         * Check the distance limit
-         */
-                mindist = 1.0;
-                minnode = 0;
-                for (p2 = 0; p2 < a->surf->np; p2++) {
-                    VEC_DIFF_17(r1,a->surf->rr[p2],diff);
-                    dist = VEC_LEN_17(diff);
-                    if (dist < mindist) {
-                        mindist = dist;
-                        minnode = p2;
-                    }
-                }
-                if (mindist < a->limit) {
-                    omit++;
-                    a->s->inuse[p1] = FALSE;
-                    a->s->nuse--;
-                    if (a->filtered)
-                        fprintf(a->filtered,"%10.3f %10.3f %10.3f\n",
-                                1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                }
+            else
+                omit++;
+            a->s->inuse[p1] = FALSE;
+            a->s->nuse--;
+            if (a->filtered) {
+                VEC_COPY_17(r1,a->s->rr[p1]);	/* Transform the point to MRI coordinates */
+                if (a->s->coord_frame == FIFFV_COORD_HEAD)
+                    FiffCoordTransOld::fiff_coord_trans_inv(r1,a->mri_head_t,FIFFV_MOVE);
+                fprintf(a->filtered,"%10.3f %10.3f %10.3f\n",
+                        1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
             }
         }
     }
@@ -728,6 +817,9 @@ void *MneSurfaceOrVolume::filter_source_space(void *arg)
     if (omit > 0)
         fprintf(stderr,"%d source space points omitted because of the %6.1f-mm distance limit.\n",
                 omit,1000*a->limit);
+    FREE_17(status);
+    delete bvh;
+    delete tree;
     a->stat = OK;
     return NULL;
 }
@@ -744,6 +836,8 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
     int             k;
     int             nproc = QThread::idealThreadCount();
     FilterThreadArg* a;
+    UTILSLIB::TriangleBvh* bvh = NULL;
+    UTILSLIB::KdTree* tree = NULL;
 
     if (!bemfile)
         return OK;
@@ -766,49 +860,35 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
     if (limit > 0.0)
         fprintf(stderr,"and at least %6.1f mm away",1000*limit);
     fprintf(stderr," (will take a few...)\n");
-    if (nproc < 2 || nspace == 1 || !use_threads) {
-        /*
-        * This is the conventional calculation
-        */
-        for (k = 0; k < nspace; k++) {
-            a = new FilterThreadArg();
-            a->s = spaces[k];
-            a->mri_head_t = mri_head_t;
-            a->surf = surf;
-            a->limit = limit;
-            a->filtered = filtered;
-            filter_source_space(a);
-            if(a)
-                delete a;
-            rearrange_source_space(spaces[k]);
-        }
-    }
-    else {
-        /*
-        * Calculate all (both) source spaces simultaneously
-        */
-        QList<FilterThreadArg*> args;//filterThreadArg *args = MALLOC_17(nspace,filterThreadArg);
-
-        for (k = 0; k < nspace; k++) {
-            a = new FilterThreadArg();
-            a->s = spaces[k];
-            a->mri_head_t = mri_head_t;
-            a->surf = surf;
-            a->limit = limit;
-            a->filtered = filtered;
-            args.append(a);
-        }
-        /*
-        * Ready to start the threads & Wait for them to complete
-        */
-        QtConcurrent::blockingMap(args, filter_source_space);
-
-        for (k = 0; k < nspace; k++) {
-            rearrange_source_space(spaces[k]);
-            if(args[k])
-                delete args[k];
-        }
-    }
+    /*
+    * The search structures are shared by all source spaces
+    */
+    if (mne_surface_is_closed(surf))
+        bvh = mne_make_surface_bvh(surf);
+    else
+        fprintf(stderr,"The inner skull surface is not closed, summing up the solid angles.\n");
+    if (limit > 0.0)
+        tree = mne_make_surface_vertex_tree(surf);
+    /*
+    * The source spaces are processed one after another, the points of each are distributed over the threads
+    */
+    for (k = 0; k < nspace; k++) {
+        a = new FilterThreadArg();
+        a->s = spaces[k];
+        a->mri_head_t = mri_head_t;
+        a->surf = surf;
+        a->limit = limit;
+        a->filtered = filtered;
+        a->bvh = bvh;
+        a->tree = tree;
+        a->use_threads = use_threads && nproc >= 2;
+        filter_source_space(a);
+        if(a)
+            delete a;
+        rearrange_source_space(spaces[k]);
+    }
+    delete bvh;
+    delete tree;
     if(surf)
         delete surf;
     printf("Thank you for waiting.\n\n");
@@ -1559,34 +1639,140 @@ void MneSurfaceOrVolume::mne_project_to_triangle(MneSurfaceOld* s,
 
 //*************************************************************************************************************
 
-void MneSurfaceOrVolume::mne_find_closest_on_surface_approx(MneSurfaceOld* s, float **r, int np, int *nearest, float *dist, int nstep)
+void MneSurfaceOrVolume::mne_find_closest_on_surface_approx(MneSurfaceOld* s, float **r, int np, int *nearest, float *dist)
 /*
       * Find the closest triangle on the surface for each point and the distance to it
-      * This uses the values in nearest as approximations of the closest triangle
+      * The search is exact, the previous results in nearest are not needed any more
+      * and are overwritten
       */
 {
-    MneProjData* p = new MneProjData(s);
-    int k,was;
+    const UTILSLIB::TriangleBvh* bvh = mne_get_surface_bvh(s);
+    int k;
     float mydist;
 
-    fprintf(stderr,"%s for %d points %d steps...",nearest[0] < 0 ? "Closest" : "Approx closest",np,nstep);
+    fprintf(stderr,"Closest for %d points...",np);
 
-    for (k = 0; k < np; k++) {
-        was = nearest[k];
-        decide_search_restriction(s,p,nearest[k],nstep,r[k]);
-        nearest[k] =  mne_project_to_surface(s,p,r[k],0,dist ? dist+k : &mydist);
-        if (nearest[k] < 0) {
-            decide_search_restriction(s,p,-1,nstep,r[k]);
-            nearest[k] =  mne_project_to_surface(s,p,r[k],0,dist ? dist+k : &mydist);
-        }
-    }
+    for (k = 0; k < np; k++)
+        nearest[k] = mne_project_to_surface_bvh(s,bvh,r[k],0,dist ? dist+k : &mydist);
 
     fprintf(stderr,"[done]\n");
-    delete p;
     return;
 }
 
 
+//*************************************************************************************************************
+
+UTILSLIB::TriangleBvh* MneSurfaceOrVolume::mne_make_surface_bvh(MneSurfaceOld* s)
+/*
+      * Set up a bounding volume hierarchy over the triangles of the surface
+      */
+{
+    MatrixX3f rr(s->np,3);
+    MatrixX3i tris(s->ntri,3);
+    int k;
+
+    for (k = 0; k < s->np; k++)
+        rr.row(k) = RowVector3f(s->rr[k][X_17],s->rr[k][Y_17],s->rr[k][Z_17]);
+    for (k = 0; k < s->ntri; k++)
+        tris.row(k) = RowVector3i(s->itris[k][X_17],s->itris[k][Y_17],s->itris[k][Z_17]);
+
+    return new UTILSLIB::TriangleBvh(rr,tris);
+}
+
+
+//*************************************************************************************************************
+
+const UTILSLIB::TriangleBvh* MneSurfaceOrVolume::mne_get_surface_bvh(MneSurfaceOld* s)
+/*
+      * The hierarchy of the surface, set up once and reused by the iterative fits
+      */
+{
+    if (!s->bvh)
+        s->bvh = mne_make_surface_bvh(s);
+    return s->bvh;
+}
+
+
+//*************************************************************************************************************
+
+void MneSurfaceOrVolume::mne_discard_surface_bvh(MneSurfaceOrVolume* s)
+/*
+      * The vertices have moved, the hierarchy is rebuilt on the next use
+      */
+{
+    delete s->bvh;
+    s->bvh = NULL;
+}
+
+
+//*************************************************************************************************************
+
+UTILSLIB::KdTree* MneSurfaceOrVolume::mne_make_surface_vertex_tree(MneSurfaceOld* s)
+/*
+      * Set up a k-d tree over the vertices of the surface
+      */
+{
+    MatrixX3f rr(s->np,3);
+    int k;
+
+    for (k = 0; k < s->np; k++)
+        rr.row(k) = RowVector3f(s->rr[k][X_17],s->rr[k][Y_17],s->rr[k][Z_17]);
+
+    return new UTILSLIB::KdTree(rr);
+}
+
+
+//*************************************************************************************************************
+
+int MneSurfaceOrVolume::mne_project_to_surface_bvh(MneSurfaceOld* s, const UTILSLIB::TriangleBvh* bvh, float *r, int project_it, float *distp)
+/*
+      * Project the point onto the closest point on the surface
+      * This gives the same result as mne_project_to_surface without search restriction
+      * but only examines the triangles close to the point
+      */
+{
+    Vector3f    rr(r[X_17],r[Y_17],r[Z_17]);
+    Vector3f    closest;
+    QVector<int> cand;
+    float dist,edist;
+    float p,q,p0,q0,dist0;
+    int   best;
+    int   k;
+
+    if ((best = bvh->closestTriangle(rr,closest,edist)) < 0) {
+        if (distp)
+            *distp = 0.0;
+        return -1;
+    }
+    /*
+     * The distance reported by nearest_triangle_point is at least half of the euclidean one.
+     * Every triangle which can beat the euclidean closest one is thus within twice its distance.
+     */
+    nearest_triangle_point(r,s,NULL,best,&p0,&q0,&dist0);
+    bvh->trianglesWithin(rr,2.0*std::fabs(dist0)*(1.0+1e-4)+1e-6,cand);
+    /*
+     * Examine the candidates in increasing order to select the same triangle as the full search
+     */
+    p0 = q0 = 0.0;
+    dist0 = 0.0;
+    for (best = -1, k = 0; k < cand.size(); k++) {
+        if (nearest_triangle_point(r,s,NULL,cand[k],&p,&q,&dist)) {
+            if (best < 0 || std::fabs(dist) < std::fabs(dist0)) {
+                dist0 = dist;
+                best = cand[k];
+                p0 = p;
+                q0 = q;
+            }
+        }
+    }
+    if (best >= 0 && project_it)
+        project_to_triangle(s,best,p0,q0,r);
+    if (distp)
+        *distp = dist0;
+    return best;
+}
+
+
 //*************************************************************************************************************
 
 void MneSurfaceOrVolume::decide_search_restriction(MneSurfaceOld* s,
@@ -2083,6 +2269,7 @@ int MneSurfaceOrVolume::mne_transform_source_space(MneSourceSpaceOld* ss, FiffCo
         FiffCoordTransOld::fiff_coord_trans(ss->rr[k],t,FIFFV_MOVE);
         FiffCoordTransOld::fiff_coord_trans(ss->nn[k],t,FIFFV_NO_MOVE);
     }
+    mne_discard_surface_bvh(ss);
     if (ss->tris) {
         for (k = 0; k < ss->ntri; k++)
             FiffCoordTransOld::fiff_coord_trans(ss->tris[k].nn,t,FIFFV_NO_MOVE);
@@ -3118,7 +3305,6 @@ void MneSurfaceOrVolume::calculate_digitizer_distances(FIFFLIB::FiffDigitizerDat
     float             *dist;
     FiffDigPoint      point;
     FiffCoordTransOld*    t = dig->head_mri_t_adj ? dig->head_mri_t_adj : dig->head_mri_t;
-    int               nstep = 4;
 
     if (dig->dist_valid)
         return;
@@ -3154,7 +3340,7 @@ void MneSurfaceOrVolume::calculate_digitizer_distances(FIFFLIB::FiffDigitizerDat
         }
     }
 
-    mne_find_closest_on_surface_approx(head->s,rr,nactive,closest,dist,nstep);
+    mne_find_closest_on_surface_approx(head->s,rr,nactive,closest,dist);
     /*
     * Project the points on the triangles
     */
@@ -3319,6 +3505,7 @@ void MneSurfaceOrVolume::scale_display_surface(MneMshDisplaySurface* surf,
     for (j = 0; j < surf->s->np; j++)
         for (k = 0; k < 3; k++)
             surf->s->rr[j][k] = surf->s->rr[j][k]*scales[k];
+    mne_discard_surface_bvh(surf->s);
     return;
 }
 
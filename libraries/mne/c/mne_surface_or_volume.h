@@ -90,6 +90,11 @@ namespace FIFFLIB {
     class FiffDigitizerData;
 }
 
+namespace UTILSLIB {
+    class KdTree;
+    class TriangleBvh;
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -157,6 +162,18 @@ public:
 
     static double sum_solids(float *from, MneSurfaceOld* surf);
 
+    static double sum_solids_bvh(float *from, MneSurfaceOld* surf, const UTILSLIB::TriangleBvh* bvh);
+
+    static int mne_surface_is_closed(MneSurfaceOld* s);   /* Is each edge shared by exactly two consistently oriented triangles? */
+
+    static void mne_classify_source_points(MneSourceSpaceOld* s,      /* The source space */
+                                           FIFFLIB::FiffCoordTransOld* mri_head_t,
+                                           MneSurfaceOld* surf,        /* The bounding surface */
+                                           const UTILSLIB::TriangleBvh* bvh,  /* Triangle hierarchy of surf (may be NULL) */
+                                           const UTILSLIB::KdTree* tree,      /* Vertex tree of surf (needed if limit > 0) */
+                                           float limit,
+                                           int *status,                /* FILTER_KEEP, FILTER_OUTSIDE or FILTER_TOO_CLOSE for each point in use */
+                                           bool use_threads);
 
     static int mne_filter_source_spaces(MneSurfaceOld* surf,  /* The bounding surface must be provided */
                                         float limit,                                   /* Minimum allowed distance from the surface */
@@ -254,7 +271,21 @@ public:
                                             float      *r,
                                             float      *proj);
 
-    static void mne_find_closest_on_surface_approx(MneSurfaceOld* s, float **r, int np, int *nearest, float *dist, int nstep);
+    static void mne_find_closest_on_surface_approx(MneSurfaceOld* s, float **r, int np, int *nearest, float *dist);
+
+    static UTILSLIB::TriangleBvh* mne_make_surface_bvh(MneSurfaceOld* s);     /* Bounding volume hierarchy of the triangles */
+
+    static const UTILSLIB::TriangleBvh* mne_get_surface_bvh(MneSurfaceOld* s); /* The above, built on first use and kept in s->bvh */
+
+    static void mne_discard_surface_bvh(MneSurfaceOrVolume* s);               /* Call when the vertex locations change */
+
+    static UTILSLIB::KdTree* mne_make_surface_vertex_tree(MneSurfaceOld* s);  /* k-d tree of the vertices */
+
+    static int mne_project_to_surface_bvh(MneSurfaceOld*         s,
+                                          const UTILSLIB::TriangleBvh* bvh,  /* From mne_make_surface_bvh */
+                                          float                  *r,
+                                          int                    project_it,
+                                          float                  *distp);
 
     static void decide_search_restriction(MneSurfaceOld* s,
                           MneProjData*   p,
@@ -478,6 +509,8 @@ public:
     int              **neighbor_tri;    /* Neighboring triangles for each vertex Note: number of entries varies for vertex to vertex */
     int              *nneighbor_tri;    /* Number of neighboring triangles for each vertex */
 
+    UTILSLIB::TriangleBvh* bvh;     /* Bounding volume hierarchy of the triangles, see mne_get_surface_bvh (may be NULL) */
+
     MneNearest*      nearest;   /* Nearest inuse vertex info (number of these is the same as the number vertices) */
     MnePatchInfo*    *patches;  /* Patch information (number of these is the same as the number of points in use) */
     int              npatch;    /* How many (should be same as nuse) */
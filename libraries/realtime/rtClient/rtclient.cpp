@@ -141,10 +141,6 @@ void RtClient::run()
     //
     // Inits
     //
-    MatrixXf t_matRawBuffer;
-
-    fiff_int_t kind;
-
     qint32 from = 0;
     qint32 to = -1;
 
@@ -173,14 +169,10 @@ void RtClient::run()
     t_cmdClient["start"].pValues()[0].setValue(clientId);
     t_cmdClient["start"].send();
 
-    while(m_bIsRunning)
-    {
-
-//        while(m_bIsMeasuring)
-
-
-        t_dataClient.readRawBuffer(m_pFiffInfo->nchan, t_matRawBuffer, kind);
-
+    //
+    // Receive event driven: the buffers are parsed as soon as the data arrive, without waiting for whole tags
+    //
+    t_dataClient.startReceiving(m_pFiffInfo->nchan, 0, 16, [&](const MatrixXf& t_matRawBuffer, fiff_int_t kind) {
         if(kind == FIFF_DATA_BUFFER)
         {
             to += t_matRawBuffer.cols();
@@ -188,13 +180,22 @@ void RtClient::run()
             from += t_matRawBuffer.cols();
 
             emit rawBufferReceived(t_matRawBuffer);
+
+            printf("[done]\n");
         }
-        else if(FIFF_DATA_BUFFER == FIFF_BLOCK_END)
+        else if(kind == FIFF_BLOCK_END)
             m_bIsRunning = false;
+    });
 
-        printf("[done]\n");
+    while(m_bIsRunning)
+    {
+        // readyRead is emitted from within waitForReadyRead, no event loop needed
+        if(!t_dataClient.waitForReadyRead(100) && t_dataClient.state() != QAbstractSocket::ConnectedState)
+            break;
     }
 
+    t_dataClient.stopReceiving();
+
     //
     // Disconnect Stuff
     //
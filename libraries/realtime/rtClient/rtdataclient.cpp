@@ -44,6 +44,22 @@
 #include <fiff/fiff_file.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -52,6 +68,22 @@
 using namespace REALTIMELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+static inline void float_from_big_endian(float* p_pData, qint64 p_iNel)
+{
+    //Swap the raw bits in place, the loop is vectorized by the compiler
+    const uchar* t_pBytes = reinterpret_cast<const uchar*>(p_pData);
+    for(qint64 i = 0; i < p_iNel; ++i) {
+        quint32 t_bits = qFromBigEndian<quint32>(t_pBytes + 4*i);
+        std::memcpy(p_pData + i, &t_bits, sizeof(float));
+    }
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -60,6 +92,17 @@ using namespace REALTIMELIB;
 RtDataClient::RtDataClient(QObject *parent)
 : QTcpSocket(parent)
 , m_clientID(-1)
+, m_iNChannels(0)
+, m_iPoolWrite(0)
+, m_iPoolRead(0)
+, m_iDroppedBuffers(0)
+, m_iHeaderBytes(0)
+, m_iTagKind(0)
+, m_iTagSize(0)
+, m_iTagBytes(0)
+, m_pTagTarget(NULL)
+, m_bTagToPool(false)
+, m_bStopAtTagEnd(false)
 {
     getClientId();
 }
@@ -77,6 +120,11 @@ void RtDataClient::connectToHost(const QString& p_sRtServerHostName)
 
 void RtDataClient::disconnectFromHost()
 {
+    //The connection ends anyway, so a partially received tag is not finished
+    disconnect(m_readyReadConnection);
+    m_readyReadConnection = QMetaObject::Connection();
+    m_iHeaderBytes = 0;
+
     QTcpSocket::disconnectFromHost();
     m_clientID = -1;
 }
@@ -360,25 +408,245 @@ FiffInfo::SPtr RtDataClient::readInfo()
 
 void RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t& kind)
 {
-//        data = [];
-
-    FiffStream t_fiffStream(this);
     //
-    // Find the start
+    // Read the tag header
     //
-    FiffTag::SPtr t_pTag;
+    char t_cHeader[16];
+    if(!waitForBytes(16) || read(t_cHeader, 16) != 16) {
+        kind = 0;
+        return;
+    }
+
+    kind = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(t_cHeader));
+    fiff_int_t t_iType = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(t_cHeader) + 4);
+    fiff_int_t t_iSize = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(t_cHeader) + 8);
+
+    if(t_iSize < 0) {
+        printf("Error in RtDataClient::readRawBuffer: Invalid tag size %d.\n", t_iSize);
+        kind = 0;
+        return;
+    }
+
+    if(!waitForBytes(t_iSize)) {
+        kind = 0;
+        return;
+    }
+
+    if(kind == FIFF_DATA_BUFFER && t_iType == FIFFT_FLOAT && p_nChannels > 0 && t_iSize % (4*p_nChannels) == 0) {
+        //
+        // Read the samples straight into data, it is only reallocated if the buffer size changed
+        //
+        qint32 nSamples = (t_iSize/4)/p_nChannels;
+        if(data.rows() != p_nChannels || data.cols() != nSamples)
+            data.resize(p_nChannels, nSamples);
+
+        read(reinterpret_cast<char*>(data.data()), t_iSize);
+        float_from_big_endian(data.data(), data.size());
+    }
+    else {
+        read(t_iSize);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::startReceiving(qint32 p_nChannels, qint32 p_nSamples, qint32 p_iPoolSize, const RawBufferCallback& p_callback)
+{
+    stopReceiving();
+
+    m_iNChannels = p_nChannels;
+    m_rawBufferCallback = p_callback;
+
+    //One slot stays empty to tell a full from an empty ring
+    m_vecPool.clear();
+    m_vecPoolKinds.clear();
+    if(!m_rawBufferCallback) {
+        m_vecPool.resize(qMax(p_iPoolSize, 1) + 1);
+        m_vecPoolKinds.fill(0, m_vecPool.size());
+    }
+
+    if(p_nSamples > 0) {
+        for(qint32 i = 0; i < m_vecPool.size(); ++i)
+            m_vecPool[i].resize(p_nChannels, p_nSamples);
+        if(m_rawBufferCallback)
+            m_matScratch.resize(p_nChannels, p_nSamples);
+    }
+
+    m_iPoolWrite.storeRelease(0);
+    m_iPoolRead.storeRelease(0);
+    m_iDroppedBuffers.storeRelease(0);
+    m_iHeaderBytes = 0;
+    m_bStopAtTagEnd = false;
+
+    if(m_baSkip.isEmpty())
+        m_baSkip.resize(64*1024);
+
+    m_readyReadConnection = connect(this, &QIODevice::readyRead, this, &RtDataClient::readAvailableTags);
+
+    //Data which arrived before are not announced again
+    readAvailableTags();
+}
 
-    t_fiffStream.read_rt_tag(t_pTag);
 
-    kind = t_pTag->kind;
+//*************************************************************************************************************
+
+void RtDataClient::stopReceiving()
+{
+    if(!m_readyReadConnection)
+        return;
+
+    disconnect(m_readyReadConnection);
+    m_readyReadConnection = QMetaObject::Connection();
+
+    //Finish the partially received tag, the blocking reads continue with the next one
+    m_bStopAtTagEnd = true;
+    while(m_iHeaderBytes > 0 && waitForBytes(1))
+        readAvailableTags();
+    m_bStopAtTagEnd = false;
+    m_iHeaderBytes = 0;
+
+    m_rawBufferCallback = RawBufferCallback();
+}
 
+
+//*************************************************************************************************************
+
+bool RtDataClient::popRawBuffer(MatrixXf& data, fiff_int_t& kind)
+{
+    int t_iRead = m_iPoolRead.loadAcquire();
+    if(t_iRead == m_iPoolWrite.loadAcquire())
+        return false;
+
+    kind = m_vecPoolKinds[t_iRead];
     if(kind == FIFF_DATA_BUFFER)
-    {
-        qint32 nSamples = (t_pTag->size()/4)/p_nChannels;
-        data = MatrixXf(Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples));
+        data.swap(m_vecPool[t_iRead]);
+    m_iPoolRead.storeRelease((t_iRead + 1) % m_vecPool.size());
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::readAvailableTags()
+{
+    qint64 t_iRead;
+
+    while(true) {
+        //
+        // Tag header
+        //
+        if(m_iHeaderBytes < 16) {
+            if(m_iHeaderBytes == 0 && m_bStopAtTagEnd)
+                return;
+
+            t_iRead = read(m_cTagHeader + m_iHeaderBytes, 16 - m_iHeaderBytes);
+            if(t_iRead <= 0)
+                return;
+            m_iHeaderBytes += t_iRead;
+            if(m_iHeaderBytes < 16)
+                return;
+
+            const uchar* t_pHeader = reinterpret_cast<const uchar*>(m_cTagHeader);
+            m_iTagKind = qFromBigEndian<qint32>(t_pHeader);
+            fiff_int_t t_iType = qFromBigEndian<qint32>(t_pHeader + 4);
+            m_iTagSize = qFromBigEndian<qint32>(t_pHeader + 8);
+            m_iTagBytes = 0;
+            m_pTagTarget = NULL;
+            m_bTagToPool = false;
+
+            if(m_iTagSize < 0) {
+                printf("Error in RtDataClient::readAvailableTags: Invalid tag size %d.\n", m_iTagSize);
+                m_iTagSize = 0;
+            }
+
+            if(m_iTagKind == FIFF_DATA_BUFFER && t_iType == FIFFT_FLOAT && m_iNChannels > 0 && m_iTagSize > 0
+                    && m_iTagSize % (4*m_iNChannels) == 0) {
+                if(m_rawBufferCallback) {
+                    m_pTagTarget = &m_matScratch;
+                }
+                else {
+                    int t_iWrite = m_iPoolWrite.loadAcquire();
+                    if((t_iWrite + 1) % m_vecPool.size() != m_iPoolRead.loadAcquire()) {
+                        m_pTagTarget = &m_vecPool[t_iWrite];
+                        m_bTagToPool = true;
+                    }
+                    else {
+                        //Ring is full, the buffer is skipped
+                        m_iDroppedBuffers.ref();
+                    }
+                }
+
+                if(m_pTagTarget) {
+                    qint32 t_nSamples = (m_iTagSize/4)/m_iNChannels;
+                    if(m_pTagTarget->rows() != m_iNChannels || m_pTagTarget->cols() != t_nSamples)
+                        m_pTagTarget->resize(m_iNChannels, t_nSamples);
+                }
+            }
+        }
+
+        //
+        // Tag data, read into the target matrix or skipped
+        //
+        while(m_iTagBytes < m_iTagSize) {
+            if(m_pTagTarget)
+                t_iRead = read(reinterpret_cast<char*>(m_pTagTarget->data()) + m_iTagBytes, m_iTagSize - m_iTagBytes);
+            else
+                t_iRead = read(m_baSkip.data(), qMin<qint64>(m_iTagSize - m_iTagBytes, m_baSkip.size()));
+            if(t_iRead <= 0)
+                return;
+            m_iTagBytes += t_iRead;
+        }
+
+        m_iHeaderBytes = 0;
+
+        if(m_pTagTarget) {
+            float_from_big_endian(m_pTagTarget->data(), m_pTagTarget->size());
+
+            if(m_bTagToPool) {
+                int t_iWrite = m_iPoolWrite.loadAcquire();
+                m_vecPoolKinds[t_iWrite] = FIFF_DATA_BUFFER;
+                m_iPoolWrite.storeRelease((t_iWrite + 1) % m_vecPool.size());
+                emit rawBufferAvailable();
+            }
+            else {
+                m_rawBufferCallback(m_matScratch, FIFF_DATA_BUFFER);
+            }
+            m_pTagTarget = NULL;
+        }
+        else if(m_iTagKind != FIFF_DATA_BUFFER) {
+            //
+            // Other tags are passed on by their kind, e.g. FIFF_BLOCK_END at the end of the measurement
+            //
+            if(m_rawBufferCallback) {
+                m_rawBufferCallback(MatrixXf(), m_iTagKind);
+            }
+            else {
+                int t_iWrite = m_iPoolWrite.loadAcquire();
+                if((t_iWrite + 1) % m_vecPool.size() != m_iPoolRead.loadAcquire()) {
+                    m_vecPoolKinds[t_iWrite] = m_iTagKind;
+                    m_iPoolWrite.storeRelease((t_iWrite + 1) % m_vecPool.size());
+                    emit rawBufferAvailable();
+                }
+                else {
+                    m_iDroppedBuffers.ref();
+                }
+            }
+        }
     }
-//        else
-//            data = tag.data;
+}
+
+
+//*************************************************************************************************************
+
+bool RtDataClient::waitForBytes(qint64 p_iBytes)
+{
+    //Sleep until data arrive, give up when the connection is lost
+    while(bytesAvailable() < p_iBytes)
+        if(!waitForReadyRead(100) && state() != QAbstractSocket::ConnectedState)
+            return false;
+    return true;
 }
 
 
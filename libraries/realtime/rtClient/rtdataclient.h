@@ -64,6 +64,17 @@
 #include <QSharedPointer>
 #include <QString>
 #include <QTcpSocket>
+#include <QVector>
+#include <QByteArray>
+#include <QAtomicInt>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
 
 
 //*************************************************************************************************************
@@ -87,6 +98,11 @@ using namespace FIFFLIB;
 /**
 * The real-time data client class provides an interface to communicate with the data port 4218 of a running mne_rt_server.
 *
+* Raw buffers can be read blocking with readRawBuffer or received event driven (see startReceiving): the tags are
+* then parsed incrementally whenever data arrive and the raw buffers are read straight from the socket into a pool
+* of matrices, from where they are taken with popRawBuffer or handed to a callback. The kinds of all other tags are
+* passed on in the same way, so the consumer sees the end of the measurement (FIFF_BLOCK_END).
+*
 * @brief Real-time data client
 */
 class REALTIMESHARED_EXPORT RtDataClient : public QTcpSocket
@@ -96,6 +112,8 @@ public:
     typedef QSharedPointer<RtDataClient> SPtr;               /**< Shared pointer type for RtDataClient. */
     typedef QSharedPointer<const RtDataClient> ConstSPtr;    /**< Const shared pointer type for RtDataClient. */
 
+    typedef std::function<void(const MatrixXf&, fiff_int_t)> RawBufferCallback;  /**< Receives the kind of each tag and for FIFF_DATA_BUFFER the raw buffer (channels x samples), valid only during the call. The matrix is empty for all other tags. */
+
     //=========================================================================================================
     /**
     * Creates the real-time data client.
@@ -141,11 +159,59 @@ public:
     * Reads fiff measurement information of a data the connection
     *
     * @param[in] p_nChannels    Number of channels to reshape the received data
-    * @param[out] data          The read data - ToDo change this to raw buffer data object
+    * @param[out] data          The read data - ToDo change this to raw buffer data object. The matrix is only
+    *                           reallocated if the buffer size changed.
     * @param[out] kind          Data kind
     */
     void readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t& kind);
 
+    //=========================================================================================================
+    /**
+    * Switches to the event driven mode: received raw buffers are parsed as soon as the data arrive and stored
+    * in a pool of preallocated matrices, the other tags are stored by their kind. If a callback is given, each
+    * tag is handed to it in the thread of the client instead. The tags are parsed on readyRead, which requires
+    * an event loop in the thread of the client or a loop calling waitForReadyRead. Read the measurement info
+    * before, the blocking read functions must not be used while receiving.
+    *
+    * @param[in] p_nChannels    Number of channels of the raw buffers
+    * @param[in] p_nSamples     Number of samples per buffer to preallocate the pool with (optional, otherwise allocated with the first buffers)
+    * @param[in] p_iPoolSize    Number of tags the pool holds until tags are dropped
+    * @param[in] p_callback     Receives the tags instead of the pool (optional)
+    */
+    void startReceiving(qint32 p_nChannels,
+                        qint32 p_nSamples = 0,
+                        qint32 p_iPoolSize = 16,
+                        const RawBufferCallback& p_callback = RawBufferCallback());
+
+    //=========================================================================================================
+    /**
+    * Leaves the event driven mode. A tag which is partially received is read to its end first, so the blocking
+    * read functions can continue on a tag boundary.
+    */
+    void stopReceiving();
+
+    //=========================================================================================================
+    /**
+    * Takes the oldest received tag from the pool. Lock free, may be called from another thread (one
+    * consumer). A raw buffer is swapped into data, data's previous storage goes back to the pool, so no
+    * allocation takes place as long as the buffer size does not change. For all other tags data is left
+    * untouched.
+    *
+    * @param[out] data      The raw buffer (channels x samples), if kind is FIFF_DATA_BUFFER
+    * @param[out] kind      Kind of the tag
+    *
+    * @return true if a tag was available, false otherwise
+    */
+    bool popRawBuffer(MatrixXf& data, fiff_int_t& kind);
+
+    //=========================================================================================================
+    /**
+    * Number of raw buffers and other tags dropped because the pool was full. May be called from another thread.
+    *
+    * @return the number of dropped tags
+    */
+    inline qint64 droppedBuffers() const;
+
     //=========================================================================================================
     /**
     * Sets the alias of the data client
@@ -155,14 +221,65 @@ public:
     void setClientAlias(const QString &p_sAlias);
 
 private:
+    //=========================================================================================================
+    /**
+    * Parses the received data tag by tag, called on readyRead in the event driven mode.
+    */
+    void readAvailableTags();
+
+    //=========================================================================================================
+    /**
+    * Blocks until p_iBytes bytes are available.
+    *
+    * @return true if the bytes are available, false if the connection was lost
+    */
+    bool waitForBytes(qint64 p_iBytes);
+
     qint32 m_clientID;  /**< Corresponding client id of the data client at mne_rt_server */
 
+    QMetaObject::Connection m_readyReadConnection;  /**< readyRead connection of the event driven mode */
+    RawBufferCallback m_rawBufferCallback;          /**< Receives the buffers instead of the pool, if set */
+    qint32 m_iNChannels;                            /**< Number of channels of the raw buffers */
+
+    QVector<MatrixXf> m_vecPool;        /**< Ring of received raw buffers */
+    QVector<fiff_int_t> m_vecPoolKinds; /**< Tag kinds of the ring entries, only FIFF_DATA_BUFFER entries hold a buffer */
+    QAtomicInt m_iPoolWrite;            /**< Number of buffers written to the ring (producer) */
+    QAtomicInt m_iPoolRead;             /**< Number of buffers taken from the ring (consumer) */
+    MatrixXf m_matScratch;              /**< Receives the buffers handed to the callback */
+    QAtomicInt m_iDroppedBuffers;       /**< Tags dropped because the ring was full */
+
+    char m_cTagHeader[16];              /**< Big endian header of the tag being received */
+    qint32 m_iHeaderBytes;              /**< Received bytes of the header */
+    fiff_int_t m_iTagKind;              /**< Kind of the tag being received */
+    fiff_int_t m_iTagSize;              /**< Data size of the tag being received */
+    qint64 m_iTagBytes;                 /**< Received data bytes of the tag */
+    MatrixXf* m_pTagTarget;             /**< Matrix receiving the data, NULL if the tag is skipped */
+    bool m_bTagToPool;                  /**< Whether the target is the next ring slot */
+    bool m_bStopAtTagEnd;               /**< Return after the current tag, see stopReceiving */
+    QByteArray m_baSkip;                /**< Scratch for skipped tag data */
+
 signals:
-    
+    //=========================================================================================================
+    /**
+    * Emitted in the event driven mode whenever a raw buffer or another tag was added to the pool.
+    */
+    void rawBufferAvailable();
+
 public slots:
     
 };
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint64 RtDataClient::droppedBuffers() const
+{
+    return m_iDroppedBuffers.loadAcquire();
+}
+
 } // NAMESPACE
 
 #endif // RTDATACLIENT_H
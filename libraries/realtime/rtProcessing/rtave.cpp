@@ -285,8 +285,6 @@ bool RtAve::stop()
 
     m_pRawMatrixBuffer->releaseFromPop();
 
-    m_pRawMatrixBuffer->clear();
-
     return true;
 }
 
@@ -298,6 +296,8 @@ void RtAve::run()
     //Do initial reset
     reset();
 
+    MatrixXd rawSegment;
+
     //Enter the main loop
     while(m_bIsRunning) {
         //Wait for first data block to arrive
@@ -310,7 +310,8 @@ void RtAve::run()
             //time.start();
 
             //Acquire Data m_pRawMatrixBuffer is thread safe
-            MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
+            if(!m_pRawMatrixBuffer->pop(rawSegment))
+                continue;
 
             //QMutexLocker locker(&m_qMutex);
             doAveraging(rawSegment);
@@ -318,6 +319,10 @@ void RtAve::run()
             //qDebug()<<"RtAve::run() - time.elapsed()"<<time.elapsed();
         }
     }
+
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer)
+        m_pRawMatrixBuffer->clear();
 }
 
 
@@ -94,8 +94,11 @@ void RtCov::append(const MatrixXd &p_DataSegment)
 {
 //    if(m_pRawMatrixBuffer) // ToDo handle change buffersize
 
-    if(!m_pRawMatrixBuffer)
+    if(!m_pRawMatrixBuffer) {
+        QMutexLocker locker(&mutex);
         m_pRawMatrixBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(32, p_DataSegment.rows(), p_DataSegment.cols()));
+        m_waitCondition.wakeAll();
+    }
 
     m_pRawMatrixBuffer->push(&p_DataSegment);
 }
@@ -117,7 +120,10 @@ bool RtCov::start()
     if(this->isRunning())
         QThread::wait();
 
+    mutex.lock();
     m_bIsRunning = true;
+    mutex.unlock();
+
     QThread::start();
 
     return true;
@@ -128,11 +134,20 @@ bool RtCov::start()
 
 bool RtCov::stop()
 {
+    mutex.lock();
     m_bIsRunning = false;
+    m_waitCondition.wakeAll();
+    mutex.unlock();
 
-    m_pRawMatrixBuffer->releaseFromPop();
+    //Release the worker from beginPop and join it before the buffer is cleared beneath it. A release only
+    //cancels a wait which has begun, so it is repeated until the worker has returned.
+    do {
+        if(m_pRawMatrixBuffer)
+            m_pRawMatrixBuffer->releaseFromPop();
+    } while(!QThread::wait(10));
 
-    m_pRawMatrixBuffer->clear();
+    if(m_pRawMatrixBuffer)
+        m_pRawMatrixBuffer->clear();
 
     return true;
 }
@@ -156,24 +171,39 @@ void RtCov::run()
     FiffCov::SPtr cov(new FiffCov());
     VectorXd mu;
 
+    //Sleep until the first data arrived, the buffer is created on demand
+    mutex.lock();
+    while(m_bIsRunning && !m_pRawMatrixBuffer)
+        m_waitCondition.wait(&mutex);
+    mutex.unlock();
+
     while(m_bIsRunning)
     {
         if(m_pRawMatrixBuffer)
         {
-            MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
+            //Borrow the block from the buffer, the statistics are accumulated without copying it
+            Map<const MatrixXd> rawSegment = m_pRawMatrixBuffer->beginPop();
+
+            //A released pop returns the zero block, which must not enter the statistics
+            if(m_pRawMatrixBuffer->poppedZeroBlock()) {
+                m_pRawMatrixBuffer->endPop();
+                continue;
+            }
 
             if(n_samples == 0)
             {
                 mu = rawSegment.rowwise().sum();
-                cov->data = rawSegment * rawSegment.transpose();
+                cov->data.noalias() = rawSegment * rawSegment.transpose();
             }
             else
             {
                 mu.array() += rawSegment.rowwise().sum().array();
-                cov->data += rawSegment * rawSegment.transpose();
+                cov->data.noalias() += rawSegment * rawSegment.transpose();
             }
             n_samples += rawSegment.cols();
 
+            m_pRawMatrixBuffer->endPop();
+
             if(n_samples > m_iMaxSamples)
             {
                 mu /= (float)n_samples;
@@ -68,6 +68,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QSharedPointer>
 
 
@@ -187,6 +188,7 @@ protected:
 
 private:
     QMutex      mutex;                  /**< Provides access serialization between threads*/
+    QWaitCondition m_waitCondition;     /**< Wakes up the worker when the first data arrived or the estimation is stopped.*/
 
     quint32      m_iMaxSamples;         /**< Maximal amount of samples received, before covariance is estimated.*/
 
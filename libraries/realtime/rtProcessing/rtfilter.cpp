@@ -52,26 +52,14 @@ using namespace UTILSLIB;
 using namespace FIFFLIB;
 
 
-//*************************************************************************************************************
-//=============================================================================================================
-// DEFINE GLOBAL METHODS
-//=============================================================================================================
-
-void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &channelDataTime)
-{
-    for(int i = 0; i < channelDataTime.first.size(); ++i) {
-        //channelDataTime.second.second = channelDataTime.first.at(i).applyConvFilter(channelDataTime.second.second, true, FilterData::ZeroPad);
-        channelDataTime.second.second = channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, true, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
-    }
-}
-
-
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
 RtFilter::RtFilter()
+: m_iMaxFilterLength(-1)
+, m_iNumChannels(-1)
 {
 }
 
@@ -87,68 +75,52 @@ RtFilter::~RtFilter()
 
 MatrixXd RtFilter::filterChannelsConcurrently(const MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
 {
-    //Initialise the overlay matrix
-    if(m_matOverlap.cols() != iMaxFilterLength || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matOverlap.resize(matDataIn.rows(), iMaxFilterLength);
-        m_matOverlap.setZero();
-    }
+    MatrixXd matDataOut = matDataIn;
+    filterChannels(matDataOut, iMaxFilterLength, lFilterChannelList, lFilterData);
 
-    if(m_matDelay.cols() != iMaxFilterLength/2 || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matDelay.resize(matDataIn.rows(), iMaxFilterLength/2);
-        m_matDelay.setZero();
-    }
+    return matDataOut;
+}
 
-    //Resize output matrix to match input matrix
-    MatrixXd matDataOut(matDataIn.rows(), matDataIn.cols());
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
-    QList<int> notFilterChannelIndex;
+//*************************************************************************************************************
 
-    //Only select channels specified in lFilterChannelList
-    for(qint32 i = 0; i < matDataIn.rows(); ++i) {
-        int pos = lFilterChannelList.indexOf(i);
-        if(pos != -1 && pos < matDataIn.rows()) {
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(lFilterData,QPair<int,RowVectorXd>(pos,matDataIn.row(pos))));
-        } else {
-            notFilterChannelIndex.append(i);
+void RtFilter::filterChannels(MatrixXd& matData, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
+{
+    if(!isSetUpFor(matData.rows(), iMaxFilterLength, lFilterChannelList, lFilterData)) {
+        m_multiChannelFilter.setFilters(lFilterData, lFilterChannelList, matData.rows(), matData.cols());
+
+        m_lFilterCoeffs.clear();
+        m_lFilterSOS.clear();
+        for(int i = 0; i < lFilterData.size(); ++i) {
+            m_lFilterCoeffs.append(lFilterData.at(i).m_dCoeffA);
+            m_lFilterSOS.append(lFilterData.at(i).m_matSOS);
         }
+        m_lFilterChannelList = lFilterChannelList;
+        m_iMaxFilterLength = iMaxFilterLength;
+        m_iNumChannels = matData.rows();
     }
 
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
-
-        future.waitForFinished();
-
-        //Do the overlap add method and store in matDataOut
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
-
-        for(int r = 0; r < timeData.size(); r++) {
-            //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-            RowVectorXd tempData = timeData.at(r).second.second;
+    m_multiChannelFilter.filter(matData);
+}
 
-            //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-            tempData.head(iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
 
-            //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-            int start = 0;
-            matDataOut.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-iMaxFilterLength) = tempData.head(iFilteredNumberCols-iMaxFilterLength);
+//*************************************************************************************************************
 
-            //Refresh the m_matOverlap with the new calculated filtered data.
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(iMaxFilterLength);
-        }
+bool RtFilter::isSetUpFor(int iNumChannels, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData) const
+{
+    if(iNumChannels != m_iNumChannels || iMaxFilterLength != m_iMaxFilterLength || lFilterData.size() != m_lFilterCoeffs.size() || lFilterChannelList != m_lFilterChannelList) {
+        return false;
     }
 
-    //Fill filtered data with raw data if the channel was not filtered
-    for(int i = 0; i < notFilterChannelIndex.size(); ++i) {
-        matDataOut.row(notFilterChannelIndex.at(i)) << m_matDelay.row(notFilterChannelIndex.at(i)), matDataIn.row(notFilterChannelIndex.at(i)).head(matDataIn.cols() - iMaxFilterLength/2);
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        if(lFilterData.at(i).m_dCoeffA.cols() != m_lFilterCoeffs.at(i).cols() || lFilterData.at(i).m_dCoeffA != m_lFilterCoeffs.at(i)) {
+            return false;
+        }
 
-        //matDataOut.row(notFilterChannelIndex.at(i)).segment(0, matDataIn.row(notFilterChannelIndex.at(i)).cols()) = matDataIn.row(notFilterChannelIndex.at(i));
+        if(lFilterData.at(i).m_matSOS.rows() != m_lFilterSOS.at(i).rows() || lFilterData.at(i).m_matSOS != m_lFilterSOS.at(i)) {
+            return false;
+        }
     }
 
-    m_matDelay = matDataIn.block(0, matDataIn.cols()-iMaxFilterLength/2, matDataIn.rows(), iMaxFilterLength/2);
-
-    return matDataOut;
+    return true;
 }
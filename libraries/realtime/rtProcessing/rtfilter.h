@@ -41,6 +41,7 @@
 //=============================================================================================================
 
 #include "../realtime_global.h"
+#include "rtmultichannelfilter.h"
 
 #include <utils/filterTools/filterdata.h>
 #include <fiff/fiff_info.h>
@@ -52,8 +53,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
-#include <QtConcurrent/QtConcurrent>
-#include <QFuture>
+#include <QList>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -62,7 +63,6 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
-#include <unsupported/Eigen/FFT>
 
 
 //*************************************************************************************************************
@@ -107,17 +107,57 @@ public:
 
     //=========================================================================================================
     /**
-    * Calculates the filtered version of the raw input data
+    * Calculates the filtered version of the raw input data. The data is filtered block by block with an
+    * overlap-save filter whose state is carried over between calls. IIR filters (Butterworth, Chebyshev) are
+    * applied as streaming second-order sections instead. Channels which are not filtered are delayed by half the
+    * combined FIR filter length to stay aligned with the filtered ones. The filter is only set up again if the
+    * filters, the channel selection or the number of channels change.
     *
-    * @param [in] matDataIn     data which is to be filtered
-    * @param [out] matDataOut    data which is to be filtered
-    * @param [in] iDataIndex    current position in the global data matrix
+    * In contrast to the former per-channel filtering, iMaxFilterLength does not determine the overlap and the
+    * delay anymore, both follow from the combined FIR filter length. A change of iMaxFilterLength only sets the
+    * filter up again. lFilterChannelList holds the indices of the rows to filter, in any order. Formerly row i
+    * was only filtered correctly if it was stored at position i of the list.
+    *
+    * @param [in] matDataIn             data which is to be filtered
+    * @param [in] iMaxFilterLength      the maximum filter length of the filters in lFilterData, not used for the filtering
+    * @param [in] lFilterChannelList    the indices of the rows which are to be filtered
+    * @param [in] lFilterData           the filters which are applied one after another
+    *
+    * @return the filtered data
     */
     Eigen::MatrixXd filterChannelsConcurrently(const Eigen::MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
 
+    //=========================================================================================================
+    /**
+    * Filters the data in place. See filterChannelsConcurrently.
+    *
+    * @param [in, out] matData          data which is to be filtered
+    * @param [in] iMaxFilterLength      the maximum filter length of the filters in lFilterData, not used for the filtering
+    * @param [in] lFilterChannelList    the indices of the rows which are to be filtered
+    * @param [in] lFilterData           the filters which are applied one after another
+    */
+    void filterChannels(Eigen::MatrixXd& matData, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
+
 protected:
-    Eigen::MatrixXd                 m_matOverlap;                   /**< Last overlap block */
-    Eigen::MatrixXd                 m_matDelay;                     /**< Last delay block */
+    //=========================================================================================================
+    /**
+    * Checks whether the overlap-save filter was set up for the given filters and channels.
+    *
+    * @param [in] iNumChannels          the number of rows of the data
+    * @param [in] iMaxFilterLength      the maximum filter length of the filters in lFilterData
+    * @param [in] lFilterChannelList    the rows which are to be filtered
+    * @param [in] lFilterData           the filters which are applied one after another
+    *
+    * @return true if the current setup can be reused
+    */
+    bool isSetUpFor(int iNumChannels, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData) const;
+
+    RtMultiChannelFilter            m_multiChannelFilter;           /**< The overlap-save filter carrying the state between blocks. */
+    QList<Eigen::RowVectorXd>       m_lFilterCoeffs;                /**< Coefficients of the filters m_multiChannelFilter was set up for. */
+    QList<Eigen::MatrixXd>          m_lFilterSOS;                   /**< IIR sections of the filters m_multiChannelFilter was set up for. */
+    QVector<int>                    m_lFilterChannelList;           /**< Rows m_multiChannelFilter was set up for. */
+    int                             m_iMaxFilterLength;             /**< Maximum filter length m_multiChannelFilter was set up for. */
+    int                             m_iNumChannels;                 /**< Number of rows m_multiChannelFilter was set up for. */
 
 private:
 
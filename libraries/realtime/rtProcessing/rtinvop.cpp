@@ -50,6 +50,14 @@
 #include <QDebug>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -66,8 +74,11 @@ using namespace REALTIMELIB;
 RtInvOp::RtInvOp(FiffInfo::SPtr &p_pFiffInfo, MNEForwardSolution::SPtr &p_pFwd, QObject *parent)
 : QThread(parent)
 , m_bIsRunning(false)
+, m_queueNoiseCov(1)
 , m_pFiffInfo(p_pFiffInfo)
 , m_pFwd(p_pFwd)
+, m_iNumUpdates(0)
+, m_iNumComputations(0)
 {
     qRegisterMetaType<MNEInverseOperator::SPtr>("MNEInverseOperator::SPtr");
 }
@@ -85,13 +96,30 @@ RtInvOp::~RtInvOp()
 
 void RtInvOp::appendNoiseCov(FiffCov &p_noiseCov)
 {
-    mutex.lock();
-    //Use here a circular buffer
-    m_vecNoiseCov.push_back(p_noiseCov);
+    if(m_queueNoiseCov.push(p_noiseCov) > 0)
+        qDebug() << "RtInvOp::appendNoiseCov - Dropped stale noise covariance.";
+}
 
-    qDebug() << "RtInvOp m_vecNoiseCov" << m_vecNoiseCov.size();
 
+//*************************************************************************************************************
+
+bool RtInvOp::start()
+{
+    //Wait for a still stopping thread before restarting it
+    if(QThread::isRunning())
+        QThread::wait();
+
+    m_queueNoiseCov.clear();
+
+    mutex.lock();
+    m_bIsRunning = true;
+    m_iNumUpdates = 0;
+    m_iNumComputations = 0;
     mutex.unlock();
+
+    QThread::start();
+
+    return true;
 }
 
 
@@ -99,32 +127,179 @@ void RtInvOp::appendNoiseCov(FiffCov &p_noiseCov)
 
 bool RtInvOp::stop()
 {
+    mutex.lock();
     m_bIsRunning = false;
+    mutex.unlock();
+
+    //Wake up the worker if it is waiting for a noise covariance
+    m_queueNoiseCov.releaseFromPop();
     QThread::wait();
 
     return true;
 }
 
 
+//*************************************************************************************************************
+
+int RtInvOp::getNumUpdates()
+{
+    QMutexLocker locker(&mutex);
+    return m_iNumUpdates;
+}
+
+
+//*************************************************************************************************************
+
+int RtInvOp::getNumComputations()
+{
+    QMutexLocker locker(&mutex);
+    return m_iNumComputations;
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator::SPtr RtInvOp::computeInverseOperator(const MNEForwardSolution &p_forward, const FiffCov &p_noiseCov)
+{
+    MNEInverseOperator::SPtr t_pInvOp(new MNEInverseOperator(*m_pFiffInfo.data(), p_forward, p_noiseCov, 0.2f, 0.8f));
+    //The inverse operator is shared with the receivers once emitted, only read it through a const reference
+    const MNEInverseOperator& t_invOp = *t_pInvOp.data();
+
+    m_pInvOpCached.reset();
+    m_matGainCov.resize(0,0);
+    m_qListChNames.clear();
+
+    //The updates only hold if the inverse operator was computed with the lead field of the forward solution
+    if(!t_invOp.source_cov || t_invOp.isFixedOrient() != p_forward.isFixedOrient())
+        return t_pInvOp;
+
+    FiffInfo t_gainInfo;
+    MatrixXd t_matGain;
+    MatrixXd t_matWhitener;
+    FiffCov t_noiseCov;
+    qint32 t_iNumNonZero;
+    p_forward.prepare_forward(*m_pFiffInfo.data(), p_noiseCov, false, t_gainInfo, t_matGain, t_noiseCov, t_matWhitener, t_iNumNonZero);
+
+    if(t_matGain.cols() != t_invOp.source_cov->data.rows())
+        return t_pInvOp;
+
+    //G*R*G' does not depend on the noise covariance
+    MatrixXd t_matGainWeighted = t_matGain * t_invOp.source_cov->data.col(0).asDiagonal();
+    m_matGainCov.noalias() = t_matGainWeighted * t_matGain.transpose();
+
+    m_pInvOpCached = t_pInvOp;
+    m_qListChNames = t_gainInfo.ch_names;
+
+    return t_pInvOp;
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator::SPtr RtInvOp::updateInverseOperator(const MNEForwardSolution &p_forward, const FiffCov &p_noiseCov)
+{
+    if(!m_pInvOpCached)
+        return MNEInverseOperator::SPtr();
+
+    const MNEInverseOperator& t_invOpCached = *m_pInvOpCached.data();
+
+    FiffInfo t_gainInfo;
+    MatrixXd t_matGain;
+    MatrixXd t_matWhitener;
+    FiffCov t_noiseCov;
+    qint32 t_iNumNonZero;
+    p_forward.prepare_forward(*m_pFiffInfo.data(), p_noiseCov, false, t_gainInfo, t_matGain, t_noiseCov, t_matWhitener, t_iNumNonZero);
+
+    if(t_gainInfo.ch_names != m_qListChNames || t_iNumNonZero <= 0)
+        return MNEInverseOperator::SPtr();
+
+    //
+    // The whitened and weighted lead field is A = sqrt(s)*W*G*sqrt(R), its left singular vectors and singular
+    // values follow from the eigendecomposition of A*A' = s*W*(G*R*G')*W'
+    //
+    MatrixXd t_matWGain = t_matWhitener * m_matGainCov;
+    MatrixXd t_matGram;
+    t_matGram.noalias() = t_matWGain * t_matWhitener.transpose();
+
+    //Scale the source covariance such that trace(A*A') equals the number of non-zero noise components
+    double t_dScaling = (double)t_iNumNonZero / t_matGram.trace();
+    t_matGram *= t_dScaling;
+
+    SelfAdjointEigenSolver<MatrixXd> t_eigenSolver(t_matGram);
+
+    //Sort descending as the SVD does
+    VectorXd t_vecSing = t_eigenSolver.eigenvalues().reverse().cwiseMax(0.0).cwiseSqrt();
+    MatrixXd t_matU = t_eigenSolver.eigenvectors().rowwise().reverse();
+
+    //The right singular vectors are V = A'*U*diag(1/sing), components without signal are left zero
+    VectorXd t_vecSingInv = VectorXd::Zero(t_vecSing.size());
+    for(qint32 i = 0; i < t_vecSing.size(); ++i)
+        if(t_vecSing[i] > t_vecSing[0] * 1e-12)
+            t_vecSingInv[i] = 1.0 / t_vecSing[i];
+
+    VectorXd t_vecSourceStd = (t_dScaling * t_invOpCached.source_cov->data.col(0)).cwiseSqrt();
+
+    MatrixXd t_matWU = t_matWhitener.transpose() * t_matU * t_vecSingInv.asDiagonal();
+    MatrixXd t_matV;
+    t_matV.noalias() = t_matGain.transpose() * t_matWU;
+    t_matV = t_vecSourceStd.asDiagonal() * t_matV;
+
+    MNEInverseOperator::SPtr t_pInvOp(new MNEInverseOperator(t_invOpCached));
+
+    t_pInvOp->eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_matU.cols(),
+                                                                        t_matU.rows(),
+                                                                        defaultQStringList,
+                                                                        t_gainInfo.ch_names,
+                                                                        t_matU.transpose()));
+    t_pInvOp->eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_matV.rows(),
+                                                                       t_matV.cols(),
+                                                                       defaultQStringList,
+                                                                       defaultQStringList,
+                                                                       t_matV));
+    t_pInvOp->sing = t_vecSing;
+    t_pInvOp->source_cov->data = t_dScaling * t_invOpCached.source_cov->data;
+    t_pInvOp->noise_cov = FiffCov::SDPtr(new FiffCov(t_noiseCov));
+
+    return t_pInvOp;
+}
+
+
 //*************************************************************************************************************
 
 void RtInvOp::run()
 {
-    m_bIsRunning = true;
+    FiffCov t_noiseCov;
+
+    // Restrict forward solution as necessary for MEG
+    MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
 
-    while(m_bIsRunning)
+    m_pInvOpCached.reset();
+
+    //Sleep until a noise covariance arrives or the worker is stopped
+    while(m_queueNoiseCov.pop(t_noiseCov))
     {
-        if(m_vecNoiseCov.size() > 0)
-        {
-            // Restrict forward solution as necessary for MEG
-            MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
-
-            mutex.lock();
-            MNEInverseOperator::SPtr t_invOpMeg(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, m_vecNoiseCov[0], 0.2f, 0.8f));
-            m_vecNoiseCov.pop_front();
-            mutex.unlock();
-
-            emit invOperatorCalculated(t_invOpMeg);
-        }
+        mutex.lock();
+        bool t_bIsRunning = m_bIsRunning;
+        mutex.unlock();
+
+        if(!t_bIsRunning)
+            break;
+
+        //Reuse the lead field decomposition of the last inverse operator if the channels did not change
+        MNEInverseOperator::SPtr t_invOpMeg = updateInverseOperator(t_forwardMeg, t_noiseCov);
+        bool t_bUpdated = !t_invOpMeg.isNull();
+
+        if(!t_bUpdated)
+            t_invOpMeg = computeInverseOperator(t_forwardMeg, t_noiseCov);
+
+        //Count before emitting, so receivers of the signal already see the new numbers
+        mutex.lock();
+        if(t_bUpdated)
+            ++m_iNumUpdates;
+        else
+            ++m_iNumComputations;
+        mutex.unlock();
+
+        emit invOperatorCalculated(t_invOpMeg);
     }
 }
@@ -60,6 +60,14 @@
 #include <mne/mne_inverse_operator.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// UTILS INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/workqueue.h>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
@@ -93,6 +101,7 @@ namespace REALTIMELIB
 //=============================================================================================================
 
 using namespace Eigen;
+using namespace IOBUFFER;
 using namespace FIFFLIB;
 using namespace MNELIB;
 
@@ -128,12 +137,22 @@ public:
 
     //=========================================================================================================
     /**
-    * Slot to receive incoming noise covariance estimations.
+    * Slot to receive incoming noise covariance estimations. A noise covariance which is still pending when a
+    * newer one arrives is dropped, the inverse operator is only computed for the latest one.
     *
     * @param[in] p_NoiseCov     Noise covariance estimation
     */
     void appendNoiseCov(FiffCov &p_NoiseCov);
 
+    //=========================================================================================================
+    /**
+    * Starts the RtInv by starting the producer's thread. Not virtual, it hides QThread::start and starts the
+    * thread with the default priority.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool start();
+
     //=========================================================================================================
     /**
     * Stops the RtInv by stopping the producer's thread.
@@ -150,6 +169,22 @@ public:
     */
     inline bool isRunning();
 
+    //=========================================================================================================
+    /**
+    * Returns the number of inverse operators which were derived from the cached operator since the last start.
+    *
+    * @return the number of cached updates
+    */
+    int getNumUpdates();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of inverse operators which were computed from scratch since the last start.
+    *
+    * @return the number of full computations
+    */
+    int getNumComputations();
+
 signals:
     //=========================================================================================================
     /**
@@ -169,13 +204,47 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Computes the inverse operator from scratch and caches the parts which do not depend on the noise
+    * covariance for the following updates.
+    *
+    * @param[in] p_forward      The forward solution
+    * @param[in] p_noiseCov     The noise covariance
+    *
+    * @return the inverse operator
+    */
+    MNEInverseOperator::SPtr computeInverseOperator(const MNEForwardSolution &p_forward, const FiffCov &p_noiseCov);
+
+    //=========================================================================================================
+    /**
+    * Updates the cached inverse operator for a new noise covariance. The source covariance and the weighted
+    * lead field Gram matrix G*R*G' are reused, so instead of the SVD of the whitened lead field only the
+    * eigendecomposition of the channels x channels matrix W*G*R*G'*W' and one matrix product with the lead field
+    * are computed.
+    *
+    * @param[in] p_forward      The forward solution
+    * @param[in] p_noiseCov     The noise covariance
+    *
+    * @return the updated inverse operator, a null pointer if the cache can not be used (e.g. the channel
+    *         selection changed) and the inverse operator has to be computed from scratch.
+    */
+    MNEInverseOperator::SPtr updateInverseOperator(const MNEForwardSolution &p_forward, const FiffCov &p_noiseCov);
+
     QMutex      mutex;                  /**< Provides access serialization between threads. */
     bool        m_bIsRunning;           /**< Whether RtInv is running. */
 
-    QVector<FiffCov> m_vecNoiseCov;     /**< Noise covariance matrices. */
+    WorkQueue<FiffCov> m_queueNoiseCov; /**< Pending noise covariance matrices, the worker sleeps until one arrives. */
 
     FiffInfo::SPtr m_pFiffInfo;         /**< The fiff measurement information. */
     MNEForwardSolution::SPtr m_pFwd;    /**< The forward solution. */
+
+    MNEInverseOperator::SPtr m_pInvOpCached;    /**< Last inverse operator computed from scratch, the template for the updates. */
+    MatrixXd m_matGainCov;              /**< Lead field Gram matrix G*R*G' of the cached channels, R is the cached source covariance. */
+    QStringList m_qListChNames;         /**< Channels of the cached inverse operator. */
+
+    int m_iNumUpdates;                  /**< Number of inverse operators derived from the cache since the last start. */
+    int m_iNumComputations;             /**< Number of inverse operators computed from scratch since the last start. */
 };
 
 //*************************************************************************************************************
@@ -0,0 +1,248 @@
+//=============================================================================================================
+/**
+* @file     rtmultichannelfilter.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtMultiChannelFilter class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtmultichannelfilter.h"
+
+#include <utils/fftservice.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtMultiChannelFilter::RtMultiChannelFilter()
+: m_iNumChannels(0)
+, m_bHasFir(false)
+, m_iFilterLength(1)
+, m_iHistoryLength(0)
+, m_iDelay(0)
+, m_iFFTLength(0)
+, m_iChunkSize(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void RtMultiChannelFilter::setFilters(const QList<FilterData>& lFilterData, const QVector<int>& lFilterChannelList, int iNumChannels, int iBlockSize, int iDelay)
+{
+    //Combine the cascade of FIR filters into a single impulse response and collect the sections of the IIR filters
+    RowVectorXd vecImpulse = RowVectorXd::Ones(1);
+    m_iirFilter.m_matSOS.resize(0, 6);
+    m_bHasFir = false;
+
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        if(lFilterData.at(i).isIIR()) {
+            const MatrixXd& matSOS = lFilterData.at(i).m_matSOS;
+            m_iirFilter.m_matSOS.conservativeResize(m_iirFilter.m_matSOS.rows() + matSOS.rows(), 6);
+            m_iirFilter.m_matSOS.bottomRows(matSOS.rows()) = matSOS;
+            continue;
+        }
+
+        const RowVectorXd& vecCoeff = lFilterData.at(i).m_dCoeffA;
+
+        if(vecCoeff.cols() == 0) {
+            continue;
+        }
+
+        m_bHasFir = true;
+
+        RowVectorXd vecConv = RowVectorXd::Zero(vecImpulse.cols() + vecCoeff.cols() - 1);
+        for(int k = 0; k < vecCoeff.cols(); ++k) {
+            vecConv.segment(k, vecImpulse.cols()) += vecCoeff(k) * vecImpulse;
+        }
+        vecImpulse = vecConv;
+    }
+
+    m_iNumChannels = iNumChannels;
+    m_iFilterLength = vecImpulse.cols();
+    m_iDelay = iDelay < 0 ? m_iFilterLength/2 : iDelay;
+    m_iHistoryLength = std::max(m_iFilterLength - 1, m_iDelay);
+
+    //Choose the FFT length such that a whole block fits into one overlap-save frame
+    m_iFFTLength = 2;
+    while(m_iFFTLength < 2*m_iFilterLength || m_iFFTLength < m_iFilterLength - 1 + std::max(iBlockSize, 1)) {
+        m_iFFTLength *= 2;
+    }
+    m_iChunkSize = m_iFFTLength - (m_iFilterLength - 1);
+
+    FFTService::fwd(m_vecFreqResp, vecImpulse, m_iFFTLength);
+
+    //Split the rows into filtered and delayed ones
+    QVector<bool> vecIsFiltered(iNumChannels, false);
+    int iNumFiltered = 0;
+
+    for(int i = 0; i < lFilterChannelList.size(); ++i) {
+        int iRow = lFilterChannelList.at(i);
+        if(iRow >= 0 && iRow < iNumChannels && !vecIsFiltered.at(iRow)) {
+            vecIsFiltered[iRow] = true;
+            ++iNumFiltered;
+        }
+    }
+
+    m_vecFilterRows.resize(iNumFiltered);
+    m_vecDelayRows.resize(iNumChannels - iNumFiltered);
+
+    for(int i = 0, iFilter = 0, iDelayed = 0; i < iNumChannels; ++i) {
+        if(vecIsFiltered.at(i)) {
+            m_vecFilterRows[iFilter++] = i;
+        } else {
+            m_vecDelayRows[iDelayed++] = i;
+        }
+    }
+
+    //Allocate all buffers used while filtering
+    m_matHistory = MatrixXd::Zero(iNumChannels, m_iHistoryLength);
+    m_matExtended = MatrixXd::Zero(iNumChannels, m_iHistoryLength + m_iChunkSize);
+    m_matFrame = MatrixXd::Zero(iNumFiltered, m_iFFTLength);
+    m_matFrameFreq = MatrixXcd::Zero(iNumFiltered, m_iFFTLength/2+1);
+    m_matFrameFiltered = MatrixXd::Zero(iNumFiltered, m_iFFTLength);
+    m_matIirState = MatrixXd::Zero(iNumFiltered, 2*m_iirFilter.m_matSOS.rows());
+    m_matIirData = MatrixXd::Zero(iNumFiltered, m_iirFilter.m_matSOS.rows() > 0 ? std::max(iBlockSize, 1) : 0);
+}
+
+
+//*************************************************************************************************************
+
+bool RtMultiChannelFilter::filter(MatrixXd& matData)
+{
+    if(matData.rows() != m_iNumChannels) {
+        qWarning() << "RtMultiChannelFilter::filter - Number of rows" << matData.rows() << "does not match the filter setup" << m_iNumChannels;
+        return false;
+    }
+
+    if(m_iirFilter.m_matSOS.rows() > 0 && m_vecFilterRows.size() > 0) {
+        filterIir(matData);
+    }
+
+    for(int iStart = 0; iStart < matData.cols(); iStart += m_iChunkSize) {
+        filterChunk(matData, iStart, std::min(m_iChunkSize, static_cast<int>(matData.cols()) - iStart));
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtMultiChannelFilter::reset()
+{
+    m_matHistory.setZero();
+    m_matIirState.setZero();
+}
+
+
+//*************************************************************************************************************
+
+void RtMultiChannelFilter::filterChunk(MatrixXd& matData, int iStart, int iNumSamples)
+{
+    const int iOverlap = m_iFilterLength - 1;
+
+    //Append the new samples to the carried over ones before they get overwritten by the output
+    m_matExtended.leftCols(m_iHistoryLength) = m_matHistory;
+    m_matExtended.middleCols(m_iHistoryLength, iNumSamples) = matData.middleCols(iStart, iNumSamples);
+    m_matHistory = m_matExtended.middleCols(iNumSamples, m_iHistoryLength);
+
+    if(m_bHasFir && m_vecFilterRows.size() > 0) {
+        //Gather the overlap-save frames: the last iOverlap input samples followed by the new ones
+        for(int k = 0; k < m_vecFilterRows.size(); ++k) {
+            m_matFrame.row(k).head(iOverlap + iNumSamples) = m_matExtended.row(m_vecFilterRows[k]).segment(m_iHistoryLength - iOverlap, iOverlap + iNumSamples);
+        }
+
+        if(iOverlap + iNumSamples < m_iFFTLength) {
+            m_matFrame.rightCols(m_iFFTLength - iOverlap - iNumSamples).setZero();
+        }
+
+        FFTService::fwd(m_matFrameFreq, m_matFrame);
+        m_matFrameFreq.array().rowwise() *= m_vecFreqResp.array();
+        FFTService::inv(m_matFrameFiltered, m_matFrameFreq, m_iFFTLength);
+
+        //The first iOverlap samples of each frame are corrupted by the circular wrap-around, the rest is the linear convolution
+        for(int k = 0; k < m_vecFilterRows.size(); ++k) {
+            matData.row(m_vecFilterRows[k]).segment(iStart, iNumSamples) = m_matFrameFiltered.row(k).segment(iOverlap, iNumSamples);
+        }
+    }
+
+    //Delay all other rows to keep them aligned with the filtered ones
+    for(int k = 0; k < m_vecDelayRows.size(); ++k) {
+        matData.row(m_vecDelayRows[k]).segment(iStart, iNumSamples) = m_matExtended.row(m_vecDelayRows[k]).segment(m_iHistoryLength - m_iDelay, iNumSamples);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtMultiChannelFilter::filterIir(MatrixXd& matData)
+{
+    const int iNumSamples = matData.cols();
+
+    //Only grows if a block is larger than announced in setFilters
+    if(m_matIirData.cols() < iNumSamples) {
+        m_matIirData.resize(m_vecFilterRows.size(), iNumSamples);
+    }
+
+    for(int k = 0; k < m_vecFilterRows.size(); ++k) {
+        m_matIirData.row(k).head(iNumSamples) = matData.row(m_vecFilterRows[k]);
+    }
+
+    m_iirFilter.filter(m_matIirData, m_matIirState, iNumSamples);
+
+    for(int k = 0; k < m_vecFilterRows.size(); ++k) {
+        matData.row(m_vecFilterRows[k]) = m_matIirData.row(k).head(iNumSamples);
+    }
+}
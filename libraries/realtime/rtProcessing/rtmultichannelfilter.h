@@ -0,0 +1,228 @@
+//=============================================================================================================
+/**
+* @file     rtmultichannelfilter.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtMultiChannelFilter class declaration.
+*
+*/
+
+#ifndef RTMULTICHANNELFILTER_H
+#define RTMULTICHANNELFILTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+#include <utils/filterTools/filterdata.h>
+#include <utils/filterTools/iirfilter.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* Streaming FIR filter for multichannel data blocks based on the overlap-save method. The cascade of all FIR
+* filters is combined into a single impulse response whose frequency response is computed once. Each block is
+* filtered in place: the selected channels are transformed with one batched FFT per chunk, multiplied with the
+* frequency response and transformed back, while all other channels are delayed by the group delay to stay
+* aligned. The last input samples of every channel are carried over to the next block, so consecutive blocks
+* yield the same result as filtering the continuous stream. All buffers are allocated in setFilters, filtering a
+* block does not allocate.
+*
+* IIR filters (Butterworth, Chebyshev) are not part of the overlap-save cascade. Their second-order sections are
+* run sample by sample on the selected channels before the FIR part, with the per-channel state carried over
+* between blocks. They do not add to the delay of the unfiltered rows.
+*
+* @brief Block-streaming overlap-save filter for multichannel data.
+*/
+class REALTIMESHARED_EXPORT RtMultiChannelFilter
+{
+
+public:
+    typedef QSharedPointer<RtMultiChannelFilter> SPtr;             /**< Shared pointer type for RtMultiChannelFilter. */
+    typedef QSharedPointer<const RtMultiChannelFilter> ConstSPtr;  /**< Const shared pointer type for RtMultiChannelFilter. */
+
+    //=========================================================================================================
+    /**
+    * Creates an empty filter which passes all data unchanged.
+    */
+    RtMultiChannelFilter();
+
+    //=========================================================================================================
+    /**
+    * Sets up the filter and resets the carried over state.
+    *
+    * @param[in] lFilterData        The FIR and IIR filters which are applied one after another.
+    * @param[in] lFilterChannelList The indices of the rows which are filtered, in any order. Indices out of range are ignored. All other rows are delayed by iDelay samples.
+    * @param[in] iNumChannels       The number of rows of the data blocks.
+    * @param[in] iBlockSize         The expected number of samples per block, used to choose the FFT length.
+    * @param[in] iDelay             The delay of the unfiltered rows. Defaults to half the combined FIR filter length.
+    */
+    void setFilters(const QList<UTILSLIB::FilterData>& lFilterData, const QVector<int>& lFilterChannelList, int iNumChannels, int iBlockSize, int iDelay = -1);
+
+    //=========================================================================================================
+    /**
+    * Filters a data block in place. The block can have any number of samples.
+    *
+    * @param[in, out] matData   The data block (channels x samples). Its number of rows must match the setup.
+    *
+    * @return true if succeeded, false if the number of rows does not match the setup.
+    */
+    bool filter(Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Clears the carried over state, i.e. the next block is filtered as if the stream started with it.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Returns the length of the combined FIR impulse response.
+    *
+    * @return the combined FIR filter length in samples.
+    */
+    inline int filterLength() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the delay applied to the unfiltered rows.
+    *
+    * @return the delay in samples.
+    */
+    inline int delay() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the FFT length used for the overlap-save blocks.
+    *
+    * @return the FFT length.
+    */
+    inline int fftLength() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Filters a chunk of at most m_iChunkSize samples in place.
+    *
+    * @param[in, out] matData   The data block.
+    * @param[in] iStart         The first sample of the chunk.
+    * @param[in] iNumSamples    The number of samples of the chunk.
+    */
+    void filterChunk(Eigen::MatrixXd& matData, int iStart, int iNumSamples);
+
+    //=========================================================================================================
+    /**
+    * Applies the IIR sections to the filtered rows of a data block in place.
+    *
+    * @param[in, out] matData   The data block.
+    */
+    void filterIir(Eigen::MatrixXd& matData);
+
+    int                 m_iNumChannels;         /**< Number of rows of the data blocks. */
+    bool                m_bHasFir;              /**< Whether there are FIR filters, i.e. the overlap-save part is not the identity. */
+    int                 m_iFilterLength;        /**< Length of the combined FIR impulse response. */
+    int                 m_iHistoryLength;       /**< Number of input samples carried over, at least m_iFilterLength-1 and m_iDelay. */
+    int                 m_iDelay;               /**< Delay of the unfiltered rows. */
+    int                 m_iFFTLength;           /**< FFT length of the overlap-save blocks. */
+    int                 m_iChunkSize;           /**< New samples per overlap-save frame, i.e. m_iFFTLength-m_iFilterLength+1. */
+
+    Eigen::VectorXi     m_vecFilterRows;        /**< The filtered rows. */
+    Eigen::VectorXi     m_vecDelayRows;         /**< The delayed rows. */
+
+    Eigen::RowVectorXcd m_vecFreqResp;          /**< Half spectrum of the combined impulse response. */
+    Eigen::MatrixXd     m_matHistory;           /**< Last m_iHistoryLength input samples of every row. */
+    Eigen::MatrixXd     m_matExtended;          /**< Carried over plus new input samples of every row. */
+
+    Eigen::MatrixXd     m_matFrame;             /**< Overlap-save input frames of the filtered rows. */
+    Eigen::MatrixXcd    m_matFrameFreq;         /**< Spectra of the frames. */
+    Eigen::MatrixXd     m_matFrameFiltered;     /**< Filtered frames. */
+
+    UTILSLIB::IirFilter m_iirFilter;            /**< Second-order sections of all IIR filters, one per row, with their scratch buffers. */
+    Eigen::MatrixXd     m_matIirState;          /**< IIR state of the filtered rows (rows x 2*sections). */
+    Eigen::MatrixXd     m_matIirData;           /**< Filtered rows of the current block. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int RtMultiChannelFilter::filterLength() const
+{
+    return m_iFilterLength;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtMultiChannelFilter::delay() const
+{
+    return m_iDelay;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtMultiChannelFilter::fftLength() const
+{
+    return m_iFFTLength;
+}
+
+} // NAMESPACE
+
+#endif // RTMULTICHANNELFILTER_H
@@ -45,6 +45,7 @@
 
 #include <iostream>
 #include <fiff/fiff_cov.h>
+#include <utils/fftservice.h>
 
 
 //*************************************************************************************************************
@@ -62,6 +63,7 @@
 
 using namespace REALTIMELIB;
 using namespace FIFFLIB;
+using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
@@ -187,8 +189,6 @@ bool RtNoise::stop()
 
     m_pRawMatrixBuffer->releaseFromPop();
 
-    m_pRawMatrixBuffer->clear();
-
     qDebug()<<" RtNoise Thread is stopped.";
 
     return true;
@@ -200,12 +200,15 @@ bool RtNoise::stop()
 void RtNoise::run()
 {
     bool FirstStart = true;
+    MatrixXd block;
 
     while(m_bIsRunning)
     {
         if(m_pRawMatrixBuffer)
         {
-            MatrixXd block = m_pRawMatrixBuffer->pop();
+            //A released pop returns no data
+            if(!m_pRawMatrixBuffer->pop(block))
+                continue;
 
             if(FirstStart){
                 //init the circ buffer and parameters
@@ -239,6 +242,7 @@ void RtNoise::run()
                 int nb = floor(m_iNumOfBlocks*m_iBlockSize/m_iFFTlength)+1;
                 qDebug()<<"nb"<<nb<<"NumOfBlocks"<<m_iNumOfBlocks<<"BlockSize"<<m_iBlockSize;
                 MatrixXd t_mat(m_iSensors,m_iFFTlength);
+                MatrixXcd t_freqData;
                 MatrixXd t_psdx(m_iSensors,m_iFFTlength/2+1);
                 for (int n = 0; n<nb; n++){
                     //collect a data block with data length of m_iFFTlength;
@@ -259,36 +263,23 @@ void RtNoise::run()
                             t_mat(ii,jj) = m_matCircBuf(ii,jj+n*m_iFFTlength);
                     }
 
-                    //FFT calculation by row
-                    for(qint32 i = 0; i < t_mat.rows(); i++){
-                        RowVectorXd data;
-
-                        data = t_mat.row(i);
-
-                        //zero-pad data to m_iFFTlength
-                        RowVectorXd t_dataZeroPad = RowVectorXd::Zero(m_iFFTlength);
-                        t_dataZeroPad.head(data.cols()) = data;
-
-                        for (qint32 lk = 0; lk<m_iFFTlength; lk++)
-                            t_dataZeroPad[lk] = t_dataZeroPad[lk]*m_fWin[lk];
-
-                        //generate fft object
-                        Eigen::FFT<double> fft;
-                        fft.SetFlag(fft.HalfSpectrum);
+                    //apply the window to all channels
+                    for (qint32 lk = 0; lk<m_iFFTlength; lk++)
+                        t_mat.col(lk) *= m_fWin[lk];
 
-                        //fft-transform data sequence
-                        RowVectorXcd t_freqData(m_iFFTlength/2+1);
-                        fft.fwd(t_freqData,t_dataZeroPad);
+                    //FFT calculation of all channels at once
+                    FFTService::fwd(t_freqData, t_mat);
 
-                        // calculate spectrum from FFT
+                    // calculate spectrum from FFT
+                    for(qint32 i = 0; i < t_freqData.rows(); i++){
                         for(qint32 j=0; j<m_iFFTlength/2+1;j++)
                         {
-                            double mag_abs = sqrt(t_freqData(j).real()* t_freqData(j).real() +  t_freqData(j).imag()*t_freqData(j).imag());
+                            double mag_abs = std::abs(t_freqData(i,j));
                             double spower = (1.0/(m_Fs*m_iFFTlength))* mag_abs;
                             if (j>0&&j<m_iFFTlength/2) spower = 2.0*spower;
                             sum_psdx(i,j) = sum_psdx(i,j) + spower;
                         }
-                     }//row computing is done
+                    }//row computing is done
                 }//nb
 
                 //DB-calculation
@@ -308,5 +299,8 @@ void RtNoise::run()
 
     }
 
+    //The consumer drops the blocks which are left, a clear from stop() would race with the pops
+    if(m_pRawMatrixBuffer)
+        m_pRawMatrixBuffer->clear();
 }
 
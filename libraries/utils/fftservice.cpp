@@ -0,0 +1,275 @@
+//=============================================================================================================
+/**
+* @file     fftservice.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FFTService class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fftservice.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <vector>
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QThreadStorage>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+/**
+* Per thread FFT state. The Eigen FFT engine keeps one plan per transform length and direction.
+*/
+struct FFTWorkspace
+{
+    FFTWorkspace()
+    {
+        fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    }
+
+    Eigen::FFT<double> fft;                         /**< Plan caching FFT engine. */
+    std::vector<double> vecTime;                    /**< Scratch buffer for padded/gathered time series. */
+    std::vector<std::complex<double> > vecFreq;     /**< Scratch buffer for padded/gathered spectra. */
+};
+
+FFTWorkspace& workspace()
+{
+    static QThreadStorage<FFTWorkspace*> s_workspace;
+
+    if(!s_workspace.hasLocalData()) {
+        s_workspace.setLocalData(new FFTWorkspace);
+    }
+
+    return *s_workspace.localData();
+}
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+void FFTService::fwd(RowVectorXcd& p_vecFreq, const RowVectorXd& p_vecTime, int p_iNfft, bool p_bHalfSpectrum)
+{
+    int nfft = p_iNfft < 1 ? static_cast<int>(p_vecTime.cols()) : p_iNfft;
+    p_vecFreq.resize(p_bHalfSpectrum ? nfft/2+1 : nfft);
+
+    if(p_vecTime.cols() >= nfft) {
+        fwd(p_vecFreq.data(), p_vecTime.data(), nfft, p_bHalfSpectrum);
+        return;
+    }
+
+    FFTWorkspace& ws = workspace();
+    ws.vecTime.assign(nfft, 0.0);
+    std::copy(p_vecTime.data(), p_vecTime.data() + p_vecTime.cols(), ws.vecTime.begin());
+
+    fwd(p_vecFreq.data(), ws.vecTime.data(), nfft, p_bHalfSpectrum);
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::fwd(VectorXcd& p_vecFreq, const VectorXd& p_vecTime, int p_iNfft, bool p_bHalfSpectrum)
+{
+    int nfft = p_iNfft < 1 ? static_cast<int>(p_vecTime.rows()) : p_iNfft;
+    p_vecFreq.resize(p_bHalfSpectrum ? nfft/2+1 : nfft);
+
+    if(p_vecTime.rows() >= nfft) {
+        fwd(p_vecFreq.data(), p_vecTime.data(), nfft, p_bHalfSpectrum);
+        return;
+    }
+
+    FFTWorkspace& ws = workspace();
+    ws.vecTime.assign(nfft, 0.0);
+    std::copy(p_vecTime.data(), p_vecTime.data() + p_vecTime.rows(), ws.vecTime.begin());
+
+    fwd(p_vecFreq.data(), ws.vecTime.data(), nfft, p_bHalfSpectrum);
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::fwd(MatrixXcd& p_matFreq, const MatrixXd& p_matTime, int p_iNfft)
+{
+    int nfft = p_iNfft < 1 ? static_cast<int>(p_matTime.cols()) : p_iNfft;
+    int nbins = nfft/2+1;
+    int ncopy = std::min(nfft, static_cast<int>(p_matTime.cols()));
+
+    p_matFreq.resize(p_matTime.rows(), nbins);
+
+    //The rows of a column major matrix are strided - gather each row into the (zero padded) scratch buffer and
+    //transform it from there. The padding stays zero since only the head of the buffer is overwritten.
+    FFTWorkspace& ws = workspace();
+    ws.vecTime.assign(nfft, 0.0);
+    ws.vecFreq.resize(nbins);
+
+    Map<RowVectorXd> t_vecTime(ws.vecTime.data(), ncopy);
+    Map<RowVectorXcd> t_vecFreq(ws.vecFreq.data(), nbins);
+
+    for(int i = 0; i < p_matTime.rows(); ++i) {
+        t_vecTime = p_matTime.row(i).head(ncopy);
+        fwd(ws.vecFreq.data(), ws.vecTime.data(), nfft, true);
+        p_matFreq.row(i) = t_vecFreq;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::inv(RowVectorXd& p_vecTime, const RowVectorXcd& p_vecFreq, int p_iNfft)
+{
+    int nfft = p_iNfft < 1 ? 2*(static_cast<int>(p_vecFreq.cols())-1) : p_iNfft;
+    p_vecTime.resize(nfft);
+
+    inv(p_vecTime.data(), p_vecFreq.data(), static_cast<int>(p_vecFreq.cols()), nfft);
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::inv(VectorXd& p_vecTime, const VectorXcd& p_vecFreq, int p_iNfft)
+{
+    int nfft = p_iNfft < 1 ? 2*(static_cast<int>(p_vecFreq.rows())-1) : p_iNfft;
+    p_vecTime.resize(nfft);
+
+    inv(p_vecTime.data(), p_vecFreq.data(), static_cast<int>(p_vecFreq.rows()), nfft);
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::inv(MatrixXd& p_matTime, const MatrixXcd& p_matFreq, int p_iNfft)
+{
+    int nfft = p_iNfft < 1 ? 2*(static_cast<int>(p_matFreq.cols())-1) : p_iNfft;
+    int nbins = nfft/2+1;
+    int ncopy = std::min(nbins, static_cast<int>(p_matFreq.cols()));
+
+    p_matTime.resize(p_matFreq.rows(), nfft);
+
+    //Gather each row into the (zero padded) scratch buffer, see the batched forward transform
+    FFTWorkspace& ws = workspace();
+    ws.vecFreq.assign(nbins, std::complex<double>(0.0, 0.0));
+    ws.vecTime.resize(nfft);
+
+    Map<RowVectorXcd> t_vecFreq(ws.vecFreq.data(), ncopy);
+    Map<RowVectorXd> t_vecTime(ws.vecTime.data(), nfft);
+
+    for(int i = 0; i < p_matFreq.rows(); ++i) {
+        t_vecFreq = p_matFreq.row(i).head(ncopy);
+        inv(ws.vecTime.data(), ws.vecFreq.data(), nbins, nfft);
+        p_matTime.row(i) = t_vecTime;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::clearCache()
+{
+    FFTWorkspace& ws = workspace();
+
+    ws.fft.impl().clear();
+    std::vector<double>().swap(ws.vecTime);
+    std::vector<std::complex<double> >().swap(ws.vecFreq);
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::fwd(std::complex<double>* p_pFreq, const double* p_pTime, int p_iNfft, bool p_bHalfSpectrum)
+{
+    workspace().fft.fwd(p_pFreq, p_pTime, p_iNfft);
+
+    //Reflect the conjugate symmetric half if the full spectrum was requested
+    if(!p_bHalfSpectrum) {
+        for(int k = p_iNfft/2+1; k < p_iNfft; ++k) {
+            p_pFreq[k] = std::conj(p_pFreq[p_iNfft-k]);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FFTService::inv(double* p_pTime, const std::complex<double>* p_pFreq, int p_iBins, int p_iNfft)
+{
+    FFTWorkspace& ws = workspace();
+    int nbins = p_iNfft/2+1;
+
+    if(p_iBins >= nbins) {
+        ws.fft.inv(p_pTime, p_pFreq, p_iNfft);
+        return;
+    }
+
+    //Zero pad a truncated spectrum
+    ws.vecFreq.assign(nbins, std::complex<double>(0.0, 0.0));
+    std::copy(p_pFreq, p_pFreq + p_iBins, ws.vecFreq.begin());
+
+    ws.fft.inv(p_pTime, ws.vecFreq.data(), p_iNfft);
+}
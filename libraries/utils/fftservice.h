@@ -0,0 +1,179 @@
+//=============================================================================================================
+/**
+* @file     fftservice.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FFTService class declaration.
+*
+*/
+
+#ifndef FFTSERVICE_H
+#define FFTSERVICE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Shared FFT service for the filtering and spectral routines. Every thread owns one FFT engine which keeps the
+* plans (twiddle factors and factorizations) of all transform lengths it was used with, together with the
+* scratch buffers needed for zero padding and row gathering. Calls therefore never re-plan a length a thread has
+* already seen and do not allocate once the scratch buffers have grown to the largest transform length.
+*
+* Real forward transforms return the half spectrum (nfft/2+1 bins) unless stated otherwise, real inverse
+* transforms consume the half spectrum and are scaled by 1/nfft, i.e. inv(fwd(x)) == x.
+*
+* @brief Thread-local, plan caching FFT engine with a batched multi-channel real-to-complex API.
+*/
+class UTILSSHARED_EXPORT FFTService
+{
+public:
+    //=========================================================================================================
+    /**
+    * Real-to-complex forward FFT of a single row.
+    *
+    * @param[out] p_vecFreq         The spectrum (nfft/2+1 bins, or nfft bins if p_bHalfSpectrum is false).
+    * @param[in] p_vecTime          The time series. It is zero padded or truncated to p_iNfft samples.
+    * @param[in] p_iNfft            The transform length. Defaults to the length of p_vecTime.
+    * @param[in] p_bHalfSpectrum    Whether to return the half spectrum only.
+    */
+    static void fwd(RowVectorXcd& p_vecFreq, const RowVectorXd& p_vecTime, int p_iNfft = -1, bool p_bHalfSpectrum = true);
+
+    //=========================================================================================================
+    /**
+    * Real-to-complex forward FFT of a single column.
+    *
+    * @param[out] p_vecFreq         The spectrum (nfft/2+1 bins, or nfft bins if p_bHalfSpectrum is false).
+    * @param[in] p_vecTime          The time series. It is zero padded or truncated to p_iNfft samples.
+    * @param[in] p_iNfft            The transform length. Defaults to the length of p_vecTime.
+    * @param[in] p_bHalfSpectrum    Whether to return the half spectrum only.
+    */
+    static void fwd(VectorXcd& p_vecFreq, const VectorXd& p_vecTime, int p_iNfft = -1, bool p_bHalfSpectrum = true);
+
+    //=========================================================================================================
+    /**
+    * Batched real-to-complex forward FFT of all rows of a matrix (channels x samples).
+    *
+    * @param[out] p_matFreq         The half spectra (channels x nfft/2+1).
+    * @param[in] p_matTime          The time series of each channel. They are zero padded or truncated to p_iNfft samples.
+    * @param[in] p_iNfft            The transform length. Defaults to the number of columns of p_matTime.
+    */
+    static void fwd(MatrixXcd& p_matFreq, const MatrixXd& p_matTime, int p_iNfft = -1);
+
+    //=========================================================================================================
+    /**
+    * Complex-to-real inverse FFT of a single row.
+    *
+    * @param[out] p_vecTime         The time series (p_iNfft samples).
+    * @param[in] p_vecFreq          The spectrum. Only the first nfft/2+1 bins are used.
+    * @param[in] p_iNfft            The transform length. Defaults to 2*(bins-1), i.e. p_vecFreq is a half spectrum.
+    */
+    static void inv(RowVectorXd& p_vecTime, const RowVectorXcd& p_vecFreq, int p_iNfft = -1);
+
+    //=========================================================================================================
+    /**
+    * Complex-to-real inverse FFT of a single column.
+    *
+    * @param[out] p_vecTime         The time series (p_iNfft samples).
+    * @param[in] p_vecFreq          The spectrum. Only the first nfft/2+1 bins are used.
+    * @param[in] p_iNfft            The transform length. Defaults to 2*(bins-1), i.e. p_vecFreq is a half spectrum.
+    */
+    static void inv(VectorXd& p_vecTime, const VectorXcd& p_vecFreq, int p_iNfft = -1);
+
+    //=========================================================================================================
+    /**
+    * Batched complex-to-real inverse FFT of all rows of a matrix (channels x bins).
+    *
+    * @param[out] p_matTime         The time series of each channel (channels x p_iNfft).
+    * @param[in] p_matFreq          The spectra. Only the first nfft/2+1 bins of each row are used.
+    * @param[in] p_iNfft            The transform length. Defaults to 2*(bins-1), i.e. p_matFreq holds half spectra.
+    */
+    static void inv(MatrixXd& p_matTime, const MatrixXcd& p_matFreq, int p_iNfft = -1);
+
+    //=========================================================================================================
+    /**
+    * Releases the plans and scratch buffers of the calling thread.
+    */
+    static void clearCache();
+
+private:
+    //=========================================================================================================
+    /**
+    * Transforms a contiguous real series of p_iNfft samples.
+    *
+    * @param[out] p_pFreq           Destination of p_iNfft/2+1 bins, or p_iNfft bins if p_bHalfSpectrum is false.
+    * @param[in] p_pTime            The p_iNfft samples to transform.
+    * @param[in] p_iNfft            The transform length.
+    * @param[in] p_bHalfSpectrum    Whether to fill the half spectrum only.
+    */
+    static void fwd(std::complex<double>* p_pFreq, const double* p_pTime, int p_iNfft, bool p_bHalfSpectrum);
+
+    //=========================================================================================================
+    /**
+    * Transforms a contiguous spectrum of p_iBins bins back to p_iNfft real samples.
+    *
+    * @param[out] p_pTime           Destination of p_iNfft samples.
+    * @param[in] p_pFreq            The spectrum.
+    * @param[in] p_iBins            The number of bins available in p_pFreq.
+    * @param[in] p_iNfft            The transform length.
+    */
+    static void inv(double* p_pTime, const std::complex<double>* p_pFreq, int p_iBins, int p_iNfft);
+};
+
+} // NAMESPACE
+
+#endif // FFTSERVICE_H
@@ -46,6 +46,9 @@
 
 #include "parksmcclellan.h"
 #include "cosinefilter.h"
+#include "iirfilter.h"
+
+#include "../fftservice.h"
 
 
 //*************************************************************************************************************
@@ -54,6 +57,7 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <algorithm>
 
 
 //*************************************************************************************************************
@@ -70,10 +74,6 @@
 //=============================================================================================================
 
 #include <Eigen/SparseCore>
-//#ifndef EIGEN_FFTW_DEFAULT
-//#define EIGEN_FFTW_DEFAULT
-//#endif
-#include <unsupported/Eigen/FFT>
 
 
 //*************************************************************************************************************
@@ -124,6 +124,8 @@ FilterData::FilterData(QString unique_name, FilterType type, int order, double c
 
 void FilterData::designFilter()
 {
+    m_matSOS.resize(0, 0);
+
     switch(m_designMethod) {
         case Tschebyscheff: {
             ParksMcClellan filter(m_iFilterOrder, m_dCenterFreq, m_dBandwidth, m_dParksWidth, (ParksMcClellan::TPassType)m_Type);
@@ -183,6 +185,29 @@ void FilterData::designFilter()
 
             break;
         }
+
+        case Butterworth:
+        case Chebyshev: {
+            IirFilter filteriir(m_iFilterOrder,
+                                m_dCenterFreq,
+                                m_dBandwidth,
+                                (IirFilter::TPassType)m_Type,
+                                m_designMethod == Chebyshev ? IirFilter::Chebyshev : IirFilter::Butterworth);
+            m_matSOS = filteriir.m_matSOS;
+
+            //The frequency-domain and convolution filtering need a finite impulse response. Truncate it where it has decayed.
+            RowVectorXd t_impulse = IirFilter::impulseResponse(m_matSOS, std::max(m_iFFTlength/4, 1));
+            double dThreshold = 1e-6 * t_impulse.cwiseAbs().maxCoeff();
+            int iLength = t_impulse.cols();
+            while(iLength > 1 && std::abs(t_impulse(iLength-1)) <= dThreshold) {
+                --iLength;
+            }
+            m_dCoeffA = t_impulse.head(iLength);
+
+            fftTransformCoeffs();
+
+            break;
+        }
     }
 
     switch(m_Type) {
@@ -213,13 +238,8 @@ void FilterData::fftTransformCoeffs()
     RowVectorXd t_coeffAzeroPad = RowVectorXd::Zero(m_iFFTlength);
     t_coeffAzeroPad.head(m_dCoeffA.cols()) = m_dCoeffA;
 
-    //generate fft object
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
-
     //fft-transform filter coeffs
-    m_dFFTCoeffA = RowVectorXcd::Zero(m_iFFTlength);
-    fft.fwd(m_dFFTCoeffA,t_coeffAzeroPad);
+    FFTService::fwd(m_dFFTCoeffA, t_coeffAzeroPad);
 }
 
 
@@ -300,20 +320,16 @@ RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhea
             break;
     }
 
-    //generate fft object
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
-
     //fft-transform data sequence
     RowVectorXcd t_freqData;
-    fft.fwd(t_freqData,t_dataZeroPad);
+    FFTService::fwd(t_freqData, t_dataZeroPad);
 
     //perform frequency-domain filtering
-    RowVectorXcd t_filteredFreq = m_dFFTCoeffA.array()*t_freqData.array();
+    t_freqData.array() *= m_dFFTCoeffA.array();
 
     //inverse-FFT
     RowVectorXd t_filteredTime;
-    fft.inv(t_filteredTime,t_filteredFreq);
+    FFTService::inv(t_filteredTime, t_freqData, m_iFFTlength);
 
     //Return filtered data
     if(!keepOverhead)
@@ -323,6 +339,54 @@ RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhea
 }
 
 
+//*************************************************************************************************************
+
+MatrixXd FilterData::applyFFTFilter(const MatrixXd& data, bool keepOverhead, CompensateEdgeEffects compensateEdgeEffects) const
+{
+    if(data.cols()<m_dCoeffA.cols() && compensateEdgeEffects==MirrorData) {
+        qDebug()<<QString("Error in FilterData: Number of filter taps(%1) bigger then data size(%2). Not enough data to perform mirroring!").arg(m_dCoeffA.cols()).arg(data.cols());
+        return data;
+    }
+
+    if(2*m_dCoeffA.cols() + data.cols()>m_iFFTlength) {
+        qDebug()<<"Error in FilterData: Number of mirroring/zeropadding size plus data size is bigger then fft length!";
+        return data;
+    }
+
+    //Do zero padding or mirroring of all channels depending on user input
+    MatrixXd t_matDataZeroPad = MatrixXd::Zero(data.rows(), m_iFFTlength);
+
+    switch(compensateEdgeEffects) {
+        case MirrorData:
+            t_matDataZeroPad.leftCols(m_dCoeffA.cols()) = data.leftCols(m_dCoeffA.cols()).rowwise().reverse();     //front
+            t_matDataZeroPad.middleCols(m_dCoeffA.cols(), data.cols()) = data;                                      //middle
+            t_matDataZeroPad.rightCols(m_dCoeffA.cols()) = data.rightCols(m_dCoeffA.cols()).rowwise().reverse();   //back
+            break;
+
+        default:
+            t_matDataZeroPad.leftCols(data.cols()) = data;
+            break;
+    }
+
+    //fft-transform all channels at once
+    MatrixXcd t_matFreqData;
+    FFTService::fwd(t_matFreqData, t_matDataZeroPad);
+
+    //perform frequency-domain filtering
+    t_matFreqData.array().rowwise() *= m_dFFTCoeffA.array();
+
+    //inverse-FFT
+    MatrixXd t_matFilteredTime;
+    FFTService::inv(t_matFilteredTime, t_matFreqData, m_iFFTlength);
+
+    //Return filtered data
+    if(!keepOverhead)
+        return t_matFilteredTime.middleCols(m_dCoeffA.cols()/2, data.cols());
+
+    return t_matFilteredTime.leftCols(data.cols()+m_dCoeffA.cols());
+}
+
+
 //*************************************************************************************************************
 
 QString FilterData::getStringForDesignMethod(const FilterData::DesignMethod &designMethod)
@@ -338,10 +402,29 @@ QString FilterData::getStringForDesignMethod(const FilterData::DesignMethod &des
     if(designMethod == FilterData::Tschebyscheff)
         designMethodString = "Tschebyscheff";
 
+    if(designMethod == FilterData::Butterworth)
+        designMethodString = "Butterworth";
+
+    if(designMethod == FilterData::Chebyshev)
+        designMethodString = "Chebyshev";
+
     return designMethodString;
 }
 
 
+//*************************************************************************************************************
+
+void FilterData::applyIirFilter(MatrixXd& data, MatrixXd& matState) const
+{
+    if(!isIIR()) {
+        qDebug()<<"Error in FilterData: applyIirFilter called for a filter without IIR sections!";
+        return;
+    }
+
+    IirFilter::filter(m_matSOS, data, matState);
+}
+
+
 //*************************************************************************************************************
 
 QString FilterData::getStringForFilterType(const FilterData::FilterType &filterType)
@@ -379,6 +462,12 @@ FilterData::DesignMethod FilterData::getDesignMethodForString(const QString &des
     if(designMethodString == "Cosine")
         designMethod = FilterData::Cosine;
 
+    if(designMethodString == "Butterworth")
+        designMethod = FilterData::Butterworth;
+
+    if(designMethodString == "Chebyshev")
+        designMethod = FilterData::Chebyshev;
+
     return designMethod;
 }
 
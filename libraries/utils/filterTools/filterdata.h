@@ -102,7 +102,9 @@ public:
     enum DesignMethod {
         Tschebyscheff,
         Cosine,
-        External
+        External,
+        Butterworth,
+        Chebyshev
     } m_designMethod;
 
     enum FilterType {
@@ -128,13 +130,13 @@ public:
     * Constructs a FilterData object
     * @param [in] unique_name defines the name of the generated filter
     * @param [in] type of the filter: LPF, HPF, BPF, NOTCH (from enum FilterType)
-    * @param [in] order represents the order of the filter, the higher the higher is the stopband attenuation
+    * @param [in] order represents the order of the filter, the higher the higher is the stopband attenuation. For Butterworth and Chebyshev the order of the IIR lowpass prototype.
     * @param [in] centerfreq determines the center of the frequency
     * @param [in] bandwidth ignored if FilterType is set to LPF,HPF. if NOTCH/BPF: bandwidth of stop-/passband
     * @param [in] parkswidth determines the width of the filter slopes (steepness)
     * @param [in] sFreq sampling frequency
     * @param [in] fftlength length of the fft (multiple integer of 2^x)
-    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff
+    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff (FIR) or Butterworth and Chebyshev (IIR)
     */
     FilterData(QString unique_name, FilterType type, int order, double centerfreq, double bandwidth, double parkswidth, double sFreq, qint32 fftlength=4096, DesignMethod designMethod = Cosine);
 
@@ -169,6 +171,39 @@ public:
     */
     RowVectorXd applyFFTFilter(const RowVectorXd& data, bool keepOverhead = false, CompensateEdgeEffects compensateEdgeEffects = MirrorData) const;
 
+    /**
+    * Applies the current filter to all rows (channels) of the input data using multiplication in frequency domain.
+    * All channels are transformed with one batched FFT call. See applyFFTFilter for single rows.
+    *
+    * @param [in] data holds the data to be filtered (channels x samples)
+    * @param [in] keepOverhead whether the result should still include the overhead information in front and back of the data
+    * @param [in] compensateEdgeEffects defines how the edge effects should be handlted. Choose between ZeroPad and Mirroring
+    *
+    * @return the filtered data in form of a MatrixXd
+    */
+    MatrixXd applyFFTFilter(const MatrixXd& data, bool keepOverhead = false, CompensateEdgeEffects compensateEdgeEffects = MirrorData) const;
+
+    /**
+    * Applies the IIR second-order sections to all rows (channels) of the input data in place. The state of every channel is
+    * carried over in matState, hence consecutive blocks are filtered like a continuous stream. Pro: Low delay (real-time capable) Con: Non-linear phase
+    *
+    * @param [in, out] data holds the data to be filtered (channels x samples)
+    * @param [in, out] matState holds the filter state (channels x 2*sections). It is reset to zero if its dimension does not match.
+    */
+    void applyIirFilter(MatrixXd& data, MatrixXd& matState) const;
+
+    /**
+     * @brief isIIR returns whether the filter was designed as IIR filter (Butterworth, Chebyshev)
+     */
+    inline bool isIIR() const;
+
+    /**
+     * @brief getFilterLength returns the number of samples the filter spans, e.g. the overlap needed when filtering blocks.
+     * For FIR designs this is the filter order. For IIR designs it is the length of the truncated impulse response in
+     * m_dCoeffA, the order of the IIR prototype does not say anything about how long the filter rings.
+     */
+    inline int getFilterLength() const;
+
     /**
      * @brief getStringForDesignMethod returns the current design method as a string
      */
@@ -201,11 +236,13 @@ public:
 
     QString         m_sName;            /**< contains name of the filter. */
 
-    RowVectorXd     m_dCoeffA;          /**< contains the forward filter coefficient set. */
+    RowVectorXd     m_dCoeffA;          /**< contains the forward filter coefficient set. For IIR filters the truncated impulse response. */
     RowVectorXd     m_dCoeffB;          /**< contains the backward filter coefficient set (empty if FIR filter). */
 
     RowVectorXcd    m_dFFTCoeffA;       /**< the FFT-transformed forward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
     RowVectorXcd    m_dFFTCoeffB;       /**< the FFT-transformed backward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
+
+    MatrixXd        m_matSOS;           /**< the second-order sections of IIR filters, one per row: b0 b1 b2 a0 a1 a2 (empty if FIR filter). */
 };
 
 //*************************************************************************************************************
@@ -213,6 +250,19 @@ public:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline bool FilterData::isIIR() const
+{
+    return m_matSOS.rows() > 0;
+}
+
+
+//*************************************************************************************************************
+
+inline int FilterData::getFilterLength() const
+{
+    return isIIR() ? m_dCoeffA.cols() : m_iFilterOrder;
+}
+
 } // NAMESPACE UTILSLIB
 
 #ifndef metatype_filtertype
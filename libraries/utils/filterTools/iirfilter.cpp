@@ -0,0 +1,374 @@
+//=============================================================================================================
+/**
+* @file     iirfilter.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the IirFilter class
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "iirfilter.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+typedef std::complex<double> Complex;
+
+//=============================================================================================================
+/**
+* Groups roots into real polynomials 1 + c1*z^-1 + c2*z^-2. Complex roots are combined with their conjugates,
+* real roots are paired with each other. A single remaining real root yields a first order polynomial, which
+* is put in front.
+*/
+std::vector<Vector3d> rootsToPolynomials(const std::vector<Complex>& vecRoots)
+{
+    std::vector<Vector3d> vecPolys;
+    std::vector<double> vecReal;
+
+    for(size_t i = 0; i < vecRoots.size(); ++i) {
+        const Complex& r = vecRoots[i];
+
+        if(std::abs(r.imag()) <= 1e-10 * std::max(1.0, std::abs(r))) {
+            vecReal.push_back(r.real());
+        } else if(r.imag() > 0) {
+            vecPolys.push_back(Vector3d(1.0, -2.0*r.real(), std::norm(r)));
+        }
+    }
+
+    std::sort(vecReal.begin(), vecReal.end());
+
+    int i = 0;
+    int j = static_cast<int>(vecReal.size()) - 1;
+    for(; i < j; ++i, --j) {
+        vecPolys.push_back(Vector3d(1.0, -(vecReal[i] + vecReal[j]), vecReal[i] * vecReal[j]));
+    }
+
+    if(i == j) {
+        vecPolys.insert(vecPolys.begin(), Vector3d(1.0, -vecReal[i], 0.0));
+    }
+
+    return vecPolys;
+}
+
+
+//=============================================================================================================
+/**
+* Returns the product of (c - r) over all roots r.
+*/
+Complex productOfDifferences(const Complex& c, const std::vector<Complex>& vecRoots)
+{
+    Complex prod(1.0, 0.0);
+
+    for(size_t i = 0; i < vecRoots.size(); ++i) {
+        prod *= c - vecRoots[i];
+    }
+
+    return prod;
+}
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+IirFilter::IirFilter()
+{
+}
+
+
+//*************************************************************************************************************
+
+IirFilter::IirFilter(int order, double OmegaC, double BW, TPassType type, TDesignType design, double rippleDb)
+{
+    if(order < 1 || order > 32) {
+        qWarning() << "IirFilter - Order" << order << "out of range (1 - 32).";
+        return;
+    }
+
+    double dLow = OmegaC;
+    double dHigh = OmegaC;
+
+    if(type == BPF || type == NOTCH) {
+        dLow = OmegaC - BW/2;
+        dHigh = OmegaC + BW/2;
+    }
+
+    if(dLow <= 0.0 || dHigh >= 1.0 || dLow > dHigh) {
+        qWarning() << "IirFilter - Cut off frequencies" << dLow << dHigh << "must lie between 0 and the Nyquist frequency.";
+        return;
+    }
+
+    //Analog lowpass prototype with a cut off at 1 rad/s (there are no finite zeros for Butterworth and Chebyshev I)
+    std::vector<Complex> vecZeros;
+    std::vector<Complex> vecPoles;
+    double dGain = 1.0;
+
+    if(design == Chebyshev) {
+        double eps = sqrt(pow(10.0, 0.1 * rippleDb) - 1.0);
+        double mu = asinh(1.0/eps) / order;
+
+        for(int m = -order + 1; m < order; m += 2) {
+            double theta = M_PI * m / (2.0 * order);
+            vecPoles.push_back(-std::sinh(Complex(mu, theta)));
+        }
+
+        dGain = productOfDifferences(Complex(0.0, 0.0), vecPoles).real();
+        if(order % 2 == 0) {
+            dGain /= sqrt(1.0 + eps*eps);
+        }
+    } else {
+        for(int m = -order + 1; m < order; m += 2) {
+            vecPoles.push_back(-std::exp(Complex(0.0, M_PI * m / (2.0 * order))));
+        }
+    }
+
+    //Prewarp the cut off frequencies for the bilinear transform with fs = 2, i.e. the Nyquist frequency is 1
+    const double fs2 = 4.0;
+    double wLow = fs2 * tan(M_PI * dLow / 2.0);
+    double wHigh = fs2 * tan(M_PI * dHigh / 2.0);
+
+    const int iDegree = static_cast<int>(vecPoles.size() - vecZeros.size());
+
+    //Transform the prototype to the requested pass type
+    std::vector<Complex> vecZerosT;
+    std::vector<Complex> vecPolesT;
+
+    switch(type) {
+        case LPF: {
+            for(size_t i = 0; i < vecZeros.size(); ++i) {
+                vecZerosT.push_back(vecZeros[i] * wLow);
+            }
+            for(size_t i = 0; i < vecPoles.size(); ++i) {
+                vecPolesT.push_back(vecPoles[i] * wLow);
+            }
+            dGain *= pow(wLow, iDegree);
+            break;
+        }
+
+        case HPF: {
+            for(size_t i = 0; i < vecZeros.size(); ++i) {
+                vecZerosT.push_back(wLow / vecZeros[i]);
+            }
+            for(size_t i = 0; i < vecPoles.size(); ++i) {
+                vecPolesT.push_back(wLow / vecPoles[i]);
+            }
+            vecZerosT.insert(vecZerosT.end(), iDegree, Complex(0.0, 0.0));
+            dGain *= (productOfDifferences(Complex(0.0, 0.0), vecZeros) / productOfDifferences(Complex(0.0, 0.0), vecPoles)).real();
+            break;
+        }
+
+        case BPF: {
+            double wo = sqrt(wLow * wHigh);
+            double bw = wHigh - wLow;
+
+            for(size_t i = 0; i < vecZeros.size(); ++i) {
+                Complex zLp = vecZeros[i] * bw / 2.0;
+                vecZerosT.push_back(zLp + std::sqrt(zLp*zLp - wo*wo));
+                vecZerosT.push_back(zLp - std::sqrt(zLp*zLp - wo*wo));
+            }
+            for(size_t i = 0; i < vecPoles.size(); ++i) {
+                Complex pLp = vecPoles[i] * bw / 2.0;
+                vecPolesT.push_back(pLp + std::sqrt(pLp*pLp - wo*wo));
+                vecPolesT.push_back(pLp - std::sqrt(pLp*pLp - wo*wo));
+            }
+            vecZerosT.insert(vecZerosT.end(), iDegree, Complex(0.0, 0.0));
+            dGain *= pow(bw, iDegree);
+            break;
+        }
+
+        case NOTCH: {
+            double wo = sqrt(wLow * wHigh);
+            double bw = wHigh - wLow;
+
+            for(size_t i = 0; i < vecZeros.size(); ++i) {
+                Complex zHp = (bw / 2.0) / vecZeros[i];
+                vecZerosT.push_back(zHp + std::sqrt(zHp*zHp - wo*wo));
+                vecZerosT.push_back(zHp - std::sqrt(zHp*zHp - wo*wo));
+            }
+            for(size_t i = 0; i < vecPoles.size(); ++i) {
+                Complex pHp = (bw / 2.0) / vecPoles[i];
+                vecPolesT.push_back(pHp + std::sqrt(pHp*pHp - wo*wo));
+                vecPolesT.push_back(pHp - std::sqrt(pHp*pHp - wo*wo));
+            }
+            vecZerosT.insert(vecZerosT.end(), iDegree, Complex(0.0, wo));
+            vecZerosT.insert(vecZerosT.end(), iDegree, Complex(0.0, -wo));
+            dGain *= (productOfDifferences(Complex(0.0, 0.0), vecZeros) / productOfDifferences(Complex(0.0, 0.0), vecPoles)).real();
+            break;
+        }
+    }
+
+    //Bilinear transform, the zeros at infinity are mapped to the Nyquist frequency
+    std::vector<Complex> vecZerosZ;
+    std::vector<Complex> vecPolesZ;
+
+    for(size_t i = 0; i < vecZerosT.size(); ++i) {
+        vecZerosZ.push_back((fs2 + vecZerosT[i]) / (fs2 - vecZerosT[i]));
+    }
+    for(size_t i = 0; i < vecPolesT.size(); ++i) {
+        vecPolesZ.push_back((fs2 + vecPolesT[i]) / (fs2 - vecPolesT[i]));
+    }
+    vecZerosZ.insert(vecZerosZ.end(), vecPolesT.size() - vecZerosT.size(), Complex(-1.0, 0.0));
+    dGain *= (productOfDifferences(Complex(fs2, 0.0), vecZerosT) / productOfDifferences(Complex(fs2, 0.0), vecPolesT)).real();
+
+    //Group zeros and poles into second-order sections. The pole pairs closest to the unit circle come last.
+    std::vector<Vector3d> vecNum = rootsToPolynomials(vecZerosZ);
+    std::vector<Vector3d> vecDen = rootsToPolynomials(vecPolesZ);
+
+    std::vector<Vector3d>::iterator itFirst = vecDen.begin();
+    if(vecPolesZ.size() % 2 != 0) {
+        ++itFirst;
+    }
+    std::sort(itFirst, vecDen.end(), [](const Vector3d& a, const Vector3d& b) { return a(2) < b(2); });
+
+    m_matSOS.resize(vecDen.size(), 6);
+
+    for(size_t i = 0; i < vecDen.size(); ++i) {
+        m_matSOS.block(i, 0, 1, 3) = vecNum[i].transpose();
+        m_matSOS.block(i, 3, 1, 3) = vecDen[i].transpose();
+    }
+
+    m_matSOS.block(0, 0, 1, 3) *= dGain;
+}
+
+
+//*************************************************************************************************************
+
+void IirFilter::filter(const MatrixXd& matSOS, MatrixXd& matData, MatrixXd& matState, int iNumSamples)
+{
+    IirFilter iirFilter;
+    iirFilter.m_matSOS = matSOS;
+    iirFilter.filter(matData, matState, iNumSamples);
+}
+
+
+//*************************************************************************************************************
+
+void IirFilter::filter(MatrixXd& matData, MatrixXd& matState, int iNumSamples)
+{
+    const int iNumSections = m_matSOS.rows();
+    const int iNumChannels = matData.rows();
+
+    if(iNumSamples < 0 || iNumSamples > matData.cols()) {
+        iNumSamples = matData.cols();
+    }
+
+    if(matState.rows() != iNumChannels || matState.cols() != 2*iNumSections) {
+        matState = MatrixXd::Zero(iNumChannels, 2*iNumSections);
+    }
+
+    //Normalize the sections to a0 = 1, m_matSOS may have been changed since the last block. Resizing to the same
+    //dimensions does not allocate.
+    m_matCoeffs.resize(iNumSections, 5);
+    for(int s = 0; s < iNumSections; ++s) {
+        m_matCoeffs.row(s) << m_matSOS(s,0), m_matSOS(s,1), m_matSOS(s,2), m_matSOS(s,4), m_matSOS(s,5);
+        m_matCoeffs.row(s) /= m_matSOS(s,3);
+    }
+
+    m_vecIn.resize(iNumChannels);
+    m_vecOut.resize(iNumChannels);
+
+    //Direct form II transposed, the recursion runs over the samples while all channels are processed at once
+    for(int t = 0; t < iNumSamples; ++t) {
+        m_vecIn = matData.col(t);
+
+        for(int s = 0; s < iNumSections; ++s) {
+            const double b0 = m_matCoeffs(s,0);
+            const double b1 = m_matCoeffs(s,1);
+            const double b2 = m_matCoeffs(s,2);
+            const double a1 = m_matCoeffs(s,3);
+            const double a2 = m_matCoeffs(s,4);
+
+            m_vecOut = b0 * m_vecIn + matState.col(2*s);
+            matState.col(2*s) = b1 * m_vecIn - a1 * m_vecOut + matState.col(2*s+1);
+            matState.col(2*s+1) = b2 * m_vecIn - a2 * m_vecOut;
+
+            m_vecIn.swap(m_vecOut);
+        }
+
+        matData.col(t) = m_vecIn;
+    }
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXd IirFilter::impulseResponse(const MatrixXd& matSOS, int iLength)
+{
+    MatrixXd matImpulse = MatrixXd::Zero(1, iLength);
+    MatrixXd matState;
+
+    if(iLength > 0) {
+        matImpulse(0,0) = 1.0;
+        filter(matSOS, matImpulse, matState);
+    }
+
+    return matImpulse.row(0);
+}
@@ -0,0 +1,158 @@
+//=============================================================================================================
+/**
+* @file     iirfilter.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the IirFilter class
+*
+*/
+
+#ifndef IIRFILTER_H
+#define IIRFILTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Designs Butterworth and Chebyshev (type I) IIR filters as a cascade of second-order sections. The analog
+* lowpass prototype is transformed to the requested pass type and mapped to the z-plane with the bilinear
+* transform, where the cut off frequencies are prewarped. Compared to the FIR designs the filters have a low
+* delay, which makes them suited for closed-loop applications. The cascade can be applied to streaming
+* multichannel data, the state of each channel is carried over between blocks.
+*
+* @brief Creates IIR filters as second-order sections.
+*/
+class UTILSSHARED_EXPORT IirFilter
+{
+public:
+    enum TPassType {LPF, HPF, BPF, NOTCH };
+
+    enum TDesignType {Butterworth, Chebyshev };
+
+    //=========================================================================================================
+    /**
+    * Constructs an IirFilter object without sections.
+    */
+    IirFilter();
+
+    //=========================================================================================================
+    /**
+    * Constructs an IirFilter object.
+    * OmegaC and BW are normed to the Nyquist frequency. e.g. OmegaC = 0.5 centers a BPF at half the Nyquist frequency.
+    * Bandpass and notch filters have twice the order of the lowpass prototype.
+    *
+    * @param[in] order      order of the analog lowpass prototype (1 - 32)
+    * @param[in] OmegaC     cut off frequency (LPF, HPF) or center frequency (BPF, NOTCH), normed to the Nyquist frequency
+    * @param[in] BW         bandwidth of the pass-/stopband (BPF, NOTCH), normed to the Nyquist frequency
+    * @param[in] type       filter type (lowpass, highpass, etc.)
+    * @param[in] design     Butterworth or Chebyshev (type I) prototype
+    * @param[in] rippleDb   passband ripple in dB, only used for the Chebyshev prototype
+    */
+    IirFilter(int order, double OmegaC, double BW, TPassType type, TDesignType design, double rippleDb = 0.5);
+
+    //=========================================================================================================
+    /**
+    * Filters the rows (channels) of a data block in place with a cascade of second-order sections (direct form II
+    * transposed). The samples of all channels are processed at once, i.e. the recursion runs over the columns of
+    * the block. The state of every channel is read from and written back to matState, so consecutive blocks yield
+    * the same result as filtering the continuous stream. A state of wrong dimension is reset to zero.
+    *
+    * The scratch buffers are allocated per call. Streams should keep an IirFilter and use the member filter instead.
+    *
+    * @param[in] matSOS             the second-order sections, one per row: b0 b1 b2 a0 a1 a2
+    * @param[in, out] matData       the data block (channels x samples)
+    * @param[in, out] matState      the filter state (channels x 2*sections)
+    * @param[in] iNumSamples        the number of leading samples to filter. Defaults to all columns.
+    */
+    static void filter(const MatrixXd& matSOS, MatrixXd& matData, MatrixXd& matState, int iNumSamples = -1);
+
+    //=========================================================================================================
+    /**
+    * Filters the rows (channels) of a data block in place with the sections m_matSOS, see the static filter. The
+    * scratch buffers are members which are only reallocated when the number of channels or sections changes, so
+    * filtering a stream block by block does not allocate.
+    *
+    * @param[in, out] matData       the data block (channels x samples)
+    * @param[in, out] matState      the filter state (channels x 2*sections)
+    * @param[in] iNumSamples        the number of leading samples to filter. Defaults to all columns.
+    */
+    void filter(MatrixXd& matData, MatrixXd& matState, int iNumSamples = -1);
+
+    //=========================================================================================================
+    /**
+    * Computes the impulse response of a cascade of second-order sections.
+    *
+    * @param[in] matSOS     the second-order sections, one per row: b0 b1 b2 a0 a1 a2
+    * @param[in] iLength    the number of samples
+    *
+    * @return the first iLength samples of the impulse response
+    */
+    static RowVectorXd impulseResponse(const MatrixXd& matSOS, int iLength);
+
+    MatrixXd    m_matSOS;       /**< the second-order sections, one per row: b0 b1 b2 a0 a1 a2 with a0 = 1. The overall gain is part of the first section. */
+
+private:
+    MatrixXd    m_matCoeffs;    /**< the sections normalized to a0 = 1, one per row: b0 b1 b2 a1 a2 */
+    VectorXd    m_vecIn;        /**< input of the current section for all channels */
+    VectorXd    m_vecOut;       /**< output of the current section for all channels */
+};
+
+} // NAMESPACE UTILSLIB
+
+#endif // IIRFILTER_H
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "../utils_global.h"
+#include "ringindex.h"
 
 
 //*************************************************************************************************************
@@ -51,7 +52,6 @@
 //=============================================================================================================
 
 #include <QPair>
-#include <QSemaphore>
 #include <QSharedPointer>
 
 
@@ -74,7 +74,7 @@ namespace IOBUFFER
 /**
 * TEMPLATE CIRCULAR BUFFER
 *
-* @brief The TEMPLATE CIRCULAR BUFFER provides a template for thread safe circular buffers.
+* @brief The TEMPLATE CIRCULAR BUFFER provides a template for thread safe, lock-free circular buffers between one producer and one consumer thread.
 */
 template<typename _Tp>
 class CircularBuffer
@@ -124,7 +124,8 @@ public:
 
     //=========================================================================================================
     /**
-    * Clears the buffer.
+    * Consumer: Drops all elements of the buffer. The producer may keep pushing meanwhile, but only the consumer
+    * thread may call clear, or another thread while the consumer is idle (e.g. joined).
     */
     void clear();
 
@@ -136,33 +137,24 @@ public:
 
     //=========================================================================================================
     /**
-    * Releases the circular buffer from the acquire statement in the pop() function.
-    * @param [out] bool returns true if resources were freed so that the aquire statement in the pop function can release, otherwise false.
+    * Releases the consumer from waiting in pop(), which then returns a default constructed value. Has no effect
+    * if the consumer does not wait at the moment.
+    * @param [out] bool returns true if the consumer was waiting, otherwise false.
     */
     inline bool releaseFromPop();
 
     //=========================================================================================================
     /**
-    * Releases the circular buffer from the acquire statement in the push() function.
-    * @param [out] bool returns true if resources were freed so that the aquire statement in the push function can release, otherwise false.
+    * Releases the producer from waiting in push(), the pushed values are dropped. Has no effect if the
+    * producer does not wait at the moment.
+    * @param [out] bool returns true if the producer was waiting, otherwise false.
     */
     inline bool releaseFromPush();
 
 private:
-    //=========================================================================================================
-    /**
-    * Returns the current circular index to the corresponding given index.
-    *
-    * @param [in] index which should be mapped.
-    * @return the mapped index.
-    */
-    inline unsigned int mapIndex(int& index);
     unsigned int    m_uiMaxNumElements;     /**< Holds the maximal number of buffer elements.*/
     _Tp*            m_pBuffer;              /**< Holds the circular buffer.*/
-    int             m_iCurrentReadIndex;    /**< Holds the current read index.*/
-    int             m_iCurrentWriteIndex;   /**< Holds the current write index.*/
-    QSemaphore*     m_pFreeElements;        /**< Holds a semaphore which acquires free elements for thread safe writing. A semaphore is a generalization of a mutex.*/
-    QSemaphore*     m_pUsedElements;        /**< Holds a semaphore which acquires written semaphore for thread safe reading.*/
+    RingIndex       m_ringIndex;            /**< Holds the lock-free read and write position.*/
 
     bool            m_bPause;
 };
@@ -177,10 +169,7 @@ template<typename _Tp>
 CircularBuffer<_Tp>::CircularBuffer(unsigned int uiMaxNumElements)
 : m_uiMaxNumElements(uiMaxNumElements)
 , m_pBuffer(new _Tp[m_uiMaxNumElements])
-, m_iCurrentReadIndex(-1)
-, m_iCurrentWriteIndex(-1)
-, m_pFreeElements(new QSemaphore(m_uiMaxNumElements))
-, m_pUsedElements(new QSemaphore(0))
+, m_ringIndex(uiMaxNumElements)
 , m_bPause(false)
 {
 
@@ -192,8 +181,6 @@ CircularBuffer<_Tp>::CircularBuffer(unsigned int uiMaxNumElements)
 template<typename _Tp>
 CircularBuffer<_Tp>::~CircularBuffer()
 {
-    delete m_pFreeElements;
-    delete m_pUsedElements;
     delete [] m_pBuffer;
 }
 
@@ -205,10 +192,12 @@ inline void CircularBuffer<_Tp>::push(const _Tp* pArray, unsigned int size)
 {
     if(!m_bPause)
     {
-        m_pFreeElements->acquire(size);
-        for(unsigned int i = 0; i < size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pArray[i];
-        m_pUsedElements->release(size);
+        if(m_ringIndex.waitForFree(size)) {
+            unsigned int t_uiWriteIndex = m_ringIndex.writeIndex();
+            for(unsigned int i = 0; i < size; ++i)
+                m_pBuffer[(t_uiWriteIndex + i) % m_uiMaxNumElements] = pArray[i];
+            m_ringIndex.publish(size);
+        }
     }
 }
 
@@ -218,9 +207,10 @@ inline void CircularBuffer<_Tp>::push(const _Tp* pArray, unsigned int size)
 template<typename _Tp>
 inline void CircularBuffer<_Tp>::push(const _Tp& newElement)
 {
-    m_pFreeElements->acquire();
-    m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = newElement;
-    m_pUsedElements->release();
+    if(m_ringIndex.waitForFree()) {
+        m_pBuffer[m_ringIndex.writeIndex()] = newElement;
+        m_ringIndex.publish();
+    }
 }
 
 
@@ -229,42 +219,25 @@ inline void CircularBuffer<_Tp>::push(const _Tp& newElement)
 template<typename _Tp>
 inline _Tp CircularBuffer<_Tp>::pop()
 {
-    _Tp element;
+    _Tp element = _Tp();
     if(!m_bPause)
     {
-        m_pUsedElements->acquire();
-        element = m_pBuffer[mapIndex(m_iCurrentReadIndex)];
-        m_pFreeElements->release();
+        if(m_ringIndex.waitForUsed()) {
+            element = m_pBuffer[m_ringIndex.readIndex()];
+            m_ringIndex.consume();
+        }
     }
-    else
-        element = 0;
 
     return element;
 }
 
 
-//*************************************************************************************************************
-
-template<typename _Tp>
-inline unsigned int CircularBuffer<_Tp>::mapIndex(int& index)
-{
-    int aux = index;
-    return index = ++aux % m_uiMaxNumElements;
-}
-
-
 //*************************************************************************************************************
 
 template<typename _Tp>
 inline void CircularBuffer<_Tp>::clear()
 {
-    delete m_pFreeElements;
-    m_pFreeElements = new QSemaphore(m_uiMaxNumElements);
-    delete m_pUsedElements;
-    m_pUsedElements = new QSemaphore(0);
-
-    m_iCurrentReadIndex = -1;
-    m_iCurrentWriteIndex = -1;
+    m_ringIndex.clear();
 }
 
 
@@ -282,18 +255,8 @@ inline void CircularBuffer<_Tp>::pause(bool bPause)
 template<typename _Tp>
 inline bool CircularBuffer<_Tp>::releaseFromPop()
 {
-    if((uint)m_pUsedElements->available() < 1)
-    {
-        //The last value which is to be popped from the buffer is supposed to be a zero
-        m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pUsedElements so that the pop function can leave the acquire statement in the pop function
-        m_pUsedElements->release(1);
-
-        return true;
-    }
-
-    return false;
+    //A released pop returns a default constructed (zero) value
+    return m_ringIndex.releaseFromPop();
 }
 
 
@@ -302,18 +265,8 @@ inline bool CircularBuffer<_Tp>::releaseFromPop()
 template<typename _Tp>
 inline bool CircularBuffer<_Tp>::releaseFromPush()
 {
-    if((uint)m_pFreeElements->available() < 1)
-    {
-        //The last value which is to be pushed to the buffer is supposed to be a zero
-        m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) value from m_pFreeElements so that the push function can leave the acquire statement in the push function
-        m_pFreeElements->release(1);
-
-        return true;
-    }
-
-    return false;
+    //A released push drops its values
+    return m_ringIndex.releaseFromPush();
 }
 
 
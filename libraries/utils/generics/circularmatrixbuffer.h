@@ -44,6 +44,7 @@
 
 #include "../utils_global.h"
 #include "buffer.h"
+#include "ringindex.h"
 
 
 //*************************************************************************************************************
@@ -68,7 +69,6 @@
 //=============================================================================================================
 
 #include <QPair>
-#include <QSemaphore>
 #include <QSharedPointer>
 #include <stdio.h>
 
@@ -92,7 +92,11 @@ using namespace Eigen;
 
 //=============================================================================================================
 /**
-* Circular Matrix buffer provides a template for thread safe circular matrix buffers.
+* Circular Matrix buffer provides a template for thread safe circular matrix buffers between one producer and
+* one consumer thread. The buffer holds a preallocated pool of uiMaxNumMatrices blocks and is lock-free: pushing
+* and popping a block costs a copy and a few atomic operations, a thread only sleeps if the buffer is full or
+* empty. Besides push and pop, which copy the block, the producer can write into a block of the pool with
+* beginPush/endPush and the consumer can read a block of the pool without copying with beginPop/endPop.
 *
 * @brief The circular matrix buffer
 */
@@ -103,6 +107,8 @@ public:
     typedef QSharedPointer<CircularMatrixBuffer> SPtr;              /**< Shared pointer type for CircularMatrixBuffer. */
     typedef QSharedPointer<const CircularMatrixBuffer> ConstSPtr;   /**< Const shared pointer type for CircularMatrixBuffer. */
 
+    typedef Matrix<_Tp, Dynamic, Dynamic> MatrixT;                  /**< Matrix type of the blocks. */
+
     //=========================================================================================================
     /**
     * Constructs a CircularMatrixBuffer.
@@ -122,7 +128,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Adds a whole matrix at the end buffer.
+    * Adds a whole matrix at the end buffer. Blocks while the buffer is full.
     *
     * @param [in] pMatrix pointer to a Matrix which should be apend to the end.
     */
@@ -130,7 +136,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the first matrix (first in first out).
+    * Returns the first matrix (first in first out). Blocks while the buffer is empty.
     *
     * @return the first matrix
     */
@@ -138,7 +144,70 @@ public:
 
     //=========================================================================================================
     /**
-    * Clears the buffer.
+    * Copies the first matrix (first in first out) to matrix. Blocks while the buffer is empty. In contrast to
+    * pop() no memory is allocated if matrix already has the block dimension.
+    *
+    * @param [out] matrix   the first matrix, a zero matrix if the buffer is paused or released.
+    *
+    * @return true if a matrix was popped, false if the buffer is paused or was released from pop.
+    */
+    inline bool pop(Matrix<_Tp, Dynamic, Dynamic>& matrix);
+
+    //=========================================================================================================
+    /**
+    * Copies the first matrix (first in first out) to matrix if there is one. Never blocks, so the consumer can
+    * wait for several sources at once and only read the buffer when used() reports a matrix.
+    *
+    * @param [out] matrix   the first matrix, unchanged if no matrix was popped.
+    *
+    * @return true if a matrix was popped, false if the buffer is empty or paused.
+    */
+    inline bool tryPop(Matrix<_Tp, Dynamic, Dynamic>& matrix);
+
+    //=========================================================================================================
+    /**
+    * Returns a writable view of the next free block of the pool. Blocks while the buffer is full. The block is
+    * added to the buffer by endPush. Every beginPush has to be followed by exactly one endPush.
+    *
+    * @return view of the block to write to.
+    */
+    inline Map<MatrixT> beginPush();
+
+    //=========================================================================================================
+    /**
+    * Adds the block returned by the preceding beginPush to the buffer.
+    */
+    inline void endPush();
+
+    //=========================================================================================================
+    /**
+    * Returns a read-only view of the first block of the pool (first in first out) without copying it. Blocks
+    * while the buffer is empty. The view is valid until endPop, which hands the block back to the producer.
+    * Every beginPop has to be followed by exactly one endPop.
+    *
+    * @return view of the first block, a view of a zero block if the buffer is paused or released.
+    */
+    inline Map<const MatrixT> beginPop();
+
+    //=========================================================================================================
+    /**
+    * Hands the block returned by the preceding beginPop back to the producer.
+    */
+    inline void endPop();
+
+    //=========================================================================================================
+    /**
+    * Whether the preceding beginPop returned the zero block instead of data, because the buffer is paused or
+    * the consumer was released.
+    *
+    * @return true if the current view of beginPop holds no data.
+    */
+    inline bool poppedZeroBlock() const;
+
+    //=========================================================================================================
+    /**
+    * Consumer: Drops all matrices of the buffer. The producer may keep pushing meanwhile, but only the consumer
+    * thread may call clear, or another thread while the consumer is idle (e.g. joined).
     */
     void clear();
 
@@ -148,6 +217,12 @@ public:
     */
     inline quint32 size() const;
 
+    //=========================================================================================================
+    /**
+    * Number of matrices which can be popped without blocking.
+    */
+    inline quint32 used() const;
+
     //=========================================================================================================
     /**
     * Rows of the stored matrices of the buffer.
@@ -168,37 +243,40 @@ public:
 
     //=========================================================================================================
     /**
-    * Releases the circular buffer from the acquire statement in the pop() function.
-    * @param [out] bool returns true if resources were freed so that the aquire statement in the pop function can release, otherwise false.
+    * Releases the consumer from waiting in pop() or beginPop(), which then return a zero matrix. Has no effect
+    * if the consumer does not wait at the moment.
+    * @param [out] bool returns true if the consumer was waiting for data, otherwise false.
     */
     inline bool releaseFromPop();
 
     //=========================================================================================================
     /**
-    * Releases the circular buffer from the acquire statement in the push() function.
-    * @param [out] bool returns true if resources were freed so that the aquire statement in the push function can release, otherwise false.
+    * Releases the producer from waiting in push() or beginPush(), the pushed matrix is dropped. Has no effect
+    * if the producer does not wait at the moment.
+    * @param [out] bool returns true if the producer was waiting for a free block, otherwise false.
     */
     inline bool releaseFromPush();
 
 private:
     //=========================================================================================================
     /**
-    * Returns the current circular index to the corresponding given index.
+    * Returns a pointer to the first element of a block of the pool.
     *
-    * @param [in] index which should be mapped.
-    * @return the mapped index.
+    * @param [in] uiSlot    the block.
+    * @return the pointer to the block data.
     */
-    inline unsigned int mapIndex(int& index);
+    inline _Tp* slot(quint32 uiSlot) const;
 
     unsigned int    m_uiMaxNumMatrices;         /**< Holds the maximal number of matrices.*/
     unsigned int    m_uiRows;                   /**< Holds the number rows.*/
     unsigned int    m_uiCols;                   /**< Holds the number cols.*/
     unsigned int    m_uiMaxNumElements;         /**< Holds the maximal number of buffer elements.*/
-    _Tp*            m_pBuffer;                  /**< Holds the circular buffer.*/
-    int             m_iCurrentReadIndex;        /**< Holds the current read index.*/
-    int             m_iCurrentWriteIndex;       /**< Holds the current write index.*/
-    QSemaphore*     m_pFreeElements;            /**< Holds a semaphore which acquires free elements for thread safe writing. A semaphore is a generalization of a mutex.*/
-    QSemaphore*     m_pUsedElements;            /**< Holds a semaphore which acquires written semaphore for thread safe reading.*/
+    _Tp*            m_pBuffer;                  /**< Holds the preallocated block pool.*/
+    _Tp*            m_pPushScratch;             /**< Holds one extra block of the producer, written to by a released or paused beginPush.*/
+    _Tp*            m_pZeroBlock;               /**< Holds one zero block of the consumer, read by a released or paused beginPop.*/
+    RingIndex       m_ringIndex;                /**< Holds the lock-free read and write position of the blocks.*/
+    bool            m_bPushToScratch;           /**< Whether the current beginPush writes to the scratch block.*/
+    bool            m_bPopZeroBlock;            /**< Whether the current beginPop reads the zero block.*/
     bool            m_bPause;
 };
 
@@ -216,13 +294,14 @@ CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, u
 , m_uiCols(uiCols)
 , m_uiMaxNumElements(m_uiMaxNumMatrices*m_uiRows*m_uiCols)
 , m_pBuffer(new _Tp[m_uiMaxNumElements])
-, m_iCurrentReadIndex(-1)
-, m_iCurrentWriteIndex(-1)
-, m_pFreeElements(new QSemaphore(m_uiMaxNumElements))
-, m_pUsedElements(new QSemaphore(0))
+, m_pPushScratch(new _Tp[m_uiRows*m_uiCols])
+, m_pZeroBlock(new _Tp[m_uiRows*m_uiCols])
+, m_ringIndex(uiMaxNumMatrices)
+, m_bPushToScratch(false)
+, m_bPopZeroBlock(false)
 , m_bPause(false)
 {
-
+    Map<MatrixT>(m_pZeroBlock, m_uiRows, m_uiCols).setZero();
 }
 
 
@@ -231,8 +310,8 @@ CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, u
 template<typename _Tp>
 CircularMatrixBuffer<_Tp>::~CircularMatrixBuffer()
 {
-    delete m_pFreeElements;
-    delete m_pUsedElements;
+    delete [] m_pZeroBlock;
+    delete [] m_pPushScratch;
     delete [] m_pBuffer;
 }
 
@@ -247,10 +326,10 @@ inline void CircularMatrixBuffer<_Tp>::push(const Matrix<_Tp, Dynamic, Dynamic>*
         unsigned int t_size = pMatrix->size();
         if(t_size == m_uiRows*m_uiCols)
         {
-            m_pFreeElements->acquire(t_size);
-            for(unsigned int i = 0; i < t_size; ++i)
-                m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pMatrix->data()[i];
-            m_pUsedElements->release(t_size);
+            if(m_ringIndex.waitForFree()) {
+                Map<MatrixT>(slot(m_ringIndex.writeIndex()), m_uiRows, m_uiCols) = Map<const MatrixT>(pMatrix->data(), m_uiRows, m_uiCols);
+                m_ringIndex.publish();
+            }
         }
 
         else {
@@ -267,15 +346,7 @@ inline Matrix<_Tp, Dynamic, Dynamic> CircularMatrixBuffer<_Tp>::pop()
 {
     Matrix<_Tp, Dynamic, Dynamic> matrix(m_uiRows, m_uiCols);
 
-    if(!m_bPause)
-    {
-        m_pUsedElements->acquire(m_uiRows*m_uiCols);
-        for(quint32 i = 0; i < m_uiRows*m_uiCols; ++i)
-            matrix.data()[i] = m_pBuffer[mapIndex(m_iCurrentReadIndex)];
-        m_pFreeElements->release(m_uiRows*m_uiCols);
-    }
-    else
-        matrix.setZero();
+    pop(matrix);
 
     return matrix;
 }
@@ -284,27 +355,110 @@ inline Matrix<_Tp, Dynamic, Dynamic> CircularMatrixBuffer<_Tp>::pop()
 //*************************************************************************************************************
 
 template<typename _Tp>
-inline unsigned int CircularMatrixBuffer<_Tp>::mapIndex(int& index)
+inline bool CircularMatrixBuffer<_Tp>::pop(Matrix<_Tp, Dynamic, Dynamic>& matrix)
 {
-    int AuxIndex;
-    AuxIndex = ++index;
-    return index = AuxIndex % m_uiMaxNumElements;
+    matrix.resize(m_uiRows, m_uiCols);
+
+    if(m_bPause || !m_ringIndex.waitForUsed()) {
+        matrix.setZero();
+        return false;
+    }
 
+    matrix = Map<const MatrixT>(slot(m_ringIndex.readIndex()), m_uiRows, m_uiCols);
+    m_ringIndex.consume();
+
+    return true;
 }
 
 
 //*************************************************************************************************************
 
 template<typename _Tp>
-void CircularMatrixBuffer<_Tp>::clear()
+inline bool CircularMatrixBuffer<_Tp>::tryPop(Matrix<_Tp, Dynamic, Dynamic>& matrix)
 {
-    delete m_pFreeElements;
-    m_pFreeElements = new QSemaphore(m_uiMaxNumElements);
-    delete m_pUsedElements;
-    m_pUsedElements = new QSemaphore(0);
+    if(m_bPause || m_ringIndex.used() == 0) {
+        return false;
+    }
+
+    matrix = Map<const MatrixT>(slot(m_ringIndex.readIndex()), m_uiRows, m_uiCols);
+    m_ringIndex.consume();
 
-    m_iCurrentReadIndex = -1;
-    m_iCurrentWriteIndex = -1;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline Map<typename CircularMatrixBuffer<_Tp>::MatrixT> CircularMatrixBuffer<_Tp>::beginPush()
+{
+    m_bPushToScratch = m_bPause || !m_ringIndex.waitForFree();
+
+    return Map<MatrixT>(m_bPushToScratch ? m_pPushScratch : slot(m_ringIndex.writeIndex()), m_uiRows, m_uiCols);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::endPush()
+{
+    if(!m_bPushToScratch) {
+        m_ringIndex.publish();
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline Map<const typename CircularMatrixBuffer<_Tp>::MatrixT> CircularMatrixBuffer<_Tp>::beginPop()
+{
+    m_bPopZeroBlock = m_bPause || !m_ringIndex.waitForUsed();
+
+    if(m_bPopZeroBlock) {
+        return Map<const MatrixT>(m_pZeroBlock, m_uiRows, m_uiCols);
+    }
+
+    return Map<const MatrixT>(slot(m_ringIndex.readIndex()), m_uiRows, m_uiCols);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::endPop()
+{
+    if(!m_bPopZeroBlock) {
+        m_ringIndex.consume();
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool CircularMatrixBuffer<_Tp>::poppedZeroBlock() const
+{
+    return m_bPopZeroBlock;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline _Tp* CircularMatrixBuffer<_Tp>::slot(quint32 uiSlot) const
+{
+    return m_pBuffer + static_cast<size_t>(uiSlot)*m_uiRows*m_uiCols;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void CircularMatrixBuffer<_Tp>::clear()
+{
+    m_ringIndex.clear();
 }
 
 
@@ -317,6 +471,15 @@ inline quint32 CircularMatrixBuffer<_Tp>::size() const
 }
 
 
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 CircularMatrixBuffer<_Tp>::used() const
+{
+    return m_ringIndex.used();
+}
+
+
 //*************************************************************************************************************
 
 template<typename _Tp>
@@ -349,20 +512,7 @@ inline void CircularMatrixBuffer<_Tp>::pause(bool bPause)
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 {
-   if((uint)m_pUsedElements->available() < m_uiRows*m_uiCols)
-    {
-        //The last matrix which is to be popped from the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pUsedElements so that the pop function can leave the acquire statement in the pop function
-        m_pUsedElements->release(m_uiRows*m_uiCols);
-
-        return true;
-    }
-
-    return false;
+    return m_ringIndex.releaseFromPop();
 }
 
 
@@ -371,20 +521,7 @@ inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPush()
 {
-    if((uint)m_pFreeElements->available() < m_uiRows*m_uiCols)
-    {
-        //The last matrix which is to be pushed to the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pFreeElements so that the push function can leave the acquire statement in the push function
-        m_pFreeElements->release(m_uiRows*m_uiCols);
-
-        return true;
-    }
-
-    return false;
+    return m_ringIndex.releaseFromPush();
 }
 
 
@@ -0,0 +1,250 @@
+//=============================================================================================================
+/**
+* @file     ringindex.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RingIndex class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "ringindex.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QThread>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace IOBUFFER;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE LOCAL CONSTANTS
+//=============================================================================================================
+
+namespace
+{
+    const int SPIN_COUNT = 64;          /**< Number of busy checks before a waiting thread yields. */
+    const int YIELD_COUNT = 16;         /**< Number of yields before a waiting thread goes to sleep. */
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RingIndex::RingIndex(quint32 uiCapacity)
+: m_uiCapacity(uiCapacity > 0 ? uiCapacity : 1)
+, m_uiWritten(0)
+, m_uiRead(0)
+, m_iReleasePop(0)
+, m_iReleasePush(0)
+, m_iWaitingPop(0)
+, m_iWaitingPush(0)
+, m_iSleepers(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+bool RingIndex::waitForFree(quint32 uiNum)
+{
+    return waitFor(false, uiNum);
+}
+
+
+//*************************************************************************************************************
+
+void RingIndex::publish(quint32 uiNum)
+{
+    //Only the producer writes m_uiWritten, the ordered store makes the slot data visible before the counter
+    m_uiWritten.fetchAndStoreOrdered((m_uiWritten.loadAcquire() + uiNum) % (2*m_uiCapacity));
+    wakeSleepers();
+}
+
+
+//*************************************************************************************************************
+
+bool RingIndex::waitForUsed(quint32 uiNum)
+{
+    return waitFor(true, uiNum);
+}
+
+
+//*************************************************************************************************************
+
+void RingIndex::consume(quint32 uiNum)
+{
+    //Only the consumer writes m_uiRead
+    m_uiRead.fetchAndStoreOrdered((m_uiRead.loadAcquire() + uiNum) % (2*m_uiCapacity));
+    wakeSleepers();
+}
+
+
+//*************************************************************************************************************
+
+bool RingIndex::releaseFromPop()
+{
+    //Only a wait which has begun is cancelled, a flag set for an idle consumer would cancel a later wait
+    QMutexLocker locker(&m_mutex);
+
+    if(m_iWaitingPop > 0 && used() == 0) {
+        m_iReleasePop.storeRelease(1);
+        m_waitCondition.wakeAll();
+        return true;
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+bool RingIndex::releaseFromPush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(m_iWaitingPush > 0 && free() == 0) {
+        m_iReleasePush.storeRelease(1);
+        m_waitCondition.wakeAll();
+        return true;
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+void RingIndex::clear()
+{
+    //Storing 0 into both counters would mix with a concurrent publish, consuming keeps used() <= capacity
+    consume(used());
+
+    QMutexLocker locker(&m_mutex);
+
+    Q_ASSERT(m_iWaitingPop == 0);
+
+    //A producer which is still returning from a released wait resets its flag itself
+    m_iReleasePop.storeRelease(0);
+    if(m_iWaitingPush == 0) {
+        m_iReleasePush.storeRelease(0);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RingIndex::wakeSleepers()
+{
+    //The read-modify-write orders this check after the counter update, hence either the sleeper sees the new
+    //counter before it goes to sleep or we see the sleeper and wake it up.
+    if(m_iSleepers.fetchAndAddOrdered(0) > 0) {
+        QMutexLocker locker(&m_mutex);
+        m_waitCondition.wakeAll();
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool RingIndex::waitFor(bool bConsumer, quint32 uiNum)
+{
+    if((bConsumer ? used() : free()) >= uiNum) {
+        return true;
+    }
+
+    QAtomicInt& iRelease = bConsumer ? m_iReleasePop : m_iReleasePush;
+    int& iWaiting = bConsumer ? m_iWaitingPop : m_iWaitingPush;
+
+    //Register the wait, only from now on a release can cancel it
+    m_mutex.lock();
+    ++iWaiting;
+    m_mutex.unlock();
+
+    bool bAvailable = true;
+    bool bDone = false;
+
+    //Spin and yield first, a block usually arrives within a few microseconds in a running pipeline
+    for(int i = 0; i < SPIN_COUNT + YIELD_COUNT; ++i) {
+        if((bConsumer ? used() : free()) >= uiNum) {
+            bDone = true;
+            break;
+        }
+
+        if(iRelease.loadAcquire() != 0) {
+            bAvailable = false;
+            bDone = true;
+            break;
+        }
+
+        if(i >= SPIN_COUNT) {
+            QThread::yieldCurrentThread();
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    if(!bDone) {
+        m_iSleepers.fetchAndAddOrdered(1);
+
+        while((bConsumer ? used() : free()) < uiNum) {
+            if(iRelease.loadAcquire() != 0) {
+                bAvailable = false;
+                break;
+            }
+
+            m_waitCondition.wait(&m_mutex);
+        }
+
+        m_iSleepers.fetchAndAddOrdered(-1);
+    }
+
+    //A release which came together with the slots is dropped as well, it must not cancel a later wait
+    --iWaiting;
+    iRelease.storeRelease(0);
+
+    return bAvailable;
+}
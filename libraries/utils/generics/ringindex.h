@@ -0,0 +1,266 @@
+//=============================================================================================================
+/**
+* @file     ringindex.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RingIndex class declaration.
+*
+*/
+
+#ifndef RINGINDEX_H
+#define RINGINDEX_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE IOBUFFER
+//=============================================================================================================
+
+namespace IOBUFFER
+{
+
+
+//=============================================================================================================
+/**
+* Lock-free bookkeeping of a single-producer/single-consumer ring of slots. The producer and the consumer
+* each advance their own counter modulo twice the capacity, the number of readable slots is the difference of
+* both. Waiting for slots spins shortly and only then goes to sleep on a wait condition. Publishing or
+* consuming slots takes the mutex only if the other side is actually sleeping, so the common case costs a few
+* atomic operations.
+*
+* Exactly one thread may call the producer functions (waitForFree, publish, writeIndex) and exactly one thread
+* the consumer functions (waitForUsed, consume, readIndex) at a time.
+*
+* @brief Lock-free single-producer/single-consumer ring buffer index.
+*/
+class UTILSSHARED_EXPORT RingIndex
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a RingIndex.
+    *
+    * @param [in] uiCapacity    Number of slots of the ring.
+    */
+    explicit RingIndex(quint32 uiCapacity);
+
+    //=========================================================================================================
+    /**
+    * Producer: Waits until uiNum slots are free.
+    *
+    * @param [in] uiNum     Number of slots to wait for.
+    *
+    * @return true if the slots are free, false if the wait was cancelled by releaseFromPush.
+    */
+    bool waitForFree(quint32 uiNum = 1);
+
+    //=========================================================================================================
+    /**
+    * Producer: Makes the next uiNum written slots readable and wakes up a sleeping consumer.
+    *
+    * @param [in] uiNum     Number of slots to publish.
+    */
+    void publish(quint32 uiNum = 1);
+
+    //=========================================================================================================
+    /**
+    * Consumer: Waits until uiNum slots are readable.
+    *
+    * @param [in] uiNum     Number of slots to wait for.
+    *
+    * @return true if the slots are readable, false if the wait was cancelled by releaseFromPop.
+    */
+    bool waitForUsed(quint32 uiNum = 1);
+
+    //=========================================================================================================
+    /**
+    * Consumer: Frees the next uiNum read slots and wakes up a sleeping producer.
+    *
+    * @param [in] uiNum     Number of slots to free.
+    */
+    void consume(quint32 uiNum = 1);
+
+    //=========================================================================================================
+    /**
+    * Cancels the wait of the consumer if it is spinning or sleeping because there are no readable slots. Nothing
+    * is kept for later waits, so a release while the consumer is busy has no effect.
+    *
+    * @return true if the consumer wait was cancelled, false if the consumer is not waiting or there are readable slots.
+    */
+    bool releaseFromPop();
+
+    //=========================================================================================================
+    /**
+    * Cancels the wait of the producer if it is spinning or sleeping because there are no free slots. Nothing is
+    * kept for later waits, so a release while the producer is busy has no effect.
+    *
+    * @return true if the producer wait was cancelled, false if the producer is not waiting or there are free slots.
+    */
+    bool releaseFromPush();
+
+    //=========================================================================================================
+    /**
+    * Consumer: Drops all readable slots and resets both release flags. Only the read counter advances, so the
+    * producer may keep publishing meanwhile. Call it from the consumer thread or while the consumer is idle,
+    * i.e. neither in a wait nor reading a slot, e.g. after its thread was joined.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of readable slots.
+    *
+    * @return the number of readable slots.
+    */
+    inline quint32 used() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of slots which can be written.
+    *
+    * @return the number of free slots.
+    */
+    inline quint32 free() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of slots of the ring.
+    *
+    * @return the capacity.
+    */
+    inline quint32 capacity() const;
+
+    //=========================================================================================================
+    /**
+    * Producer: Returns the slot which is written next.
+    *
+    * @return the write slot.
+    */
+    inline quint32 writeIndex() const;
+
+    //=========================================================================================================
+    /**
+    * Consumer: Returns the slot which is read next.
+    *
+    * @return the read slot.
+    */
+    inline quint32 readIndex() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Wakes up all sleeping threads, if there are any.
+    */
+    void wakeSleepers();
+
+    //=========================================================================================================
+    /**
+    * Spins and sleeps until the counter condition holds or the wait is cancelled.
+    *
+    * @param [in] bConsumer     Whether the consumer waits for readable slots or the producer for free slots.
+    * @param [in] uiNum         Number of slots to wait for.
+    *
+    * @return true if the condition holds, false if the wait was cancelled.
+    */
+    bool waitFor(bool bConsumer, quint32 uiNum);
+
+    quint32                     m_uiCapacity;       /**< Number of slots. */
+    QAtomicInteger<quint32>     m_uiWritten;        /**< Number of slots published by the producer, modulo 2*m_uiCapacity. */
+    QAtomicInteger<quint32>     m_uiRead;           /**< Number of slots consumed by the consumer, modulo 2*m_uiCapacity. */
+    QAtomicInt                  m_iReleasePop;      /**< Set by releaseFromPop, cancels the current consumer wait. */
+    QAtomicInt                  m_iReleasePush;     /**< Set by releaseFromPush, cancels the current producer wait. */
+    int                         m_iWaitingPop;      /**< Number of consumer waits which spin or sleep, guarded by m_mutex. */
+    int                         m_iWaitingPush;     /**< Number of producer waits which spin or sleep, guarded by m_mutex. */
+    QAtomicInt                  m_iSleepers;        /**< Number of threads sleeping on m_waitCondition. */
+    QMutex                      m_mutex;            /**< Guards the sleeping phase of the waits and the release flags. */
+    QWaitCondition              m_waitCondition;    /**< Wakes up sleeping threads. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline quint32 RingIndex::used() const
+{
+    return (m_uiWritten.loadAcquire() + 2*m_uiCapacity - m_uiRead.loadAcquire()) % (2*m_uiCapacity);
+}
+
+
+//*************************************************************************************************************
+
+inline quint32 RingIndex::free() const
+{
+    return m_uiCapacity - used();
+}
+
+
+//*************************************************************************************************************
+
+inline quint32 RingIndex::capacity() const
+{
+    return m_uiCapacity;
+}
+
+
+//*************************************************************************************************************
+
+inline quint32 RingIndex::writeIndex() const
+{
+    return m_uiWritten.loadAcquire() % m_uiCapacity;
+}
+
+
+//*************************************************************************************************************
+
+inline quint32 RingIndex::readIndex() const
+{
+    return m_uiRead.loadAcquire() % m_uiCapacity;
+}
+
+} // NAMESPACE
+
+#endif // RINGINDEX_H
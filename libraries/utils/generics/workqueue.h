@@ -0,0 +1,262 @@
+//=============================================================================================================
+/**
+* @file     workqueue.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    WorkQueue class declaration.
+*
+*/
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE IOBUFFER
+//=============================================================================================================
+
+namespace IOBUFFER
+{
+
+
+//=============================================================================================================
+/**
+* TEMPLATE WORK QUEUE
+*
+* Hands work items from any number of producer threads to a worker thread. The worker sleeps on a wait
+* condition in pop() until an item arrives, so an idle worker does not use any CPU time. If a maximal number
+* of pending items is set, pushing onto a full queue drops the oldest pending item. This coalesces requests
+* which became stale because a newer one arrived before the worker got to them, e.g. noise covariances of
+* which only the latest one is of interest.
+*
+* @brief The TEMPLATE WORK QUEUE provides a blocking, coalescing and cancelable queue for worker threads.
+*/
+template<typename _Tp>
+class WorkQueue
+{
+public:
+    typedef QSharedPointer<WorkQueue> SPtr;              /**< Shared pointer type for WorkQueue. */
+    typedef QSharedPointer<const WorkQueue> ConstSPtr;   /**< Const shared pointer type for WorkQueue. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a WorkQueue.
+    *
+    * @param [in] iMaxPending   Maximal number of pending items, older items are dropped. 0 for no limit.
+    */
+    explicit WorkQueue(int iMaxPending = 0);
+
+    //=========================================================================================================
+    /**
+    * Appends an item and wakes up the worker.
+    *
+    * @param [in] item      The work item.
+    *
+    * @return the number of stale items which were dropped to make room for the new one.
+    */
+    inline int push(const _Tp& item);
+
+    //=========================================================================================================
+    /**
+    * Takes the oldest pending item. Blocks until an item is available or the wait is released.
+    *
+    * @param [out] item     The work item, untouched if no item was taken.
+    *
+    * @return true if an item was taken, false if the wait was released by releaseFromPop.
+    */
+    inline bool pop(_Tp& item);
+
+    //=========================================================================================================
+    /**
+    * Takes the oldest pending item without blocking.
+    *
+    * @param [out] item     The work item, untouched if no item was taken.
+    *
+    * @return true if an item was taken, false if the queue is empty.
+    */
+    inline bool tryPop(_Tp& item);
+
+    //=========================================================================================================
+    /**
+    * Releases the worker from its next (or current) wait in pop(), which then returns false regardless of the
+    * pending items. Used to cancel the worker, e.g. before joining its thread.
+    */
+    inline void releaseFromPop();
+
+    //=========================================================================================================
+    /**
+    * Drops all pending items and a not yet consumed release.
+    */
+    inline void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of pending items.
+    *
+    * @return the number of pending items.
+    */
+    inline int size() const;
+
+private:
+    mutable QMutex  m_mutex;            /**< Serializes the access to the pending items. */
+    QWaitCondition  m_waitCondition;    /**< The worker sleeps on this condition until an item arrives. */
+    QList<_Tp>      m_listItems;        /**< The pending items, oldest first. */
+    int             m_iMaxPending;      /**< Maximal number of pending items, 0 for no limit. */
+    bool            m_bRelease;         /**< Whether the next wait in pop() is released. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+WorkQueue<_Tp>::WorkQueue(int iMaxPending)
+: m_iMaxPending(iMaxPending)
+, m_bRelease(false)
+{
+
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline int WorkQueue<_Tp>::push(const _Tp& item)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int iDropped = 0;
+    if(m_iMaxPending > 0) {
+        while(m_listItems.size() >= m_iMaxPending) {
+            m_listItems.removeFirst();
+            ++iDropped;
+        }
+    }
+
+    m_listItems.append(item);
+    m_waitCondition.wakeOne();
+
+    return iDropped;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool WorkQueue<_Tp>::pop(_Tp& item)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while(!m_bRelease && m_listItems.isEmpty())
+        m_waitCondition.wait(&m_mutex);
+
+    if(m_bRelease) {
+        m_bRelease = false;
+        return false;
+    }
+
+    item = m_listItems.takeFirst();
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool WorkQueue<_Tp>::tryPop(_Tp& item)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(m_listItems.isEmpty())
+        return false;
+
+    item = m_listItems.takeFirst();
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void WorkQueue<_Tp>::releaseFromPop()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_bRelease = true;
+    m_waitCondition.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void WorkQueue<_Tp>::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_listItems.clear();
+    m_bRelease = false;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline int WorkQueue<_Tp>::size() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_listItems.size();
+}
+
+} // NAMESPACE
+
+#endif // WORKQUEUE_H
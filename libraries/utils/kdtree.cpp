@@ -0,0 +1,268 @@
+//=============================================================================================================
+/**
+* @file     kdtree.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    KdTree class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "kdtree.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent/QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define KDTREE_QUERY_BLOCK 256      /**< Number of query points handled by one task of the batched queries. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+KdTree::KdTree(const MatrixX3f& matPoints, int iLeafSize)
+: m_iLeafSize(std::max(iLeafSize, 1))
+, m_vecIndex(VectorXi::LinSpaced(matPoints.rows(), 0, matPoints.rows() - 1))
+{
+    if(matPoints.rows() == 0) {
+        m_vecIndex.resize(0);
+        return;
+    }
+
+    m_vecNodes.reserve(2 * (matPoints.rows() / m_iLeafSize + 1));
+    build(matPoints, 0, matPoints.rows());
+
+    //Store the points in tree order so that the leaves are contiguous
+    m_matPoints.resize(matPoints.rows(), 3);
+    for(int i = 0; i < m_vecIndex.size(); ++i) {
+        m_matPoints.row(i) = matPoints.row(m_vecIndex[i]);
+    }
+}
+
+
+//*************************************************************************************************************
+
+int KdTree::nearest(const Vector3f& vecPoint, float* pDist) const
+{
+    VectorXi vecIdx;
+    VectorXf vecDist;
+
+    knn(vecPoint, 1, vecIdx, vecDist);
+
+    if(vecIdx.size() == 0) {
+        return -1;
+    }
+
+    if(pDist) {
+        *pDist = vecDist[0];
+    }
+
+    return vecIdx[0];
+}
+
+
+//*************************************************************************************************************
+
+void KdTree::knn(const Vector3f& vecPoint,
+                 int k,
+                 VectorXi& vecIdx,
+                 VectorXf& vecDist) const
+{
+    k = std::min(k, size());
+
+    if(k <= 0) {
+        vecIdx.resize(0);
+        vecDist.resize(0);
+        return;
+    }
+
+    QVector<QPair<float,int> > vecHeap;
+    vecHeap.reserve(k);
+
+    search(0, vecPoint, k, vecHeap);
+
+    std::sort_heap(vecHeap.begin(), vecHeap.end());
+
+    vecIdx.resize(vecHeap.size());
+    vecDist.resize(vecHeap.size());
+    for(int i = 0; i < vecHeap.size(); ++i) {
+        vecIdx[i] = m_vecIndex[vecHeap[i].second];
+        vecDist[i] = std::sqrt(vecHeap[i].first);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void KdTree::knn(const MatrixX3f& matPoints,
+                 int k,
+                 MatrixXi& matIdx,
+                 MatrixXf& matDist) const
+{
+    k = std::max(std::min(k, size()), 0);
+
+    matIdx.resize(matPoints.rows(), k);
+    matDist.resize(matPoints.rows(), k);
+
+    QVector<int> vecBlocks;
+    for(int i = 0; i < matPoints.rows(); i += KDTREE_QUERY_BLOCK) {
+        vecBlocks.append(i);
+    }
+
+    QtConcurrent::blockingMap(vecBlocks, [&](const int& iStart) {
+        VectorXi vecIdx;
+        VectorXf vecDist;
+        const int iEnd = std::min(iStart + KDTREE_QUERY_BLOCK, static_cast<int>(matPoints.rows()));
+
+        for(int i = iStart; i < iEnd; ++i) {
+            knn(matPoints.row(i).transpose(), k, vecIdx, vecDist);
+            matIdx.row(i) = vecIdx.transpose();
+            matDist.row(i) = vecDist.transpose();
+        }
+    });
+}
+
+
+//*************************************************************************************************************
+
+int KdTree::build(const MatrixX3f& matPoints, int iBegin, int iEnd)
+{
+    Node node;
+    node.iBegin = iBegin;
+    node.iEnd = iEnd;
+    node.iLeft = -1;
+    node.iRight = -1;
+    node.iAxis = 0;
+    node.fSplit = 0.0f;
+
+    const int iNode = m_vecNodes.size();
+    m_vecNodes.append(node);
+
+    if(iEnd - iBegin <= m_iLeafSize) {
+        return iNode;
+    }
+
+    //Split at the median along the axis of largest extent
+    int* pIdx = m_vecIndex.data();
+    Vector3f vecMin = matPoints.row(pIdx[iBegin]).transpose();
+    Vector3f vecMax = vecMin;
+    for(int i = iBegin + 1; i < iEnd; ++i) {
+        vecMin = vecMin.cwiseMin(matPoints.row(pIdx[i]).transpose());
+        vecMax = vecMax.cwiseMax(matPoints.row(pIdx[i]).transpose());
+    }
+
+    int iAxis;
+    (vecMax - vecMin).maxCoeff(&iAxis);
+
+    const int iMid = (iBegin + iEnd) / 2;
+    std::nth_element(pIdx + iBegin, pIdx + iMid, pIdx + iEnd, [&matPoints, iAxis](int a, int b) {
+        return matPoints(a, iAxis) < matPoints(b, iAxis);
+    });
+
+    //Set the split before the children reorder their points
+    m_vecNodes[iNode].iAxis = iAxis;
+    m_vecNodes[iNode].fSplit = matPoints(pIdx[iMid], iAxis);
+
+    const int iLeft = build(matPoints, iBegin, iMid);
+    const int iRight = build(matPoints, iMid, iEnd);
+
+    m_vecNodes[iNode].iLeft = iLeft;
+    m_vecNodes[iNode].iRight = iRight;
+
+    return iNode;
+}
+
+
+//*************************************************************************************************************
+
+void KdTree::search(int iNode,
+                    const Vector3f& vecPoint,
+                    int k,
+                    QVector<QPair<float,int> >& vecHeap) const
+{
+    const Node& node = m_vecNodes[iNode];
+
+    if(node.iLeft < 0) {
+        for(int i = node.iBegin; i < node.iEnd; ++i) {
+            const float fDist2 = (m_matPoints.row(i).transpose() - vecPoint).squaredNorm();
+
+            if(vecHeap.size() < k) {
+                vecHeap.append(qMakePair(fDist2, i));
+                std::push_heap(vecHeap.begin(), vecHeap.end());
+            } else if(fDist2 < vecHeap.first().first) {
+                std::pop_heap(vecHeap.begin(), vecHeap.end());
+                vecHeap.last() = qMakePair(fDist2, i);
+                std::push_heap(vecHeap.begin(), vecHeap.end());
+            }
+        }
+        return;
+    }
+
+    //Descend into the side of the query point first, the other side only if it can still hold a closer point
+    const float fDiff = vecPoint[node.iAxis] - node.fSplit;
+
+    search(fDiff <= 0.0f ? node.iLeft : node.iRight, vecPoint, k, vecHeap);
+
+    if(vecHeap.size() < k || fDiff * fDiff < vecHeap.first().first) {
+        search(fDiff <= 0.0f ? node.iRight : node.iLeft, vecPoint, k, vecHeap);
+    }
+}
@@ -0,0 +1,191 @@
+//=============================================================================================================
+/**
+* @file     kdtree.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    KdTree class declaration.
+*
+*/
+
+#ifndef KDTREE_H
+#define KDTREE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* A k-d tree over a fixed set of 3D points. The tree is built once by median splits along the axis of largest
+* extent and answers nearest neighbor and k nearest neighbor queries in O(log n) per query. The tree is
+* read-only after construction, so it can be queried from several threads at the same time.
+*
+* @brief 3D k-d tree for nearest neighbor queries
+*/
+class UTILSSHARED_EXPORT KdTree
+{
+public:
+
+    //=========================================================================================================
+    /**
+    * Builds the k-d tree.
+    *
+    * @param[in] matPoints      n x 3 matrix of the points to index.
+    * @param[in] iLeafSize      Maximal number of points in a leaf.
+    */
+    KdTree(const Eigen::MatrixX3f& matPoints, int iLeafSize = 8);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of indexed points.
+    *
+    * @return the number of points.
+    */
+    inline int size() const;
+
+    //=========================================================================================================
+    /**
+    * Finds the point closest to a given position.
+    *
+    * @param[in] vecPoint   The query position.
+    * @param[out] pDist     The euclidean distance to the closest point (optional).
+    *
+    * @return the index of the closest point, -1 if the tree is empty.
+    */
+    int nearest(const Eigen::Vector3f& vecPoint, float* pDist = Q_NULLPTR) const;
+
+    //=========================================================================================================
+    /**
+    * Finds the k points closest to a given position, sorted by increasing distance.
+    *
+    * @param[in] vecPoint   The query position.
+    * @param[in] k          The number of neighbors.
+    * @param[out] vecIdx    The indices of the neighbors (min(k, size()) entries).
+    * @param[out] vecDist   The euclidean distances of the neighbors.
+    */
+    void knn(const Eigen::Vector3f& vecPoint,
+             int k,
+             Eigen::VectorXi& vecIdx,
+             Eigen::VectorXf& vecDist) const;
+
+    //=========================================================================================================
+    /**
+    * Finds the k closest points for each row of a matrix of query positions. The queries are distributed
+    * over all cores.
+    *
+    * @param[in] matPoints  m x 3 matrix of query positions.
+    * @param[in] k          The number of neighbors.
+    * @param[out] matIdx    m x min(k, size()) matrix of the neighbor indices, sorted by increasing distance.
+    * @param[out] matDist   m x min(k, size()) matrix of the euclidean distances of the neighbors.
+    */
+    void knn(const Eigen::MatrixX3f& matPoints,
+             int k,
+             Eigen::MatrixXi& matIdx,
+             Eigen::MatrixXf& matDist) const;
+
+private:
+    /**
+    * A node of the tree. Inner nodes split their points at fSplit along iAxis, leaves hold the points
+    * [iBegin, iEnd) of the reordered point matrix.
+    */
+    struct Node {
+        int     iBegin;     /**< First point of the node. */
+        int     iEnd;       /**< One past the last point of the node. */
+        int     iLeft;      /**< Left child (coordinates <= fSplit), -1 for leaves. */
+        int     iRight;     /**< Right child (coordinates >= fSplit), -1 for leaves. */
+        int     iAxis;      /**< Split axis. */
+        float   fSplit;     /**< Split coordinate. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Recursively builds the subtree of the points [iBegin, iEnd).
+    *
+    * @return the index of the subtree's root node.
+    */
+    int build(const Eigen::MatrixX3f& matPoints, int iBegin, int iEnd);
+
+    //=========================================================================================================
+    /**
+    * Recursively searches the subtree of iNode. The k best candidates are kept as a max heap ordered by the
+    * squared distance.
+    */
+    void search(int iNode,
+                const Eigen::Vector3f& vecPoint,
+                int k,
+                QVector<QPair<float,int> >& vecHeap) const;
+
+    int                 m_iLeafSize;    /**< Maximal number of points in a leaf. */
+    QVector<Node>       m_vecNodes;     /**< The tree nodes, the root is node 0. */
+    Eigen::MatrixX3f    m_matPoints;    /**< The points in tree order. */
+    Eigen::VectorXi     m_vecIndex;     /**< Original index of each point in tree order. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int KdTree::size() const
+{
+    return m_vecIndex.size();
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // KDTREE_H
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "fixdictmp.h"
+#include "../fftservice.h"
 
 
 //*************************************************************************************************************
@@ -61,7 +62,6 @@
 //=============================================================================================================
 
 #include <Eigen/SparseCore>
-#include <unsupported/Eigen/FFT>
 
 
 //*************************************************************************************************************
@@ -291,9 +291,12 @@ FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_re
     if(boost == 0 || channel_count == 0)
         channel_count = 1;
 
-    Eigen::FFT<double> fft;
     std::ptrdiff_t max_index;
-    VectorXcd fft_atom = VectorXcd::Zero(current_resid.rows());
+    VectorXcd fft_atom;
+
+    //transform the observed channels once - they are the same for all atoms
+    MatrixXcd fft_signals;
+    FFTService::fwd(fft_signals, current_resid.leftCols(channel_count).transpose());
 
     FixDictAtom best_matching;
     qreal max_scalar_product = 0;
@@ -320,21 +323,15 @@ FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_re
         norm = fitted_atom.norm();
         if(norm != 0) fitted_atom /= norm;
 
-        fft.fwd(fft_atom, fitted_atom);
+        FFTService::fwd(fft_atom, fitted_atom);
 
         for(qint32 chn = 0; chn < channel_count; chn++)
         {
             p = floor(current_resid.rows() / 2);//translation
-            VectorXd corr_coeffs = VectorXd::Zero(current_resid.rows());
-            VectorXcd fft_signal = VectorXcd::Zero(current_resid.rows());
-            VectorXcd fft_sig_atom = VectorXcd::Zero(current_resid.rows());
-
-            fft.fwd(fft_signal, current_resid.col(chn));
-
-            for( qint32 m = 0; m < current_resid.rows(); m++)
-                fft_sig_atom[m] = fft_signal[m] * conj(fft_atom[m]);
+            VectorXd corr_coeffs;
+            VectorXcd fft_sig_atom = fft_signals.row(chn).transpose().cwiseProduct(fft_atom.conjugate());
 
-            fft.inv(corr_coeffs, fft_sig_atom);
+            FFTService::inv(corr_coeffs, fft_sig_atom, current_resid.rows());
 
             //find index of maximum correlation-coefficient to use in translation
             max_scalar_product = corr_coeffs.maxCoeff(&max_index);
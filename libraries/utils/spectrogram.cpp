@@ -38,6 +38,7 @@
 //=============================================================================================================
 
 #include "spectrogram.h"
+#include "fftservice.h"
 #include "math.h"
 
 
@@ -47,7 +48,6 @@
 //=============================================================================================================
 
 #include <Eigen/SparseCore>
-#include <unsupported/Eigen/FFT>
 
 
 //*************************************************************************************************************
@@ -84,7 +84,6 @@ MatrixXd Spectrogram::make_spectrogram(VectorXd signal, qint32 window_size = 0)
     if(window_size == 0)
         window_size = signal.rows()/4;
 
-    Eigen::FFT<double> fft;
     MatrixXd tf_matrix = MatrixXd::Zero(signal.rows()/2, signal.rows());
 
     for(qint32 translate = 0; translate < signal.rows(); translate++)
@@ -92,14 +91,14 @@ MatrixXd Spectrogram::make_spectrogram(VectorXd signal, qint32 window_size = 0)
         VectorXd envelope = gauss_window(signal.rows(), window_size, translate);
 
         VectorXd windowed_sig = VectorXd::Zero(signal.rows());
-        VectorXcd fft_win_sig = VectorXcd::Zero(signal.rows());
+        VectorXcd fft_win_sig;
 
         VectorXd real_coeffs = VectorXd::Zero(signal.rows()/2);
 
         for(qint32 sample = 0; sample < signal.rows(); sample++)
             windowed_sig[sample] = signal[sample] * envelope[sample];
 
-        fft.fwd(fft_win_sig, windowed_sig);
+        FFTService::fwd(fft_win_sig, windowed_sig);
 
         for(qint32 i= 0; i<signal.rows()/2; i++)
         {
@@ -0,0 +1,449 @@
+//=============================================================================================================
+/**
+* @file     trianglebvh.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    TriangleBvh class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "trianglebvh.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent/QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define TRIANGLEBVH_QUERY_BLOCK 256     /**< Number of query points handled by one task of the batched queries. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+TriangleBvh::TriangleBvh(const MatrixX3f& matVertices, const MatrixX3i& matTris, int iLeafSize)
+: m_iLeafSize(std::max(iLeafSize, 1))
+, m_vecIndex(VectorXi::LinSpaced(matTris.rows(), 0, matTris.rows() - 1))
+{
+    const int iNumTris = matTris.rows();
+
+    if(iNumTris == 0) {
+        m_vecIndex.resize(0);
+        return;
+    }
+
+    m_matA.resize(iNumTris, 3);
+    m_matB.resize(iNumTris, 3);
+    m_matC.resize(iNumTris, 3);
+    for(int i = 0; i < iNumTris; ++i) {
+        m_matA.row(i) = matVertices.row(matTris(i, 0));
+        m_matB.row(i) = matVertices.row(matTris(i, 1));
+        m_matC.row(i) = matVertices.row(matTris(i, 2));
+    }
+
+    MatrixX3f matCentroids = (m_matA + m_matB + m_matC) / 3.0f;
+
+    m_vecNodes.reserve(2 * (iNumTris / m_iLeafSize + 1));
+    build(matCentroids, 0, iNumTris);
+
+    //Store the triangles in hierarchy order so that the leaves are contiguous
+    MatrixX3f matA = m_matA, matB = m_matB, matC = m_matC;
+    for(int i = 0; i < iNumTris; ++i) {
+        m_matA.row(i) = matA.row(m_vecIndex[i]);
+        m_matB.row(i) = matB.row(m_vecIndex[i]);
+        m_matC.row(i) = matC.row(m_vecIndex[i]);
+    }
+}
+
+
+//*************************************************************************************************************
+
+int TriangleBvh::closestTriangle(const Vector3f& vecPoint,
+                                 Vector3f& vecClosest,
+                                 float& fDist) const
+{
+    if(size() == 0) {
+        return -1;
+    }
+
+    int iBest = -1;
+    float fBestDist2 = std::numeric_limits<float>::max();
+
+    searchClosest(0, vecPoint, iBest, vecClosest, fBestDist2);
+
+    fDist = std::sqrt(fBestDist2);
+
+    return m_vecIndex[iBest];
+}
+
+
+//*************************************************************************************************************
+
+void TriangleBvh::closestTriangles(const MatrixX3f& matPoints,
+                                   VectorXi& vecTris,
+                                   MatrixX3f& matClosest,
+                                   VectorXf& vecDist) const
+{
+    vecTris.resize(matPoints.rows());
+    matClosest.resize(matPoints.rows(), 3);
+    vecDist.resize(matPoints.rows());
+
+    QVector<int> vecBlocks;
+    for(int i = 0; i < matPoints.rows(); i += TRIANGLEBVH_QUERY_BLOCK) {
+        vecBlocks.append(i);
+    }
+
+    QtConcurrent::blockingMap(vecBlocks, [&](const int& iStart) {
+        Vector3f vecClosest;
+        float fDist;
+        const int iEnd = std::min(iStart + TRIANGLEBVH_QUERY_BLOCK, static_cast<int>(matPoints.rows()));
+
+        for(int i = iStart; i < iEnd; ++i) {
+            vecTris[i] = closestTriangle(matPoints.row(i).transpose(), vecClosest, fDist);
+            matClosest.row(i) = vecClosest.transpose();
+            vecDist[i] = fDist;
+        }
+    });
+}
+
+
+//*************************************************************************************************************
+
+void TriangleBvh::trianglesWithin(const Vector3f& vecPoint,
+                                  float fRadius,
+                                  QVector<int>& vecTris) const
+{
+    vecTris.clear();
+
+    if(size() == 0 || fRadius < 0.0f) {
+        return;
+    }
+
+    const float fRadius2 = fRadius * fRadius;
+
+    QVector<int> vecStack;
+    vecStack.append(0);
+
+    while(!vecStack.isEmpty()) {
+        const Node& node = m_vecNodes[vecStack.takeLast()];
+
+        if(node.box.squaredExteriorDistance(vecPoint) > fRadius2) {
+            continue;
+        }
+
+        if(node.iLeft < 0) {
+            for(int i = node.iBegin; i < node.iEnd; ++i) {
+                if((closestPoint(i, vecPoint) - vecPoint).squaredNorm() <= fRadius2) {
+                    vecTris.append(m_vecIndex[i]);
+                }
+            }
+        } else {
+            vecStack.append(node.iLeft);
+            vecStack.append(node.iRight);
+        }
+    }
+
+    std::sort(vecTris.begin(), vecTris.end());
+}
+
+
+//*************************************************************************************************************
+
+bool TriangleBvh::windingNumber(const Vector3f& vecPoint,
+                                int& iWinding) const
+{
+    //Directions which are unlikely to be aligned with the edges of a regular triangulation
+    static const double dDirs[3][3] = {{ 0.5377, 0.3912, 0.7470},
+                                       {-0.6219, 0.7032, 0.3447},
+                                       { 0.2854,-0.5591, 0.7784}};
+
+    iWinding = 0;
+    if(size() == 0) {
+        return true;
+    }
+
+    for(int i = 0; i < 3; ++i) {
+        if(rayCrossings(vecPoint, Vector3d(dDirs[i][0], dDirs[i][1], dDirs[i][2]).normalized(), iWinding)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+Vector3f TriangleBvh::closestPointOnTriangle(const Vector3f& vecPoint,
+                                             const Vector3f& vecA,
+                                             const Vector3f& vecB,
+                                             const Vector3f& vecC)
+{
+    //Voronoi region test, see Ericson, Real-Time Collision Detection, 5.1.5
+    const Vector3f ab = vecB - vecA;
+    const Vector3f ac = vecC - vecA;
+    const Vector3f ap = vecPoint - vecA;
+
+    const float d1 = ab.dot(ap);
+    const float d2 = ac.dot(ap);
+    if(d1 <= 0.0f && d2 <= 0.0f) {
+        return vecA;
+    }
+
+    const Vector3f bp = vecPoint - vecB;
+    const float d3 = ab.dot(bp);
+    const float d4 = ac.dot(bp);
+    if(d3 >= 0.0f && d4 <= d3) {
+        return vecB;
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        return vecA + ab * (d1 / (d1 - d3));
+    }
+
+    const Vector3f cp = vecPoint - vecC;
+    const float d5 = ab.dot(cp);
+    const float d6 = ac.dot(cp);
+    if(d6 >= 0.0f && d5 <= d6) {
+        return vecC;
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        return vecA + ac * (d2 / (d2 - d6));
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return vecB + (vecC - vecB) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    //Inside the face
+    const float denom = 1.0f / (va + vb + vc);
+    return vecA + ab * (vb * denom) + ac * (vc * denom);
+}
+
+
+//*************************************************************************************************************
+
+int TriangleBvh::build(const MatrixX3f& matCentroids, int iBegin, int iEnd)
+{
+    int* pIdx = m_vecIndex.data();
+
+    Node node;
+    node.box.setEmpty();
+    for(int i = iBegin; i < iEnd; ++i) {
+        node.box.extend(Vector3f(m_matA.row(pIdx[i]).transpose()));
+        node.box.extend(Vector3f(m_matB.row(pIdx[i]).transpose()));
+        node.box.extend(Vector3f(m_matC.row(pIdx[i]).transpose()));
+    }
+    node.iBegin = iBegin;
+    node.iEnd = iEnd;
+    node.iLeft = -1;
+    node.iRight = -1;
+
+    const int iNode = m_vecNodes.size();
+    m_vecNodes.append(node);
+
+    if(iEnd - iBegin <= m_iLeafSize) {
+        return iNode;
+    }
+
+    //Split at the median centroid along the axis of largest extent
+    int iAxis;
+    node.box.sizes().maxCoeff(&iAxis);
+
+    const int iMid = (iBegin + iEnd) / 2;
+    std::nth_element(pIdx + iBegin, pIdx + iMid, pIdx + iEnd, [&matCentroids, iAxis](int a, int b) {
+        return matCentroids(a, iAxis) < matCentroids(b, iAxis);
+    });
+
+    const int iLeft = build(matCentroids, iBegin, iMid);
+    const int iRight = build(matCentroids, iMid, iEnd);
+
+    m_vecNodes[iNode].iLeft = iLeft;
+    m_vecNodes[iNode].iRight = iRight;
+
+    return iNode;
+}
+
+
+//*************************************************************************************************************
+
+bool TriangleBvh::rayCrossings(const Vector3f& vecOrigin,
+                               const Vector3d& vecDir,
+                               int& iCrossings) const
+{
+    const Vector3d vecO = vecOrigin.cast<double>();
+    const Vector3d vecInvDir = vecDir.cwiseInverse();
+    const double dEps = 1e-6;
+    const double dDistEps = 1e-6 * m_vecNodes[0].box.diagonal().norm();
+
+    int iCount = 0;
+
+    QVector<int> vecStack;
+    vecStack.append(0);
+
+    while(!vecStack.isEmpty()) {
+        const Node& node = m_vecNodes[vecStack.takeLast()];
+
+        //Slab test against the slightly enlarged box
+        const Vector3d vecT1 = (node.box.min().cast<double>() - vecO).array() * vecInvDir.array() - dDistEps * vecInvDir.array().abs();
+        const Vector3d vecT2 = (node.box.max().cast<double>() - vecO).array() * vecInvDir.array() + dDistEps * vecInvDir.array().abs();
+        const double dTNear = vecT1.cwiseMin(vecT2).maxCoeff();
+        const double dTFar = vecT1.cwiseMax(vecT2).minCoeff();
+
+        if(dTFar < std::max(dTNear, 0.0)) {
+            continue;
+        }
+
+        if(node.iLeft >= 0) {
+            vecStack.append(node.iLeft);
+            vecStack.append(node.iRight);
+            continue;
+        }
+
+        //Moeller-Trumbore intersection
+        for(int i = node.iBegin; i < node.iEnd; ++i) {
+            const Vector3d vecA = m_matA.row(i).transpose().cast<double>();
+            const Vector3d vecE1 = m_matB.row(i).transpose().cast<double>() - vecA;
+            const Vector3d vecE2 = m_matC.row(i).transpose().cast<double>() - vecA;
+
+            const Vector3d vecP = vecDir.cross(vecE2);
+            const double dDet = vecE1.dot(vecP);
+            if(std::fabs(dDet) <= 1e-12 * vecE1.norm() * vecE2.norm()) {
+                //The ray is parallel to the triangle, it can only graze it
+                continue;
+            }
+
+            const Vector3d vecS = vecO - vecA;
+            const double dU = vecS.dot(vecP) / dDet;
+            if(dU < -dEps || dU > 1.0 + dEps) {
+                continue;
+            }
+
+            const Vector3d vecQ = vecS.cross(vecE1);
+            const double dV = vecDir.dot(vecQ) / dDet;
+            if(dV < -dEps || dU + dV > 1.0 + dEps) {
+                continue;
+            }
+
+            const double dT = vecE2.dot(vecQ) / dDet;
+            if(dT < -dDistEps) {
+                continue;
+            }
+
+            if(dT <= dDistEps || dU < dEps || dV < dEps || dU + dV > 1.0 - dEps) {
+                return false;
+            }
+
+            //Leaving through a triangle which faces away from the origin counts positive
+            iCount += dDet < 0.0 ? 1 : -1;
+        }
+    }
+
+    iCrossings = iCount;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void TriangleBvh::searchClosest(int iNode,
+                                const Vector3f& vecPoint,
+                                int& iBest,
+                                Vector3f& vecBest,
+                                float& fBestDist2) const
+{
+    const Node& node = m_vecNodes[iNode];
+
+    if(node.iLeft < 0) {
+        for(int i = node.iBegin; i < node.iEnd; ++i) {
+            const Vector3f vecClosest = closestPoint(i, vecPoint);
+            const float fDist2 = (vecClosest - vecPoint).squaredNorm();
+
+            if(iBest < 0 || fDist2 < fBestDist2) {
+                iBest = i;
+                vecBest = vecClosest;
+                fBestDist2 = fDist2;
+            }
+        }
+        return;
+    }
+
+    //Visit the closer child first, the other one only if its box can still hold a closer triangle
+    const float fDistLeft2 = m_vecNodes[node.iLeft].box.squaredExteriorDistance(vecPoint);
+    const float fDistRight2 = m_vecNodes[node.iRight].box.squaredExteriorDistance(vecPoint);
+
+    const int iNear = fDistLeft2 <= fDistRight2 ? node.iLeft : node.iRight;
+    const int iFar = fDistLeft2 <= fDistRight2 ? node.iRight : node.iLeft;
+    const float fFarDist2 = std::max(fDistLeft2, fDistRight2);
+
+    if(iBest < 0 || std::min(fDistLeft2, fDistRight2) < fBestDist2) {
+        searchClosest(iNear, vecPoint, iBest, vecBest, fBestDist2);
+    }
+    if(iBest < 0 || fFarDist2 < fBestDist2) {
+        searchClosest(iFar, vecPoint, iBest, vecBest, fBestDist2);
+    }
+}
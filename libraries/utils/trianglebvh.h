@@ -0,0 +1,250 @@
+//=============================================================================================================
+/**
+* @file     trianglebvh.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    TriangleBvh class declaration.
+*
+*/
+
+#ifndef TRIANGLEBVH_H
+#define TRIANGLEBVH_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* A bounding volume hierarchy of axis aligned boxes over the triangles of a surface. It answers closest
+* triangle and radius queries in O(log n) per query. The hierarchy is read-only after construction, so it
+* can be queried from several threads at the same time.
+*
+* @brief Bounding volume hierarchy for closest point queries on triangulated surfaces
+*/
+class UTILSSHARED_EXPORT TriangleBvh
+{
+public:
+
+    //=========================================================================================================
+    /**
+    * Builds the bounding volume hierarchy.
+    *
+    * @param[in] matVertices    n x 3 matrix of the vertex positions.
+    * @param[in] matTris        m x 3 matrix of the vertex indices of the triangles.
+    * @param[in] iLeafSize      Maximal number of triangles in a leaf.
+    */
+    TriangleBvh(const Eigen::MatrixX3f& matVertices, const Eigen::MatrixX3i& matTris, int iLeafSize = 4);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of indexed triangles.
+    *
+    * @return the number of triangles.
+    */
+    inline int size() const;
+
+    //=========================================================================================================
+    /**
+    * Finds the triangle closest to a given position.
+    *
+    * @param[in] vecPoint       The query position.
+    * @param[out] vecClosest    The closest point on the surface.
+    * @param[out] fDist         The euclidean distance to the closest point.
+    *
+    * @return the index of the closest triangle, -1 if there are no triangles.
+    */
+    int closestTriangle(const Eigen::Vector3f& vecPoint,
+                        Eigen::Vector3f& vecClosest,
+                        float& fDist) const;
+
+    //=========================================================================================================
+    /**
+    * Finds the closest triangle for each row of a matrix of query positions. The queries are distributed
+    * over all cores.
+    *
+    * @param[in] matPoints      m x 3 matrix of query positions.
+    * @param[out] vecTris       The indices of the closest triangles.
+    * @param[out] matClosest    m x 3 matrix of the closest points on the surface.
+    * @param[out] vecDist       The euclidean distances to the closest points.
+    */
+    void closestTriangles(const Eigen::MatrixX3f& matPoints,
+                          Eigen::VectorXi& vecTris,
+                          Eigen::MatrixX3f& matClosest,
+                          Eigen::VectorXf& vecDist) const;
+
+    //=========================================================================================================
+    /**
+    * Collects all triangles which are not farther away from a given position than a radius.
+    *
+    * @param[in] vecPoint       The query position.
+    * @param[in] fRadius        The radius.
+    * @param[out] vecTris       The indices of the triangles in increasing order.
+    */
+    void trianglesWithin(const Eigen::Vector3f& vecPoint,
+                         float fRadius,
+                         QVector<int>& vecTris) const;
+
+    //=========================================================================================================
+    /**
+    * Calculates the winding number of the surface around a given position by counting the signed crossings
+    * of a ray with the triangles. For a closed surface this equals the total solid angle of the triangles
+    * seen from the position divided by 4 pi, i.e. 1 inside and 0 outside of a surface whose triangles are
+    * ordered counter-clockwise when seen from outside. Rays grazing an edge or a vertex are retried in
+    * another direction.
+    *
+    * @param[in] vecPoint       The query position.
+    * @param[out] iWinding      The winding number.
+    *
+    * @return false if the winding number could not be determined, e.g. because the position lies on the surface.
+    */
+    bool windingNumber(const Eigen::Vector3f& vecPoint,
+                       int& iWinding) const;
+
+    //=========================================================================================================
+    /**
+    * Calculates the point of a triangle closest to a given position.
+    *
+    * @param[in] vecPoint   The query position.
+    * @param[in] vecA       First corner of the triangle.
+    * @param[in] vecB       Second corner of the triangle.
+    * @param[in] vecC       Third corner of the triangle.
+    *
+    * @return the closest point of the triangle.
+    */
+    static Eigen::Vector3f closestPointOnTriangle(const Eigen::Vector3f& vecPoint,
+                                                  const Eigen::Vector3f& vecA,
+                                                  const Eigen::Vector3f& vecB,
+                                                  const Eigen::Vector3f& vecC);
+
+private:
+    /**
+    * A node of the hierarchy. Leaves hold the triangles [iBegin, iEnd) in hierarchy order.
+    */
+    struct Node {
+        Eigen::AlignedBox3f box;    /**< Bounding box of all triangles of the node. */
+        int     iBegin;             /**< First triangle of the node. */
+        int     iEnd;               /**< One past the last triangle of the node. */
+        int     iLeft;              /**< Left child, -1 for leaves. */
+        int     iRight;             /**< Right child, -1 for leaves. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Recursively builds the subtree of the triangles [iBegin, iEnd).
+    *
+    * @return the index of the subtree's root node.
+    */
+    int build(const Eigen::MatrixX3f& matCentroids, int iBegin, int iEnd);
+
+    //=========================================================================================================
+    /**
+    * Recursively searches the subtree of iNode for a triangle closer than fBestDist2 (squared distance).
+    */
+    void searchClosest(int iNode,
+                       const Eigen::Vector3f& vecPoint,
+                       int& iBest,
+                       Eigen::Vector3f& vecBest,
+                       float& fBestDist2) const;
+
+    //=========================================================================================================
+    /**
+    * Counts the signed crossings of the ray vecOrigin + t * vecDir, t > 0, with the triangles.
+    *
+    * @return false if the ray passes too close to an edge or a vertex, or if vecOrigin lies on the surface.
+    */
+    bool rayCrossings(const Eigen::Vector3f& vecOrigin,
+                      const Eigen::Vector3d& vecDir,
+                      int& iCrossings) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the point of the triangle at position i in hierarchy order closest to vecPoint.
+    */
+    inline Eigen::Vector3f closestPoint(int i, const Eigen::Vector3f& vecPoint) const;
+
+    int                 m_iLeafSize;    /**< Maximal number of triangles in a leaf. */
+    QVector<Node>       m_vecNodes;     /**< The hierarchy nodes, the root is node 0. */
+    Eigen::MatrixX3f    m_matA;         /**< First corners of the triangles in hierarchy order. */
+    Eigen::MatrixX3f    m_matB;         /**< Second corners of the triangles in hierarchy order. */
+    Eigen::MatrixX3f    m_matC;         /**< Third corners of the triangles in hierarchy order. */
+    Eigen::VectorXi     m_vecIndex;     /**< Original index of each triangle in hierarchy order. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int TriangleBvh::size() const
+{
+    return m_vecIndex.size();
+}
+
+
+//*************************************************************************************************************
+
+inline Eigen::Vector3f TriangleBvh::closestPoint(int i, const Eigen::Vector3f& vecPoint) const
+{
+    return closestPointOnTriangle(vecPoint, m_matA.row(i).transpose(), m_matB.row(i).transpose(), m_matC.row(i).transpose());
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // TRIANGLEBVH_H
@@ -83,16 +83,21 @@ SOURCES += \
     mp/fixdictmp.cpp \
     selectionio.cpp \
     filterTools/cosinefilter.cpp \
+    filterTools/iirfilter.cpp \
     filterTools/parksmcclellan.cpp \
     filterTools/filterdata.cpp \
     filterTools/filterio.cpp \
     detecttrigger.cpp \
     spectrogram.cpp \
+    fftservice.cpp \
     warp.cpp \
     filterTools/sphara.cpp \
     sphere.cpp \
+    kdtree.cpp \
+    trianglebvh.cpp \
     generics/buffer.cpp \
     generics/circularbuffer.cpp \
+    generics/ringindex.cpp \
     generics/circularmatrixbuffer.cpp \
     generics/observerpattern.cpp
 
@@ -110,17 +115,23 @@ HEADERS += \
     selectionio.h \
     layoutmaker.h \
     filterTools/cosinefilter.h \
+    filterTools/iirfilter.h \
     filterTools/parksmcclellan.h \
     filterTools/filterdata.h \
     filterTools/filterio.h \
     detecttrigger.h \
     spectrogram.h \
+    fftservice.h \
     warp.h \
     filterTools/sphara.h \
     sphere.h \
+    kdtree.h \
+    trianglebvh.h \
     simplex_algorithm.h \
     generics/buffer.h \
     generics/circularbuffer.h \
+    generics/ringindex.h \
+    generics/workqueue.h \
     generics/circularbuffer_old.h \
     generics/circularmatrixbuffer.h \
     generics/circularmultichannelbuffer_old.h \
@@ -41,6 +41,10 @@
 
 #include <inverse/dipoleFit/dipole_fit_settings.h>
 #include <inverse/dipoleFit/dipole_fit.h>
+#include <inverse/dipoleFit/dipole_fit_data.h>
+#include <inverse/dipoleFit/guess_data.h>
+#include <inverse/c/mne_meas_data.h>
+#include <inverse/c/mne_meas_data_set.h>
 
 
 //*************************************************************************************************************
@@ -51,12 +55,29 @@
 #include <QtTest>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
 using namespace INVERSELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// TYPEDEFS
+//=============================================================================================================
+
+typedef Matrix<float,Dynamic,Dynamic,RowMajor> MatrixXfRowMajor;
 
 
 //=============================================================================================================
@@ -77,13 +98,23 @@ private slots:
     void initTestCase();
     void dipoleFitSimple();
     void dipoleFitAdvanced();
+    void dipoleFitParallel();
+    void findBestGuessBatch();
+    void dipoleFitGradient();
     void cleanupTestCase();
 
 private:
     void compareFit();
+    void compareDipoles(const ECD& dip, const ECD& refDip, float tol);
+    float** dataRows(MatrixXfRowMajor& matData, QVector<float*>& rows);
 
     double epsilon;
 
+    DipoleFitData*      m_pFitData;     /**< Fit data of the advanced setup, shared by the fit comparisons */
+    GuessData*          m_pGuess;       /**< The initial guesses of the advanced setup */
+    QVector<float>      m_times;        /**< Time points of m_matData */
+    MatrixXfRowMajor    m_matData;      /**< The evoked data between 150 and 250 ms (time x channel) */
+
     ECDSet m_ECDSet;
     ECDSet m_refECDSet;
 };
@@ -93,6 +124,8 @@ private:
 
 TestDipoleFit::TestDipoleFit()
 : epsilon(0.000001)
+, m_pFitData(NULL)
+, m_pGuess(NULL)
 {
 }
 
@@ -101,7 +134,58 @@ TestDipoleFit::TestDipoleFit()
 
 void TestDipoleFit::initTestCase()
 {
+    //*********************************************************************************************************
+    // Set up the fit data of dipoleFitAdvanced for the comparisons of the fitting stages
+    //*********************************************************************************************************
 
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Setup Fit Data >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QString measName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif");
+    QString bemName(QDir::currentPath()+"/mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif");
+    QString mriName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/all-trans.fif");
+    QString noiseName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif");
+    QVERIFY( QFile::exists(measName) && QFile::exists(bemName) && QFile::exists(mriName) && QFile::exists(noiseName) );
+
+    DipoleFitSettings settings;
+    settings.measname = measName;
+    settings.bemname = bemName;
+    settings.mriname = mriName;
+    settings.noisename = noiseName;
+    settings.projnames.append(measName);
+    settings.include_meg = true;
+    settings.include_eeg = false;
+    settings.guess_mindist = 0.0f;
+    settings.guess_rad = 0.1f;
+
+    m_pFitData = DipoleFitData::setup_dipole_fit_data(settings.mriname,settings.measname,settings.bemname,
+                                                      &settings.r0,NULL,settings.accurate,
+                                                      settings.badname,settings.noisename,
+                                                      settings.grad_std,settings.mag_std,settings.eeg_std,
+                                                      settings.mag_reg,settings.grad_reg,settings.eeg_reg,
+                                                      settings.diagnoise,settings.projnames,settings.include_meg,settings.include_eeg);
+    QVERIFY( m_pFitData != NULL );
+
+    MneMeasData* data = MneMeasData::mne_read_meas_data(settings.measname,1,NULL,NULL,m_pFitData->ch_names,m_pFitData->nmeg+m_pFitData->neeg);
+    QVERIFY( data != NULL );
+    QVERIFY( DipoleFitData::scale_noise_cov(m_pFitData,data->current->nave) == 0 );
+
+    m_pGuess = new GuessData(settings.guessname,settings.guess_surfname,settings.guess_mindist,settings.guess_exclude,settings.guess_grid,m_pFitData);
+    QVERIFY( m_pGuess->nguess > 0 );
+
+    //Every sample between 150 and 250 ms, enough to have several blocks in fit_dipoles_parallel
+    m_matData.resize(0,data->nchan);
+    for (int s = 0; s < data->current->np; ++s) {
+        float time = data->current->tmin + s*data->current->tstep;
+        if (time < 0.15f || time > 0.25f)
+            continue;
+        m_matData.conservativeResize(m_times.size()+1,data->nchan);
+        m_matData.row(m_times.size()) = Map<RowVectorXf>(data->current->data[s],data->nchan);
+        m_times.append(time);
+    }
+    QVERIFY( m_times.size() > 1 );
+    delete data;
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Setup Fit Data Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
 }
 
 
@@ -273,6 +357,144 @@ void TestDipoleFit::dipoleFitAdvanced()
 }
 
 
+//*************************************************************************************************************
+
+void TestDipoleFit::dipoleFitParallel()
+{
+    //*********************************************************************************************************
+    // Fit all time points with fit_dipoles_parallel and one at a time with fit_one
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compare Parallel and Serial Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QVector<float*> rows;
+    MatrixXfRowMajor matData = m_matData;
+    ECDSet set;
+    QVERIFY( DipoleFit::fit_dipoles_parallel(m_pFitData,m_pGuess,m_times,dataRows(matData,rows),false,false,set) == 0 );
+
+    ECDSet refSet;
+    matData = m_matData;
+    dataRows(matData,rows);
+    for (int t = 0; t < m_times.size(); ++t) {
+        ECD dip;
+        if (DipoleFitData::fit_one(m_pFitData,m_pGuess,m_times[t],rows[t],false,dip))
+            refSet.addEcd(dip);
+    }
+
+    //The same starting points give the same simplex iterations
+    QVERIFY( set.size() == refSet.size() );
+    for (int i = 0; i < refSet.size(); ++i)
+        compareDipoles(set[i],refSet[i],1e-5f);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compare Parallel and Serial Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestDipoleFit::findBestGuessBatch()
+{
+    //*********************************************************************************************************
+    // Search the initial guesses with the packed guess basis and with the per-guess loop
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compare Batched and Per-Point Guess Search >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    int nB = m_times.size();
+    QVERIFY( m_pGuess->guess_basis.cols() == 3*m_pGuess->nguess );
+
+    QVector<float*> rows;
+    QVector<int> best(nB), refBest(nB);
+    QVector<float> good(nB), refGood(nB);
+
+    MatrixXfRowMajor matData = m_matData;
+    QVERIFY( DipoleFitData::find_best_guesses(m_pFitData,m_pGuess,dataRows(matData,rows),nB,best.data(),good.data()) == 0 );
+
+    //Without the packed basis find_best_guesses falls back to the loop over the guess forward solutions
+    MatrixXf matBasis = m_pGuess->guess_basis;
+    m_pGuess->guess_basis.resize(0,0);
+    matData = m_matData;
+    int result = DipoleFitData::find_best_guesses(m_pFitData,m_pGuess,dataRows(matData,rows),nB,refBest.data(),refGood.data());
+    m_pGuess->guess_basis = matBasis;
+    QVERIFY( result == 0 );
+
+    for (int j = 0; j < nB; ++j) {
+        printf("t = %7.1f ms : batched guess %d (%6.2f %%) per-point guess %d (%6.2f %%)\n",
+               1000*m_times[j],best[j],100*good[j],refBest[j],100*refGood[j]);
+        QVERIFY( best[j] == refBest[j] );
+        QVERIFY( std::fabs(good[j] - refGood[j]) < 1e-4f );
+    }
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compare Batched and Per-Point Guess Search Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestDipoleFit::dipoleFitGradient()
+{
+    //*********************************************************************************************************
+    // Fit all time points with the simplex and with the gradient optimizer (--gradfit)
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compare Gradient and Simplex Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QVector<float*> rows;
+    MatrixXfRowMajor matData = m_matData;
+    ECDSet refSet;
+    m_pFitData->fit_gradient = false;
+    QVERIFY( DipoleFit::fit_dipoles_parallel(m_pFitData,m_pGuess,m_times,dataRows(matData,rows),false,false,refSet) == 0 );
+
+    matData = m_matData;
+    ECDSet set;
+    m_pFitData->fit_gradient = true;
+    int result = DipoleFit::fit_dipoles_parallel(m_pFitData,m_pGuess,m_times,dataRows(matData,rows),false,false,set);
+    m_pFitData->fit_gradient = false;
+    QVERIFY( result == 0 );
+
+    QVERIFY( set.size() == refSet.size() );
+    for (int i = 0; i < refSet.size(); ++i) {
+        printf("t = %7.1f ms : gradient %8.2f %8.2f %8.2f %6.1f %% (%3d evals) simplex %8.2f %8.2f %8.2f %6.1f %% (%3d evals)\n",
+               1000*set[i].time,
+               1000*set[i].rd[0],1000*set[i].rd[1],1000*set[i].rd[2],100*set[i].good,set[i].neval,
+               1000*refSet[i].rd[0],1000*refSet[i].rd[1],1000*refSet[i].rd[2],100*refSet[i].good,refSet[i].neval);
+        QVERIFY( set[i].valid && refSet[i].valid );
+        QVERIFY( std::fabs(set[i].time - refSet[i].time) < epsilon );
+        //The simplex stops within its tolerances (0.2 mm, 1 % relative), the gradient fit must not be worse
+        QVERIFY( set[i].good > refSet[i].good - 1e-3f );
+        QVERIFY( std::fabs(set[i].good - refSet[i].good) < 1e-2f );
+        //Both find the same minimum where the data are explained well, weak fields have flat minima
+        if (refSet[i].good > 0.7f)
+            QVERIFY( (set[i].rd - refSet[i].rd).norm() < 1e-3f );
+    }
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compare Gradient and Simplex Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestDipoleFit::compareDipoles(const ECD& dip, const ECD& refDip, float tol)
+{
+    QVERIFY( dip.valid == refDip.valid );
+    QVERIFY( std::fabs(dip.time - refDip.time) < epsilon );
+    QVERIFY( (dip.rd - refDip.rd).norm() < tol );
+    QVERIFY( (dip.Q - refDip.Q).norm() <= tol*refDip.Q.norm() );
+    QVERIFY( std::fabs(dip.good - refDip.good) < tol );
+}
+
+
+//*************************************************************************************************************
+
+float** TestDipoleFit::dataRows(MatrixXfRowMajor& matData, QVector<float*>& rows)
+{
+    rows.resize(matData.rows());
+    for (int t = 0; t < matData.rows(); ++t)
+        rows[t] = matData.row(t).data();
+    return rows.data();
+}
+
+
 //*************************************************************************************************************
 
 void TestDipoleFit::compareFit()
@@ -314,6 +536,8 @@ void TestDipoleFit::compareFit()
 
 void TestDipoleFit::cleanupTestCase()
 {
+    delete m_pGuess;
+    delete m_pFitData;
 }
 
 
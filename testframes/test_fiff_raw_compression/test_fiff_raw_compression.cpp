@@ -0,0 +1,447 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_raw_compression.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for writing and reading losslessly compressed fiff raw buffers
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffRawCompression
+*
+* @brief The TestFiffRawCompression class writes raw buffers with the lossless compression enabled, reads them
+* back and verifies that the data are restored bit exactly
+*
+*/
+class TestFiffRawCompression: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffRawCompression();
+
+private slots:
+    void initTestCase();
+    void compareIntegerChannels();
+    void compareFloatChannels();
+    void compareSelectionWindow();
+    void compareConcurrentBuffer();
+    void compareSampleDataSize();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+    * Fills a buffer with the test patterns: integer valued channels (incl. values next to the int32 limits),
+    * smooth float channels, float channels with special values and channels with random bit patterns.
+    */
+    MatrixXf generateBuffer(qint32 p_iNChan, qint32 p_iNSamp, quint32 p_iSeed) const;
+
+    //=========================================================================================================
+    /**
+    * True if the read data equal the written data (calibration 1) bit exactly, NaNs only have to be NaNs.
+    */
+    bool compareBits(const MatrixXd& p_matRead, const MatrixXf& p_matWritten, const RowVectorXi& p_vecSel, qint32 p_iFirstSamp) const;
+
+    //=========================================================================================================
+    /**
+    * Writes the buffers to a raw file and returns the size of the file, -1 if a buffer could not be written.
+    */
+    qint64 writeSampleData(QFile& p_file, const FiffInfo& p_info, bool p_bCompressed, const QList<MatrixXd>& p_qListBuffers) const;
+
+    QFile m_fileOut;                /**< The compressed test file */
+
+    qint32 m_iNChan;                /**< Number of channels */
+    MatrixXf m_matWritten;          /**< All written samples (channels x samples) */
+    RowVectorXi m_vecIntChannels;   /**< Integer valued channels */
+    RowVectorXi m_vecFloatChannels; /**< Float channels */
+
+    FiffRawData m_raw;              /**< The compressed file opened for reading, reads from m_fileOut */
+};
+
+
+//*************************************************************************************************************
+
+TestFiffRawCompression::TestFiffRawCompression()
+: m_fileOut("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_compressed_out.fif")
+, m_iNChan(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXf TestFiffRawCompression::generateBuffer(qint32 p_iNChan, qint32 p_iNSamp, quint32 p_iSeed) const
+{
+    const float t_fSpecial[] = { -0.0f,
+                                 0.0f,
+                                 std::numeric_limits<float>::quiet_NaN(),
+                                 std::numeric_limits<float>::infinity(),
+                                 -std::numeric_limits<float>::infinity(),
+                                 std::numeric_limits<float>::max(),
+                                 -std::numeric_limits<float>::max(),
+                                 std::numeric_limits<float>::denorm_min(),
+                                 1.0e30f,
+                                 -3.5e-38f,
+                                 2147483648.0f,
+                                 0.5f };
+    const qint32 t_iNSpecial = sizeof(t_fSpecial)/sizeof(float);
+
+    MatrixXf t_matBuffer(p_iNChan, p_iNSamp);
+    quint32 t_iState = p_iSeed;
+
+    for(qint32 c = 0; c < p_iNChan; ++c) {
+        for(qint32 s = 0; s < p_iNSamp; ++s) {
+            //Linear congruential generator, the test is reproducible on all platforms
+            t_iState = 1664525u*t_iState + 1013904223u;
+
+            float t_fValue;
+            switch(c % 4) {
+                case 0:
+                    //Converter counts; the extremes make the order 2 prediction wrap around
+                    if(s % 50 == 7)
+                        t_fValue = (s/50) % 2 ? 2147483520.0f : -2147483520.0f;
+                    else
+                        t_fValue = (float)((qint32)(t_iState >> 8) - (1 << 23));
+                    break;
+                case 1:
+                    t_fValue = 1.0e-12f*std::sin(0.01f*s + c) + 1.0e-15f*(float)(t_iState >> 16);
+                    break;
+                case 2:
+                    t_fValue = s % 3 == 0 ? t_fSpecial[(s/3 + c) % t_iNSpecial] : 1.0e-11f*(float)(qint32)t_iState;
+                    break;
+                default: {
+                    //Random bit patterns take the escape path of the Rice coder, NaN patterns are replaced
+                    quint32 t_iBits = t_iState ^ (t_iState << 13);
+                    std::memcpy(&t_fValue, &t_iBits, sizeof(float));
+                    if(std::isnan(t_fValue))
+                        t_fValue = 1.0f;
+                    break;
+                }
+            }
+            t_matBuffer(c, s) = t_fValue;
+        }
+    }
+
+    return t_matBuffer;
+}
+
+
+//*************************************************************************************************************
+
+bool TestFiffRawCompression::compareBits(const MatrixXd& p_matRead,
+                                         const MatrixXf& p_matWritten,
+                                         const RowVectorXi& p_vecSel,
+                                         qint32 p_iFirstSamp) const
+{
+    qint32 t_iNRows = p_vecSel.size() > 0 ? p_vecSel.size() : p_matWritten.rows();
+
+    if(p_matRead.rows() != t_iNRows || p_iFirstSamp + p_matRead.cols() > p_matWritten.cols())
+        return false;
+
+    for(qint32 r = 0; r < t_iNRows; ++r) {
+        qint32 c = p_vecSel.size() > 0 ? p_vecSel[r] : r;
+        for(qint32 s = 0; s < p_matRead.cols(); ++s) {
+            double t_dExpected = 1.0*(double)p_matWritten(c, p_iFirstSamp + s);
+            double t_dRead = p_matRead(r, s);
+
+            if(std::isnan(t_dExpected) && std::isnan(t_dRead))
+                continue;
+
+            if(std::memcmp(&t_dExpected, &t_dRead, sizeof(double)) != 0) {
+                printf("Mismatch at channel %d sample %d: %g != %g\n", c, p_iFirstSamp + s, t_dRead, t_dExpected);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint64 TestFiffRawCompression::writeSampleData(QFile& p_file,
+                                               const FiffInfo& p_info,
+                                               bool p_bCompressed,
+                                               const QList<MatrixXd>& p_qListBuffers) const
+{
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(p_file, p_info, cals);
+    outfid->setRawCompression(p_bCompressed);
+
+    for(qint32 i = 0; i < p_qListBuffers.size(); ++i)
+        if(!outfid->write_raw_buffer(p_qListBuffers[i], cals))
+            return -1;
+
+    outfid->finish_writing_raw();
+
+    return QFileInfo(p_file).size();
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawCompression::initTestCase()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+
+    //
+    //   Make sure test folder exists
+    //
+    QFileInfo t_fileOutInfo(m_fileOut);
+    QDir().mkdir(t_fileOutInfo.path());
+
+    //
+    //   Take the measurement info of the sample data, with unit calibrations the read data are the stored floats
+    //
+    FiffRawData t_rawIn(t_fileIn);
+    FiffInfo t_info = t_rawIn.info;
+    t_info.filename = "";
+    t_info.projs.clear();
+    t_info.comps.clear();
+    for(qint32 k = 0; k < t_info.chs.size(); ++k) {
+        t_info.chs[k].cal = 1.0f;
+        t_info.chs[k].range = 1.0f;
+    }
+
+    m_iNChan = t_info.nchan;
+    QVERIFY(m_iNChan > 130);
+
+    //
+    //   A small buffer which is coded by one thread and a large one which is distributed over the cores
+    //
+    MatrixXf t_matSmall = generateBuffer(m_iNChan, 100, 1);
+    MatrixXf t_matLarge = generateBuffer(m_iNChan, 1000, 2);
+    m_matWritten.resize(m_iNChan, t_matSmall.cols() + t_matLarge.cols());
+    m_matWritten << t_matSmall, t_matLarge;
+
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(m_fileOut, t_info, cals);
+    outfid->setRawCompression(true);
+
+    QVERIFY(outfid->write_raw_buffer(t_matSmall.cast<double>(), cals));
+    QVERIFY(outfid->write_raw_buffer(t_matLarge.cast<double>(), cals));
+
+    outfid->finish_writing_raw();
+
+    //
+    //   Read again
+    //
+    m_raw = FiffRawData(m_fileOut);
+
+    QVERIFY(m_raw.first_samp == 0);
+    QVERIFY(m_raw.last_samp == m_matWritten.cols() - 1);
+
+    m_vecIntChannels.resize((m_iNChan + 3)/4);
+    for(qint32 i = 0; i < m_vecIntChannels.size(); ++i)
+        m_vecIntChannels[i] = 4*i;
+
+    m_vecFloatChannels.resize(m_iNChan - m_vecIntChannels.size());
+    for(qint32 c = 0, i = 0; c < m_iNChan; ++c)
+        if(c % 4 != 0)
+            m_vecFloatChannels[i++] = c;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawCompression::compareIntegerChannels()
+{
+    MatrixXd t_matData, t_matTimes;
+    QVERIFY(m_raw.read_raw_segment(t_matData, t_matTimes, 0, m_raw.last_samp, m_vecIntChannels));
+    QVERIFY(compareBits(t_matData, m_matWritten, m_vecIntChannels, 0));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawCompression::compareFloatChannels()
+{
+    MatrixXd t_matData, t_matTimes;
+    QVERIFY(m_raw.read_raw_segment(t_matData, t_matTimes, 0, m_raw.last_samp, m_vecFloatChannels));
+    QVERIFY(compareBits(t_matData, m_matWritten, m_vecFloatChannels, 0));
+
+    //-0.0 must keep its sign
+    bool t_bNegativeZero = false;
+    for(qint32 r = 0; r < t_matData.rows() && !t_bNegativeZero; ++r)
+        for(qint32 s = 0; s < t_matData.cols() && !t_bNegativeZero; ++s)
+            t_bNegativeZero = t_matData(r, s) == 0.0 && std::signbit(t_matData(r, s));
+    QVERIFY(t_bNegativeZero);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawCompression::compareSelectionWindow()
+{
+    //
+    //   A channel subset of all kinds of channels and a window starting in the middle of the first buffer
+    //
+    RowVectorXi t_vecSel(9);
+    t_vecSel << 1, 2, 3, 4, 6, 11, 130, m_iNChan - 2, m_iNChan - 1;
+
+    fiff_int_t t_iFrom = 37;
+    fiff_int_t t_iTo = 100 + 555;
+
+    MatrixXd t_matData, t_matTimes;
+    QVERIFY(m_raw.read_raw_segment(t_matData, t_matTimes, t_iFrom, t_iTo, t_vecSel));
+    QVERIFY(t_matData.cols() == t_iTo - t_iFrom + 1);
+    QVERIFY(compareBits(t_matData, m_matWritten, t_vecSel, t_iFrom));
+
+    //Window within the second buffer only
+    QVERIFY(m_raw.read_raw_segment(t_matData, t_matTimes, 100 + 413, 100 + 414, t_vecSel));
+    QVERIFY(compareBits(t_matData, m_matWritten, t_vecSel, 100 + 413));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawCompression::compareConcurrentBuffer()
+{
+    //
+    //   All channels of the large buffer are decoded concurrently, once from its start and once from the middle
+    //
+    MatrixXd t_matData, t_matTimes;
+    QVERIFY(m_raw.read_raw_segment(t_matData, t_matTimes, 100, m_raw.last_samp));
+    QVERIFY(compareBits(t_matData, m_matWritten, RowVectorXi(), 100));
+
+    QVERIFY(m_raw.read_raw_segment(t_matData, t_matTimes, 100 + 301, m_raw.last_samp));
+    QVERIFY(compareBits(t_matData, m_matWritten, RowVectorXi(), 100 + 301));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawCompression::compareSampleDataSize()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compressed vs. Float32 >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QFile t_fileCompressed("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_compressed_size_out.fif");
+    QFile t_fileFloat("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_float_size_out.fif");
+
+    FiffRawData t_rawIn(t_fileIn);
+    FiffInfo t_info = t_rawIn.info;
+    t_info.filename = "";
+
+    //
+    //   The sample data in 1 s buffers
+    //
+    QList<MatrixXd> t_qListBuffers;
+    fiff_int_t t_iQuantum = (fiff_int_t)ceil(t_info.sfreq);
+    for(fiff_int_t first = t_rawIn.first_samp; first <= t_rawIn.last_samp; first += t_iQuantum) {
+        MatrixXd t_matData, t_matTimes;
+        QVERIFY(t_rawIn.read_raw_segment(t_matData, t_matTimes, first, qMin(first + t_iQuantum - 1, t_rawIn.last_samp)));
+        t_qListBuffers.append(t_matData);
+    }
+    QVERIFY(!t_qListBuffers.isEmpty());
+
+    //
+    //   With the calibrations of the file the converter counts are coded, the tags have to be smaller than float32
+    //
+    qint64 t_iCompressed = writeSampleData(t_fileCompressed, t_info, true, t_qListBuffers);
+    qint64 t_iFloat = writeSampleData(t_fileFloat, t_info, false, t_qListBuffers);
+    printf("Calibrated: compressed %lld bytes, float32 %lld bytes\n", t_iCompressed, t_iFloat);
+    QVERIFY(t_iCompressed > 0 && t_iFloat > 0);
+    QVERIFY(t_iCompressed < t_iFloat);
+
+    //Both files hold the same floats
+    FiffRawData t_rawCompressed(t_fileCompressed);
+    FiffRawData t_rawFloat(t_fileFloat);
+    MatrixXd t_matCompressed, t_matFloat, t_matTimes;
+    QVERIFY(t_rawCompressed.read_raw_segment(t_matCompressed, t_matTimes, t_rawCompressed.first_samp, t_rawCompressed.last_samp));
+    QVERIFY(t_rawFloat.read_raw_segment(t_matFloat, t_matTimes, t_rawFloat.first_samp, t_rawFloat.last_samp));
+    QVERIFY(t_matCompressed.rows() == t_matFloat.rows() && t_matCompressed.cols() == t_matFloat.cols());
+    QVERIFY(std::memcmp(t_matCompressed.data(), t_matFloat.data(), t_matFloat.size()*sizeof(double)) == 0);
+
+    //
+    //   With unit calibrations the physical values are coded by their float bits. Channels which do not shrink are
+    //   stored verbatim, a buffer grows at most by the offset table and the channel headers.
+    //
+    for(qint32 k = 0; k < t_info.chs.size(); ++k) {
+        t_info.chs[k].cal = 1.0f;
+        t_info.chs[k].range = 1.0f;
+    }
+
+    t_iCompressed = writeSampleData(t_fileCompressed, t_info, true, t_qListBuffers);
+    t_iFloat = writeSampleData(t_fileFloat, t_info, false, t_qListBuffers);
+    printf("Physical: compressed %lld bytes, float32 %lld bytes\n", t_iCompressed, t_iFloat);
+    QVERIFY(t_iCompressed > 0 && t_iFloat > 0);
+
+    qint64 t_iOverhead = t_qListBuffers.size()*(16 + 4*(2*(qint64)t_info.nchan + 1));
+    QVERIFY(t_iCompressed <= t_iFloat + t_iOverhead);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compressed vs. Float32 Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawCompression::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffRawCompression)
+#include "test_fiff_raw_compression.moc"
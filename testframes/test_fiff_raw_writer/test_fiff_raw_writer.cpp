@@ -0,0 +1,313 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_raw_writer.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the bounded queue, the skip accounting and the posted jobs of FiffRawWriter
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <fiff/fiff_raw_writer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QSemaphore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffRawWriter
+*
+* @brief The TestFiffRawWriter class overruns the buffer pool of a FiffRawWriter while its I/O thread is held in
+* a posted job, splits the recording into a second file and reads both files back
+*
+*/
+class TestFiffRawWriter: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffRawWriter();
+
+private slots:
+    void initTestCase();
+    void compareDropCount();
+    void compareFirstFile();
+    void compareSecondFile();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns a buffer whose samples identify the buffer, the channel and the sample.
+    */
+    MatrixXf generateBuffer(qint32 p_iBuffer) const;
+
+    //=========================================================================================================
+    /**
+    * Counts the skips in the raw directory of a file and sums their lengths.
+    */
+    qint32 countSkips(const FiffRawData& p_raw, qint32& p_iSkipSamples) const;
+
+    QFile m_fileFirst;              /**< The recording before the split */
+    QFile m_fileSecond;             /**< The recording after the split */
+
+    qint32 m_iNChan;                /**< Number of channels */
+    qint32 m_iNSamp;                /**< Samples per buffer */
+
+    QVector<bool> m_vecAccepted;    /**< Which of the written buffers were queued */
+    qint64 m_iDropped;              /**< Dropped buffers reported by the writer */
+};
+
+
+//*************************************************************************************************************
+
+TestFiffRawWriter::TestFiffRawWriter()
+: m_fileFirst("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_writer_out.fif")
+, m_fileSecond("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_writer_out-1.fif")
+, m_iNChan(0)
+, m_iNSamp(100)
+, m_iDropped(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXf TestFiffRawWriter::generateBuffer(qint32 p_iBuffer) const
+{
+    MatrixXf t_matBuffer(m_iNChan, m_iNSamp);
+
+    //Small integers are exact in float
+    for(qint32 c = 0; c < m_iNChan; ++c)
+        for(qint32 s = 0; s < m_iNSamp; ++s)
+            t_matBuffer(c, s) = (float)(1000000*(p_iBuffer + 1) + 1000*c + s);
+
+    return t_matBuffer;
+}
+
+
+//*************************************************************************************************************
+
+qint32 TestFiffRawWriter::countSkips(const FiffRawData& p_raw, qint32& p_iSkipSamples) const
+{
+    qint32 t_iNSkips = 0;
+    p_iSkipSamples = 0;
+
+    for(qint32 k = 0; k < p_raw.rawdir.size(); ++k) {
+        if(!p_raw.rawdir[k].ent) {
+            ++t_iNSkips;
+            p_iSkipSamples += p_raw.rawdir[k].nsamp;
+        }
+    }
+
+    return t_iNSkips;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::initTestCase()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+
+    //
+    //   Make sure test folder exists
+    //
+    QFileInfo t_fileOutInfo(m_fileFirst);
+    QDir().mkdir(t_fileOutInfo.path());
+
+    //
+    //   Take the measurement info of the sample data, with unit calibrations the read data are the stored floats
+    //
+    FiffRawData t_rawIn(t_fileIn);
+    FiffInfo t_info = t_rawIn.info;
+    t_info.filename = "";
+    t_info.projs.clear();
+    t_info.comps.clear();
+    for(qint32 k = 0; k < t_info.chs.size(); ++k) {
+        t_info.chs[k].cal = 1.0f;
+        t_info.chs[k].range = 1.0f;
+    }
+
+    m_iNChan = t_info.nchan;
+    QVERIFY(m_iNChan > 0);
+
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(m_fileFirst, t_info, cals);
+
+    QSemaphore t_gate;
+    FiffRawWriter::StreamJob t_jobWait = [&t_gate](FiffStream::SPtr&) { t_gate.acquire(); };
+
+    {
+        //
+        //   A pool of two buffers, the I/O thread is held in a job until the pool was overrun
+        //
+        FiffRawWriter t_writer(outfid, cals, 2);
+        outfid.clear();
+
+        t_writer.post(t_jobWait);
+        for(qint32 b = 0; b < 5; ++b)
+            m_vecAccepted.append(t_writer.write(generateBuffer(b)));
+        t_gate.release();
+
+        //The three dropped buffers are written as one skip in front of buffer 5
+        t_writer.flush();
+        m_vecAccepted.append(t_writer.write(generateBuffer(5)));
+        t_writer.flush();
+
+        //
+        //   Overrun again, then split: the buffer dropped before the split must not shift the new file
+        //
+        t_writer.post(t_jobWait);
+        for(qint32 b = 6; b < 9; ++b)
+            m_vecAccepted.append(t_writer.write(generateBuffer(b)));
+
+        QFile* t_pFileSecond = &m_fileSecond;
+        t_writer.post([t_pFileSecond, t_info](FiffStream::SPtr& p_pStream) {
+            p_pStream->finish_writing_raw();
+            RowVectorXd t_cals;
+            p_pStream = FiffStream::start_writing_raw(*t_pFileSecond, t_info, t_cals);
+        });
+        t_gate.release();
+
+        t_writer.flush();
+        m_vecAccepted.append(t_writer.write(generateBuffer(9)));
+
+        t_writer.post([](FiffStream::SPtr& p_pStream) {
+            p_pStream->finish_writing_raw();
+        });
+        t_writer.flush();
+
+        m_iDropped = t_writer.droppedBuffers();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::compareDropCount()
+{
+    QVERIFY(m_vecAccepted.size() == 10);
+
+    //The pool holds two buffers while the I/O thread waits
+    for(qint32 b = 0; b < m_vecAccepted.size(); ++b) {
+        bool t_bExpected = !(b >= 2 && b <= 4) && b != 8;
+        QVERIFY(m_vecAccepted[b] == t_bExpected);
+    }
+
+    QVERIFY(m_iDropped == 4);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::compareFirstFile()
+{
+    //
+    //   Buffers 0, 1, a skip of 3 buffers, buffers 5, 6, 7
+    //
+    FiffRawData t_raw(m_fileFirst);
+
+    QVERIFY(t_raw.first_samp == 0);
+    QVERIFY(t_raw.last_samp == 8*m_iNSamp - 1);
+
+    qint32 t_iSkipSamples;
+    QVERIFY(countSkips(t_raw, t_iSkipSamples) == 1);
+    QVERIFY(t_iSkipSamples == 3*m_iNSamp);
+
+    MatrixXd t_matData, t_matTimes;
+    QVERIFY(t_raw.read_raw_segment(t_matData, t_matTimes, 0, t_raw.last_samp));
+    QVERIFY(t_matData.rows() == m_iNChan && t_matData.cols() == 8*m_iNSamp);
+
+    const qint32 t_iBuffers[] = { 0, 1, -1, -1, -1, 5, 6, 7 };
+    for(qint32 k = 0; k < 8; ++k) {
+        //Skipped samples are read as zeros
+        MatrixXd t_matExpected = MatrixXd::Zero(m_iNChan, m_iNSamp);
+        if(t_iBuffers[k] >= 0)
+            t_matExpected = generateBuffer(t_iBuffers[k]).cast<double>();
+        QVERIFY(t_matData.middleCols(k*m_iNSamp, m_iNSamp) == t_matExpected);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::compareSecondFile()
+{
+    //
+    //   Only buffer 9, without a skip
+    //
+    FiffRawData t_raw(m_fileSecond);
+
+    QVERIFY(t_raw.first_samp == 0);
+    QVERIFY(t_raw.last_samp == m_iNSamp - 1);
+
+    qint32 t_iSkipSamples;
+    QVERIFY(countSkips(t_raw, t_iSkipSamples) == 0);
+
+    MatrixXd t_matData, t_matTimes;
+    QVERIFY(t_raw.read_raw_segment(t_matData, t_matTimes, 0, t_raw.last_samp));
+    QVERIFY(t_matData == generateBuffer(9).cast<double>());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffRawWriter)
+#include "test_fiff_raw_writer.moc"
@@ -0,0 +1,653 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_stream_server.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The fiff stream server and client unit test
+*
+*/
+
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+
+#include "fiffstreamclient.h"
+#include "fiffstreamserver.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtEndian>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+#include <functional>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTSERVER;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Keeps the descriptors of the accepted connections, FiffStreamClient sets up its socket itself.
+*/
+class DescriptorServer : public QTcpServer
+{
+public:
+    QList<qintptr> m_qListDescriptors;  /**< Accepted connections not yet handed to a client */
+
+protected:
+    void incomingConnection(qintptr socketDescriptor)
+    {
+        m_qListDescriptors.append(socketDescriptor);
+    }
+};
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffStreamServer
+*
+* @brief The TestFiffStreamServer class sends raw buffers through FiffStreamClient and FiffStreamServer to
+* loopback peers and checks the send queue policies, the counters and what the peers receive
+*
+*/
+class TestFiffStreamServer: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffStreamServer();
+
+private slots:
+    void initTestCase();
+    void init();
+    void dropOldestWithinLimit();
+    void decimateWithinLimit();
+    void disconnectOnLimit();
+    void clientPolicyCommands();
+    void broadcastRawBuffer();
+    void removeClientMidStream();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the buffer with the given index. The first sample holds the index.
+    */
+    MatrixXf rawBuffer(qint32 p_iIndex) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the FIFF_DATA_BUFFER tag of the buffer with the given index, as it is sent by the server.
+    */
+    QByteArray rawFrame(qint32 p_iIndex) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the FIFF_BLOCK_START tag of the raw data block, which the clients send before the first buffer.
+    */
+    QByteArray blockStartTag() const;
+
+    //=========================================================================================================
+    /**
+    * Connects a peer to the server and waits until the server set up the client with the given ID.
+    */
+    bool connectPeer(FiffStreamServer& p_server, QTcpSocket& p_peer, qint32 p_iId) const;
+
+    //=========================================================================================================
+    /**
+    * Processes events and reads the peer until p_done returns true.
+    *
+    * @return false on timeout
+    */
+    bool receive(QTcpSocket* p_pPeer, QByteArray& p_baStream, const std::function<bool()>& p_done) const;
+
+    //=========================================================================================================
+    /**
+    * Splits a received stream into its tags. Returns the tag kinds and, for data buffers, the buffer indices
+    * (-1 for other tags). Fails if the stream does not end with a complete tag or a data buffer differs from
+    * the one which was sent.
+    */
+    bool parseStream(const QByteArray& p_baStream, QList<fiff_int_t>& p_qListKinds, QList<qint32>& p_qListIndices) const;
+
+    //=========================================================================================================
+    /**
+    * Whether the buffer indices are strictly increasing, i.e. nothing was reordered or sent twice.
+    */
+    bool isIncreasing(const QList<qint32>& p_qListIndices) const;
+
+    DescriptorServer m_server;      /**< Accepts the connections of the FiffStreamClient tests */
+    FiffStreamClient* m_pClient;    /**< The client under test, lives in the test thread */
+    QTcpSocket* m_pPeer;            /**< The receiving side, which reads only when the test drains the queue */
+
+    qint32 m_iNChan;                /**< Number of channels */
+    qint32 m_iNSamp;                /**< Samples per buffer */
+    qint32 m_iNFrames;              /**< Raw buffers sent by the policy tests */
+};
+
+
+//*************************************************************************************************************
+
+TestFiffStreamServer::TestFiffStreamServer()
+: m_pClient(NULL)
+, m_pPeer(NULL)
+, m_iNChan(64)
+, m_iNSamp(64)
+, m_iNFrames(128)
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXf TestFiffStreamServer::rawBuffer(qint32 p_iIndex) const
+{
+    MatrixXf t_matBuffer(m_iNChan, m_iNSamp);
+
+    //Small integers are exact in float
+    for(qint32 c = 0; c < m_iNChan; ++c)
+        for(qint32 s = 0; s < m_iNSamp; ++s)
+            t_matBuffer(c, s) = (float)(10000*p_iIndex + c + s);
+
+    return t_matBuffer;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray TestFiffStreamServer::rawFrame(qint32 p_iIndex) const
+{
+    MatrixXf t_matBuffer = rawBuffer(p_iIndex);
+
+    QByteArray t_baTag;
+    FiffStream t_stream(&t_baTag, QIODevice::WriteOnly);
+    t_stream.write_float(FIFF_DATA_BUFFER, t_matBuffer.data(), t_matBuffer.size());
+
+    return t_baTag;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray TestFiffStreamServer::blockStartTag() const
+{
+    QByteArray t_baTag;
+    FiffStream t_stream(&t_baTag, QIODevice::WriteOnly);
+    t_stream.start_block(FIFFB_RAW_DATA);
+
+    return t_baTag;
+}
+
+
+//*************************************************************************************************************
+
+bool TestFiffStreamServer::connectPeer(FiffStreamServer& p_server, QTcpSocket& p_peer, qint32 p_iId) const
+{
+    p_peer.connectToHost(QHostAddress::LocalHost, p_server.serverPort());
+    if(!p_peer.waitForConnected(5000))
+        return false;
+
+    //The server accepts in the test thread
+    QElapsedTimer t_timer;
+    t_timer.start();
+    while(!p_server.getClient(p_iId)) {
+        if(t_timer.elapsed() > 10000)
+            return false;
+        QTest::qWait(5);
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool TestFiffStreamServer::receive(QTcpSocket* p_pPeer, QByteArray& p_baStream, const std::function<bool()>& p_done) const
+{
+    QElapsedTimer t_timer;
+    t_timer.start();
+
+    while(!p_done()) {
+        if(t_timer.elapsed() > 10000)
+            return false;
+        QTest::qWait(5);
+        p_baStream.append(p_pPeer->readAll());
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool TestFiffStreamServer::parseStream(const QByteArray& p_baStream,
+                                       QList<fiff_int_t>& p_qListKinds,
+                                       QList<qint32>& p_qListIndices) const
+{
+    p_qListKinds.clear();
+    p_qListIndices.clear();
+
+    //16 byte big endian header (kind, type, size, next) followed by the data
+    const uchar* t_pData = reinterpret_cast<const uchar*>(p_baStream.constData());
+    qint32 t_iPos = 0;
+    while(p_baStream.size() - t_iPos >= 16) {
+        fiff_int_t t_iKind = qFromBigEndian<qint32>(t_pData + t_iPos);
+        qint32 t_iSize = qFromBigEndian<qint32>(t_pData + t_iPos + 8);
+        if(t_iSize < 0 || p_baStream.size() - t_iPos - 16 < t_iSize)
+            return false;
+
+        qint32 t_iIndex = -1;
+        if(t_iKind == FIFF_DATA_BUFFER) {
+            quint32 t_iBits = qFromBigEndian<quint32>(t_pData + t_iPos + 16);
+            float t_fFirst;
+            std::memcpy(&t_fFirst, &t_iBits, sizeof(float));
+            t_iIndex = (qint32)t_fFirst/10000;
+            if(p_baStream.mid(t_iPos, 16 + t_iSize) != rawFrame(t_iIndex)) {
+                printf("Data buffer %d differs from the sent one\n", t_iIndex);
+                return false;
+            }
+        }
+
+        p_qListKinds.append(t_iKind);
+        p_qListIndices.append(t_iIndex);
+        t_iPos += 16 + t_iSize;
+    }
+
+    return t_iPos == p_baStream.size();
+}
+
+
+//*************************************************************************************************************
+
+bool TestFiffStreamServer::isIncreasing(const QList<qint32>& p_qListIndices) const
+{
+    qint32 t_iLast = -1;
+    for(qint32 i = 0; i < p_qListIndices.size(); ++i) {
+        if(p_qListIndices[i] < 0)
+            continue;
+        if(p_qListIndices[i] <= t_iLast)
+            return false;
+        t_iLast = p_qListIndices[i];
+    }
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::initTestCase()
+{
+    QVERIFY(m_server.listen(QHostAddress::LocalHost));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::init()
+{
+    m_pPeer = new QTcpSocket;
+    m_pPeer->connectToHost(QHostAddress::LocalHost, m_server.serverPort());
+    QVERIFY(m_pPeer->waitForConnected(5000));
+
+    QVERIFY(m_server.waitForNewConnection(5000));
+    QVERIFY(!m_server.m_qListDescriptors.isEmpty());
+
+    m_pClient = new FiffStreamClient(7);
+    m_pClient->init(m_server.m_qListDescriptors.takeFirst());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::dropOldestWithinLimit()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Drop Oldest >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    qint64 t_iLimit = 4*rawFrame(0).size();
+    m_pClient->setSendPolicy(FiffStreamClient::DropOldest, t_iLimit);
+
+    //
+    //   Events are not processed while sending, the socket takes its share and the rest piles up in the queue
+    //
+    m_pClient->startMeas(7);
+    for(qint32 i = 0; i < m_iNFrames; ++i) {
+        m_pClient->sendRawFrame(rawFrame(i));
+        QVERIFY(m_pClient->getStatistics().iQueuedBytes <= t_iLimit);
+    }
+    //Control frames are queued beyond the limit and are not dropped
+    m_pClient->stopMeas(7);
+
+    FiffStreamClient::Statistics t_stats = m_pClient->getStatistics();
+    QVERIFY(t_stats.policy == FiffStreamClient::DropOldest);
+    QCOMPARE(t_stats.iMaxQueuedBytes, t_iLimit);
+    QVERIFY(t_stats.iQueuedFrames > 0);
+    QVERIFY(t_stats.iDroppedFrames > 0);
+    QCOMPARE(t_stats.iDecimatedFrames, (qint64)0);
+    QVERIFY(t_stats.iLagMs >= 0);
+
+    //
+    //   Drain: every byte handed to the socket arrives, the partially sent frame was never dropped
+    //
+    QByteArray t_baStream;
+    QVERIFY(receive(m_pPeer, t_baStream, [&]() {
+        FiffStreamClient::Statistics t_current = m_pClient->getStatistics();
+        return t_current.iQueuedFrames == 0 && t_current.iBytesSent == t_baStream.size();
+    }));
+
+    QList<fiff_int_t> t_qListKinds;
+    QList<qint32> t_qListIndices;
+    QVERIFY(parseStream(t_baStream, t_qListKinds, t_qListIndices));
+    QVERIFY(isIncreasing(t_qListIndices));
+
+    QCOMPARE(t_qListKinds.first(), FIFF_BLOCK_START);
+    QCOMPARE(t_qListKinds.last(), FIFF_BLOCK_END);
+    QCOMPARE(t_qListKinds.count(FIFF_DATA_BUFFER) + (qint32)t_stats.iDroppedFrames, m_iNFrames);
+
+    //The newest buffers survive
+    QCOMPARE(t_qListIndices[t_qListIndices.size() - 2], m_iNFrames - 1);
+
+    t_stats = m_pClient->getStatistics();
+    QCOMPARE(t_stats.iBytesSent, (qint64)t_baStream.size());
+    QCOMPARE(t_stats.iQueuedBytes, (qint64)0);
+    QVERIFY(t_stats.dThroughput >= 0.0);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Drop Oldest Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::decimateWithinLimit()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Decimate >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    qint64 t_iLimit = 8*rawFrame(0).size();
+    m_pClient->setSendPolicy(FiffStreamClient::Decimate, t_iLimit);
+
+    m_pClient->startMeas(7);
+    for(qint32 i = 0; i < m_iNFrames; ++i) {
+        m_pClient->sendRawFrame(rawFrame(i));
+        QVERIFY(m_pClient->getStatistics().iQueuedBytes <= t_iLimit);
+    }
+
+    FiffStreamClient::Statistics t_stats = m_pClient->getStatistics();
+    QVERIFY(t_stats.policy == FiffStreamClient::Decimate);
+    QVERIFY(t_stats.iDecimatedFrames > 0);
+
+    QByteArray t_baStream;
+    QVERIFY(receive(m_pPeer, t_baStream, [&]() {
+        FiffStreamClient::Statistics t_current = m_pClient->getStatistics();
+        return t_current.iQueuedFrames == 0 && t_current.iBytesSent == t_baStream.size();
+    }));
+
+    QList<fiff_int_t> t_qListKinds;
+    QList<qint32> t_qListIndices;
+    QVERIFY(parseStream(t_baStream, t_qListKinds, t_qListIndices));
+    QVERIFY(isIncreasing(t_qListIndices));
+
+    //Each buffer is either received, skipped or dropped
+    QCOMPARE(t_qListKinds.first(), FIFF_BLOCK_START);
+    QCOMPARE(t_qListKinds.count(FIFF_DATA_BUFFER) + (qint32)(t_stats.iDecimatedFrames + t_stats.iDroppedFrames), m_iNFrames);
+
+    //
+    //   Once the client caught up, every buffer is sent again
+    //
+    for(qint32 i = m_iNFrames; i < m_iNFrames + 4; ++i)
+        m_pClient->sendRawFrame(rawFrame(i));
+
+    t_baStream.clear();
+    qint64 t_iBytesSent = m_pClient->getStatistics().iBytesSent;
+    QVERIFY(receive(m_pPeer, t_baStream, [&]() {
+        FiffStreamClient::Statistics t_current = m_pClient->getStatistics();
+        return t_current.iQueuedFrames == 0 && t_current.iBytesSent - t_iBytesSent == t_baStream.size();
+    }));
+    QVERIFY(parseStream(t_baStream, t_qListKinds, t_qListIndices));
+    QCOMPARE(t_qListKinds.count(FIFF_DATA_BUFFER), 4);
+    QCOMPARE(t_qListIndices.first(), m_iNFrames);
+    QCOMPARE(t_qListIndices.last(), m_iNFrames + 3);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Decimate Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::disconnectOnLimit()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Disconnect >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QSignalSpy t_spyClosed(m_pClient, &FiffStreamClient::closed);
+
+    qint64 t_iLimit = 4*rawFrame(0).size();
+    m_pClient->setSendPolicy(FiffStreamClient::Disconnect, t_iLimit);
+
+    m_pClient->startMeas(7);
+    qint32 t_iSent = 0;
+    for(; t_iSent < m_iNFrames && t_spyClosed.isEmpty(); ++t_iSent)
+        m_pClient->sendRawFrame(rawFrame(t_iSent));
+
+    //The connection is closed by the first buffer beyond the limit, nothing was dropped before
+    QCOMPARE(t_spyClosed.count(), 1);
+    QCOMPARE(t_spyClosed.first().first().toInt(), 7);
+    QVERIFY(t_iSent < m_iNFrames);
+
+    FiffStreamClient::Statistics t_stats = m_pClient->getStatistics();
+    QVERIFY(t_stats.policy == FiffStreamClient::Disconnect);
+    QCOMPARE(t_stats.iDroppedFrames, (qint64)0);
+    QCOMPARE(t_stats.iQueuedFrames, 0);
+    QCOMPARE(t_stats.iQueuedBytes, (qint64)0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(m_pPeer->state(), QAbstractSocket::UnconnectedState, 10000);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Disconnect Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::clientPolicyCommands()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> cstats & cpolicy >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    FiffStreamServer t_fiffStreamServer;
+    QVERIFY(t_fiffStreamServer.listen(QHostAddress::LocalHost));
+
+    QTcpSocket t_peer;
+    QVERIFY(connectPeer(t_fiffStreamServer, t_peer, 0));
+    QVERIFY(t_fiffStreamServer.getClient(1) == NULL);
+
+    //Default policy and limit of 32 MB
+    QVERIFY(t_fiffStreamServer.getClientStatistics().contains("\t0\t\tdrop-oldest\t32768\t0\t0\t"));
+
+    QString t_sReply = t_fiffStreamServer.setClientPolicy("0", 64, "decimate");
+    QVERIFY(t_sReply.contains("sends with policy decimate, queue limit 64 kB"));
+
+    FiffStreamClient::Statistics t_stats = t_fiffStreamServer.getClient(0)->getStatistics();
+    QVERIFY(t_stats.policy == FiffStreamClient::Decimate);
+    QCOMPARE(t_stats.iMaxQueuedBytes, (qint64)64*1024);
+    QVERIFY(t_fiffStreamServer.getClientStatistics().contains("\t0\t\tdecimate\t64\t"));
+
+    //
+    //   Invalid requests leave the policy unchanged
+    //
+    QVERIFY(t_fiffStreamServer.setClientPolicy("0", 64, "fastest").contains("unknown policy"));
+    QVERIFY(t_fiffStreamServer.setClientPolicy("0", 0, "disconnect").contains("has to be positive"));
+    QVERIFY(t_fiffStreamServer.setClientPolicy("5", 64, "disconnect").contains("not available"));
+    QVERIFY(t_fiffStreamServer.getClientStatistics().contains("\t0\t\tdecimate\t64\t"));
+
+    QVERIFY(t_fiffStreamServer.setClientPolicy("0", 128, "Disconnect").contains("sends with policy disconnect, queue limit 128 kB"));
+    QVERIFY(t_fiffStreamServer.getClient(0)->getStatistics().policy == FiffStreamClient::Disconnect);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< cstats & cpolicy Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::broadcastRawBuffer()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Broadcast >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    FiffStreamServer t_fiffStreamServer;
+    QVERIFY(t_fiffStreamServer.listen(QHostAddress::LocalHost));
+
+    QTcpSocket t_peerA, t_peerB;
+    QVERIFY(connectPeer(t_fiffStreamServer, t_peerA, 0));
+    QVERIFY(connectPeer(t_fiffStreamServer, t_peerB, 1));
+
+    emit t_fiffStreamServer.startMeasFiffStreamClient(0);
+    emit t_fiffStreamServer.startMeasFiffStreamClient(1);
+
+    //
+    //   Each buffer is encoded once, both clients have to receive the same FIFF_DATA_BUFFER frames
+    //
+    QByteArray t_baExpected = blockStartTag();
+    for(qint32 i = 0; i < 16; ++i) {
+        t_fiffStreamServer.forwardRawBuffer(QSharedPointer<MatrixXf>(new MatrixXf(rawBuffer(i))));
+        t_baExpected.append(rawFrame(i));
+    }
+
+    QByteArray t_baStreamA, t_baStreamB;
+    QVERIFY(receive(&t_peerA, t_baStreamA, [&]() { return t_baStreamA.size() >= t_baExpected.size(); }));
+    QVERIFY(receive(&t_peerB, t_baStreamB, [&]() { return t_baStreamB.size() >= t_baExpected.size(); }));
+
+    QVERIFY(t_baStreamA == t_baExpected);
+    QVERIFY(t_baStreamB == t_baExpected);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Broadcast Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::removeClientMidStream()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Disconnect Mid-Stream >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    FiffStreamServer t_fiffStreamServer;
+    QVERIFY(t_fiffStreamServer.listen(QHostAddress::LocalHost));
+
+    QTcpSocket t_peerA, t_peerB;
+    QVERIFY(connectPeer(t_fiffStreamServer, t_peerA, 0));
+    QVERIFY(connectPeer(t_fiffStreamServer, t_peerB, 1));
+
+    emit t_fiffStreamServer.startMeasFiffStreamClient(0);
+    emit t_fiffStreamServer.startMeasFiffStreamClient(1);
+
+    QByteArray t_baExpected = blockStartTag();
+    for(qint32 i = 0; i < 8; ++i) {
+        t_fiffStreamServer.forwardRawBuffer(QSharedPointer<MatrixXf>(new MatrixXf(rawBuffer(i))));
+        t_baExpected.append(rawFrame(i));
+    }
+
+    //
+    //   Client B leaves while buffers are on their way, the server removes it and keeps serving A
+    //
+    QByteArray t_baStreamA, t_baStreamB;
+    QVERIFY(receive(&t_peerB, t_baStreamB, [&]() { return t_baStreamB.size() > 0; }));
+    t_peerB.abort();
+
+    QTRY_VERIFY_WITH_TIMEOUT(t_fiffStreamServer.getClient(1) == NULL, 10000);
+    QVERIFY(t_fiffStreamServer.getClient(0) != NULL);
+
+    for(qint32 i = 8; i < 24; ++i) {
+        t_fiffStreamServer.forwardRawBuffer(QSharedPointer<MatrixXf>(new MatrixXf(rawBuffer(i))));
+        t_baExpected.append(rawFrame(i));
+    }
+
+    QVERIFY(receive(&t_peerA, t_baStreamA, [&]() { return t_baStreamA.size() >= t_baExpected.size(); }));
+    QVERIFY(t_baStreamA == t_baExpected);
+
+    QList<fiff_int_t> t_qListKinds;
+    QList<qint32> t_qListIndices;
+    QVERIFY(parseStream(t_baStreamA, t_qListKinds, t_qListIndices));
+    QCOMPARE(t_qListKinds.count(FIFF_DATA_BUFFER), 24);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Disconnect Mid-Stream Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::cleanup()
+{
+    delete m_pClient;
+    m_pClient = NULL;
+    delete m_pPeer;
+    m_pPeer = NULL;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffStreamServer::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestFiffStreamServer)
+#include "test_fiff_stream_server.moc"
@@ -0,0 +1,386 @@
+//=============================================================================================================
+/**
+* @file     test_filtering.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and per-block benchmark of the streaming FIR and IIR filters
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/filterTools/filterdata.h>
+#include <realtime/rtProcessing/rtfilter.h>
+#include <realtime/rtProcessing/rtmultichannelfilter.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiltering
+*
+* @brief The TestFiltering class verifies the IIR designs and the streaming FIR and IIR filters and compares the
+* per-block latency and throughput of the streaming IIR filter with the overlap-save FIR filter.
+*
+*/
+class TestFiltering: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiltering();
+
+private slots:
+    void initTestCase();
+    void testIirResponse();
+    void testFilterLength();
+    void testIirStreaming();
+    void testFirStreaming();
+    void testFirChannelRows();
+    void testLatency();
+    void benchmarkFirBlock();
+    void benchmarkIirBlock();
+    void cleanupTestCase();
+
+private:
+    double groupDelay(const FilterData& filter, double dFreq) const;
+    RowVectorXd convolve(const RowVectorXd& vecData, const RowVectorXd& vecCoeff) const;
+
+    double m_dSFreq;
+    int m_iNumChannels;
+    int m_iBlockSize;
+    MatrixXd m_matData;
+    QVector<int> m_lFilterChannelList;
+    FilterData m_firFilter;
+    FilterData m_iirFilter;
+};
+
+
+//*************************************************************************************************************
+
+TestFiltering::TestFiltering()
+: m_dSFreq(1000.0)
+, m_iNumChannels(306)
+, m_iBlockSize(20)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::initTestCase()
+{
+    //8 - 30 Hz bandpass as used for motor imagery, once as FIR and once as IIR design
+    double dNyquist = m_dSFreq/2;
+    double dCenter = 19.0/dNyquist;
+    double dBandwidth = 22.0/dNyquist;
+
+    m_firFilter = FilterData("FIR BPF", FilterData::BPF, 256, dCenter, dBandwidth, 5.0/dNyquist, m_dSFreq, 4096, FilterData::Tschebyscheff);
+    m_iirFilter = FilterData("IIR BPF", FilterData::BPF, 4, dCenter, dBandwidth, 5.0/dNyquist, m_dSFreq, 4096, FilterData::Butterworth);
+
+    m_matData = MatrixXd::Random(m_iNumChannels, 10 * m_iBlockSize);
+
+    for(int i = 0; i < m_iNumChannels; ++i) {
+        m_lFilterChannelList.append(i);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::testIirResponse()
+{
+    QVERIFY(!m_firFilter.isIIR());
+    QVERIFY(m_iirFilter.isIIR());
+    QCOMPARE(m_iirFilter.m_matSOS.rows(), 4);
+
+    //Butterworth has its half power point at the cut off frequency (bin 512 for a cut off at a quarter of the Nyquist frequency)
+    FilterData lowpass("IIR LPF", FilterData::LPF, 5, 0.25, 0.0, 0.1, m_dSFreq, 4096, FilterData::Butterworth);
+    QVERIFY(qAbs(std::abs(lowpass.m_dFFTCoeffA(512)) - 1.0/std::sqrt(2.0)) < 1e-3);
+    QVERIFY(qAbs(std::abs(lowpass.m_dFFTCoeffA(0)) - 1.0) < 1e-3);
+    QVERIFY(std::abs(lowpass.m_dFFTCoeffA(2048)) < 1e-6);
+
+    //Chebyshev passband stays within the ripple
+    FilterData chebyshev("IIR LPF", FilterData::LPF, 6, 0.25, 0.0, 0.1, m_dSFreq, 4096, FilterData::Chebyshev);
+    for(int k = 0; k <= 512; ++k) {
+        double dGainDb = 20.0 * std::log10(std::abs(chebyshev.m_dFFTCoeffA(k)));
+        QVERIFY(dGainDb < 1e-3 && dGainDb > -0.5 - 1e-3);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::testFilterLength()
+{
+    //FIR designs keep the order as their length, the displays size their overlap with it
+    double dNyquist = m_dSFreq/2;
+    FilterData cosine("FIR LPF", FilterData::LPF, 128, 40.0/dNyquist, 0.0, 5.0/dNyquist, m_dSFreq, 4096, FilterData::Cosine);
+    QCOMPARE(cosine.getFilterLength(), 128);
+    QCOMPARE(m_firFilter.getFilterLength(), m_firFilter.m_iFilterOrder);
+
+    //IIR designs span their truncated impulse response, which is far longer than the prototype order
+    QCOMPARE(m_iirFilter.getFilterLength(), int(m_iirFilter.m_dCoeffA.cols()));
+    QVERIFY(m_iirFilter.getFilterLength() > m_iirFilter.m_iFilterOrder);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::testIirStreaming()
+{
+    MatrixXd matStream = m_matData;
+    MatrixXd matState;
+    m_iirFilter.applyIirFilter(matStream, matState);
+
+    //Filtering block by block yields the same result as filtering the whole stream
+    RtFilter rtFilter;
+    MatrixXd matBlocks = m_matData;
+
+    for(int i = 0; i < matBlocks.cols(); i += m_iBlockSize) {
+        MatrixXd matBlock = matBlocks.middleCols(i, m_iBlockSize);
+        rtFilter.filterChannels(matBlock, m_iirFilter.m_dCoeffA.cols(), m_lFilterChannelList, QList<FilterData>() << m_iirFilter);
+        matBlocks.middleCols(i, m_iBlockSize) = matBlock;
+    }
+
+    QVERIFY((matBlocks - matStream).cwiseAbs().maxCoeff() < 1e-10);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::testFirStreaming()
+{
+    //Cascade of two FIR filters, its combined length is the sum of both lengths minus one
+    double dNyquist = m_dSFreq/2;
+    FilterData lowpass("FIR LPF", FilterData::LPF, 128, 40.0/dNyquist, 0.0, 5.0/dNyquist, m_dSFreq, 4096, FilterData::Cosine);
+    QList<FilterData> lFilter = QList<FilterData>() << m_firFilter << lowpass;
+
+    int iNumChannels = 6;
+    int iNumSamples = 3000;
+    MatrixXd matData = MatrixXd::Random(iNumChannels, iNumSamples);
+    QVector<int> lFilterRows = QVector<int>() << 1 << 4 << 2;
+
+    RtMultiChannelFilter multiChannelFilter;
+    multiChannelFilter.setFilters(lFilter, lFilterRows, iNumChannels, m_iBlockSize);
+
+    int iFilterLength = m_firFilter.m_dCoeffA.cols() + lowpass.m_dCoeffA.cols() - 1;
+    QCOMPARE(multiChannelFilter.filterLength(), iFilterLength);
+    QCOMPARE(multiChannelFilter.delay(), iFilterLength/2);
+
+    //Odd block sizes, blocks shorter than the filter and a block longer than one overlap-save frame
+    QVector<int> vecBlockSizes = QVector<int>() << 1 << 7 << 33 << 101 << multiChannelFilter.fftLength() + 17 << 255 << 3;
+    QVERIFY(vecBlockSizes.at(1) < iFilterLength && vecBlockSizes.at(3) < iFilterLength);
+
+    MatrixXd matStream = matData;
+    for(int iStart = 0, k = 0; iStart < iNumSamples; ++k) {
+        int iCols = std::min(vecBlockSizes.at(k % vecBlockSizes.size()), iNumSamples - iStart);
+        MatrixXd matBlock = matStream.middleCols(iStart, iCols);
+        QVERIFY(multiChannelFilter.filter(matBlock));
+        matStream.middleCols(iStart, iCols) = matBlock;
+        iStart += iCols;
+    }
+
+    //The filtered rows match the causal one-shot convolution, all other rows are delayed by half the combined length
+    for(int i = 0; i < iNumChannels; ++i) {
+        RowVectorXd vecExpected = RowVectorXd::Zero(iNumSamples);
+
+        if(lFilterRows.contains(i)) {
+            vecExpected = convolve(convolve(matData.row(i), m_firFilter.m_dCoeffA), lowpass.m_dCoeffA);
+        } else {
+            vecExpected.tail(iNumSamples - iFilterLength/2) = matData.row(i).head(iNumSamples - iFilterLength/2);
+        }
+
+        QVERIFY((matStream.row(i) - vecExpected).cwiseAbs().maxCoeff() < 1e-9);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::testFirChannelRows()
+{
+    //The channel list holds the row indices to filter, in any order
+    int iNumChannels = 5;
+    MatrixXd matData = MatrixXd::Random(iNumChannels, 10 * m_iBlockSize);
+    QVector<int> lFilterRows = QVector<int>() << 3 << 0;
+
+    RtFilter rtFilter;
+    MatrixXd matStream = matData;
+
+    for(int i = 0; i < matStream.cols(); i += m_iBlockSize) {
+        MatrixXd matBlock = matStream.middleCols(i, m_iBlockSize);
+        rtFilter.filterChannels(matBlock, m_firFilter.m_dCoeffA.cols(), lFilterRows, QList<FilterData>() << m_firFilter);
+        matStream.middleCols(i, m_iBlockSize) = matBlock;
+    }
+
+    int iDelay = m_firFilter.m_dCoeffA.cols()/2;
+
+    for(int i = 0; i < iNumChannels; ++i) {
+        RowVectorXd vecExpected = RowVectorXd::Zero(matData.cols());
+
+        if(lFilterRows.contains(i)) {
+            vecExpected = convolve(matData.row(i), m_firFilter.m_dCoeffA);
+        } else {
+            vecExpected.tail(matData.cols() - iDelay) = matData.row(i).head(matData.cols() - iDelay);
+        }
+
+        QVERIFY((matStream.row(i) - vecExpected).cwiseAbs().maxCoeff() < 1e-9);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::testLatency()
+{
+    //The FIR filter is linear phase, i.e. delays all frequencies by half its length
+    double dFirDelay = groupDelay(m_firFilter, 19.0);
+    QVERIFY(qAbs(dFirDelay - (m_firFilter.m_dCoeffA.cols()-1)/2.0) < 1.0);
+
+    double dIirDelay = groupDelay(m_iirFilter, 19.0);
+
+    qDebug() << "Group delay at 19 Hz - FIR:" << 1000.0*dFirDelay/m_dSFreq << "ms, IIR:" << 1000.0*dIirDelay/m_dSFreq << "ms";
+
+    //Unfiltered channels are only delayed to compensate the FIR part
+    RtMultiChannelFilter multiChannelFilter;
+    multiChannelFilter.setFilters(QList<FilterData>() << m_iirFilter, QVector<int>() << 0, 2, m_iBlockSize);
+    QCOMPARE(multiChannelFilter.delay(), 0);
+
+    QVERIFY(dIirDelay < 0.5 * dFirDelay);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::benchmarkFirBlock()
+{
+    RtFilter rtFilter;
+    QList<FilterData> lFilter = QList<FilterData>() << m_firFilter;
+    MatrixXd matBlock = m_matData.leftCols(m_iBlockSize);
+
+    QBENCHMARK {
+        rtFilter.filterChannels(matBlock, m_firFilter.m_dCoeffA.cols(), m_lFilterChannelList, lFilter);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::benchmarkIirBlock()
+{
+    RtFilter rtFilter;
+    QList<FilterData> lFilter = QList<FilterData>() << m_iirFilter;
+    MatrixXd matBlock = m_matData.leftCols(m_iBlockSize);
+
+    QBENCHMARK {
+        rtFilter.filterChannels(matBlock, m_iirFilter.m_dCoeffA.cols(), m_lFilterChannelList, lFilter);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiltering::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+double TestFiltering::groupDelay(const FilterData& filter, double dFreq) const
+{
+    //Derivative of the phase between two neighbouring bins
+    int k = qRound(dFreq / m_dSFreq * filter.m_iFFTlength);
+    std::complex<double> ratio = filter.m_dFFTCoeffA(k+1) / filter.m_dFFTCoeffA(k);
+
+    return -std::arg(ratio) / (2.0 * M_PI / filter.m_iFFTlength);
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXd TestFiltering::convolve(const RowVectorXd& vecData, const RowVectorXd& vecCoeff) const
+{
+    //Causal direct form convolution with zero initial state, truncated to the length of the data
+    RowVectorXd vecOut = RowVectorXd::Zero(vecData.cols());
+
+    for(int n = 0; n < vecData.cols(); ++n) {
+        for(int k = 0; k < vecCoeff.cols() && k <= n; ++k) {
+            vecOut(n) += vecCoeff(k) * vecData(n - k);
+        }
+    }
+
+    return vecOut;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiltering)
+#include "test_filtering.moc"
@@ -77,6 +77,7 @@ private slots:
     void testEmptyInputsForProjecting();
     void testEmptyInputsForSCDC();
     void testDimensionsForSCDC();
+    void testSparseSCDC();
     void cleanupTestCase();
 
 private:
@@ -200,6 +201,37 @@ void TestGeometryInfo::testDimensionsForSCDC() {
 }
 
 
+//*************************************************************************************************************
+
+void TestGeometryInfo::testSparseSCDC() {
+    const double dCancelDist = 0.5;
+    QSharedPointer<MatrixXd> distTable = GeometryInfo::scdc(smallSurface.rr, smallSurface.neighbor_vert, smallSubset, dCancelDist);
+    QSharedPointer<SparseMatrix<float> > sparseTable = GeometryInfo::scdcSparse(smallSurface.rr, smallSurface.neighbor_vert, smallSubset, dCancelDist);
+    QVERIFY(sparseTable->rows() == distTable->rows());
+    QVERIFY(sparseTable->cols() == distTable->cols());
+
+    // distances which are not stored are infinity
+    MatrixXd matSparseDist = MatrixXd::Constant(sparseTable->rows(), sparseTable->cols(), FLOAT_INFINITY);
+    for (int col = 0; col < sparseTable->outerSize(); ++col) {
+        for (SparseMatrix<float>::InnerIterator it(*sparseTable, col); it; ++it) {
+            matSparseDist(it.row(), it.col()) = it.value();
+        }
+    }
+
+    // compare all distances which are not too close to the cancel distance
+    for (int row = 0; row < distTable->rows(); ++row) {
+        for (int col = 0; col < distTable->cols(); ++col) {
+            const double dDist = distTable->coeff(row, col);
+            if (dDist < dCancelDist - 1e-5) {
+                QVERIFY(std::fabs(matSparseDist(row, col) - dDist) < 1e-5);
+            } else if (dDist > dCancelDist + 1e-5) {
+                QVERIFY(matSparseDist(row, col) == FLOAT_INFINITY);
+            }
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void TestGeometryInfo::cleanupTestCase() {
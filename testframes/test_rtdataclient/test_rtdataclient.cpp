@@ -0,0 +1,426 @@
+//=============================================================================================================
+/**
+* @file     test_rtdataclient.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the event driven mode of RtDataClient over a loopback socket
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <realtime/rtClient/rtdataclient.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtDataClient
+*
+* @brief The TestRtDataClient class sends fiff tags to a RtDataClient over a loopback socket and compares what
+* the event driven mode hands on with what was sent
+*
+*/
+class TestRtDataClient: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtDataClient();
+
+private slots:
+    void initTestCase();
+    void init();
+    void receivePool();
+    void receiveCallback();
+    void dropOnOverrun();
+    void stopWithinTag();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns a buffer whose samples identify the buffer, the channel and the sample.
+    */
+    MatrixXf generateBuffer(qint32 p_iBuffer, qint32 p_iNSamp) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the FIFF_DATA_BUFFER tag of a buffer as it is sent by mne_rt_server.
+    */
+    QByteArray dataBufferTag(const MatrixXf& p_matBuffer) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the FIFF_BLOCK_START or FIFF_BLOCK_END tag of a raw data block.
+    */
+    QByteArray blockTag(bool p_bStart) const;
+
+    //=========================================================================================================
+    /**
+    * Writes data from the server side and waits until they are sent.
+    */
+    void send(const QByteArray& p_baData);
+
+    //=========================================================================================================
+    /**
+    * Waits for data on the client side until p_done returns true. The tags are parsed within waitForReadyRead.
+    *
+    * @return false if no more data arrived
+    */
+    bool receive(const std::function<bool()>& p_done);
+
+    QTcpServer m_server;        /**< Listens on the loopback interface */
+    RtDataClient* m_pClient;    /**< The client under test */
+    QTcpSocket* m_pPeer;        /**< The server side of the connection */
+
+    qint32 m_iNChan;            /**< Number of channels */
+    qint32 m_iNSamp;            /**< Samples per buffer */
+};
+
+
+//*************************************************************************************************************
+
+TestRtDataClient::TestRtDataClient()
+: m_pClient(NULL)
+, m_pPeer(NULL)
+, m_iNChan(20)
+, m_iNSamp(50)
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXf TestRtDataClient::generateBuffer(qint32 p_iBuffer, qint32 p_iNSamp) const
+{
+    MatrixXf t_matBuffer(m_iNChan, p_iNSamp);
+
+    //Small integers are exact in float
+    for(qint32 c = 0; c < m_iNChan; ++c)
+        for(qint32 s = 0; s < p_iNSamp; ++s)
+            t_matBuffer(c, s) = (float)(1000000*(p_iBuffer + 1) + 1000*c + s);
+
+    return t_matBuffer;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray TestRtDataClient::dataBufferTag(const MatrixXf& p_matBuffer) const
+{
+    QByteArray t_baTag;
+    FiffStream t_stream(&t_baTag, QIODevice::WriteOnly);
+
+    //Column major, i.e. all channels of a sample after each other
+    t_stream.write_float(FIFF_DATA_BUFFER, p_matBuffer.data(), p_matBuffer.size());
+
+    return t_baTag;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray TestRtDataClient::blockTag(bool p_bStart) const
+{
+    QByteArray t_baTag;
+    FiffStream t_stream(&t_baTag, QIODevice::WriteOnly);
+
+    if(p_bStart)
+        t_stream.start_block(FIFFB_RAW_DATA);
+    else
+        t_stream.end_block(FIFFB_RAW_DATA);
+
+    return t_baTag;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::send(const QByteArray& p_baData)
+{
+    m_pPeer->write(p_baData);
+    while(m_pPeer->bytesToWrite() > 0)
+        if(!m_pPeer->waitForBytesWritten(5000))
+            break;
+}
+
+
+//*************************************************************************************************************
+
+bool TestRtDataClient::receive(const std::function<bool()>& p_done)
+{
+    while(!p_done())
+        if(!m_pClient->waitForReadyRead(5000))
+            return false;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::initTestCase()
+{
+    QVERIFY(m_server.listen(QHostAddress::LocalHost));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::init()
+{
+    m_pClient = new RtDataClient;
+
+    //RtDataClient::connectToHost connects to the port of mne_rt_server
+    m_pClient->QTcpSocket::connectToHost(QHostAddress::LocalHost, m_server.serverPort());
+    QVERIFY(m_pClient->waitForConnected(5000));
+
+    QVERIFY(m_server.waitForNewConnection(5000));
+    m_pPeer = m_server.nextPendingConnection();
+    QVERIFY(m_pPeer != NULL);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::receivePool()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Pool, fragmented tags >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    m_pClient->startReceiving(m_iNChan, m_iNSamp, 8);
+
+    QByteArray t_baData = blockTag(true);
+    for(qint32 i = 0; i < 3; ++i)
+        t_baData.append(dataBufferTag(generateBuffer(i, m_iNSamp)));
+    t_baData.append(blockTag(false));
+
+    //Odd chunks split the headers and the samples
+    for(qint32 i = 0; i < t_baData.size(); i += 7) {
+        send(t_baData.mid(i, 7));
+        QVERIFY(m_pClient->waitForReadyRead(5000));
+    }
+
+    MatrixXf t_matBuffer;
+    fiff_int_t t_iKind = 0;
+
+    QVERIFY(m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+    QCOMPARE(t_iKind, FIFF_BLOCK_START);
+
+    for(qint32 i = 0; i < 3; ++i) {
+        QVERIFY(m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+        QCOMPARE(t_iKind, FIFF_DATA_BUFFER);
+        QVERIFY(t_matBuffer == generateBuffer(i, m_iNSamp));
+    }
+
+    QVERIFY(m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+    QCOMPARE(t_iKind, FIFF_BLOCK_END);
+
+    QVERIFY(!m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+    QVERIFY(m_pClient->droppedBuffers() == 0);
+
+    m_pClient->stopReceiving();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Pool, fragmented tags Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::receiveCallback()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Callback >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QList<fiff_int_t> t_qListKinds;
+    QList<MatrixXf> t_qListBuffers;
+
+    m_pClient->startReceiving(m_iNChan, 0, 0, [&](const MatrixXf& t_matBuffer, fiff_int_t t_iKind) {
+        t_qListKinds.append(t_iKind);
+        if(t_iKind == FIFF_DATA_BUFFER)
+            t_qListBuffers.append(t_matBuffer);
+        else
+            QVERIFY(t_matBuffer.size() == 0);
+    });
+
+    //The buffer size may change between the buffers
+    send(blockTag(true)
+         + dataBufferTag(generateBuffer(0, m_iNSamp))
+         + dataBufferTag(generateBuffer(1, 2*m_iNSamp))
+         + blockTag(false));
+
+    QVERIFY(receive([&]() { return t_qListKinds.size() == 4; }));
+
+    QCOMPARE(t_qListKinds[0], FIFF_BLOCK_START);
+    QCOMPARE(t_qListKinds[1], FIFF_DATA_BUFFER);
+    QCOMPARE(t_qListKinds[2], FIFF_DATA_BUFFER);
+    QCOMPARE(t_qListKinds[3], FIFF_BLOCK_END);
+
+    QCOMPARE(t_qListBuffers.size(), 2);
+    QVERIFY(t_qListBuffers[0] == generateBuffer(0, m_iNSamp));
+    QVERIFY(t_qListBuffers[1] == generateBuffer(1, 2*m_iNSamp));
+
+    m_pClient->stopReceiving();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Callback Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::dropOnOverrun()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Overrun >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    m_pClient->startReceiving(m_iNChan, m_iNSamp, 2);
+
+    //Nothing is taken from the pool, all but the first two tags are dropped
+    QByteArray t_baData;
+    for(qint32 i = 0; i < 4; ++i)
+        t_baData.append(dataBufferTag(generateBuffer(i, m_iNSamp)));
+    t_baData.append(blockTag(false));
+    send(t_baData);
+
+    QVERIFY(receive([&]() { return m_pClient->droppedBuffers() == 3; }));
+
+    MatrixXf t_matBuffer;
+    fiff_int_t t_iKind = 0;
+
+    for(qint32 i = 0; i < 2; ++i) {
+        QVERIFY(m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+        QCOMPARE(t_iKind, FIFF_DATA_BUFFER);
+        QVERIFY(t_matBuffer == generateBuffer(i, m_iNSamp));
+    }
+    QVERIFY(!m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+
+    //The pool accepts tags again once it was emptied
+    send(blockTag(false));
+
+    t_iKind = 0;
+    QVERIFY(receive([&]() { return m_pClient->popRawBuffer(t_matBuffer, t_iKind); }));
+    QCOMPARE(t_iKind, FIFF_BLOCK_END);
+    QVERIFY(m_pClient->droppedBuffers() == 3);
+
+    m_pClient->stopReceiving();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Overrun Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::stopWithinTag()
+{
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Stop within a tag >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    m_pClient->startReceiving(m_iNChan, m_iNSamp, 4);
+
+    QByteArray t_baFirst = dataBufferTag(generateBuffer(0, m_iNSamp));
+    qint32 t_iSplit = t_baFirst.size()/2;
+
+    send(t_baFirst.left(t_iSplit));
+    QVERIFY(m_pClient->waitForReadyRead(5000));
+
+    //The first tag is finished by stopReceiving, the second one is left to the blocking read
+    send(t_baFirst.mid(t_iSplit) + dataBufferTag(generateBuffer(1, m_iNSamp)));
+    m_pClient->stopReceiving();
+
+    MatrixXf t_matBuffer;
+    fiff_int_t t_iKind = 0;
+
+    QVERIFY(m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+    QCOMPARE(t_iKind, FIFF_DATA_BUFFER);
+    QVERIFY(t_matBuffer == generateBuffer(0, m_iNSamp));
+    QVERIFY(!m_pClient->popRawBuffer(t_matBuffer, t_iKind));
+
+    m_pClient->readRawBuffer(m_iNChan, t_matBuffer, t_iKind);
+    QCOMPARE(t_iKind, FIFF_DATA_BUFFER);
+    QVERIFY(t_matBuffer == generateBuffer(1, m_iNSamp));
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Stop within a tag Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::cleanup()
+{
+    delete m_pClient;
+    m_pClient = NULL;
+
+    delete m_pPeer;
+    m_pPeer = NULL;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtDataClient::cleanupTestCase()
+{
+    m_server.close();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtDataClient)
+#include "test_rtdataclient.moc"
@@ -0,0 +1,250 @@
+//=============================================================================================================
+/**
+* @file     test_rtinvop.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the real-time inverse operator updates
+*
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtProcessing/rtinvop.h>
+#include <mne/mne_forwardsolution.h>
+#include <mne/mne_inverse_operator.h>
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_cov.h>
+#include <fs/label.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QMutex>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace MNELIB;
+using namespace FIFFLIB;
+using namespace FSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtInvOp
+*
+* @brief The TestRtInvOp class compares the inverse operators RtInvOp updates from its cached lead field Gram
+* matrix with inverse operators computed from scratch.
+*
+*/
+class TestRtInvOp: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtInvOp();
+
+private slots:
+    void initTestCase();
+    void compareUpdateWithScratch();
+    void cleanupTestCase();
+
+private:
+    MNEInverseOperator::SPtr computeWithRtInvOp(RtInvOp& rtInvOp, FiffCov& noiseCov);
+    MatrixXd kernel(const MNEInverseOperator& invOp) const;
+    double relativeError(const MatrixXd& matTest, const MatrixXd& matRef) const;
+
+    double epsilon;
+
+    FiffInfo::SPtr m_pFiffInfo;
+    MNEForwardSolution::SPtr m_pFwd;
+    FiffCov m_noiseCov;
+    FiffCov m_noiseCovReg;
+
+    QMutex m_mutex;
+    QWaitCondition m_condCalculated;
+    MNEInverseOperator::SPtr m_pInvOpCalculated;
+};
+
+
+//*************************************************************************************************************
+
+TestRtInvOp::TestRtInvOp()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtInvOp::initTestCase()
+{
+    QFile t_fileRaw(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QVERIFY(t_fileRaw.exists());
+    FiffRawData t_raw(t_fileRaw);
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo(t_raw.info));
+
+    QFile t_fileFwd(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
+    QVERIFY(t_fileFwd.exists());
+    m_pFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(t_fileFwd));
+
+    QFile t_fileCov(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif");
+    QVERIFY(t_fileCov.exists());
+    m_noiseCov = FiffCov(t_fileCov);
+
+    //A second noise covariance with the same channels but a different whitener
+    m_noiseCovReg = m_noiseCov.regularize(*m_pFiffInfo.data(), 0.05, 0.05, 0.1, true);
+    QVERIFY(relativeError(m_noiseCovReg.data, m_noiseCov.data) > 1e-3);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtInvOp::compareUpdateWithScratch()
+{
+    //RtInvOp computes its operators from the MEG part of the forward solution
+    MNEForwardSolution t_fwdMeg = m_pFwd->pick_types(true, false);
+
+    RtInvOp rtInvOp(m_pFiffInfo, m_pFwd);
+    connect(&rtInvOp, &RtInvOp::invOperatorCalculated, [this](MNEInverseOperator::SPtr p_pInvOp) {
+        QMutexLocker locker(&m_mutex);
+        m_pInvOpCalculated = p_pInvOp;
+        m_condCalculated.wakeAll();
+    });
+    rtInvOp.start();
+
+    //The first noise covariance is computed from scratch and fills the cache, the following ones are updates
+    MNEInverseOperator::SPtr t_pInvOpFirst = computeWithRtInvOp(rtInvOp, m_noiseCov);
+    QCOMPARE(rtInvOp.getNumComputations(), 1);
+    QCOMPARE(rtInvOp.getNumUpdates(), 0);
+
+    MNEInverseOperator::SPtr t_pInvOpUpdate = computeWithRtInvOp(rtInvOp, m_noiseCovReg);
+    MNEInverseOperator::SPtr t_pInvOpUpdateBack = computeWithRtInvOp(rtInvOp, m_noiseCov);
+
+    rtInvOp.stop();
+
+    QVERIFY(t_pInvOpFirst && t_pInvOpUpdate && t_pInvOpUpdateBack);
+
+    //Both following operators have to come from the cache, not from a silent fallback to the full computation
+    QCOMPARE(rtInvOp.getNumComputations(), 1);
+    QCOMPARE(rtInvOp.getNumUpdates(), 2);
+
+    MNEInverseOperator t_invOpScratch(*m_pFiffInfo.data(), t_fwdMeg, m_noiseCov, 0.2f, 0.8f);
+    MNEInverseOperator t_invOpScratchReg(*m_pFiffInfo.data(), t_fwdMeg, m_noiseCovReg, 0.2f, 0.8f);
+
+    //The singular vectors are only unique up to their sign, so the operators are compared by their kernels
+    QCOMPARE(t_pInvOpUpdate->sing.size(), t_invOpScratchReg.sing.size());
+    QVERIFY(relativeError(t_pInvOpUpdate->sing, t_invOpScratchReg.sing) < epsilon);
+    QVERIFY(relativeError(t_pInvOpUpdate->source_cov->data, t_invOpScratchReg.source_cov->data) < epsilon);
+    QVERIFY(relativeError(kernel(*t_pInvOpUpdate.data()), kernel(t_invOpScratchReg)) < epsilon);
+
+    //Updating back to the first noise covariance restores the first operator
+    QVERIFY(relativeError(t_pInvOpUpdateBack->sing, t_invOpScratch.sing) < epsilon);
+    QVERIFY(relativeError(kernel(*t_pInvOpUpdateBack.data()), kernel(t_invOpScratch)) < epsilon);
+    QVERIFY(relativeError(kernel(*t_pInvOpUpdateBack.data()), kernel(*t_pInvOpFirst.data())) < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtInvOp::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator::SPtr TestRtInvOp::computeWithRtInvOp(RtInvOp& rtInvOp, FiffCov& noiseCov)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pInvOpCalculated.reset();
+
+    rtInvOp.appendNoiseCov(noiseCov);
+
+    //The computation from scratch takes a while with a full resolution forward solution
+    while(!m_pInvOpCalculated) {
+        if(!m_condCalculated.wait(&m_mutex, 300000)) {
+            break;
+        }
+    }
+
+    return m_pInvOpCalculated;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtInvOp::kernel(const MNEInverseOperator& invOp) const
+{
+    MNEInverseOperator t_invOp = invOp.prepare_inverse_operator(1, 1.0f/9.0f, false);
+
+    MatrixXd K;
+    SparseMatrix<double> noiseNorm;
+    QList<VectorXi> vertno;
+    t_invOp.assemble_kernel(Label(), "MNE", false, K, noiseNorm, vertno);
+
+    return K;
+}
+
+
+//*************************************************************************************************************
+
+double TestRtInvOp::relativeError(const MatrixXd& matTest, const MatrixXd& matRef) const
+{
+    return (matTest - matRef).norm() / matRef.norm();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtInvOp)
+#include "test_rtinvop.moc"
@@ -0,0 +1,866 @@
+//=============================================================================================================
+/**
+* @file     test_spatial_search.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the k-d tree and triangle bounding volume hierarchy against brute force searches, including
+*           the solid angle tests of the source space filtering
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/kdtree.h>
+#include <utils/trianglebvh.h>
+#include <mne/c/mne_surface_old.h>
+#include <mne/c/mne_source_space_old.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QMap>
+#include <QPair>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// CONST
+//=============================================================================================================
+
+//Status codes of MneSurfaceOrVolume::mne_classify_source_points
+const int FILTER_KEEP       = 0;
+const int FILTER_OUTSIDE    = 1;
+const int FILTER_TOO_CLOSE  = 2;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestSpatialSearch
+*
+* @brief The TestSpatialSearch class compares the queries of KdTree and TriangleBvh with brute force searches
+*
+*/
+class TestSpatialSearch: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSpatialSearch();
+
+private slots:
+    void initTestCase();
+    void compareNearest();
+    void compareKnn();
+    void compareKnnMoreThanSize();
+    void compareEmptyTree();
+    void compareClosestTriangle();
+    void compareTrianglesWithin();
+    void compareWindingNumber();
+    void compareOpenSurface();
+    void compareClassifySourcePoints();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns a uniformly distributed random number in [p_fMin, p_fMax). A linear congruential generator is used,
+    * so the test is reproducible on all platforms.
+    */
+    float random(float p_fMin, float p_fMax);
+
+    //=========================================================================================================
+    /**
+    * Creates an icosahedron on the unit sphere, each subdivision splits every triangle into four.
+    */
+    void makeIcosahedron(int p_iSubdivisions, MatrixX3f& p_matVertices, MatrixX3i& p_matTris) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the squared distances of all points to a query position, computed the same way as in KdTree.
+    */
+    VectorXf bruteDistances(const MatrixX3f& p_matPoints, const Vector3f& p_vecQuery) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the squared distances of all triangles to a query position.
+    */
+    VectorXf bruteTriangleDistances(const MatrixX3f& p_matVertices, const MatrixX3i& p_matTris, const Vector3f& p_vecQuery) const;
+
+    //=========================================================================================================
+    /**
+    * Checks the k nearest neighbors found by the tree against the sorted brute force distances.
+    */
+    void verifyKnn(const KdTree& p_tree, const Vector3f& p_vecQuery, int p_iK);
+
+    //=========================================================================================================
+    /**
+    * Creates an MNE surface with triangle data from a triangulation.
+    */
+    MneSurfaceOld* makeSurface(const MatrixX3f& p_matVertices, const MatrixX3i& p_matTris) const;
+
+    //=========================================================================================================
+    /**
+    * Returns positions close to the triangles, vertices and edges of a triangulation, on both sides and at
+    * distances down to the precision of the winding number test.
+    */
+    MatrixX3f nearSurfaceQueries(const MatrixX3f& p_matVertices, const MatrixX3i& p_matTris);
+
+    //=========================================================================================================
+    /**
+    * Classifies the points in use with the exact solid angle sum and the brute force vertex distances, in the
+    * same way as MneSurfaceOrVolume::mne_classify_source_points.
+    */
+    QVector<int> bruteClassify(MneSourceSpaceOld* p_pSpace, MneSurfaceOld* p_pSurf, const MatrixX3f& p_matVertices, float p_fLimit) const;
+
+    quint32 m_iState;               /**< State of the random number generator */
+
+    MatrixX3f m_matPoints;          /**< Random points including duplicates */
+    MatrixX3f m_matQueries;         /**< Random query positions and some of the points */
+
+    MatrixX3f m_matIcoVertices;     /**< Vertices of the plain icosahedron */
+    MatrixX3i m_matIcoTris;         /**< Triangles of the plain icosahedron */
+    MatrixX3f m_matSphereVertices;  /**< Vertices of the subdivided icosahedron */
+    MatrixX3i m_matSphereTris;      /**< Triangles of the subdivided icosahedron */
+    MatrixX3f m_matSurfQueries;     /**< Query positions for the surface searches */
+};
+
+
+//*************************************************************************************************************
+
+TestSpatialSearch::TestSpatialSearch()
+: m_iState(1)
+{
+}
+
+
+//*************************************************************************************************************
+
+float TestSpatialSearch::random(float p_fMin, float p_fMax)
+{
+    m_iState = 1664525u*m_iState + 1013904223u;
+    return p_fMin + (p_fMax - p_fMin)*(float)(m_iState >> 8)/(float)(1 << 24);
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::makeIcosahedron(int p_iSubdivisions, MatrixX3f& p_matVertices, MatrixX3i& p_matTris) const
+{
+    const float t = (1.0f + std::sqrt(5.0f))/2.0f;
+
+    QVector<Vector3f> t_vecVertices;
+    t_vecVertices << Vector3f(-1, t, 0) << Vector3f(1, t, 0) << Vector3f(-1, -t, 0) << Vector3f(1, -t, 0)
+                  << Vector3f(0, -1, t) << Vector3f(0, 1, t) << Vector3f(0, -1, -t) << Vector3f(0, 1, -t)
+                  << Vector3f(t, 0, -1) << Vector3f(t, 0, 1) << Vector3f(-t, 0, -1) << Vector3f(-t, 0, 1);
+
+    const int t_iIcoTris[20][3] = { {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+                                    {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+                                    {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+                                    {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1} };
+
+    QVector<Vector3i> t_vecTris;
+    for(int i = 0; i < 20; ++i)
+        t_vecTris << Vector3i(t_iIcoTris[i][0], t_iIcoTris[i][1], t_iIcoTris[i][2]);
+
+    for(int i = 0; i < t_vecVertices.size(); ++i)
+        t_vecVertices[i].normalize();
+
+    for(int s = 0; s < p_iSubdivisions; ++s) {
+        QMap<QPair<int,int>, int> t_mapMidpoints;
+        QVector<Vector3i> t_vecNewTris;
+
+        for(int i = 0; i < t_vecTris.size(); ++i) {
+            int t_iMid[3];
+            for(int e = 0; e < 3; ++e) {
+                int a = t_vecTris[i][e];
+                int b = t_vecTris[i][(e + 1) % 3];
+                QPair<int,int> t_edge(std::min(a, b), std::max(a, b));
+
+                if(!t_mapMidpoints.contains(t_edge)) {
+                    t_mapMidpoints.insert(t_edge, t_vecVertices.size());
+                    t_vecVertices << (t_vecVertices[a] + t_vecVertices[b]).normalized();
+                }
+                t_iMid[e] = t_mapMidpoints[t_edge];
+            }
+
+            t_vecNewTris << Vector3i(t_vecTris[i][0], t_iMid[0], t_iMid[2])
+                         << Vector3i(t_vecTris[i][1], t_iMid[1], t_iMid[0])
+                         << Vector3i(t_vecTris[i][2], t_iMid[2], t_iMid[1])
+                         << Vector3i(t_iMid[0], t_iMid[1], t_iMid[2]);
+        }
+
+        t_vecTris = t_vecNewTris;
+    }
+
+    p_matVertices.resize(t_vecVertices.size(), 3);
+    for(int i = 0; i < t_vecVertices.size(); ++i)
+        p_matVertices.row(i) = t_vecVertices[i].transpose();
+
+    p_matTris.resize(t_vecTris.size(), 3);
+    for(int i = 0; i < t_vecTris.size(); ++i)
+        p_matTris.row(i) = t_vecTris[i].transpose();
+}
+
+
+//*************************************************************************************************************
+
+VectorXf TestSpatialSearch::bruteDistances(const MatrixX3f& p_matPoints, const Vector3f& p_vecQuery) const
+{
+    VectorXf t_vecDist2(p_matPoints.rows());
+    for(int i = 0; i < p_matPoints.rows(); ++i)
+        t_vecDist2[i] = (p_matPoints.row(i).transpose() - p_vecQuery).squaredNorm();
+
+    return t_vecDist2;
+}
+
+
+//*************************************************************************************************************
+
+VectorXf TestSpatialSearch::bruteTriangleDistances(const MatrixX3f& p_matVertices,
+                                                   const MatrixX3i& p_matTris,
+                                                   const Vector3f& p_vecQuery) const
+{
+    VectorXf t_vecDist2(p_matTris.rows());
+    for(int i = 0; i < p_matTris.rows(); ++i) {
+        Vector3f t_vecClosest = TriangleBvh::closestPointOnTriangle(p_vecQuery,
+                                                                    p_matVertices.row(p_matTris(i, 0)).transpose(),
+                                                                    p_matVertices.row(p_matTris(i, 1)).transpose(),
+                                                                    p_matVertices.row(p_matTris(i, 2)).transpose());
+        t_vecDist2[i] = (t_vecClosest - p_vecQuery).squaredNorm();
+    }
+
+    return t_vecDist2;
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::verifyKnn(const KdTree& p_tree, const Vector3f& p_vecQuery, int p_iK)
+{
+    VectorXf t_vecDist2 = bruteDistances(m_matPoints, p_vecQuery);
+    std::vector<float> t_vecSorted(t_vecDist2.data(), t_vecDist2.data() + t_vecDist2.size());
+    std::sort(t_vecSorted.begin(), t_vecSorted.end());
+
+    VectorXi t_vecIdx;
+    VectorXf t_vecDist;
+    p_tree.knn(p_vecQuery, p_iK, t_vecIdx, t_vecDist);
+
+    const int t_iExpected = std::min(p_iK, (int)m_matPoints.rows());
+    QCOMPARE((int)t_vecIdx.size(), t_iExpected);
+    QCOMPARE((int)t_vecDist.size(), t_iExpected);
+
+    //Duplicates make the order of equally distant points arbitrary, so the distances are compared
+    QVector<bool> t_vecUsed(m_matPoints.rows(), false);
+    for(int i = 0; i < t_iExpected; ++i) {
+        QVERIFY(t_vecIdx[i] >= 0 && t_vecIdx[i] < m_matPoints.rows());
+        QVERIFY(!t_vecUsed[t_vecIdx[i]]);
+        t_vecUsed[t_vecIdx[i]] = true;
+
+        QCOMPARE(t_vecDist[i], std::sqrt(t_vecSorted[i]));
+        QCOMPARE(t_vecDist[i], std::sqrt(t_vecDist2[t_vecIdx[i]]));
+    }
+}
+
+
+//*************************************************************************************************************
+
+MneSurfaceOld* TestSpatialSearch::makeSurface(const MatrixX3f& p_matVertices, const MatrixX3i& p_matTris) const
+{
+    MneSurfaceOld* t_pSurf = (MneSurfaceOld*)MneSurfaceOrVolume::mne_new_source_space(p_matVertices.rows());
+
+    for(int i = 0; i < p_matVertices.rows(); ++i) {
+        for(int j = 0; j < 3; ++j)
+            t_pSurf->rr[i][j] = p_matVertices(i, j);
+        t_pSurf->inuse[i] = 1;
+        t_pSurf->vertno[i] = i;
+    }
+    t_pSurf->nuse = t_pSurf->np;
+
+    //Allocated in one block as the surface releases it
+    t_pSurf->ntri = p_matTris.rows();
+    t_pSurf->itris = (int **)malloc(t_pSurf->ntri*sizeof(int *));
+    t_pSurf->itris[0] = (int *)malloc(3*t_pSurf->ntri*sizeof(int));
+    for(int k = 0; k < t_pSurf->ntri; ++k) {
+        t_pSurf->itris[k] = t_pSurf->itris[0] + 3*k;
+        for(int j = 0; j < 3; ++j)
+            t_pSurf->itris[k][j] = p_matTris(k, j);
+    }
+    MneSurfaceOrVolume::mne_add_triangle_data((MneSourceSpaceOld*)t_pSurf);
+
+    return t_pSurf;
+}
+
+
+//*************************************************************************************************************
+
+MatrixX3f TestSpatialSearch::nearSurfaceQueries(const MatrixX3f& p_matVertices, const MatrixX3i& p_matTris)
+{
+    const float t_fOffsets[] = { 1e-2f, 1e-4f, 1e-5f, 1e-6f, 1e-7f };
+    const int t_iNOffsets = sizeof(t_fOffsets)/sizeof(float);
+    const int t_iNTris = std::min(60, (int)p_matTris.rows());
+
+    QVector<Vector3f> t_vecQueries;
+
+    for(int k = 0; k < t_iNTris; ++k) {
+        int t = (k*97) % p_matTris.rows();
+        Vector3f a = p_matVertices.row(p_matTris(t, 0)).transpose();
+        Vector3f b = p_matVertices.row(p_matTris(t, 1)).transpose();
+        Vector3f c = p_matVertices.row(p_matTris(t, 2)).transpose();
+        Vector3f t_vecNormal = (b - a).cross(c - a).normalized();
+
+        //A random point of the face, the middle of an edge and a vertex
+        float u = random(0.05f, 0.9f);
+        float v = random(0.05f, 0.95f - u);
+        Vector3f t_vecOnSurf[3] = { a + u*(b - a) + v*(c - a), 0.5f*(a + b), a };
+
+        for(int p = 0; p < 3; ++p)
+            for(int o = 0; o < t_iNOffsets; ++o) {
+                t_vecQueries << t_vecOnSurf[p] + t_fOffsets[o]*t_vecNormal;
+                t_vecQueries << t_vecOnSurf[p] - t_fOffsets[o]*t_vecNormal;
+            }
+    }
+
+    MatrixX3f t_matQueries(t_vecQueries.size(), 3);
+    for(int i = 0; i < t_vecQueries.size(); ++i)
+        t_matQueries.row(i) = t_vecQueries[i].transpose();
+
+    return t_matQueries;
+}
+
+
+//*************************************************************************************************************
+
+QVector<int> TestSpatialSearch::bruteClassify(MneSourceSpaceOld* p_pSpace, MneSurfaceOld* p_pSurf, const MatrixX3f& p_matVertices, float p_fLimit) const
+{
+    QVector<int> t_vecStatus(p_pSpace->np, FILTER_KEEP);
+
+    for(int p = 0; p < p_pSpace->np; ++p) {
+        if(!p_pSpace->inuse[p])
+            continue;
+        if(std::fabs(MneSurfaceOrVolume::sum_solids(p_pSpace->rr[p], p_pSurf)/(4*M_PI) - 1.0) > 1e-5)
+            t_vecStatus[p] = FILTER_OUTSIDE;
+        else if(p_fLimit > 0.0f) {
+            Vector3f t_vecPoint(p_pSpace->rr[p][0], p_pSpace->rr[p][1], p_pSpace->rr[p][2]);
+            if(std::sqrt(bruteDistances(p_matVertices, t_vecPoint).minCoeff()) < p_fLimit)
+                t_vecStatus[p] = FILTER_TOO_CLOSE;
+        }
+    }
+
+    return t_vecStatus;
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::initTestCase()
+{
+    //
+    //   Random points with a few exact duplicates and a cluster of identical points
+    //
+    const int t_iNRandom = 700;
+    const int t_iNDuplicates = 60;
+    const int t_iNCluster = 25;
+
+    m_matPoints.resize(t_iNRandom + t_iNDuplicates + t_iNCluster, 3);
+    for(int i = 0; i < t_iNRandom; ++i)
+        m_matPoints.row(i) << random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-0.2f, 0.2f);
+    for(int i = 0; i < t_iNDuplicates; ++i)
+        m_matPoints.row(t_iNRandom + i) = m_matPoints.row((i*37) % t_iNRandom);
+    for(int i = 0; i < t_iNCluster; ++i)
+        m_matPoints.row(t_iNRandom + t_iNDuplicates + i) = m_matPoints.row(11);
+
+    m_matQueries.resize(300, 3);
+    for(int i = 0; i < 250; ++i)
+        m_matQueries.row(i) << random(-1.5f, 1.5f), random(-1.5f, 1.5f), random(-0.5f, 0.5f);
+    for(int i = 250; i < 300; ++i)
+        m_matQueries.row(i) = m_matPoints.row((i*37) % t_iNRandom);
+    m_matQueries.row(299) = m_matPoints.row(11);
+
+    //
+    //   The plain and a subdivided icosahedron
+    //
+    makeIcosahedron(0, m_matIcoVertices, m_matIcoTris);
+    makeIcosahedron(3, m_matSphereVertices, m_matSphereTris);
+
+    QCOMPARE((int)m_matIcoTris.rows(), 20);
+    QCOMPARE((int)m_matSphereTris.rows(), 20*64);
+
+    //Query positions inside, outside, close to and on the surface
+    m_matSurfQueries.resize(400, 3);
+    for(int i = 0; i < 300; ++i) {
+        Vector3f t_vecDir(random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f));
+        if(t_vecDir.norm() < 1e-3f)
+            t_vecDir = Vector3f(1, 0, 0);
+        m_matSurfQueries.row(i) = (random(0.0f, 2.5f)*t_vecDir.normalized()).transpose();
+    }
+    for(int i = 300; i < 350; ++i) {
+        Vector3f t_vecDir(random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f));
+        if(t_vecDir.norm() < 1e-3f)
+            t_vecDir = Vector3f(0, 1, 0);
+        m_matSurfQueries.row(i) = (random(0.98f, 1.02f)*t_vecDir.normalized()).transpose();
+    }
+    for(int i = 350; i < 400; ++i)
+        m_matSurfQueries.row(i) = m_matSphereVertices.row((i*13) % m_matSphereVertices.rows());
+    m_matSurfQueries.row(0).setZero();
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareNearest()
+{
+    KdTree t_tree(m_matPoints);
+    QCOMPARE(t_tree.size(), (int)m_matPoints.rows());
+
+    for(int i = 0; i < m_matQueries.rows(); ++i) {
+        Vector3f t_vecQuery = m_matQueries.row(i).transpose();
+        VectorXf t_vecDist2 = bruteDistances(m_matPoints, t_vecQuery);
+
+        float t_fDist;
+        int t_iIdx = t_tree.nearest(t_vecQuery, &t_fDist);
+
+        QVERIFY(t_iIdx >= 0 && t_iIdx < m_matPoints.rows());
+        QCOMPARE(t_fDist, std::sqrt(t_vecDist2.minCoeff()));
+        QCOMPARE(t_vecDist2[t_iIdx], t_vecDist2.minCoeff());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareKnn()
+{
+    const int t_iK[] = { 1, 2, 8, 30, 100 };
+
+    //The leaf size 1 gives the deepest tree, the duplicate cluster does not fit into a single leaf
+    const int t_iLeafSize[] = { 1, 8, 64 };
+
+    for(int l = 0; l < 3; ++l) {
+        KdTree t_tree(m_matPoints, t_iLeafSize[l]);
+
+        for(int k = 0; k < 5; ++k) {
+            for(int i = 0; i < m_matQueries.rows(); ++i) {
+                verifyKnn(t_tree, m_matQueries.row(i).transpose(), t_iK[k]);
+                if(QTest::currentTestFailed())
+                    return;
+            }
+
+            //The batched queries give the same results as the single ones
+            MatrixXi t_matIdx;
+            MatrixXf t_matDist;
+            t_tree.knn(m_matQueries, t_iK[k], t_matIdx, t_matDist);
+
+            QCOMPARE((int)t_matIdx.rows(), (int)m_matQueries.rows());
+            QCOMPARE((int)t_matIdx.cols(), t_iK[k]);
+
+            for(int i = 0; i < m_matQueries.rows(); ++i) {
+                VectorXi t_vecIdx;
+                VectorXf t_vecDist;
+                t_tree.knn(m_matQueries.row(i).transpose(), t_iK[k], t_vecIdx, t_vecDist);
+
+                QVERIFY(t_matIdx.row(i).transpose() == t_vecIdx);
+                QVERIFY(t_matDist.row(i).transpose() == t_vecDist);
+            }
+        }
+    }
+
+    //All points of the duplicate cluster are found at distance zero
+    KdTree t_tree(m_matPoints);
+    VectorXi t_vecIdx;
+    VectorXf t_vecDist;
+    t_tree.knn(m_matPoints.row(11).transpose(), 26, t_vecIdx, t_vecDist);
+    QCOMPARE((int)t_vecIdx.size(), 26);
+    QVERIFY(t_vecDist.maxCoeff() == 0.0f);
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareKnnMoreThanSize()
+{
+    //k > n returns all points, sorted by their distances
+    KdTree t_tree(m_matPoints, 4);
+    const int t_iN = m_matPoints.rows();
+
+    for(int i = 0; i < 20; ++i) {
+        verifyKnn(t_tree, m_matQueries.row(i).transpose(), t_iN);
+        verifyKnn(t_tree, m_matQueries.row(i).transpose(), t_iN + 17);
+    }
+
+    MatrixXi t_matIdx;
+    MatrixXf t_matDist;
+    t_tree.knn(m_matQueries.topRows(20), t_iN + 17, t_matIdx, t_matDist);
+    QCOMPARE((int)t_matIdx.cols(), t_iN);
+    QCOMPARE((int)t_matDist.cols(), t_iN);
+
+    //A tree of fewer points than a single leaf
+    MatrixX3f t_matFew = m_matPoints.topRows(3);
+    t_matFew.row(2) = t_matFew.row(0);
+    KdTree t_treeFew(t_matFew);
+
+    VectorXi t_vecIdx;
+    VectorXf t_vecDist;
+    t_treeFew.knn(Vector3f(5, 5, 5), 10, t_vecIdx, t_vecDist);
+    QCOMPARE((int)t_vecIdx.size(), 3);
+    for(int i = 1; i < 3; ++i)
+        QVERIFY(t_vecDist[i - 1] <= t_vecDist[i]);
+
+    VectorXi t_vecSorted = t_vecIdx;
+    std::sort(t_vecSorted.data(), t_vecSorted.data() + t_vecSorted.size());
+    QVERIFY(t_vecSorted == Vector3i(0, 1, 2));
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareEmptyTree()
+{
+    KdTree t_tree(MatrixX3f(0, 3));
+    QCOMPARE(t_tree.size(), 0);
+    QCOMPARE(t_tree.nearest(Vector3f(0, 0, 0)), -1);
+
+    VectorXi t_vecIdx;
+    VectorXf t_vecDist;
+    t_tree.knn(Vector3f(0, 0, 0), 5, t_vecIdx, t_vecDist);
+    QCOMPARE((int)t_vecIdx.size(), 0);
+
+    TriangleBvh t_bvh(MatrixX3f(0, 3), MatrixX3i(0, 3));
+    QCOMPARE(t_bvh.size(), 0);
+
+    Vector3f t_vecClosest;
+    float t_fDist;
+    QCOMPARE(t_bvh.closestTriangle(Vector3f(0, 0, 0), t_vecClosest, t_fDist), -1);
+
+    QVector<int> t_vecTris;
+    t_bvh.trianglesWithin(Vector3f(0, 0, 0), 10.0f, t_vecTris);
+    QVERIFY(t_vecTris.isEmpty());
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareClosestTriangle()
+{
+    const MatrixX3f* t_pVertices[] = { &m_matIcoVertices, &m_matSphereVertices };
+    const MatrixX3i* t_pTris[] = { &m_matIcoTris, &m_matSphereTris };
+    const int t_iLeafSize[] = { 1, 4, 16 };
+
+    for(int m = 0; m < 2; ++m) {
+        for(int l = 0; l < 3; ++l) {
+            TriangleBvh t_bvh(*t_pVertices[m], *t_pTris[m], t_iLeafSize[l]);
+            QCOMPARE(t_bvh.size(), (int)t_pTris[m]->rows());
+
+            for(int i = 0; i < m_matSurfQueries.rows(); ++i) {
+                Vector3f t_vecQuery = m_matSurfQueries.row(i).transpose();
+                VectorXf t_vecDist2 = bruteTriangleDistances(*t_pVertices[m], *t_pTris[m], t_vecQuery);
+
+                Vector3f t_vecClosest;
+                float t_fDist;
+                int t_iTri = t_bvh.closestTriangle(t_vecQuery, t_vecClosest, t_fDist);
+
+                //Neighboring triangles share edges and vertices, so only the distance has to be minimal
+                QVERIFY(t_iTri >= 0 && t_iTri < t_pTris[m]->rows());
+                QCOMPARE(t_fDist, std::sqrt(t_vecDist2.minCoeff()));
+                QCOMPARE(t_vecDist2[t_iTri], t_vecDist2.minCoeff());
+                QCOMPARE((t_vecClosest - t_vecQuery).squaredNorm(), t_vecDist2[t_iTri]);
+            }
+
+            //The batched queries give the same results as the single ones
+            VectorXi t_vecTris;
+            MatrixX3f t_matClosest;
+            VectorXf t_vecDist;
+            t_bvh.closestTriangles(m_matSurfQueries, t_vecTris, t_matClosest, t_vecDist);
+
+            QCOMPARE((int)t_vecTris.size(), (int)m_matSurfQueries.rows());
+            for(int i = 0; i < m_matSurfQueries.rows(); ++i) {
+                Vector3f t_vecClosest;
+                float t_fDist;
+                QCOMPARE(t_vecTris[i], t_bvh.closestTriangle(m_matSurfQueries.row(i).transpose(), t_vecClosest, t_fDist));
+                QVERIFY(t_matClosest.row(i).transpose() == t_vecClosest);
+                QVERIFY(t_vecDist[i] == t_fDist);
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareTrianglesWithin()
+{
+    const MatrixX3f* t_pVertices[] = { &m_matIcoVertices, &m_matSphereVertices };
+    const MatrixX3i* t_pTris[] = { &m_matIcoTris, &m_matSphereTris };
+    const float t_fRadius[] = { 0.0f, 0.01f, 0.1f, 0.4f, 1.0f, 4.0f };
+
+    for(int m = 0; m < 2; ++m) {
+        TriangleBvh t_bvh(*t_pVertices[m], *t_pTris[m]);
+
+        for(int r = 0; r < 6; ++r) {
+            const float t_fRadius2 = t_fRadius[r]*t_fRadius[r];
+
+            for(int i = 0; i < m_matSurfQueries.rows(); ++i) {
+                Vector3f t_vecQuery = m_matSurfQueries.row(i).transpose();
+                VectorXf t_vecDist2 = bruteTriangleDistances(*t_pVertices[m], *t_pTris[m], t_vecQuery);
+
+                QVector<int> t_vecExpected;
+                for(int t = 0; t < t_vecDist2.size(); ++t)
+                    if(t_vecDist2[t] <= t_fRadius2)
+                        t_vecExpected.append(t);
+
+                QVector<int> t_vecTris;
+                t_bvh.trianglesWithin(t_vecQuery, t_fRadius[r], t_vecTris);
+
+                QCOMPARE(t_vecTris, t_vecExpected);
+            }
+        }
+
+        //A vertex of the mesh lies within radius zero of all triangles around it
+        QVector<int> t_vecTris;
+        t_bvh.trianglesWithin(t_pVertices[m]->row(0).transpose(), 0.0f, t_vecTris);
+        QCOMPARE(t_vecTris.size(), 5);
+
+        //Negative radii give no triangles
+        t_bvh.trianglesWithin(Vector3f(0, 0, 0), -1.0f, t_vecTris);
+        QVERIFY(t_vecTris.isEmpty());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareWindingNumber()
+{
+    const MatrixX3f* t_pVertices[] = { &m_matIcoVertices, &m_matSphereVertices };
+    const MatrixX3i* t_pTris[] = { &m_matIcoTris, &m_matSphereTris };
+
+    for(int m = 0; m < 2; ++m) {
+        MneSurfaceOld* t_pSurf = makeSurface(*t_pVertices[m], *t_pTris[m]);
+        TriangleBvh* t_pBvh = MneSurfaceOrVolume::mne_make_surface_bvh(t_pSurf);
+
+        QVERIFY(MneSurfaceOrVolume::mne_surface_is_closed(t_pSurf));
+
+        MatrixX3f t_matNear = nearSurfaceQueries(*t_pVertices[m], *t_pTris[m]);
+        MatrixX3f t_matQueries(m_matSurfQueries.rows() + t_matNear.rows(), 3);
+        t_matQueries << m_matSurfQueries, t_matNear;
+
+        int t_iNUndecided = 0;
+        for(int i = 0; i < t_matQueries.rows(); ++i) {
+            float t_fQuery[3] = { t_matQueries(i, 0), t_matQueries(i, 1), t_matQueries(i, 2) };
+            double t_dSum = MneSurfaceOrVolume::sum_solids(t_fQuery, t_pSurf);
+
+            //Positions on the surface are left to the exact sum
+            int t_iWinding;
+            if(t_pBvh->windingNumber(t_matQueries.row(i).transpose(), t_iWinding)) {
+                QCOMPARE(t_iWinding, (int)std::floor(t_dSum/(4*M_PI) + 0.5));
+                QVERIFY(t_iWinding == 0 || t_iWinding == 1);
+            } else {
+                ++t_iNUndecided;
+            }
+
+            //Inside or outside must be decided as by the exact sum
+            double t_dSumBvh = MneSurfaceOrVolume::sum_solids_bvh(t_fQuery, t_pSurf, t_pBvh);
+            QCOMPARE(std::fabs(t_dSumBvh/(4*M_PI) - 1.0) > 1e-5, std::fabs(t_dSum/(4*M_PI) - 1.0) > 1e-5);
+        }
+
+        //The hierarchy decides all but the positions (almost) on the surface
+        QVERIFY(t_iNUndecided < t_matQueries.rows()/4);
+
+        delete t_pBvh;
+        delete t_pSurf;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareOpenSurface()
+{
+    //
+    //   A sphere with a hole at the top and a sphere with one triangle flipped
+    //
+    QVector<int> t_vecKept;
+    for(int t = 0; t < m_matSphereTris.rows(); ++t) {
+        float t_fZ = (m_matSphereVertices(m_matSphereTris(t, 0), 2) + m_matSphereVertices(m_matSphereTris(t, 1), 2) + m_matSphereVertices(m_matSphereTris(t, 2), 2))/3.0f;
+        if(t_fZ < 0.6f)
+            t_vecKept.append(t);
+    }
+    QVERIFY(t_vecKept.size() < m_matSphereTris.rows());
+
+    MatrixX3i t_matOpenTris(t_vecKept.size(), 3);
+    for(int k = 0; k < t_vecKept.size(); ++k)
+        t_matOpenTris.row(k) = m_matSphereTris.row(t_vecKept[k]);
+
+    MatrixX3i t_matFlippedTris = m_matSphereTris;
+    t_matFlippedTris.row(7) << m_matSphereTris(7, 0), m_matSphereTris(7, 2), m_matSphereTris(7, 1);
+
+    MneSurfaceOld* t_pOpen = makeSurface(m_matSphereVertices, t_matOpenTris);
+    MneSurfaceOld* t_pFlipped = makeSurface(m_matSphereVertices, t_matFlippedTris);
+
+    QVERIFY(!MneSurfaceOrVolume::mne_surface_is_closed(t_pOpen));
+    QVERIFY(!MneSurfaceOrVolume::mne_surface_is_closed(t_pFlipped));
+
+    //
+    //   Without a hierarchy the exact sum is used, which is not a multiple of 4 pi next to the hole
+    //
+    MatrixX3f t_matNear = nearSurfaceQueries(m_matSphereVertices, t_matOpenTris);
+    MatrixX3f t_matQueries(m_matSurfQueries.rows() + t_matNear.rows(), 3);
+    t_matQueries << m_matSurfQueries, t_matNear;
+
+    bool t_bFractional = false;
+    for(int i = 0; i < t_matQueries.rows(); ++i) {
+        float t_fQuery[3] = { t_matQueries(i, 0), t_matQueries(i, 1), t_matQueries(i, 2) };
+        double t_dSum = MneSurfaceOrVolume::sum_solids(t_fQuery, t_pOpen);
+
+        QVERIFY(MneSurfaceOrVolume::sum_solids_bvh(t_fQuery, t_pOpen, Q_NULLPTR) == t_dSum);
+
+        double t_dWinding = t_dSum/(4*M_PI);
+        if(std::fabs(t_dWinding - std::floor(t_dWinding + 0.5)) > 0.01)
+            t_bFractional = true;
+    }
+    QVERIFY(t_bFractional);
+
+    //
+    //   The source space filter classifies with the exact sum
+    //
+    MneSourceSpaceOld* t_pSpace = MneSurfaceOrVolume::mne_new_source_space(t_matQueries.rows());
+    for(int p = 0; p < t_pSpace->np; ++p) {
+        for(int j = 0; j < 3; ++j)
+            t_pSpace->rr[p][j] = t_matQueries(p, j);
+        t_pSpace->inuse[p] = 1;
+    }
+    t_pSpace->nuse = t_pSpace->np;
+
+    KdTree* t_pTree = MneSurfaceOrVolume::mne_make_surface_vertex_tree(t_pOpen);
+    QVector<int> t_vecStatus(t_pSpace->np);
+    MneSurfaceOrVolume::mne_classify_source_points(t_pSpace, Q_NULLPTR, t_pOpen, Q_NULLPTR, t_pTree, 0.05f, t_vecStatus.data(), true);
+    QCOMPARE(t_vecStatus, bruteClassify(t_pSpace, t_pOpen, m_matSphereVertices, 0.05f));
+
+    delete t_pTree;
+    delete t_pSpace;
+    delete t_pFlipped;
+    delete t_pOpen;
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::compareClassifySourcePoints()
+{
+    MneSurfaceOld* t_pSurf = makeSurface(m_matSphereVertices, m_matSphereTris);
+    TriangleBvh* t_pBvh = MneSurfaceOrVolume::mne_make_surface_bvh(t_pSurf);
+    KdTree* t_pTree = MneSurfaceOrVolume::mne_make_surface_vertex_tree(t_pSurf);
+
+    //
+    //   Several chunks of points and a partial last one: random points, points close to the surface and
+    //   points which are not in use
+    //
+    MatrixX3f t_matNear = nearSurfaceQueries(m_matSphereVertices, m_matSphereTris);
+    const int t_iNRandom = 700;
+
+    MneSourceSpaceOld* t_pSpace = MneSurfaceOrVolume::mne_new_source_space(t_iNRandom + t_matNear.rows());
+    for(int p = 0; p < t_pSpace->np; ++p) {
+        if(p < t_iNRandom) {
+            t_pSpace->rr[p][0] = random(-1.3f, 1.3f);
+            t_pSpace->rr[p][1] = random(-1.3f, 1.3f);
+            t_pSpace->rr[p][2] = random(-1.3f, 1.3f);
+        } else {
+            for(int j = 0; j < 3; ++j)
+                t_pSpace->rr[p][j] = t_matNear(p - t_iNRandom, j);
+        }
+        t_pSpace->inuse[p] = p % 7 != 3;
+    }
+    QVERIFY(t_pSpace->np > 3*256);
+
+    const float t_fLimits[] = { 0.0f, 0.05f, 0.2f };
+    for(int l = 0; l < 3; ++l) {
+        QVector<int> t_vecExpected = bruteClassify(t_pSpace, t_pSurf, m_matSphereVertices, t_fLimits[l]);
+
+        QVERIFY(t_vecExpected.contains(FILTER_KEEP) && t_vecExpected.contains(FILTER_OUTSIDE));
+        if(t_fLimits[l] > 0.0f)
+            QVERIFY(t_vecExpected.contains(FILTER_TOO_CLOSE));
+
+        QVector<int> t_vecStatus(t_pSpace->np, -1);
+        MneSurfaceOrVolume::mne_classify_source_points(t_pSpace, Q_NULLPTR, t_pSurf, t_pBvh, t_pTree, t_fLimits[l], t_vecStatus.data(), false);
+        QCOMPARE(t_vecStatus, t_vecExpected);
+
+        t_vecStatus.fill(-1);
+        MneSurfaceOrVolume::mne_classify_source_points(t_pSpace, Q_NULLPTR, t_pSurf, t_pBvh, t_pTree, t_fLimits[l], t_vecStatus.data(), true);
+        QCOMPARE(t_vecStatus, t_vecExpected);
+    }
+
+    delete t_pSpace;
+    delete t_pTree;
+    delete t_pBvh;
+    delete t_pSurf;
+}
+
+
+//*************************************************************************************************************
+
+void TestSpatialSearch::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestSpatialSearch)
+#include "test_spatial_search.moc"
@@ -41,11 +41,18 @@ SUBDIRS += \
     test_codecov \
     test_dipole_fit \
     test_fiff_rwr \
+    test_fiff_raw_compression \
+    test_fiff_raw_writer \
     test_fiff_mne_types_io \
     test_forward_solution \
     test_fiff_cov \
     test_fiff_digitizer \
     test_mne_msh_display_surface_set \
+    test_filtering \
+    test_rtinvop \
+    test_rtdataclient \
+    test_fiff_stream_server \
+    test_spatial_search \
 
 !contains(MNECPP_CONFIG, minimalVersion) {
     qtHaveModule(charts) {
@@ -2,7 +2,7 @@
 cd bin
 
 :: Array of tests to run
-set tests=test_fiff_rwr test_dipole_fit test_fiff_mne_types_io test_fiff_cov test_fiff_digitizer test_mne_msh_display_surface_set test_geometryinfo  test_interpolation
+set tests=test_fiff_rwr test_fiff_raw_compression test_fiff_raw_writer test_spatial_search test_dipole_fit test_filtering test_rtinvop test_rtdataclient test_fiff_stream_server test_fiff_mne_types_io test_fiff_cov test_fiff_digitizer test_mne_msh_display_surface_set test_geometryinfo  test_interpolation
 
 :: Run tests
 (for %%t in (%tests%) do ( 